@@ -1,13 +1,19 @@
 package db
 
 import (
+	"bytes"
 	"fmt"
+	"io"
 	"net"
+	"strings"
 )
 
 type KeyValueDb struct {
-	host string
-	conn net.Conn
+	network string
+	host    string
+	conn    net.Conn
+	near    *NearCache
+	ring    bool
 }
 
 func ok(e error) {
@@ -20,8 +26,21 @@ func NewKeyValueDb(host string) (db *KeyValueDb, err error) {
 	conn, err := net.Dial("tcp", host)
 
 	return &KeyValueDb{
-		host: host,
-		conn: conn,
+		network: "tcp",
+		host:    host,
+		conn:    conn,
+	}, err
+}
+
+func NewKeyValueDbUnix(path string) (db *KeyValueDb, err error) {
+
+	// a server on the same host also listens on a unix domain socket
+	conn, err := net.Dial("unix", path)
+
+	return &KeyValueDb{
+		network: "unix",
+		host:    path,
+		conn:    conn,
 	}, err
 }
 
@@ -32,7 +51,7 @@ func (db *KeyValueDb) ParseResponse() (resp_buf []byte, err error) {
 	var resp_len_buf []byte = make([]byte, 8)
 	var n int
 
-	n, err = db.conn.Read(resp_len_buf)
+	n, err = io.ReadFull(db.conn, resp_len_buf)
 	if err != nil {
 		return nil, fmt.Errorf("failed to read response length: %w", err)
 	}
@@ -54,9 +73,11 @@ func (db *KeyValueDb) ParseResponse() (resp_buf []byte, err error) {
 	// allocate a response buffer
 	resp_buf = make([]byte, resp_len)
 
-	// receive the response
-	n, err = db.conn.Read(resp_buf)
-	ok(err)
+	// receive the response. large values arrive across many reads
+	n, err = io.ReadFull(db.conn, resp_buf)
+	if err != nil {
+		return nil, fmt.Errorf("failed to read response: %w", err)
+	}
 
 	// error check
 	if int64(n) != resp_len {
@@ -68,32 +89,26 @@ func (db *KeyValueDb) ParseResponse() (resp_buf []byte, err error) {
 
 func (db *KeyValueDb) Get(key string) (response []byte, err error) {
 
-	// error check
-	if db.conn == nil {
-		const maxRetries = 3
-		for i := 0; i < maxRetries; i++ {
-			if err := db.Reconnect(); err == nil {
-				break
-			}
-			if i == maxRetries-1 {
-				return nil, fmt.Errorf("no active connection")
-			}
+	// initialized data
+	var sequence uint64 = 0
+
+	// serve watched keys from the near cache
+	if db.near != nil {
+		var found bool
+		if response, sequence, found = db.near.load(key); found {
+			return response, nil
 		}
 	}
 
-	// construct the get command
-	req := serialize_request(fmt.Sprintf("get %s", key))
-
-	// Send the request to the server
-	_, err = db.conn.Write(req)
+	// get the value from the server
+	buf, err := db.roundTrip(fmt.Sprintf("get %s", key))
 	if err != nil {
-		return nil, fmt.Errorf("failed to send request: %w", err)
+		return nil, err
 	}
 
-	// read the response from the server
-	buf, err := db.ParseResponse()
-	if err != nil {
-		return nil, fmt.Errorf("failed to parse response: %w", err)
+	// remember the value, unless it changed while it was fetched
+	if db.near != nil && bytes.HasPrefix(buf, []byte(`{"okay":true`)) {
+		db.near.store(key, buf, sequence)
 	}
 
 	return buf, nil
@@ -101,6 +116,58 @@ func (db *KeyValueDb) Get(key string) (response []byte, err error) {
 
 func (db *KeyValueDb) Set(key string, value string) (response []byte, err error) {
 
+	// a get racing the push must not cache the old value
+	defer db.invalidate(key)
+
+	// set the value on the server
+	return db.roundTrip(fmt.Sprintf("set %s %s", key, value))
+}
+
+func (db *KeyValueDb) IncrBy(key string, delta int64) (response []byte, err error) {
+
+	// a get racing the push must not cache the old value
+	defer db.invalidate(key)
+
+	// increment the counter on the server, in one round trip
+	return db.roundTrip(fmt.Sprintf("incrby %s %d", key, delta))
+}
+
+func (db *KeyValueDb) Cas(key string, expected string, value string) (response []byte, err error) {
+
+	// a get racing the push must not cache the old value
+	defer db.invalidate(key)
+
+	// compare and set on the server. on a mismatch the response holds the current value
+	return db.roundTrip(fmt.Sprintf("cas %s %s %s", key, expected, value))
+}
+
+func (db *KeyValueDb) Batch(operations ...string) (response []byte, err error) {
+
+	// apply every operation atomically, in one round trip. each operation
+	// is a "set <key> <value>", "incrby <key> <delta>" or "check <key> <version>"
+	command := "batch"
+	for _, operation := range operations {
+		command += "\n" + operation
+
+		// a get racing the push must not cache the old value
+		if fields := strings.Fields(operation); len(fields) > 1 {
+			defer db.invalidate(fields[1])
+		}
+	}
+
+	return db.roundTrip(command + "\nexec")
+}
+
+func (db *KeyValueDb) invalidate(key string) {
+
+	// drop this client's own copy. the push for the write may arrive after the next get
+	if db.near != nil {
+		db.near.invalidate(key)
+	}
+}
+
+func (db *KeyValueDb) roundTrip(command string) (response []byte, err error) {
+
 	// error check
 	if db.conn == nil {
 		const maxRetries = 3
@@ -114,11 +181,8 @@ func (db *KeyValueDb) Set(key string, value string) (response []byte, err error)
 		}
 	}
 
-	// construct the set command
-	req := serialize_request(fmt.Sprintf("set %s %s", key, value))
-
 	// Send the request to the server
-	_, err = db.conn.Write(req)
+	_, err = db.conn.Write(serialize_request(command))
 	if err != nil {
 		return nil, fmt.Errorf("failed to send request: %w", err)
 	}
@@ -136,7 +200,12 @@ func (db *KeyValueDb) Reconnect() error {
 
 	var err error = nil
 
-	db.conn, err = net.Dial("tcp", db.host)
+	db.conn, err = net.Dial(db.network, db.host)
+
+	// ask for rings again, on the new connection
+	if err == nil && db.ring {
+		err = db.EnableRing()
+	}
 
 	// done
 	return err
@@ -149,6 +218,11 @@ func (db *KeyValueDb) Close() error {
 		return fmt.Errorf("no active connection")
 	}
 
+	// stop the near cache
+	if db.near != nil {
+		db.near.Close()
+	}
+
 	// construct the exit command
 	req := serialize_request("exit")
 
@@ -0,0 +1,181 @@
+package db
+
+import (
+	"bytes"
+	"encoding/json"
+	"fmt"
+	"net"
+	"strings"
+	"sync"
+)
+
+// a push frame. a frame without a value invalidates the key
+type watchFrame struct {
+	Watch   string          `json:"watch"`
+	Version uint64          `json:"version"`
+	Value   json.RawMessage `json:"value"`
+}
+
+type NearCache struct {
+	mutex    sync.Mutex
+	entries  map[string][]byte
+	prefixes []string
+	conn     net.Conn
+	sequence uint64
+	online   bool
+}
+
+func (db *KeyValueDb) EnableNearCache(prefixes ...string) (err error) {
+
+	// initialized data
+	var near *NearCache = &NearCache{
+		entries:  make(map[string][]byte),
+		prefixes: prefixes,
+		online:   true,
+	}
+
+	// pushes arrive on their own connection, so they never interleave with responses
+	near.conn, err = net.Dial(db.network, db.host)
+	if err != nil {
+		return fmt.Errorf("failed to connect watcher: %w", err)
+	}
+
+	// watch each prefix
+	for _, prefix := range prefixes {
+		_, err = near.conn.Write(serialize_request(fmt.Sprintf("watch %s", prefix)))
+		if err != nil {
+			near.conn.Close()
+			return fmt.Errorf("failed to send watch: %w", err)
+		}
+	}
+
+	// wait until every watch is in place, so nothing is cached before it is watched
+	for acked := 0; acked < len(prefixes); {
+
+		// read the next frame
+		buf, err := (&KeyValueDb{conn: near.conn}).ParseResponse()
+		if err != nil {
+			near.conn.Close()
+			return fmt.Errorf("failed to read watch response: %w", err)
+		}
+
+		// nothing is cached yet, so early pushes can be skipped
+		var frame watchFrame
+		if json.Unmarshal(buf, &frame) == nil && frame.Watch != "" {
+			continue
+		}
+
+		// error check
+		if !bytes.HasPrefix(buf, []byte(`{"okay":true`)) {
+			near.conn.Close()
+			return fmt.Errorf("watch refused: %s", buf)
+		}
+
+		acked++
+	}
+
+	// apply pushes until the connection drops
+	go near.listen()
+
+	db.near = near
+
+	return nil
+}
+
+func (near *NearCache) listen() {
+
+	// initialized data
+	var watcher *KeyValueDb = &KeyValueDb{conn: near.conn}
+
+	for {
+
+		// read the next frame
+		buf, err := watcher.ParseResponse()
+		if err != nil {
+			break
+		}
+
+		// skip anything that is not a push
+		var frame watchFrame
+		if json.Unmarshal(buf, &frame) != nil || frame.Watch == "" {
+			continue
+		}
+
+		near.mutex.Lock()
+
+		// any fetch in flight may have read an older value
+		near.sequence++
+
+		// update a cached key, or drop it when the value was not pushed
+		if _, found := near.entries[frame.Watch]; found {
+			if len(frame.Value) > 0 {
+				near.entries[frame.Watch] = append(append([]byte(`{"okay":true,"value":`), frame.Value...), '}')
+			} else {
+				delete(near.entries, frame.Watch)
+			}
+		}
+
+		near.mutex.Unlock()
+	}
+
+	// without pushes the cache can not stay coherent, so stop using it
+	near.mutex.Lock()
+	near.online = false
+	near.entries = nil
+	near.mutex.Unlock()
+}
+
+func (near *NearCache) watching(key string) bool {
+
+	// search the prefixes
+	for _, prefix := range near.prefixes {
+		if strings.HasPrefix(key, prefix) {
+			return true
+		}
+	}
+
+	return false
+}
+
+func (near *NearCache) load(key string) (response []byte, sequence uint64, found bool) {
+
+	near.mutex.Lock()
+	defer near.mutex.Unlock()
+
+	// error check
+	if !near.online || !near.watching(key) {
+		return nil, 0, false
+	}
+
+	response, found = near.entries[key]
+
+	return response, near.sequence, found
+}
+
+func (near *NearCache) store(key string, response []byte, sequence uint64) {
+
+	near.mutex.Lock()
+	defer near.mutex.Unlock()
+
+	// only keep the response if no push arrived while it was fetched
+	if near.online && near.sequence == sequence && near.watching(key) {
+		near.entries[key] = response
+	}
+}
+
+func (near *NearCache) invalidate(key string) {
+
+	near.mutex.Lock()
+	defer near.mutex.Unlock()
+
+	// any fetch in flight may have read the value before the write
+	near.sequence++
+
+	delete(near.entries, key)
+}
+
+func (near *NearCache) Close() error {
+
+	// stop listening. listen takes the cache offline
+	return near.conn.Close()
+}
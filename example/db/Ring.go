@@ -0,0 +1,317 @@
+//go:build linux
+
+package db
+
+import (
+	"bytes"
+	"encoding/json"
+	"fmt"
+	"io"
+	"net"
+	"sync/atomic"
+	"syscall"
+	"time"
+	"unsafe"
+)
+
+// the layout of a ring's header, which the server maps too
+const (
+	ringHead          = 0
+	ringTail          = 64
+	ringReadable      = 128
+	ringReaderWaiting = 132
+	ringWritable      = 192
+	ringWriterWaiting = 196
+	ringClosed        = 256
+	ringCapacity      = 264
+	ringHeader        = 320
+	ringSpin          = 4096
+	ringPoll          = 100 * time.Millisecond
+	futexWait         = 0
+	futexWake         = 1
+)
+
+// a single producer, single consumer byte ring in shared memory
+type ring struct {
+	memory   []byte
+	capacity uint64
+}
+
+// a connection whose frames travel on two rings. the socket only tells
+// each side the other is still there
+type ringConn struct {
+	*net.UnixConn
+	region    []byte
+	requests  *ring
+	responses *ring
+}
+
+func (r *ring) u64(offset int) *uint64 {
+	return (*uint64)(unsafe.Pointer(&r.memory[offset]))
+}
+
+func (r *ring) u32(offset int) *uint32 {
+	return (*uint32)(unsafe.Pointer(&r.memory[offset]))
+}
+
+func (r *ring) ready(reader bool) bool {
+
+	// the reader waits for bytes, and the writer for room
+	if reader {
+		return atomic.LoadUint64(r.u64(ringHead)) != *r.u64(ringTail)
+	}
+	return *r.u64(ringHead)-atomic.LoadUint64(r.u64(ringTail)) < r.capacity
+}
+
+func (r *ring) closed() bool {
+	return atomic.LoadUint32(r.u32(ringClosed)) != 0
+}
+
+func (r *ring) wake(offset int) {
+
+	// change the word, so a side about to sleep does not, then wake the sleeper
+	atomic.AddUint32(r.u32(offset), 1)
+	syscall.Syscall6(syscall.SYS_FUTEX, uintptr(unsafe.Pointer(r.u32(offset))), futexWake, 1, 0, 0, 0)
+}
+
+func (r *ring) wait(reader bool) bool {
+
+	// initialized data
+	signal, waiting := ringWritable, ringWriterWaiting
+	if reader {
+		signal, waiting = ringReadable, ringReaderWaiting
+	}
+
+	// poll, then sleep once
+	for spin := 0; ; spin++ {
+
+		// ready
+		if r.ready(reader) {
+			return true
+		}
+
+		// closed. the other side may have written its last bytes just before
+		if r.closed() {
+			return reader && r.ready(reader)
+		}
+
+		// poll
+		if spin < ringSpin {
+			continue
+		}
+
+		// already slept
+		if spin > ringSpin {
+			return false
+		}
+
+		// say this side is sleeping, then look again, so a wake is never missed
+		value := atomic.LoadUint32(r.u32(signal))
+		atomic.StoreUint32(r.u32(waiting), 1)
+		if !r.ready(reader) && !r.closed() {
+			timeout := syscall.NsecToTimespec(int64(ringPoll))
+			syscall.Syscall6(syscall.SYS_FUTEX, uintptr(unsafe.Pointer(r.u32(signal))), futexWait, uintptr(value), uintptr(unsafe.Pointer(&timeout)), 0, 0)
+		}
+		atomic.StoreUint32(r.u32(waiting), 0)
+	}
+}
+
+func (r *ring) read(p []byte) (n int, err error) {
+
+	// wait for bytes
+	if !r.wait(true) {
+		if r.closed() {
+			return 0, io.EOF
+		}
+		return 0, nil
+	}
+
+	// the bytes the writer published. more than the capacity is a broken ring
+	tail := *r.u64(ringTail)
+	available := atomic.LoadUint64(r.u64(ringHead)) - tail
+	if available > r.capacity {
+		r.close()
+		return 0, fmt.Errorf("broken ring")
+	}
+	if available > uint64(len(p)) {
+		available = uint64(len(p))
+	}
+
+	// copy the bytes, which may wrap around the end
+	offset := tail & (r.capacity - 1)
+	first := copy(p[:available], r.memory[ringHeader+offset:ringHeader+r.capacity])
+	copy(p[first:available], r.memory[ringHeader:])
+
+	// give the room back, and wake a waiting writer
+	atomic.StoreUint64(r.u64(ringTail), tail+available)
+	if atomic.LoadUint32(r.u32(ringWriterWaiting)) != 0 {
+		r.wake(ringWritable)
+	}
+
+	return int(available), nil
+}
+
+func (r *ring) write(p []byte) (n int, err error) {
+
+	// wait for room
+	if !r.wait(false) {
+		if r.closed() {
+			return 0, io.ErrClosedPipe
+		}
+		return 0, nil
+	}
+
+	// the room the reader gave back. less than none is a broken ring
+	head := *r.u64(ringHead)
+	used := head - atomic.LoadUint64(r.u64(ringTail))
+	if used > r.capacity {
+		r.close()
+		return 0, fmt.Errorf("broken ring")
+	}
+	length := r.capacity - used
+	if length > uint64(len(p)) {
+		length = uint64(len(p))
+	}
+
+	// copy the bytes, which may wrap around the end
+	offset := head & (r.capacity - 1)
+	first := copy(r.memory[ringHeader+offset:ringHeader+r.capacity], p[:length])
+	copy(r.memory[ringHeader:], p[first:length])
+
+	// publish the bytes, and wake a waiting reader
+	atomic.StoreUint64(r.u64(ringHead), head+length)
+	if atomic.LoadUint32(r.u32(ringReaderWaiting)) != 0 {
+		r.wake(ringReadable)
+	}
+
+	return int(length), nil
+}
+
+func (r *ring) close() {
+
+	// close the ring, and wake both sides
+	atomic.StoreUint32(r.u32(ringClosed), 1)
+	r.wake(ringReadable)
+	r.wake(ringWritable)
+}
+
+func (c *ringConn) alive() bool {
+
+	// nothing follows the rings on the socket, so anything but a timeout means the server is gone
+	var peek [1]byte
+	c.UnixConn.SetReadDeadline(time.Now().Add(time.Millisecond))
+	_, err := c.UnixConn.Read(peek[:])
+	timeout, isTimeout := err.(net.Error)
+	return isTimeout && timeout.Timeout()
+}
+
+func (c *ringConn) Read(p []byte) (n int, err error) {
+
+	// wait for responses, and check on the server between waits
+	for n == 0 && err == nil {
+		if n, err = c.responses.read(p); n == 0 && err == nil && !c.alive() {
+			err = io.EOF
+		}
+	}
+
+	return n, err
+}
+
+func (c *ringConn) Write(p []byte) (n int, err error) {
+
+	// write until every byte is in the ring
+	for n < len(p) && err == nil {
+		var written int
+		if written, err = c.requests.write(p[n:]); written == 0 && err == nil && !c.alive() {
+			err = io.ErrClosedPipe
+		}
+		n += written
+	}
+
+	return n, err
+}
+
+func (c *ringConn) Close() error {
+
+	// tell the server, and release the rings
+	c.requests.close()
+	syscall.Munmap(c.region)
+
+	return c.UnixConn.Close()
+}
+
+func (db *KeyValueDb) EnableRing() (err error) {
+
+	// initialized data
+	var response struct {
+		Okay  bool `json:"okay"`
+		Value struct {
+			Capacity uint64 `json:"capacity"`
+		} `json:"value"`
+	}
+	var buf []byte = make([]byte, 256)
+	var oob []byte = make([]byte, syscall.CmsgSpace(4))
+	var fds []int
+
+	// rings are negotiated on a unix domain socket
+	conn, isUnix := db.conn.(*net.UnixConn)
+	if !isUnix {
+		return fmt.Errorf("rings need a unix domain socket")
+	}
+
+	// ask for rings
+	_, err = conn.Write(serialize_request("ring"))
+	if err != nil {
+		return fmt.Errorf("failed to send ring: %w", err)
+	}
+
+	// the response carries the shared memory's descriptor
+	n, oobn, _, _, err := conn.ReadMsgUnix(buf, oob)
+	if err != nil {
+		return fmt.Errorf("failed to read ring response: %w", err)
+	}
+	if messages, err := syscall.ParseSocketControlMessage(oob[:oobn]); err == nil && len(messages) > 0 {
+		fds, _ = syscall.ParseUnixRights(&messages[0])
+	}
+
+	// error check
+	if n < 8 || json.Unmarshal(bytes.TrimRight(buf[8:n], "\x00"), &response) != nil || !response.Okay || len(fds) != 1 {
+		for _, fd := range fds {
+			syscall.Close(fd)
+		}
+		return fmt.Errorf("ring refused: %s", buf[:n])
+	}
+
+	// error check
+	capacity := response.Value.Capacity
+	if capacity == 0 || capacity&(capacity-1) != 0 {
+		syscall.Close(fds[0])
+		return fmt.Errorf("bad ring capacity %d", capacity)
+	}
+
+	// map the rings. the mapping keeps the memory
+	region, err := syscall.Mmap(fds[0], 0, int(2*(ringHeader+capacity)), syscall.PROT_READ|syscall.PROT_WRITE, syscall.MAP_SHARED)
+	syscall.Close(fds[0])
+	if err != nil {
+		return fmt.Errorf("failed to map rings: %w", err)
+	}
+
+	// the request ring, then the response ring
+	rings := &ringConn{
+		UnixConn:  conn,
+		region:    region,
+		requests:  &ring{memory: region[:ringHeader+capacity], capacity: capacity},
+		responses: &ring{memory: region[ringHeader+capacity:], capacity: capacity},
+	}
+
+	// error check
+	if *rings.requests.u64(ringCapacity) != capacity || *rings.responses.u64(ringCapacity) != capacity {
+		syscall.Munmap(region)
+		return fmt.Errorf("rings do not match capacity %d", capacity)
+	}
+
+	db.conn = rings
+	db.ring = true
+
+	return nil
+}
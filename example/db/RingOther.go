@@ -0,0 +1,11 @@
+//go:build !linux
+
+package db
+
+import "fmt"
+
+func (db *KeyValueDb) EnableRing() (err error) {
+
+	// rings sleep on a futex, which only linux has
+	return fmt.Errorf("rings are not supported on this platform")
+}
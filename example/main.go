@@ -7,6 +7,7 @@ import (
 	"key_value_db/db"
 	"net/http"
 	"os"
+	"strings"
 )
 
 // data
@@ -106,10 +107,26 @@ func main() {
 	// log
 	fmt.Printf("Connecting to key value database on %s\n", addr)
 
-	// construct a database connection
-	database, err = db.NewKeyValueDb(addr)
+	// construct a database connection. a server on this host may be reached on its unix domain socket
+	if path, isUnix := strings.CutPrefix(addr, "unix:"); isUnix {
+		database, err = db.NewKeyValueDbUnix(path)
+	} else {
+		database, err = db.NewKeyValueDb(addr)
+	}
 	ok(err)
 
+	// move requests and responses to shared memory rings
+	if os.Getenv("RING") != "" {
+		fmt.Printf("Using shared memory rings\n")
+		ok(database.EnableRing())
+	}
+
+	// serve keys under these comma separated prefixes from a near cache
+	if prefixes := os.Getenv("NEAR_CACHE"); prefixes != "" {
+		fmt.Printf("Caching keys under %s\n", prefixes)
+		ok(database.EnableNearCache(strings.Split(prefixes, ",")...))
+	}
+
 	// log
 	fmt.Printf("Listening for http requests on :3013\n")
 
@@ -0,0 +1,151 @@
+/** !
+ * B+tree of string keys. Each node keeps the prefix its keys share once, and
+ * the next 8 bytes of each key as an integer, so most comparisons are made
+ * on a few cache lines of integers, without following a pointer to the key.
+ * Leaves hold values, and are linked in key order, for range walks
+ *
+ * @file key_value/b_plus_tree.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// gsdk
+#include <gsdk.h>
+
+/// core
+#include <core/log.h>
+
+// key value
+#include <key_value/memory.h>
+
+// preprocessor definitions
+#define B_PLUS_TREE_FANOUT     32  // keys of a leaf, and separators of an inner node. the heads fill 4 cache lines
+#define B_PLUS_TREE_MIN        ( B_PLUS_TREE_FANOUT / 4 )
+#define B_PLUS_TREE_KEY_MAX    64  // including the null terminator
+#define B_PLUS_TREE_DEPTH_MAX  16
+
+// structure declarations
+struct b_plus_tree_s;
+struct b_plus_tree_statistics_s;
+
+// type definitions
+typedef struct b_plus_tree_s            b_plus_tree;
+typedef struct b_plus_tree_statistics_s b_plus_tree_statistics;
+
+/** !
+ * Get the key of a value
+ *
+ * @param p_value the value
+ *
+ * @return the key
+ */
+typedef const char *(fn_b_plus_tree_key)( const void *p_value );
+
+/** !
+ * Called for each value of a range
+ *
+ * @param p_value     the value
+ * @param p_parameter the parameter
+ *
+ * @return 1 to continue, 0 to stop
+ */
+typedef int (fn_b_plus_tree_value)( void *p_value, void *p_parameter );
+
+// structure definitions
+struct b_plus_tree_statistics_s
+{
+    size_t count,   // values
+           height,  // levels, including the leaves
+           leaves,
+           inners;
+};
+
+// forward declarations
+/// constructors
+/** !
+ * Construct a B+tree
+ *
+ * @param pp_b_plus_tree return
+ * @param pfn_key        the function that gets the key of a value. keys are at most B_PLUS_TREE_KEY_MAX - 1 characters
+ *
+ * @return 1 on success, 0 on error
+ */
+int b_plus_tree_construct ( b_plus_tree **pp_b_plus_tree, fn_b_plus_tree_key *pfn_key );
+
+/// accessors
+/** !
+ * Find the value of a key
+ *
+ * @param p_b_plus_tree the B+tree
+ * @param p_key         the key
+ * @param pp_value      return
+ *
+ * @return 1 if the key is in the tree, 0 otherwise
+ */
+int b_plus_tree_search ( b_plus_tree *p_b_plus_tree, const char *p_key, void **pp_value );
+
+/** !
+ * Call a function with each value, in key order, from the first key at or
+ * after a key
+ *
+ * @param p_b_plus_tree the B+tree
+ * @param p_first       the key to start at, or null pointer for the first key
+ * @param pfn_value     the function
+ * @param p_parameter   the parameter of the function
+ *
+ * @return 1 if every call continued, 0 otherwise
+ */
+int b_plus_tree_range ( b_plus_tree *p_b_plus_tree, const char *p_first, fn_b_plus_tree_value *pfn_value, void *p_parameter );
+
+/** !
+ * Get the size, and the shape, of a B+tree
+ *
+ * @param p_b_plus_tree the B+tree
+ * @param p_statistics  return
+ *
+ * @return void
+ */
+void b_plus_tree_statistics_get ( b_plus_tree *p_b_plus_tree, b_plus_tree_statistics *p_statistics );
+
+/// mutators
+/** !
+ * Insert a value. A value whose key is after every key in the tree leaves
+ * the full leaf behind, so keys inserted in order are loaded into full leaves
+ *
+ * @param p_b_plus_tree the B+tree
+ * @param p_value       the value
+ *
+ * @return 1 on success, 0 if the key is already in the tree, or on error
+ */
+int b_plus_tree_insert ( b_plus_tree *p_b_plus_tree, void *p_value );
+
+/** !
+ * Remove the value of a key. A node under B_PLUS_TREE_MIN keys borrows
+ * from, or merges with, a sibling
+ *
+ * @param p_b_plus_tree the B+tree
+ * @param p_key         the key
+ * @param pp_value      return the value, or null pointer
+ *
+ * @return 1 on success, 0 if the key is not in the tree
+ */
+int b_plus_tree_remove ( b_plus_tree *p_b_plus_tree, const char *p_key, void **pp_value );
+
+/// destructors
+/** !
+ * Destroy a B+tree. The values are owned by the caller, and are not freed
+ *
+ * @param pp_b_plus_tree pointer to the B+tree
+ *
+ * @return 1 on success, 0 on error
+ */
+int b_plus_tree_destroy ( b_plus_tree **pp_b_plus_tree );
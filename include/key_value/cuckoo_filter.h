@@ -0,0 +1,123 @@
+/** !
+ * Cuckoo filter
+ *
+ * @file key_value/cuckoo_filter.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// gsdk
+#include <gsdk.h>
+
+/// core
+#include <core/log.h>
+
+// key value
+#include <key_value/memory.h>
+
+// preprocessor definitions
+#define CUCKOO_FILTER_SLOTS  4
+#define CUCKOO_FILTER_KICKS  500
+
+// structure declarations
+struct cuckoo_filter_s;
+
+// type definitions
+typedef struct cuckoo_filter_s cuckoo_filter;
+
+// forward declarations
+/// constructors
+/** !
+ * Construct a cuckoo filter. The bucket count is rounded up to a power of two
+ *
+ * @param pp_cuckoo_filter return
+ * @param capacity         the quantity of keys the filter should hold
+ *
+ * @return 1 on success, 0 on error
+ */
+int cuckoo_filter_construct ( cuckoo_filter **pp_cuckoo_filter, size_t capacity );
+
+/// mutators
+/** !
+ * Add a key. A key may be added more than once, and must then be removed as
+ * many times. A full filter grows by a table twice as large as its newest,
+ * and the keys already added stay where they are
+ *
+ * @param p_cuckoo_filter the cuckoo filter
+ * @param p_key           the key
+ * @param length          the length of the key
+ *
+ * @return 1 on success, 0 if the filter is full and can not grow. The filter
+ *         still holds every key added to it
+ */
+int cuckoo_filter_add ( cuckoo_filter *p_cuckoo_filter, const char *p_key, size_t length );
+
+/** !
+ * Remove a key. Only keys that were added may be removed, or the fingerprint
+ * of another key may be removed in its place
+ *
+ * @param p_cuckoo_filter the cuckoo filter
+ * @param p_key           the key
+ * @param length          the length of the key
+ *
+ * @return 1 if a fingerprint was removed, 0 otherwise
+ */
+int cuckoo_filter_remove ( cuckoo_filter *p_cuckoo_filter, const char *p_key, size_t length );
+
+/// accessors
+/** !
+ * Test if a key may have been added
+ *
+ * @param p_cuckoo_filter the cuckoo filter
+ * @param p_key           the key
+ * @param length          the length of the key
+ *
+ * @return false if the key was definitely not added, true otherwise
+ */
+bool cuckoo_filter_contains ( cuckoo_filter *p_cuckoo_filter, const char *p_key, size_t length );
+
+/** !
+ * Test if the newest table of the filter is full, so the next add grows it
+ *
+ * @param p_cuckoo_filter the cuckoo filter
+ *
+ * @return true if the newest table is full, false otherwise
+ */
+bool cuckoo_filter_full ( cuckoo_filter *p_cuckoo_filter );
+
+/** !
+ * Get the quantity of fingerprints in the filter
+ *
+ * @param p_cuckoo_filter the cuckoo filter
+ *
+ * @return the quantity of fingerprints
+ */
+size_t cuckoo_filter_count ( cuckoo_filter *p_cuckoo_filter );
+
+/** !
+ * Get the quantity of fingerprints the tables of the filter have room for
+ *
+ * @param p_cuckoo_filter the cuckoo filter
+ *
+ * @return the quantity of slots
+ */
+size_t cuckoo_filter_capacity ( cuckoo_filter *p_cuckoo_filter );
+
+/// destructors
+/** !
+ * Destroy a cuckoo filter
+ *
+ * @param pp_cuckoo_filter pointer to the cuckoo filter
+ *
+ * @return 1 on success, 0 on error
+ */
+int cuckoo_filter_destroy ( cuckoo_filter **pp_cuckoo_filter );
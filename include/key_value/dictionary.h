@@ -0,0 +1,161 @@
+/** !
+ * Shared compression dictionaries, trained from sample values
+ *
+ * @file key_value/dictionary.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+// gsdk
+#include <gsdk.h>
+
+/// core
+#include <core/log.h>
+
+// key value
+#include <key_value/memory.h>
+
+// preprocessor definitions
+#define DICTIONARY_SIZE_MAX     16384  // matches are encoded with 16 bit distances
+#define DICTIONARY_INPUT_MAX    32768
+#define DICTIONARY_MATCH_MIN    4
+#define DICTIONARY_MATCH_MAX    ( 127 + DICTIONARY_MATCH_MIN )
+#define DICTIONARY_LITERAL_MAX  128
+#define DICTIONARY_TABLE_BITS   12
+#define DICTIONARY_KMER         8      // the length of the substrings training counts
+#define DICTIONARY_SEGMENT      32     // the length of the pieces training picks
+#define DICTIONARY_COUNT_BITS   16
+#define DICTIONARY_PASSES       8
+
+// structure declarations
+struct dictionary_s;
+struct dictionary_statistics_s;
+
+// type definitions
+typedef struct dictionary_s            dictionary;
+typedef struct dictionary_statistics_s dictionary_statistics;
+
+// structure definitions
+struct dictionary_statistics_s
+{
+
+    // values stored packed, and their sizes before and after
+    size_t values,
+           raw_bytes,
+           packed_bytes;
+
+    // since startup
+    unsigned long long compressions,
+                       compress_ns,
+                       decompressions,
+                       decompress_ns;
+};
+
+// forward declarations
+/// constructors
+/** !
+ * Train a dictionary from sample values. Substrings that recur across the
+ * samples are kept, the most common last, up to a capacity
+ *
+ * @param pp_dictionary return
+ * @param pp_samples    the samples
+ * @param p_lengths     the length of each sample
+ * @param count         the quantity of samples
+ * @param capacity      the largest dictionary, up to DICTIONARY_SIZE_MAX bytes
+ *
+ * @return 1 on success, 0 on error
+ */
+int dictionary_train ( dictionary **pp_dictionary, const char *const *pp_samples, const size_t *p_lengths, size_t count, size_t capacity );
+
+/// reference counting
+/** !
+ * Take a reference for a value packed with a dictionary
+ *
+ * @param p_dictionary the dictionary
+ * @param raw          the length of the value
+ * @param packed       the length of the packed value
+ *
+ * @return void
+ */
+void dictionary_retain ( dictionary *p_dictionary, size_t raw, size_t packed );
+
+/** !
+ * Drop the reference of a value packed with a dictionary, releasing the
+ * dictionary with the last reference
+ *
+ * @param p_dictionary the dictionary
+ * @param raw          the length of the value
+ * @param packed       the length of the packed value
+ *
+ * @return void
+ */
+void dictionary_release ( dictionary *p_dictionary, size_t raw, size_t packed );
+
+/// compression
+/** !
+ * Compress a value. Matches may refer to the dictionary, or to earlier bytes
+ * of the value
+ *
+ * @param p_dictionary the dictionary
+ * @param p_text       the value
+ * @param length       the length of the value
+ * @param p_buffer     the compressed value
+ * @param capacity     the size of the buffer
+ * @param p_length     return the length of the compressed value
+ *
+ * @return 1 on success, 0 if the value does not compress to capacity bytes
+ */
+int dictionary_compress ( const dictionary *p_dictionary, const char *p_text, size_t length, char *p_buffer, size_t capacity, size_t *p_length );
+
+/** !
+ * Decompress a value
+ *
+ * @param p_dictionary the dictionary the value was compressed with
+ * @param p_packed     the compressed value
+ * @param packed       the length of the compressed value
+ * @param p_buffer     the value
+ * @param length       the length of the value
+ *
+ * @return 1 on success, 0 on error
+ */
+int dictionary_decompress ( const dictionary *p_dictionary, const char *p_packed, size_t packed, char *p_buffer, size_t length );
+
+/// accessors
+/** !
+ * Get the size of a dictionary
+ *
+ * @param p_dictionary the dictionary
+ *
+ * @return the quantity of bytes
+ */
+size_t dictionary_length ( const dictionary *p_dictionary );
+
+/** !
+ * Get the packed values, and the time spent compressing and decompressing
+ *
+ * @param p_statistics return
+ *
+ * @return void
+ */
+void dictionary_statistics_get ( dictionary_statistics *p_statistics );
+
+/// destructors
+/** !
+ * Drop the owner's reference to a dictionary. Values packed with it keep it
+ * until they are released
+ *
+ * @param pp_dictionary pointer to the dictionary
+ *
+ * @return 1 on success, 0 on error
+ */
+int dictionary_destroy ( dictionary **pp_dictionary );
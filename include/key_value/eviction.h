@@ -0,0 +1,113 @@
+/** !
+ * Approximate LRU / LFU eviction
+ *
+ * @file key_value/eviction.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// gsdk
+#include <gsdk.h>
+
+// preprocessor definitions
+#define EVICTION_SAMPLES         5
+#define EVICTION_LFU_INIT        5
+#define EVICTION_LFU_LOG_FACTOR  10
+#define EVICTION_LFU_DECAY_TIME  60
+
+// enumeration definitions
+enum eviction_policy_e
+{
+    EVICTION_POLICY_LRU = 0,
+    EVICTION_POLICY_LFU = 1
+};
+
+// structure declarations
+struct eviction_meta_s;
+
+// type definitions
+typedef enum   eviction_policy_e eviction_policy;
+typedef struct eviction_meta_s   eviction_meta;
+
+// structure definitions
+struct eviction_meta_s
+{
+    unsigned int  clock;    // seconds, at the last access
+    unsigned char counter;  // logarithmic access frequency
+};
+
+// forward declarations
+/// initializer
+/** !
+ * Initialize the eviction metadata of a new record
+ *
+ * @param p_eviction_meta the eviction metadata
+ * @param now             the current time in seconds
+ *
+ * @return void
+ */
+void eviction_meta_init ( eviction_meta *p_eviction_meta, unsigned int now );
+
+/// mutators
+/** !
+ * Record an access. The LFU counter is decayed by the idle time, and then
+ * incremented with a probability that falls as the counter grows
+ *
+ * @param p_eviction_meta the eviction metadata
+ * @param now             the current time in seconds
+ * @param random          a uniformly distributed random number
+ *
+ * @return void
+ */
+void eviction_meta_touch ( eviction_meta *p_eviction_meta, unsigned int now, unsigned long long random );
+
+/// accessors
+/** !
+ * Score a record for eviction. Higher scores are better victims
+ *
+ * @param p_eviction_meta the eviction metadata
+ * @param policy          the eviction policy
+ * @param now             the current time in seconds
+ *
+ * @return the score
+ */
+unsigned long long eviction_meta_score ( const eviction_meta *p_eviction_meta, eviction_policy policy, unsigned int now );
+
+/// random
+/** !
+ * Advance an xorshift generator
+ *
+ * @param p_state the generator state. Must be non zero
+ *
+ * @return the next random number
+ */
+unsigned long long eviction_random ( unsigned long long *p_state );
+
+/// parsers
+/** !
+ * Parse an eviction policy name
+ *
+ * @param p_name   "lru" or "lfu"
+ * @param p_policy return
+ *
+ * @return 1 on success, 0 on error
+ */
+int eviction_policy_parse ( const char *p_name, eviction_policy *p_policy );
+
+/** !
+ * Get the name of an eviction policy
+ *
+ * @param policy the eviction policy
+ *
+ * @return the name
+ */
+const char *eviction_policy_name ( eviction_policy policy );
@@ -0,0 +1,147 @@
+/** !
+ * Self sizing W-TinyLFU front cache
+ *
+ * @file key_value/front_cache.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// gsdk
+#include <gsdk.h>
+
+/// core
+#include <core/log.h>
+
+// key value
+#include <key_value/memory.h>
+
+// preprocessor definitions
+#define FRONT_CACHE_CAPACITY_MIN 64
+
+// structure declarations
+struct front_cache_s;
+struct front_cache_statistics_s;
+
+// type definitions
+typedef struct front_cache_s            front_cache;
+typedef struct front_cache_statistics_s front_cache_statistics;
+
+// structure definitions
+struct front_cache_statistics_s
+{
+    size_t hits,
+           misses,
+           admitted,
+           rejected,
+           evicted,
+           size,
+           capacity,
+           capacity_max,
+           window;
+};
+
+// forward declarations
+/// constructors
+/** !
+ * Construct a front cache. Keys are borrowed, and must outlive their entry
+ *
+ * @param pp_front_cache return
+ * @param capacity       the initial quantity of entries
+ * @param budget         the most memory the cache may use, in bytes
+ *
+ * @return 1 on success, 0 on error
+ */
+int front_cache_construct ( front_cache **pp_front_cache, size_t capacity, size_t budget );
+
+/// accessors
+/** !
+ * Find a value in the cache. Hits and misses both count towards the
+ * frequency sketch, and towards the sizing statistics
+ *
+ * @param p_front_cache the front cache
+ * @param p_key         the key
+ * @param pp_value      return
+ *
+ * @return 1 on hit, 0 on miss
+ */
+int front_cache_find ( front_cache *p_front_cache, const char *p_key, void **pp_value );
+
+/** !
+ * Get the cache statistics
+ *
+ * @param p_front_cache the front cache
+ * @param p_statistics  return
+ *
+ * @return 1 on success, 0 on error
+ */
+int front_cache_statistics_get ( front_cache *p_front_cache, front_cache_statistics *p_statistics );
+
+/** !
+ * List the cached keys, hottest first. Keys are ordered by their sketch
+ * estimate, and keys with equal estimates by segment, protected first, then
+ * by recency. Keys are borrowed from the cache
+ *
+ * @param p_front_cache  the front cache
+ * @param pp_keys        return
+ * @param p_frequencies  return, the sketch estimate of each key
+ * @param max            the most keys to list
+ *
+ * @return the quantity of keys listed
+ */
+size_t front_cache_hot ( front_cache *p_front_cache, const char **pp_keys, unsigned int *p_frequencies, size_t max );
+
+/// mutators
+/** !
+ * Offer a value to the cache after a miss. The value enters the admission
+ * window, and only displaces a main region entry if it is used more often
+ *
+ * @param p_front_cache the front cache
+ * @param p_key         the key
+ * @param p_value       the value
+ *
+ * @return 1 on success, 0 on error
+ */
+int front_cache_insert ( front_cache *p_front_cache, const char *p_key, void *p_value );
+
+/** !
+ * Place a value directly in the main region, without an admission contest,
+ * and raise its sketch estimate to a recorded frequency. This is for warming
+ * the cache with a hot set recorded before a restart
+ *
+ * @param p_front_cache the front cache
+ * @param p_key         the key
+ * @param p_value       the value
+ * @param frequency     the recorded frequency, from front_cache_hot
+ *
+ * @return 1 on success, 0 on error or if the cache is full
+ */
+int front_cache_warm ( front_cache *p_front_cache, const char *p_key, void *p_value, unsigned int frequency );
+
+/** !
+ * Remove a value from the cache. Removing a missing key is a no-op
+ *
+ * @param p_front_cache the front cache
+ * @param p_key         the key
+ *
+ * @return 1 on success, 0 on error
+ */
+int front_cache_remove ( front_cache *p_front_cache, const char *p_key );
+
+/// destructors
+/** !
+ * Destroy a front cache
+ *
+ * @param pp_front_cache pointer to the front cache
+ *
+ * @return 1 on success, 0 on error
+ */
+int front_cache_destroy ( front_cache **pp_front_cache );
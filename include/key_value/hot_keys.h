@@ -0,0 +1,107 @@
+/** !
+ * Heavy hitters, with a count min sketch and a top K list
+ *
+ * @file key_value/hot_keys.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// gsdk
+#include <gsdk.h>
+
+/// core
+#include <core/log.h>
+
+// key value
+#include <key_value/memory.h>
+
+// preprocessor definitions
+#define HOT_KEYS_DEPTH    4
+#define HOT_KEYS_WIDTH    4096
+#define HOT_KEYS_TOP      10
+#define HOT_KEYS_KEY_MAX  64
+
+// structure declarations
+struct hot_keys_s;
+struct hot_keys_entry_s;
+
+// type definitions
+typedef struct hot_keys_s       hot_keys;
+typedef struct hot_keys_entry_s hot_keys_entry;
+
+// structure definitions
+struct hot_keys_entry_s
+{
+    char               _key[HOT_KEYS_KEY_MAX];
+    unsigned long long hash,
+                       count;  // decayed estimate
+    double             rate;   // per second
+};
+
+// forward declarations
+/// constructors
+/** !
+ * Construct a heavy hitter tracker. Every counter is halved once per interval
+ *
+ * @param pp_hot_keys return
+ * @param interval    the milliseconds between halvings
+ * @param now         the current time in milliseconds
+ *
+ * @return 1 on success, 0 on error
+ */
+int hot_keys_construct ( hot_keys **pp_hot_keys, unsigned long long interval, unsigned long long now );
+
+/// mutators
+/** !
+ * Count one access to a key. The sketch is updated conservatively, and the
+ * key displaces the coldest key of the top list if its estimate is higher
+ *
+ * @param p_hot_keys the heavy hitter tracker
+ * @param p_key      the key
+ *
+ * @return void
+ */
+void hot_keys_record ( hot_keys *p_hot_keys, const char *p_key );
+
+/** !
+ * Halve every counter, if an interval has passed since the last halving
+ *
+ * @param p_hot_keys the heavy hitter tracker
+ * @param now        the current time in milliseconds
+ *
+ * @return void
+ */
+void hot_keys_decay ( hot_keys *p_hot_keys, unsigned long long now );
+
+/// accessors
+/** !
+ * Get the top list, hottest first. The rate divides the decayed count by
+ * the time it covers, decayed the same way, which tends to one interval
+ * plus the time since the last halving
+ *
+ * @param p_hot_keys the heavy hitter tracker
+ * @param p_entries  return, room for HOT_KEYS_TOP entries
+ * @param now        the current time in milliseconds
+ *
+ * @return the quantity of entries
+ */
+size_t hot_keys_top ( hot_keys *p_hot_keys, hot_keys_entry *p_entries, unsigned long long now );
+
+/// destructors
+/** !
+ * Destroy a heavy hitter tracker
+ *
+ * @param pp_hot_keys pointer to the heavy hitter tracker
+ *
+ * @return 1 on success, 0 on error
+ */
+int hot_keys_destroy ( hot_keys **pp_hot_keys );
@@ -0,0 +1,91 @@
+/** !
+ * JSON path locator over serialized values
+ *
+ * @file key_value/json_path.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+
+// gsdk
+#include <gsdk.h>
+
+/// reflection
+#include <reflection/json.h>
+
+// key value
+#include <key_value/tokenizer.h>
+
+// forward declarations
+/// accessors
+/** !
+ * Locate the value at a path inside a serialized JSON value, without parsing
+ * the rest of the document. Paths are an optional "$", followed by any
+ * quantity of ".name" and "[index]" segments
+ *
+ * @param p_text      the serialized value
+ * @param length      the length of the serialized value
+ * @param p_path      the path
+ * @param path_length the length of the path
+ * @param p_offset    return the offset of the value
+ * @param p_span      return the length of the value
+ *
+ * @return 1 if the path exists, 0 otherwise
+ */
+int json_path_locate ( const char *p_text, size_t length, const char *p_path, size_t path_length, size_t *p_offset, size_t *p_span );
+
+/** !
+ * Validate a serialized JSON value in one pass, without building a tree
+ *
+ * @param p_text the serialized value
+ * @param length the length of the serialized value
+ * @param p_type return the json value type
+ *
+ * @return 1 if the text is exactly one valid value, 0 otherwise
+ */
+int json_path_classify ( const char *p_text, size_t length, unsigned char *p_type );
+
+/** !
+ * Validate, classify and minify a serialized JSON value in one pass, in place.
+ * Whitespace outside of strings is removed, so equal values compare equal
+ *
+ * @param p_text   the serialized value
+ * @param length   the length of the serialized value
+ * @param p_length return the length of the minified value
+ * @param p_type   return the json value type
+ *
+ * @return 1 if the text is exactly one valid value, 0 otherwise
+ */
+int json_path_minify ( char *p_text, size_t length, size_t *p_length, unsigned char *p_type );
+
+/** !
+ * Split the last segment off of a path, if it is a ".name" segment
+ *
+ * @param p_path          the path
+ * @param path_length     the length of the path
+ * @param p_parent_length return the length of the parent path
+ * @param pp_name         return the name
+ * @param p_name_length   return the length of the name
+ *
+ * @return 1 if the last segment is a name, 0 otherwise
+ */
+int json_path_split ( const char *p_path, size_t path_length, size_t *p_parent_length, const char **pp_name, size_t *p_name_length );
+
+/** !
+ * Test if a located value is empty, so that an insertion needs no comma
+ *
+ * @param p_text the serialized array, or object
+ * @param span   the length of the serialized array, or object
+ *
+ * @return true if the array, or object, has no elements
+ */
+bool json_path_empty ( const char *p_text, size_t span );
@@ -11,6 +11,25 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <signal.h>
+
+// platform dependent includes
+#ifndef _WIN64
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/uio.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <sys/mman.h>
+#endif
+
+// the time stamp counter
+#if ( defined(__x86_64__) || defined(__i386__) ) && defined(__GNUC__)
+    #include <x86intrin.h>
+#endif
 
 // gsdk
 #include <gsdk.h>
@@ -19,29 +38,238 @@
 #include <core/log.h>
 #include <core/socket.h>
 #include <core/pack.h>
+#include <core/sync.h>
 
 /// data
 #include <data/array.h>
-#include <data/binary.h>
-#include <data/cache.h>
 
 /// performance
 #include <performance/thread_pool.h>
+#include <performance/parallel.h>
+
+// key value
+#include <key_value/memory.h>
+#include <key_value/timing_wheel.h>
+#include <key_value/b_plus_tree.h>
+#include <key_value/eviction.h>
+#include <key_value/front_cache.h>
+#include <key_value/value.h>
+#include <key_value/dictionary.h>
+#include <key_value/json_path.h>
+#include <key_value/tokenizer.h>
+#include <key_value/lsm.h>
+#include <key_value/cuckoo_filter.h>
+#include <key_value/hot_keys.h>
+#include <key_value/secondary_index.h>
+#include <key_value/mvcc.h>
+#include <key_value/ring.h>
+#include <key_value/probes.h>
 
 // preprocessor definitions
-#define KEY_VALUE_DB_IDLE_SHUTDOWN 30
+#define KEY_VALUE_DB_IDLE_SHUTDOWN  300
+#define KEY_VALUE_DB_TICK_MS        100
+#define KEY_VALUE_DB_EXPIRE_BUDGET  64
+#define KEY_VALUE_DB_MAXMEMORY      0
+#define KEY_VALUE_DB_CACHE_CAPACITY 1024
+#define KEY_VALUE_DB_CACHE_BUDGET   ( 8 * 1024 * 1024 )
+#define KEY_VALUE_DB_BATCH_MAX      64
+#define KEY_VALUE_DB_FRAME_SMALL    4096
+#define KEY_VALUE_DB_RESPONSE_MAX   ( KEY_VALUE_DB_FRAME_SMALL - sizeof(size_t) )
+#define KEY_VALUE_DB_FRAME_HEAD     256
+#define KEY_VALUE_DB_FRAME_MAX      ( KEY_VALUE_VALUE_LIMIT + KEY_VALUE_DB_FRAME_HEAD )
+#define KEY_VALUE_DB_ATTACH_MIN     1024
+#define KEY_VALUE_DB_RECEIVE_BUFFER ( 4 * KEY_VALUE_DB_FRAME_SMALL )
+#define KEY_VALUE_DB_WATCH_MAX      16
+#define KEY_VALUE_DB_MAX_CONNECTIONS 1024
+#define KEY_VALUE_DB_MAX_IN_FLIGHT   64
+#define KEY_VALUE_DB_SHED_TARGET_US  5000
+#define KEY_VALUE_DB_SHED_INTERVAL_US 100000
+#define KEY_VALUE_DB_WATCH_VALUE    1024
+#define KEY_VALUE_DB_PUSH_PENDING   ( 4 * KEY_VALUE_DB_FRAME_SMALL )
+#define KEY_VALUE_DB_SNAPSHOT       "key_value_db.snapshot"
+#define KEY_VALUE_DB_HOT_SET        "key_value_db.hot"
+#define KEY_VALUE_DB_LSM_DIRECTORY  "key_value_db.lsm"
+#define KEY_VALUE_DB_LSM_MEMTABLE   ( 4 * 1024 * 1024 )
+#define KEY_VALUE_DB_BLOCK_CACHE    ( 8 * 1024 * 1024 )
+#define KEY_VALUE_DB_FILTER_CAPACITY 65536
+#define KEY_VALUE_DB_HOT_KEYS_HALF_LIFE 10000
+#define KEY_VALUE_DB_HOT_KEYS_ENTRY 96
+#define KEY_VALUE_DB_SLOWLOG_MAX    128
+#define KEY_VALUE_DB_SLOWLOG_REPLY  10
+#define KEY_VALUE_DB_SLOWLOG_THRESHOLD 10000
+#define KEY_VALUE_DB_INDEX_MAX      16
+#define KEY_VALUE_DB_FIND_MAX       ( KEY_VALUE_DB_FRAME_SMALL - 128 )
+#define KEY_VALUE_DB_DICTIONARY     ( 16 * 1024 )
+#define KEY_VALUE_DB_DICTIONARY_SAMPLES 1024
+#define KEY_VALUE_DB_MVCC_IDLE      60000  // milliseconds an unread snapshot stays open
+#define KEY_VALUE_DB_SCAN_COUNT     64
+#define KEY_VALUE_DB_SCAN_VALUE     1024
+#define KEY_VALUE_DB_SCAN_MAX       ( KEY_VALUE_DB_FRAME_SMALL - 128 )
+#define KEY_VALUE_DB_UNIX_SOCKET    "key_value_db.sock"
+#define KEY_VALUE_DB_RING_CAPACITY  ( 256 * 1024 )
+#define KEY_VALUE_DB_RING_POLL_MS   100  // how often a side waiting on a ring checks the socket
+#define KEY_VALUE_DB_RING_STALL_MS  5000 // how long a full response ring may go unread
 
 // structure declarations
 struct key_value_db_s;
 struct key_value_property_s;
+struct key_value_db_entry_s;
 
 // type definitions
 typedef struct key_value_db_s       key_value_db;
 typedef struct key_value_property_s key_value_property;
+typedef struct key_value_db_entry_s key_value_db_entry;
+
+// structure definitions
+// a key, and a value in the caller's buffer, for the embedded batch calls
+struct key_value_db_entry_s
+{
+    char    _key[63+1];
+    char   *p_value;   // a set reads the value here. a get, or a scan, writes it here, if it fits
+    size_t  length,    // the length of the value, or the length a get needs
+            capacity;  // the size of the buffer at p_value
+    int     result;    // 1 if the key was found, or written, 0 otherwise
+};
 
 // forward declarations
 /// constructors
 int key_value_db_construct ( key_value_db **pp_db );
 
+/** !
+ * Open a database in this process, without a network. The database restores
+ * the previous run from the directory, and runs its expiry, compaction, and
+ * shutdown threads, but never shuts down for being idle. Close it with
+ * key_value_db_close
+ *
+ * @param pp_db       return
+ * @param p_directory an existing directory the snapshot, the hot set, and the
+ *                    tables are kept in, or null pointer for the working directory
+ *
+ * @return 1 on success, 0 on error
+ */
+int key_value_db_open ( key_value_db **pp_db, const char *p_directory );
+
+/// shutdown
+/** !
+ * Ask the database to shut down. The shutdown thread writes the snapshot, and
+ * the hot set, and then stops the server. Safe to call from a signal handler
+ *
+ * @param p_db the database
+ *
+ * @return void
+ */
+void key_value_db_stop ( key_value_db *p_db );
+
+/** !
+ * Wait for the database to shut down, after key_value_db_stop, or after
+ * KEY_VALUE_DB_IDLE_SHUTDOWN seconds without a request
+ *
+ * @param p_db the database
+ *
+ * @return 1 on success, 0 on error
+ */
+int key_value_db_wait ( key_value_db *p_db );
+
+/// destructors
+/** !
+ * Close a database opened with key_value_db_open. The snapshot, and the hot
+ * set, are written, or the tables flushed, then every thread is joined, and
+ * everything the database holds is released
+ *
+ * @param pp_db pointer to the database
+ *
+ * @return 1 on success, 0 on error
+ */
+int key_value_db_close ( key_value_db **pp_db );
+
+/// embedded
+/** !
+ * Get a value, in the caller's buffer
+ *
+ * @param p_db     the database
+ * @param p_key    the key
+ * @param p_value  the buffer, which the value and a null terminator are written to
+ * @param capacity the size of the buffer
+ * @param p_length return the length of the value, or 0 if there is no such key
+ *
+ * @return 1 on success, 0 if there is no such key, or if the value does not fit
+ */
+int key_value_db_get ( key_value_db *p_db, const char *p_key, char *p_value, size_t capacity, size_t *p_length );
+
+/** !
+ * Set a value. The value is validated, and copied
+ *
+ * @param p_db    the database
+ * @param p_key   the key
+ * @param p_value the value, a JSON text
+ * @param length  the length of the value
+ * @param seconds the seconds until the key expires, or 0 if it never does
+ *
+ * @return 1 on success, 0 on error
+ */
+int key_value_db_set ( key_value_db *p_db, const char *p_key, const char *p_value, size_t length, long long seconds );
+
+/** !
+ * Delete a key
+ *
+ * @param p_db  the database
+ * @param p_key the key
+ *
+ * @return 1 on success, 0 if there is no such key
+ */
+int key_value_db_del ( key_value_db *p_db, const char *p_key );
+
+/** !
+ * Get the next keys, in order, and the values that fit in each entry's buffer
+ *
+ * @param p_db      the database
+ * @param p_pattern a glob the keys match, or null pointer for every key
+ * @param p_after   the last key of the previous page, or null pointer for the first page
+ * @param p_entries the entries. an entry with a null pointer value gets the key only
+ * @param capacity  the quantity of entries, up to KEY_VALUE_DB_SCAN_COUNT are filled
+ * @param p_count   return the quantity of entries filled
+ * @param p_more    return true if there are keys after the last entry
+ *
+ * @return 1 on success, 0 on error
+ */
+int key_value_db_scan ( key_value_db *p_db, const char *p_pattern, const char *p_after, key_value_db_entry *p_entries, size_t capacity, size_t *p_count, bool *p_more );
+
+/** !
+ * Get many values, under one lock. Each entry's result says if its key was
+ * found, and its value fit
+ *
+ * @param p_db      the database
+ * @param p_entries the entries
+ * @param count     the quantity of entries
+ *
+ * @return the quantity of entries found
+ */
+size_t key_value_db_get_batch ( key_value_db *p_db, key_value_db_entry *p_entries, size_t count );
+
+/** !
+ * Set many values, under one lock, with one commit sequence. If any value is
+ * not valid, nothing is written. Each entry's result says if its value was
+ * written. A write that fails, which only happens when memory runs out,
+ * leaves the others written
+ *
+ * @param p_db      the database
+ * @param p_entries the entries
+ * @param count     the quantity of entries
+ *
+ * @return 1 if every value was written, 0 on error
+ */
+int key_value_db_set_batch ( key_value_db *p_db, key_value_db_entry *p_entries, size_t count );
+
+/** !
+ * Delete many keys, under one lock
+ *
+ * @param p_db      the database
+ * @param p_entries the entries
+ * @param count     the quantity of entries
+ *
+ * @return the quantity of keys deleted
+ */
+size_t key_value_db_del_batch ( key_value_db *p_db, key_value_db_entry *p_entries, size_t count );
+
 /// printers
 int key_value_db_print ( key_value_db *p_db );
@@ -0,0 +1,208 @@
+/** !
+ * Log structured merge tree storage engine
+ *
+ * @file key_value/lsm.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+
+// platform dependent includes
+#ifdef _WIN64
+    #include <direct.h>
+    #include <io.h>
+#else
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+// gsdk
+#include <gsdk.h>
+
+/// core
+#include <core/log.h>
+#include <core/sync.h>
+
+/// performance
+#include <performance/parallel.h>
+
+// key value
+#include <key_value/memory.h>
+#include <key_value/value.h>
+
+// preprocessor definitions
+#define LSM_KEY_MAX         64
+#define LSM_LEVELS          7
+#define LSM_BLOCK_SIZE      4096
+#define LSM_TABLE_SIZE      ( 2 * 1024 * 1024 )
+#define LSM_LEVEL_BASE      ( 10 * 1024 * 1024 )
+#define LSM_LEVEL_RATIO     10
+#define LSM_L0_TRIGGER      4
+#define LSM_BLOOM_BITS      10
+#define LSM_BLOOM_HASHES    7
+#define LSM_COMPACT_MS      100
+#define LSM_COMPACT_BACKOFF 10   // a failing compaction waits up to LSM_COMPACT_MS << LSM_COMPACT_BACKOFF
+
+// structure declarations
+struct lsm_s;
+struct lsm_entry_s;
+struct lsm_statistics_s;
+
+// type definitions
+typedef struct lsm_s            lsm;
+typedef struct lsm_entry_s      lsm_entry;
+typedef struct lsm_statistics_s lsm_statistics;
+
+// function type definitions
+typedef int (fn_lsm_key) ( const char *p_key, size_t length, void *p_parameter );
+
+// structure definitions
+struct lsm_entry_s
+{
+    const char         *p_key;
+    const char         *p_value;
+    size_t              length;
+    unsigned long long  expires,
+                        version;
+    unsigned char       type;
+};
+
+struct lsm_statistics_s
+{
+    size_t tables,
+           bytes,
+           flushes,
+           compactions,
+           bloom_skips,
+           block_hits,
+           block_misses;
+};
+
+// forward declarations
+/// constructors
+/** !
+ * Open the tables in a directory, creating the directory if it is missing,
+ * and start the compaction thread. A manifest that can not be read, or a
+ * table it lists that can not be opened, fails the open
+ *
+ * @param pp_lsm      return
+ * @param p_directory the directory
+ * @param block_cache the most memory the block cache may use, in bytes
+ *
+ * @return 1 on success, 0 on error
+ */
+int lsm_construct ( lsm **pp_lsm, const char *p_directory, size_t block_cache );
+
+/// accessors
+/** !
+ * Test if a directory holds tables from a previous run
+ *
+ * @param p_directory the directory
+ *
+ * @return true if the directory has a manifest, false otherwise
+ */
+bool lsm_exists ( const char *p_directory );
+
+/** !
+ * Find the newest record of a key. Pending deletes, then level 0 from newest
+ * to oldest, then one table per deeper level are searched, and tables whose
+ * key range or Bloom filter excludes the key are skipped without a read
+ *
+ * @param p_lsm     the lsm tree
+ * @param p_key     the key
+ * @param p_value   return
+ * @param p_expires return, the absolute expiry time in milliseconds, or 0
+ * @param p_version return, the commit sequence of the record
+ *
+ * @return 1 if the key has a value, 0 if it is missing, deleted, or on error
+ */
+int lsm_get ( lsm *p_lsm, const char *p_key, key_value_value *p_value, unsigned long long *p_expires, unsigned long long *p_version );
+
+/** !
+ * Read the blocks that lsm_get would read for a key into the block cache,
+ * without holding the lock while the disk is read, so a later lsm_get of
+ * the key finds them in memory
+ *
+ * @param p_lsm the lsm tree
+ * @param p_key the key
+ *
+ * @return 1 on success, 0 on error
+ */
+int lsm_prefetch ( lsm *p_lsm, const char *p_key );
+
+/** !
+ * Get the commit sequence recorded by the last flush
+ *
+ * @param p_lsm the lsm tree
+ *
+ * @return the commit sequence
+ */
+unsigned long long lsm_sequence ( lsm *p_lsm );
+
+/** !
+ * Get the lsm tree statistics
+ *
+ * @param p_lsm        the lsm tree
+ * @param p_statistics return
+ *
+ * @return 1 on success, 0 on error
+ */
+int lsm_statistics_get ( lsm *p_lsm, lsm_statistics *p_statistics );
+
+/** !
+ * Pass each key the tables hold a value for to a function, once, in order.
+ * A key whose newest record is a delete is skipped
+ *
+ * @param p_lsm       the lsm tree
+ * @param pfn_key     the function. It returns 1 to go on, or 0 to stop
+ * @param p_parameter passed to the function
+ *
+ * @return 1 on success, 0 if the function stopped, or on error
+ */
+int lsm_keys ( lsm *p_lsm, fn_lsm_key *pfn_key, void *p_parameter );
+
+/// mutators
+/** !
+ * Record that a key was removed. The delete hides older records of the key
+ * from lsm_get, and is written with the next flush
+ *
+ * @param p_lsm the lsm tree
+ * @param p_key the key
+ *
+ * @return 1 on success, 0 on error
+ */
+int lsm_delete ( lsm *p_lsm, const char *p_key );
+
+/** !
+ * Write records, and the pending deletes, to a new level 0 table. Records
+ * are sorted in place. A record shadows a pending delete of the same key
+ *
+ * @param p_lsm     the lsm tree
+ * @param p_entries the records. Keys are unique
+ * @param count     the quantity of records
+ * @param sequence  the commit sequence to record in the manifest
+ *
+ * @return 1 on success, 0 on error
+ */
+int lsm_flush ( lsm *p_lsm, lsm_entry *p_entries, size_t count, unsigned long long sequence );
+
+/// destructors
+/** !
+ * Stop the compaction thread, and close every table
+ *
+ * @param pp_lsm pointer to the lsm tree
+ *
+ * @return 1 on success, 0 on error
+ */
+int lsm_destroy ( lsm **pp_lsm );
@@ -0,0 +1,114 @@
+/** !
+ * Memory accounting, per subsystem
+ *
+ * @file key_value/memory.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// gsdk
+#include <gsdk.h>
+
+/// core
+#include <core/log.h>
+
+// preprocessor definitions
+#define KEY_VALUE_MEMORY_HEADER        16  // the size and tag stored in front of each allocation
+#define KEY_VALUE_MEMORY_CHUNK_HEADER  8   // the size word of a typical malloc chunk
+#define KEY_VALUE_MEMORY_CHUNK_ALIGN   16  // the size class step of a typical malloc
+#define KEY_VALUE_MEMORY_CHUNK_MIN     32  // the smallest chunk of a typical malloc
+
+// enumeration definitions
+enum key_value_memory_tag_e
+{
+    KEY_VALUE_MEMORY_PROPERTIES  = 0,  // records, with their keys, and inline values
+    KEY_VALUE_MEMORY_VALUES      = 1,  // out of line value buffers
+    KEY_VALUE_MEMORY_KEYSPACE    = 2,  // the keyspace array, which eviction samples
+    KEY_VALUE_MEMORY_CACHE       = 3,  // front cache entries, buckets and sketch
+    KEY_VALUE_MEMORY_FILTER      = 4,  // the cuckoo filter
+    KEY_VALUE_MEMORY_STORAGE     = 5,  // tables, block cache and pending deletes
+    KEY_VALUE_MEMORY_CONNECTIONS = 6,  // connections, and their receive buffers
+    KEY_VALUE_MEMORY_OTHER       = 7,  // timers, hot keys, and scratch space
+    KEY_VALUE_MEMORY_INDEXES     = 8,  // secondary indexes
+    KEY_VALUE_MEMORY_VERSIONS    = 9,  // versions saved for snapshots
+    KEY_VALUE_MEMORY_INDEX       = 10, // the B+tree nodes of the ordered index
+    KEY_VALUE_MEMORY_QUANTITY    = 11
+};
+
+// structure declarations
+struct key_value_memory_usage_s;
+
+// type definitions
+typedef enum   key_value_memory_tag_e   key_value_memory_tag;
+typedef struct key_value_memory_usage_s key_value_memory_usage;
+
+// structure definitions
+struct key_value_memory_usage_s
+{
+    size_t             bytes,        // requested, and not yet released
+                       objects,      // live allocations
+                       overhead;     // estimated bytes the allocator holds beyond the request
+    unsigned long long allocations;  // since startup
+};
+
+// forward declarations
+/// allocators
+/** !
+ * Allocate, reallocate or release memory for a subsystem, with the semantics
+ * of default_allocator. Memory must be released through this function, with
+ * any tag, and never through default_allocator
+ *
+ * @param tag     the subsystem
+ * @param p_data  the memory to reallocate, or release. null pointer to allocate
+ * @param size    the new size. 0 to release
+ *
+ * @return pointer to the memory on success, null pointer on error or release
+ */
+void *key_value_memory_allocator ( key_value_memory_tag tag, void *p_data, size_t size );
+
+/// accessors
+/** !
+ * Get the memory a subsystem holds
+ *
+ * @param tag     the subsystem
+ * @param p_usage return
+ *
+ * @return void
+ */
+void key_value_memory_usage_get ( key_value_memory_tag tag, key_value_memory_usage *p_usage );
+
+/** !
+ * Get the name of a subsystem
+ *
+ * @param tag the subsystem
+ *
+ * @return the name
+ */
+const char *key_value_memory_tag_name ( key_value_memory_tag tag );
+
+/** !
+ * Estimate the bytes a typical malloc holds beyond a request
+ *
+ * @param size the request
+ *
+ * @return the estimate
+ */
+size_t key_value_memory_slack ( size_t size );
+
+/** !
+ * Get the resident set size of the process
+ *
+ * @param void
+ *
+ * @return the resident bytes, or 0 where they can not be read
+ */
+size_t key_value_memory_resident ( void );
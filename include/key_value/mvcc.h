@@ -0,0 +1,204 @@
+/** !
+ * Multi version reads. While a snapshot is open, each write first saves
+ * the version it replaces, so a reader at the snapshot's commit sequence
+ * sees the keyspace as it was
+ *
+ * @file key_value/mvcc.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// gsdk
+#include <gsdk.h>
+
+/// core
+#include <core/log.h>
+
+// key value
+#include <key_value/memory.h>
+#include <key_value/value.h>
+
+// preprocessor definitions
+#define MVCC_SNAPSHOT_MAX  16
+#define MVCC_KEY_MAX       64
+#define MVCC_BUCKETS       64
+
+// structure declarations
+struct mvcc_s;
+struct mvcc_version_s;
+struct mvcc_snapshot_s;
+
+// type definitions
+typedef struct mvcc_s          mvcc;
+typedef struct mvcc_version_s  mvcc_version;
+typedef struct mvcc_snapshot_s mvcc_snapshot;
+
+/** !
+ * Called for each key with a saved version
+ *
+ * @param p_key       the key
+ * @param p_parameter the parameter
+ *
+ * @return 1 to continue, 0 to stop
+ */
+typedef int (fn_mvcc_key)( const char *p_key, void *p_parameter );
+
+// structure definitions
+struct mvcc_version_s
+{
+    key_value_value    _value;
+    unsigned long long version,     // the commit sequence that wrote it
+                       expires,     // absolute expiry time in milliseconds, or 0
+                       superseded;  // the commit sequence of the write that replaced it
+    bool               found;       // false if the key did not exist
+};
+
+struct mvcc_snapshot_s
+{
+    size_t             id;
+    unsigned long long sequence,  // the commit sequence it reads at
+                       time,      // the wall clock time it was opened, in milliseconds
+                       used;      // the wall clock time it was last read, in milliseconds
+};
+
+// forward declarations
+/// constructors
+/** !
+ * Construct a version store
+ *
+ * @param pp_mvcc return
+ *
+ * @return 1 on success, 0 on error
+ */
+int mvcc_construct ( mvcc **pp_mvcc );
+
+/// snapshots
+/** !
+ * Open a snapshot
+ *
+ * @param p_mvcc   the version store
+ * @param sequence the commit sequence to read at. no write may have it
+ * @param now      the wall clock time, in milliseconds
+ * @param p_id     return the snapshot's id
+ *
+ * @return 1 on success, 0 if MVCC_SNAPSHOT_MAX snapshots are open
+ */
+int mvcc_snapshot_open ( mvcc *p_mvcc, unsigned long long sequence, unsigned long long now, size_t *p_id );
+
+/** !
+ * Get an open snapshot, and mark it used
+ *
+ * @param p_mvcc     the version store
+ * @param id         the snapshot's id
+ * @param now        the wall clock time, in milliseconds
+ * @param p_snapshot return
+ *
+ * @return 1 on success, 0 if no such snapshot is open
+ */
+int mvcc_snapshot_get ( mvcc *p_mvcc, size_t id, unsigned long long now, mvcc_snapshot *p_snapshot );
+
+/** !
+ * Close a snapshot, and drop the versions only it needed
+ *
+ * @param p_mvcc the version store
+ * @param id     the snapshot's id
+ *
+ * @return 1 on success, 0 if no such snapshot is open
+ */
+int mvcc_snapshot_close ( mvcc *p_mvcc, size_t id );
+
+/** !
+ * Close the snapshots that were not read for a while
+ *
+ * @param p_mvcc the version store
+ * @param now    the wall clock time, in milliseconds
+ * @param idle   the milliseconds a snapshot may go unread
+ *
+ * @return the quantity of snapshots closed
+ */
+size_t mvcc_snapshot_expire ( mvcc *p_mvcc, unsigned long long now, unsigned long long idle );
+
+/** !
+ * Get the open snapshots
+ *
+ * @param p_mvcc      the version store
+ * @param p_snapshots return, room for MVCC_SNAPSHOT_MAX snapshots
+ *
+ * @return the quantity of snapshots
+ */
+size_t mvcc_snapshots ( mvcc *p_mvcc, mvcc_snapshot *p_snapshots );
+
+/// versions
+/** !
+ * Test if a snapshot is open, so writes must save the versions they replace
+ *
+ * @param p_mvcc the version store
+ *
+ * @return true if a snapshot is open, false otherwise
+ */
+bool mvcc_pinned ( mvcc *p_mvcc );
+
+/** !
+ * Save the version of a key a write is about to replace. Nothing is saved
+ * if an earlier write already saved a version every open snapshot can read
+ *
+ * @param p_mvcc     the version store
+ * @param p_key      the key
+ * @param superseded the commit sequence of the write
+ * @param p_value    the value, or null pointer if the key does not exist
+ * @param version    the commit sequence of the value
+ * @param expires    the expiry time of the value, in milliseconds, or 0
+ *
+ * @return 1 on success, 0 on error
+ */
+int mvcc_save ( mvcc *p_mvcc, const char *p_key, unsigned long long superseded, const key_value_value *p_value, unsigned long long version, unsigned long long expires );
+
+/** !
+ * Find the version of a key a snapshot reads
+ *
+ * @param p_mvcc   the version store
+ * @param p_key    the key
+ * @param sequence the snapshot's commit sequence
+ *
+ * @return the version, or null pointer if the key was not written since the snapshot
+ */
+const mvcc_version *mvcc_read ( mvcc *p_mvcc, const char *p_key, unsigned long long sequence );
+
+/** !
+ * Call a function with each key that has a saved version
+ *
+ * @param p_mvcc      the version store
+ * @param pfn_key     the function
+ * @param p_parameter the parameter of the function
+ *
+ * @return 1 if every call continued, 0 otherwise
+ */
+int mvcc_keys ( mvcc *p_mvcc, fn_mvcc_key *pfn_key, void *p_parameter );
+
+/** !
+ * Get the quantity of saved versions
+ *
+ * @param p_mvcc the version store
+ *
+ * @return the quantity of versions
+ */
+size_t mvcc_count ( mvcc *p_mvcc );
+
+/// destructors
+/** !
+ * Destroy a version store
+ *
+ * @param pp_mvcc pointer to the version store
+ *
+ * @return 1 on success, 0 on error
+ */
+int mvcc_destroy ( mvcc **pp_mvcc );
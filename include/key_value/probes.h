@@ -0,0 +1,54 @@
+/** !
+ * USDT probes on the request lifecycle
+ *
+ * @file key_value/probes.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// The probes are compiled in when <sys/sdt.h> is available, and
+// KEY_VALUE_DB_NO_USDT is not defined. A probe is a single nop until a
+// tracer attaches. Arguments that cost something to compute are guarded
+// with KEY_VALUE_DB_PROBE_ENABLED, which reads the semaphore the tracer
+// raises, so a detached probe skips them too
+#if !defined(KEY_VALUE_DB_NO_USDT) && defined(__has_include)
+    #if __has_include(<sys/sdt.h>)
+        #define KEY_VALUE_DB_USDT
+    #endif
+#endif
+
+#ifdef KEY_VALUE_DB_USDT
+
+    // systemtap sdt
+    #define _SDT_HAS_SEMAPHORES 1
+    #include <sys/sdt.h>
+
+    // data
+    extern unsigned short key_value_db_connection__accept_semaphore,
+                          key_value_db_connection__close_semaphore,
+                          key_value_db_request__start_semaphore,
+                          key_value_db_request__end_semaphore,
+                          key_value_db_cache__hit_semaphore,
+                          key_value_db_cache__miss_semaphore,
+                          key_value_db_index__insert_semaphore,
+                          key_value_db_index__remove_semaphore,
+                          key_value_db_evict_semaphore;
+
+    // preprocessor macros
+    #define KEY_VALUE_DB_PROBE_ENABLED(name)           __builtin_expect(key_value_db_##name##_semaphore, 0)
+    #define KEY_VALUE_DB_PROBE2(name, a, b)            DTRACE_PROBE2(key_value_db, name, a, b)
+    #define KEY_VALUE_DB_PROBE3(name, a, b, c)         DTRACE_PROBE3(key_value_db, name, a, b, c)
+    #define KEY_VALUE_DB_PROBE4(name, a, b, c, d)      DTRACE_PROBE4(key_value_db, name, a, b, c, d)
+    #define KEY_VALUE_DB_PROBE5(name, a, b, c, d, e)   DTRACE_PROBE5(key_value_db, name, a, b, c, d, e)
+#else
+
+    // preprocessor macros. the arguments are never evaluated
+    #define KEY_VALUE_DB_PROBE_ENABLED(name)           0
+    #define KEY_VALUE_DB_PROBE2(name, a, b)            do { if ( 0 ) (void) (a), (void) (b); } while (0)
+    #define KEY_VALUE_DB_PROBE3(name, a, b, c)         do { if ( 0 ) (void) (a), (void) (b), (void) (c); } while (0)
+    #define KEY_VALUE_DB_PROBE4(name, a, b, c, d)      do { if ( 0 ) (void) (a), (void) (b), (void) (c), (void) (d); } while (0)
+    #define KEY_VALUE_DB_PROBE5(name, a, b, c, d, e)   do { if ( 0 ) (void) (a), (void) (b), (void) (c), (void) (d), (void) (e); } while (0)
+#endif
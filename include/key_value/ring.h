@@ -0,0 +1,168 @@
+/** !
+ * Single producer, single consumer byte rings in shared memory. A ring
+ * carries a stream of bytes, like a socket, between two processes on the
+ * same host. A side with nothing to do polls for a while, then sleeps on a
+ * futex, where there is one
+ *
+ * @file key_value/ring.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+// gsdk
+#include <gsdk.h>
+
+/// core
+#include <core/log.h>
+
+// key value
+#include <key_value/memory.h>
+
+// preprocessor definitions
+#define RING_HEADER        320   // the bytes in front of the data. other languages map the same layout
+#define RING_CAPACITY_MIN  4096
+#define RING_SPIN          4096  // the polls before a side sleeps
+
+// structure declarations
+struct ring_s;
+struct ring_header_s;
+
+// type definitions
+typedef struct ring_s        ring;
+typedef struct ring_header_s ring_header;
+
+// structure definitions
+// the shared memory in front of the data. the other side may write any of
+// it, so each side keeps its own capacity, and checks head against tail
+struct ring_header_s
+{
+
+    // bytes written. only the writer stores it
+    _Alignas(64) unsigned long long head;
+
+    // bytes read. only the reader stores it
+    _Alignas(64) unsigned long long tail;
+
+    // the reader sleeps on readable, after it sets reader_waiting
+    _Alignas(64) unsigned int readable;
+    unsigned int              reader_waiting;
+
+    // the writer sleeps on writable, after it sets writer_waiting
+    _Alignas(64) unsigned int writable;
+    unsigned int              writer_waiting;
+
+    // either side closes the ring when it goes away
+    _Alignas(64) unsigned int closed;
+    unsigned long long        capacity;  // a power of two
+
+    _Alignas(64) char _data[];
+};
+
+// forward declarations
+/// constructors
+/** !
+ * Get the bytes of shared memory a ring takes
+ *
+ * @param capacity the capacity of the ring, a power of two
+ *
+ * @return the size of the ring
+ */
+size_t ring_size ( size_t capacity );
+
+/** !
+ * Construct a ring in shared memory
+ *
+ * @param pp_ring  return
+ * @param p_memory the memory, at least ring_size(capacity) bytes
+ * @param capacity the capacity of the ring, a power of two, at least RING_CAPACITY_MIN
+ *
+ * @return 1 on success, 0 on error
+ */
+int ring_construct ( ring **pp_ring, void *p_memory, size_t capacity );
+
+/** !
+ * Attach to a ring another process constructed
+ *
+ * @param pp_ring  return
+ * @param p_memory the memory
+ * @param size     the bytes of memory that are mapped
+ *
+ * @return 1 on success, 0 if the memory does not hold a ring
+ */
+int ring_attach ( ring **pp_ring, void *p_memory, size_t size );
+
+/// io
+/** !
+ * Read the bytes that are in a ring, waiting for at least one
+ *
+ * @param p_ring     the ring
+ * @param p_data     the destination
+ * @param capacity   the most bytes to read
+ * @param timeout_ms the longest wait, in milliseconds
+ *
+ * @return the quantity of bytes read, or 0 if the ring is closed, or the wait timed out
+ */
+size_t ring_read ( ring *p_ring, void *p_data, size_t capacity, int timeout_ms );
+
+/** !
+ * Write as many bytes as there is room for in a ring, waiting for room for at least one
+ *
+ * @param p_ring     the ring
+ * @param p_data     the source
+ * @param length     the quantity of bytes
+ * @param timeout_ms the longest wait, in milliseconds
+ *
+ * @return the quantity of bytes written, or 0 if the ring is closed, or the wait timed out
+ */
+size_t ring_write ( ring *p_ring, const void *p_data, size_t length, int timeout_ms );
+
+/** !
+ * Write every byte to a ring, or none, without waiting
+ *
+ * @param p_ring the ring
+ * @param p_data the source
+ * @param length the quantity of bytes
+ *
+ * @return 1 on success, 0 if there is no room, or the ring is closed
+ */
+int ring_try_write ( ring *p_ring, const void *p_data, size_t length );
+
+/// state
+/** !
+ * Close a ring, and wake the other side
+ *
+ * @param p_ring the ring
+ *
+ * @return void
+ */
+void ring_close ( ring *p_ring );
+
+/** !
+ * Test if a ring is closed
+ *
+ * @param p_ring the ring
+ *
+ * @return true if either side closed it, false otherwise
+ */
+bool ring_closed ( ring *p_ring );
+
+/// destructors
+/** !
+ * Destroy a ring. The shared memory is left to the caller
+ *
+ * @param pp_ring pointer to the ring
+ *
+ * @return 1 on success, 0 on error
+ */
+int ring_destroy ( ring **pp_ring );
@@ -0,0 +1,169 @@
+/** !
+ * Secondary indexes, from a JSON path in the values of matching keys, to the keys
+ *
+ * @file key_value/secondary_index.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// gsdk
+#include <gsdk.h>
+
+/// core
+#include <core/log.h>
+
+// key value
+#include <key_value/memory.h>
+#include <key_value/json_path.h>
+
+// preprocessor definitions
+#define SECONDARY_INDEX_NAME_MAX     32
+#define SECONDARY_INDEX_PATTERN_MAX  64
+#define SECONDARY_INDEX_PATH_MAX     64
+#define SECONDARY_INDEX_KEY_MAX      64
+#define SECONDARY_INDEX_VALUE_MAX    256
+#define SECONDARY_INDEX_BUCKETS      64
+
+// structure declarations
+struct secondary_index_s;
+
+// type definitions
+typedef struct secondary_index_s secondary_index;
+
+/** !
+ * Called for each key that holds a value
+ *
+ * @param p_key       the key
+ * @param p_parameter the parameter
+ *
+ * @return 1 to continue, 0 to stop
+ */
+typedef int (fn_secondary_index_key)( const char *p_key, void *p_parameter );
+
+// forward declarations
+/// constructors
+/** !
+ * Construct a secondary index
+ *
+ * @param pp_secondary_index return
+ * @param p_name             the name of the index
+ * @param p_pattern          the keys to index. "*" matches any run of characters, and "?" any one character
+ * @param p_path             the path of the indexed value, inside each value
+ *
+ * @return 1 on success, 0 on error
+ */
+int secondary_index_construct ( secondary_index **pp_secondary_index, const char *p_name, const char *p_pattern, const char *p_path );
+
+/// mutators
+/** !
+ * Index a key, or drop it, if its value has nothing at the path, or the
+ * value at the path is longer than SECONDARY_INDEX_VALUE_MAX bytes. Keys
+ * that do not match the pattern are ignored
+ *
+ * @param p_secondary_index the secondary index
+ * @param p_key             the key
+ * @param p_text            the serialized, minified value
+ * @param length            the length of the value
+ *
+ * @return 1 if the key is indexed, 0 otherwise
+ */
+int secondary_index_update ( secondary_index *p_secondary_index, const char *p_key, const char *p_text, size_t length );
+
+/** !
+ * Drop a key
+ *
+ * @param p_secondary_index the secondary index
+ * @param p_key             the key
+ *
+ * @return 1 if the key was indexed, 0 otherwise
+ */
+int secondary_index_remove ( secondary_index *p_secondary_index, const char *p_key );
+
+/// accessors
+/** !
+ * Test if a key matches a pattern. "*" matches any run of characters, and "?" any one character
+ *
+ * @param p_pattern the pattern
+ * @param p_key     the key
+ *
+ * @return true if the key matches, false otherwise
+ */
+bool secondary_index_glob ( const char *p_pattern, const char *p_key );
+
+/** !
+ * Test if a key matches the pattern of an index
+ *
+ * @param p_secondary_index the secondary index
+ * @param p_key             the key
+ *
+ * @return true if the key matches, false otherwise
+ */
+bool secondary_index_match ( secondary_index *p_secondary_index, const char *p_key );
+
+/** !
+ * Call a function with each key whose value at the path is a value
+ *
+ * @param p_secondary_index the secondary index
+ * @param p_value           the serialized, minified value
+ * @param length            the length of the value
+ * @param pfn_key           the function
+ * @param p_parameter       the parameter of the function
+ *
+ * @return the quantity of calls
+ */
+size_t secondary_index_find ( secondary_index *p_secondary_index, const char *p_value, size_t length, fn_secondary_index_key *pfn_key, void *p_parameter );
+
+/** !
+ * Get the name of an index
+ *
+ * @param p_secondary_index the secondary index
+ *
+ * @return the name
+ */
+const char *secondary_index_name ( secondary_index *p_secondary_index );
+
+/** !
+ * Get the key pattern of an index
+ *
+ * @param p_secondary_index the secondary index
+ *
+ * @return the pattern
+ */
+const char *secondary_index_pattern ( secondary_index *p_secondary_index );
+
+/** !
+ * Get the path of an index
+ *
+ * @param p_secondary_index the secondary index
+ *
+ * @return the path
+ */
+const char *secondary_index_path ( secondary_index *p_secondary_index );
+
+/** !
+ * Get the quantity of indexed keys
+ *
+ * @param p_secondary_index the secondary index
+ *
+ * @return the quantity of keys
+ */
+size_t secondary_index_count ( secondary_index *p_secondary_index );
+
+/// destructors
+/** !
+ * Destroy a secondary index
+ *
+ * @param pp_secondary_index pointer to the secondary index
+ *
+ * @return 1 on success, 0 on error
+ */
+int secondary_index_destroy ( secondary_index **pp_secondary_index );
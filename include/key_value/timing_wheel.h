@@ -0,0 +1,125 @@
+/** !
+ * Hierarchical timing wheel
+ *
+ * @file key_value/timing_wheel.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// gsdk
+#include <gsdk.h>
+
+/// core
+#include <core/log.h>
+
+// key value
+#include <key_value/memory.h>
+
+// preprocessor definitions
+#define TIMING_WHEEL_LEVELS     4
+#define TIMING_WHEEL_SLOT_BITS  6
+#define TIMING_WHEEL_SLOTS      ( 1 << TIMING_WHEEL_SLOT_BITS )
+#define TIMING_WHEEL_SLOT_MASK  ( TIMING_WHEEL_SLOTS - 1 )
+
+// structure declarations
+struct timing_wheel_s;
+struct timing_wheel_timer_s;
+
+// type definitions
+typedef struct timing_wheel_s       timing_wheel;
+typedef struct timing_wheel_timer_s timing_wheel_timer;
+
+// structure definitions
+struct timing_wheel_timer_s
+{
+    timing_wheel_timer *p_next,
+                       *p_prev;
+    unsigned long long  deadline;
+    void               *p_data;
+};
+
+// forward declarations
+/// constructors
+/** !
+ * Construct a timing wheel
+ *
+ * @param pp_timing_wheel return
+ * @param now             the current tick
+ *
+ * @return 1 on success, 0 on error
+ */
+int timing_wheel_construct ( timing_wheel **pp_timing_wheel, unsigned long long now );
+
+/// mutators
+/** !
+ * Arm a timer. The timer is owned by the caller, and must stay alive until
+ * it is removed, or popped from the expired list
+ *
+ * @param p_timing_wheel the timing wheel
+ * @param p_timer        the timer
+ * @param deadline       the tick on which the timer expires
+ *
+ * @return 1 on success, 0 on error
+ */
+int timing_wheel_add ( timing_wheel *p_timing_wheel, timing_wheel_timer *p_timer, unsigned long long deadline );
+
+/** !
+ * Disarm a timer. Removing a timer that is not armed is a no-op
+ *
+ * @param p_timing_wheel the timing wheel
+ * @param p_timer        the timer
+ *
+ * @return 1 on success, 0 on error
+ */
+int timing_wheel_remove ( timing_wheel *p_timing_wheel, timing_wheel_timer *p_timer );
+
+/** !
+ * Advance the wheel to a tick, cascading timers down the levels and moving
+ * due timers onto the expired list. Expired timers are not reclaimed here
+ *
+ * @param p_timing_wheel the timing wheel
+ * @param now            the current tick
+ *
+ * @return 1 on success, 0 on error
+ */
+int timing_wheel_advance ( timing_wheel *p_timing_wheel, unsigned long long now );
+
+/** !
+ * Pop one timer off the expired list
+ *
+ * @param p_timing_wheel the timing wheel
+ * @param pp_timer       return
+ *
+ * @return 1 if a timer was popped, 0 if the expired list is empty
+ */
+int timing_wheel_expired ( timing_wheel *p_timing_wheel, timing_wheel_timer **pp_timer );
+
+/// accessors
+/** !
+ * Get the quantity of armed timers, including expired timers that have not
+ * been popped
+ *
+ * @param p_timing_wheel the timing wheel
+ *
+ * @return the quantity of timers
+ */
+size_t timing_wheel_count ( timing_wheel *p_timing_wheel );
+
+/// destructors
+/** !
+ * Destroy a timing wheel. Armed timers are owned by the caller, and are not freed
+ *
+ * @param pp_timing_wheel pointer to the timing wheel
+ *
+ * @return 1 on success, 0 on error
+ */
+int timing_wheel_destroy ( timing_wheel **pp_timing_wheel );
@@ -0,0 +1,109 @@
+/** !
+ * Vectorized request tokenizer
+ *
+ * @file key_value/tokenizer.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// gsdk
+#include <gsdk.h>
+
+/// core
+#include <core/log.h>
+
+// enumeration definitions
+enum tokenizer_verb_e
+{
+    TOKENIZER_VERB_UNKNOWN = 0,
+    TOKENIZER_VERB_GET,
+    TOKENIZER_VERB_SET,
+    TOKENIZER_VERB_EXPIRE,
+    TOKENIZER_VERB_TTL,
+    TOKENIZER_VERB_INCR,
+    TOKENIZER_VERB_DECR,
+    TOKENIZER_VERB_INCRBY,
+    TOKENIZER_VERB_DECRBY,
+    TOKENIZER_VERB_CAS,
+    TOKENIZER_VERB_JGET,
+    TOKENIZER_VERB_JSET,
+    TOKENIZER_VERB_JAPPEND,
+    TOKENIZER_VERB_BATCH,
+    TOKENIZER_VERB_VERSION,
+    TOKENIZER_VERB_CONFIG,
+    TOKENIZER_VERB_INFO,
+    TOKENIZER_VERB_WRITE,
+    TOKENIZER_VERB_WATCH,
+    TOKENIZER_VERB_SLOWLOG,
+    TOKENIZER_VERB_INDEX,
+    TOKENIZER_VERB_FIND,
+    TOKENIZER_VERB_SNAPSHOT,
+    TOKENIZER_VERB_SCAN,
+    TOKENIZER_VERB_QUANTITY
+};
+
+// type definitions
+typedef enum tokenizer_verb_e tokenizer_verb;
+
+// forward declarations
+/// initializers
+/** !
+ * Choose the widest implementation the processor supports. Until this is
+ * called, the scalar implementation is used
+ *
+ * @param void
+ *
+ * @return void
+ */
+void tokenizer_init ( void );
+
+/// accessors
+/** !
+ * Find the end of a token
+ *
+ * @param p_text the text
+ * @param length the length of the text
+ * @param i      the offset of the token
+ *
+ * @return the offset of the first blank, newline or null terminator, or length
+ */
+size_t tokenizer_token_end ( const char *p_text, size_t length, size_t i );
+
+/** !
+ * Find the end of the plain run of a JSON string
+ *
+ * @param p_text the text
+ * @param length the length of the text
+ * @param i      an offset inside the string
+ *
+ * @return the offset of the first quote, backslash or control character, or length
+ */
+size_t tokenizer_string_end ( const char *p_text, size_t length, size_t i );
+
+/** !
+ * Identify a command verb with a perfect hash
+ *
+ * @param p_verb the verb
+ * @param length the length of the verb
+ *
+ * @return the verb, or TOKENIZER_VERB_UNKNOWN
+ */
+tokenizer_verb tokenizer_verb_parse ( const char *p_verb, size_t length );
+
+/** !
+ * Get the name of the implementation in use
+ *
+ * @param void
+ *
+ * @return "avx2", "sse4.2" or "scalar"
+ */
+const char *tokenizer_implementation ( void );
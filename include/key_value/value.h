@@ -0,0 +1,226 @@
+/** !
+ * Tagged property values
+ *
+ * @file key_value/value.h
+ *
+ * @author Jacob Smith
+ */
+
+// include guard
+#pragma once
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// gsdk
+#include <gsdk.h>
+
+/// core
+#include <core/log.h>
+
+/// reflection
+#include <reflection/json.h>
+
+// key value
+#include <key_value/memory.h>
+#include <key_value/dictionary.h>
+
+// preprocessor definitions
+#define KEY_VALUE_VALUE_INLINE  22
+#define KEY_VALUE_VALUE_HEAP    0xFF
+#define KEY_VALUE_VALUE_PACKED  0xFE
+#define KEY_VALUE_VALUE_PACK_MAX 1024
+#define KEY_VALUE_VALUE_MAX     4096
+#define KEY_VALUE_VALUE_LIMIT   (64 * 1024 * 1024)
+
+// structure declarations
+struct key_value_value_s;
+
+// type definitions
+typedef struct key_value_value_s key_value_value;
+
+// structure definitions
+struct key_value_value_s
+{
+
+    // the serialized value. short values live inside the record, and the
+    // rest live in a reference counted buffer, so a response can keep
+    // sending a buffer after the record is rewritten or removed. values
+    // packed with a dictionary are never shared, and are decompressed
+    // wherever they are read
+    union
+    {
+        char _inline[KEY_VALUE_VALUE_INLINE];
+        struct
+        {
+            char   *p_text;
+            size_t  length;
+        } heap;
+        struct
+        {
+            void   *p_packed;
+            size_t  length;
+        } packed;
+    };
+
+    unsigned char type;    // the json value type
+    unsigned char length;  // the inline length, KEY_VALUE_VALUE_HEAP, or KEY_VALUE_VALUE_PACKED
+};
+
+// forward declarations
+/// constructors
+/** !
+ * Store a serialized value. Values that fit are stored inline, and the rest
+ * are copied into an out of line buffer. Any previous value is released
+ *
+ * @param p_value the value
+ * @param p_text  the serialized value
+ * @param length  the length of the serialized value
+ * @param type    the json value type
+ *
+ * @return 1 on success, 0 on error
+ */
+int key_value_value_from_text ( key_value_value *p_value, const char *p_text, size_t length, unsigned char type );
+
+/** !
+ * Allocate an out of line buffer, holding one reference
+ *
+ * @param length the length of the serialized value
+ *
+ * @return pointer to the buffer on success, null pointer on error
+ */
+char *key_value_value_allocate ( size_t length );
+
+/** !
+ * Store a buffer from key_value_value_allocate without copying it. The value
+ * takes over the caller's reference. Any previous value is released
+ *
+ * @param p_value the value
+ * @param p_text  the buffer
+ * @param length  the length of the serialized value
+ * @param type    the json value type
+ *
+ * @return 1 on success, 0 on error
+ */
+int key_value_value_adopt ( key_value_value *p_value, char *p_text, size_t length, unsigned char type );
+
+/** !
+ * Compress an out of line value with a dictionary, if it is no longer than
+ * KEY_VALUE_VALUE_PACK_MAX bytes, and it gets smaller. A value packed with
+ * another dictionary is packed again
+ *
+ * @param p_value      the value
+ * @param p_dictionary the dictionary
+ *
+ * @return 1 if the value is packed with the dictionary, 0 otherwise
+ */
+int key_value_value_pack ( key_value_value *p_value, dictionary *p_dictionary );
+
+/// mutators
+/** !
+ * Replace a span of the serialized value with a fragment. Out of line values
+ * are edited in place, so only the bytes after the span move, unless a
+ * response still holds a reference to the buffer
+ *
+ * @param p_value the value
+ * @param offset  the offset of the span
+ * @param span    the length of the span
+ * @param p_text  the fragment
+ * @param length  the length of the fragment
+ *
+ * @return 1 on success, 0 on error
+ */
+int key_value_value_splice ( key_value_value *p_value, size_t offset, size_t span, const char *p_text, size_t length );
+
+/// accessors
+/** !
+ * Get the serialized value. A packed value is decompressed into a buffer
+ * owned by the calling thread, which the next call overwrites
+ *
+ * @param p_value  the value
+ * @param p_length return
+ *
+ * @return pointer to the serialized value. Not null terminated
+ */
+const char *key_value_value_text ( const key_value_value *p_value, size_t *p_length );
+
+/** !
+ * Get an integer value
+ *
+ * @param p_value   the value
+ * @param p_integer return
+ *
+ * @return 1 if the value is an integer, 0 otherwise
+ */
+int key_value_value_integer ( const key_value_value *p_value, long long *p_integer );
+
+/** !
+ * Get the length of the serialized value
+ *
+ * @param p_value the value
+ *
+ * @return the length
+ */
+size_t key_value_value_length ( const key_value_value *p_value );
+
+/** !
+ * Test if a value is packed with a dictionary
+ *
+ * @param p_value the value
+ *
+ * @return true if the value is packed, false otherwise
+ */
+bool key_value_value_packed ( const key_value_value *p_value );
+
+/** !
+ * Get the quantity of out of line bytes
+ *
+ * @param p_value the value
+ *
+ * @return the quantity of bytes
+ */
+size_t key_value_value_heap_size ( const key_value_value *p_value );
+
+/** !
+ * Take a reference to an out of line buffer
+ *
+ * @param p_value the value
+ *
+ * @return pointer to the buffer, or null pointer if the value is inline, or packed
+ */
+const char *key_value_value_retain ( const key_value_value *p_value );
+
+/// serializer
+/** !
+ * Copy the serialized value into a buffer. A packed value is decompressed
+ * straight into it
+ *
+ * @param p_value  the value
+ * @param p_buffer the buffer
+ *
+ * @return the quantity of bytes written
+ */
+size_t key_value_value_serialize ( const key_value_value *p_value, char *p_buffer );
+
+/// destructors
+/** !
+ * Drop a reference to an out of line buffer, releasing it with the last one
+ *
+ * @param p_text the buffer, or null pointer
+ *
+ * @return void
+ */
+void key_value_value_release ( const char *p_text );
+
+/** !
+ * Drop the reference to an out of line buffer, if there is one, or release
+ * a packed value
+ *
+ * @param p_value the value
+ *
+ * @return void
+ */
+void key_value_value_free ( key_value_value *p_value );
@@ -12,6 +12,14 @@
 #include <string.h>
 #include <stdbool.h>
 
+// platform dependent includes
+#ifndef _WIN64
+    #include <unistd.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <sys/mman.h>
+#endif
+
 // gsdk
 #include <gsdk.h>
 
@@ -45,9 +53,48 @@ void print_usage ( const char *argv0 );
  */
 void parse_command_line_arguments ( int argc, const char *argv[] );
 
+/** !
+ * Connect to the server's unix domain socket, and move to shared memory
+ * rings, if they were asked for
+ *
+ * @return 1 on success, 0 on error
+ */
+int local_connect ( void );
+
+/** !
+ * Send a request, and receive its response, on the local transport
+ *
+ * @param p_frame    the request, after its length
+ * @param length     the length of the request
+ * @param p_response return the response, null terminated
+ * @param capacity   the size of the response buffer. the rest of a longer response is dropped
+ *
+ * @return 1 on success, 0 on error
+ */
+int local_request ( char *p_frame, size_t length, char *p_response, size_t capacity );
+
+/** !
+ * Close the local transport
+ *
+ * @return void
+ */
+void local_close ( void );
+
 // data
 unsigned short  port       = 6713;
-const char     *p_hostname = "localhost";
+const char     *p_hostname = "localhost",
+               *p_unix     = NULL;
+bool            use_ring   = false;
+
+// the local transport
+struct
+{
+    int     socket;
+    void   *p_region;
+    size_t  size;
+    ring   *p_requests,
+           *p_responses;
+} local = { .socket = -1 };
 
 // entry point
 int main ( int argc, const char *argv[] )
@@ -63,11 +110,27 @@ int main ( int argc, const char *argv[] )
     // parse command line arguments
     parse_command_line_arguments(argc, argv);
 
-    // log connection 
-    log_info("Connecting to db server at %s:%hu\n", p_hostname, port);
+    // connect to the server's unix domain socket
+    if ( p_unix )
+    {
+
+        // log connection
+        log_info("Connecting to db server at %s%s\n", p_unix, ( use_ring ) ? ", with shared memory rings" : "");
+
+        // connect to the server
+        if ( 0 == local_connect() ) goto no_connection;
+    }
 
     // connect to the server
-    if ( 0 == connection_construct(&p_connection, p_hostname, port) ) goto no_connection;
+    else
+    {
+
+        // log connection 
+        log_info("Connecting to db server at %s:%hu\n", p_hostname, port);
+
+        // connect to the server
+        if ( 0 == connection_construct(&p_connection, p_hostname, port) ) goto no_connection;
+    }
 
     // repl
     while ( 0 == feof(stdin) )
@@ -104,11 +167,16 @@ int main ( int argc, const char *argv[] )
         strncpy(_net_buffer + sizeof(size_t), _stdin_buffer, input_len);
         len = input_len;
 
-        // send
-        connection_write(p_connection, _net_buffer, sizeof(size_t) + len);
+        // send, and receive on the local transport
+        if ( p_unix )
+        {
+            if ( 0 == local_request(_net_buffer, len, _res_buffer, sizeof(_res_buffer)) ) goto no_connection;
+        }
 
-        // receive
-        connection_read(p_connection, _res_buffer, &size);
+        // send, and receive
+        else
+            connection_write(p_connection, _net_buffer, sizeof(size_t) + len),
+            connection_read(p_connection, _res_buffer, &size);
 
         // parse the response
         if ( 0 == json_value_parse(_res_buffer, 0, &p_value) ) goto failed_to_parse_json;
@@ -137,6 +205,9 @@ int main ( int argc, const char *argv[] )
         }
     }
 
+    // close the local transport
+    local_close();
+
     // success
     return EXIT_SUCCESS;
 
@@ -144,9 +215,13 @@ int main ( int argc, const char *argv[] )
     {
         no_connection:
             #ifndef NDEBUG
-                log_error("Error: Failed to connect to %s:%hu\n", p_hostname, port);
+                if ( p_unix ) log_error("Error: Failed to connect to %s\n", p_unix);
+                else          log_error("Error: Failed to connect to %s:%hu\n", p_hostname, port);
             #endif
 
+            // close the local transport
+            local_close();
+
             // error
             return EXIT_FAILURE;
 
@@ -167,7 +242,7 @@ void print_usage ( const char *argv0 )
     if ( argv0 == (void *) 0 ) exit(EXIT_FAILURE);
 
     // Print a usage message to standard out
-    printf("Usage: %s [-p | --port <port>] [-h | --host <hostname>] \n", argv0);
+    printf("Usage: %s [-p | --port <port>] [-h | --host <hostname>] [-u | --unix <path> [-r | --ring]] \n", argv0);
 
     // done
     return;
@@ -201,7 +276,35 @@ void parse_command_line_arguments ( int argc, const char *argv[] )
             
             // set the host name
             p_hostname = argv[++i];
+
+        // unix domain socket?
+        else if
+        ( 
+            0 == strcmp(argv[i], "-u")     ||
+            0 == strcmp(argv[i], "--unix")
+        )
+        {
+
+            // error check
+            if ( i + 1 >= (size_t) argc ) goto invalid_arguments;
+
+            // set the path
+            p_unix = argv[++i];
+        }
+
+        // shared memory rings?
+        else if
+        ( 
+            0 == strcmp(argv[i], "-r")     ||
+            0 == strcmp(argv[i], "--ring")
+        )
+
+            // use rings
+            use_ring = true;
     }
+
+    // rings are negotiated on the unix domain socket
+    if ( use_ring && NULL == p_unix ) p_unix = KEY_VALUE_DB_UNIX_SOCKET;
     
     // success
     return;
@@ -221,3 +324,204 @@ void parse_command_line_arguments ( int argc, const char *argv[] )
         }
     }
 }
+
+#ifndef _WIN64
+int local_send ( const void *p_data, size_t length )
+{
+
+    // write to the request ring
+    if ( local.p_requests )
+    {
+        while ( length )
+        {
+
+            // initialized data
+            size_t written = ring_write(local.p_requests, p_data, length, KEY_VALUE_DB_RING_POLL_MS);
+
+            // error check
+            if ( 0 == written && ring_closed(local.p_requests) ) return 0;
+
+            // skip the written bytes
+            p_data  = (const char *) p_data + written,
+            length -= written;
+        }
+
+        // success
+        return 1;
+    }
+
+    // send on the socket
+    while ( length )
+    {
+
+        // initialized data
+        ssize_t sent = send(local.socket, p_data, length, MSG_NOSIGNAL);
+
+        // error check
+        if ( sent <= 0 ) return 0;
+
+        // skip the sent bytes
+        p_data  = (const char *) p_data + sent,
+        length -= (size_t) sent;
+    }
+
+    // success
+    return 1;
+}
+
+int local_receive ( void *p_data, size_t length )
+{
+
+    // receive every byte
+    while ( length )
+    {
+
+        // initialized data
+        ssize_t received = 0;
+
+        // read from the response ring
+        if ( local.p_responses )
+        {
+            received = (ssize_t) ring_read(local.p_responses, p_data, length, KEY_VALUE_DB_RING_POLL_MS);
+            if ( 0 == received && ring_closed(local.p_responses) ) return 0;
+        }
+
+        // receive on the socket
+        else if ( ( received = recv(local.socket, p_data, length, 0) ) <= 0 ) return 0;
+
+        // skip the received bytes
+        p_data  = (char *) p_data + received,
+        length -= (size_t) received;
+    }
+
+    // success
+    return 1;
+}
+
+int local_connect ( void )
+{
+
+    // initialized data
+    struct sockaddr_un _address = { .sun_family = AF_UNIX };
+    char               _frame[sizeof(size_t) + 64] = { 0 };
+    union
+    {
+        char           _buffer[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr _header;
+    }                  _control = { 0 };
+    struct iovec       _iov     = { .iov_base = _frame, .iov_len = sizeof(_frame) - 1 };
+    struct msghdr      _message = { .msg_iov = &_iov, .msg_iovlen = 1, .msg_control = _control._buffer, .msg_controllen = sizeof(_control._buffer) };
+    struct cmsghdr    *p_header = NULL;
+    ssize_t            received = 0;
+    size_t             capacity = 0;
+    int                descriptor = -1;
+
+    // connect to the socket
+    strncpy(_address.sun_path, p_unix, sizeof(_address.sun_path) - 1);
+    local.socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if ( local.socket < 0 ) return 0;
+    if ( connect(local.socket, (struct sockaddr *) &_address, sizeof(_address)) ) return 0;
+
+    // done
+    if ( false == use_ring ) return 1;
+
+    // ask for rings
+    *(size_t *)_frame = 4;
+    memcpy(_frame + sizeof(size_t), "ring", 4);
+    if ( 0 == local_send(_frame, sizeof(size_t) + 4) ) return 0;
+
+    // the response carries the shared memory's descriptor
+    memset(_frame, 0, sizeof(_frame));
+    received = recvmsg(local.socket, &_message, 0);
+    if ( received < (ssize_t) sizeof(size_t) ) return 0;
+    for (p_header = CMSG_FIRSTHDR(&_message); p_header; p_header = CMSG_NXTHDR(&_message, p_header))
+        if ( SOL_SOCKET == p_header->cmsg_level && SCM_RIGHTS == p_header->cmsg_type ) memcpy(&descriptor, CMSG_DATA(p_header), sizeof(int));
+
+    // the server said no
+    if ( descriptor < 0 || 1 != sscanf(_frame + sizeof(size_t), "{\"okay\":true,\"value\":{\"capacity\":%zu}}", &capacity) )
+    {
+        log_error("%s\n", _frame + sizeof(size_t));
+        if ( descriptor >= 0 ) close(descriptor);
+        return 0;
+    }
+
+    // map the rings
+    local.size     = 2 * ring_size(capacity),
+    local.p_region = mmap(NULL, local.size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    if ( MAP_FAILED == local.p_region ) return local.p_region = NULL, 0;
+
+    // attach to the request ring, then the response ring
+    if ( 0 == ring_attach(&local.p_requests, local.p_region, ring_size(capacity)) ) return 0;
+    if ( 0 == ring_attach(&local.p_responses, (char *) local.p_region + ring_size(capacity), ring_size(capacity)) ) return 0;
+
+    // success
+    return 1;
+}
+
+int local_request ( char *p_frame, size_t length, char *p_response, size_t capacity )
+{
+
+    // initialized data
+    size_t response_length = 0;
+    char   _drain[256];
+
+    // set the length
+    *(size_t *)p_frame = length;
+
+    // send the request
+    if ( 0 == local_send(p_frame, sizeof(size_t) + length) ) return 0;
+
+    // receive the length of the response
+    if ( 0 == local_receive(&response_length, sizeof(size_t)) ) return 0;
+
+    // receive the response
+    if ( 0 == local_receive(p_response, ( response_length < capacity ) ? response_length : capacity - 1) ) return 0;
+    p_response[( response_length < capacity ) ? response_length : capacity - 1] = '\0';
+
+    // drop the rest of a long response
+    for (size_t rest = ( response_length < capacity ) ? 0 : response_length - capacity + 1; rest; )
+    {
+
+        // initialized data
+        size_t chunk = ( rest < sizeof(_drain) ) ? rest : sizeof(_drain);
+
+        // error check
+        if ( 0 == local_receive(_drain, chunk) ) return 0;
+
+        rest -= chunk;
+    }
+
+    // success
+    return 1;
+}
+
+void local_close ( void )
+{
+
+    // close the rings
+    if ( local.p_requests ) ring_close(local.p_requests), ring_destroy(&local.p_requests);
+    if ( local.p_responses ) ring_destroy(&local.p_responses);
+    if ( local.p_region ) munmap(local.p_region, local.size), local.p_region = NULL;
+
+    // close the socket
+    if ( local.socket >= 0 ) close(local.socket), local.socket = -1;
+
+    // done
+    return;
+}
+#else
+int local_connect ( void )
+{
+
+    // there is no unix domain socket
+    log_error("Error: Unix domain sockets are not supported on this platform\n");
+
+    // error
+    return 0;
+}
+
+int local_request ( char *p_frame, size_t length, char *p_response, size_t capacity ) { return 0; }
+
+void local_close ( void ) { return; }
+#endif
@@ -11,6 +11,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <signal.h>
 
 // gsdk
 #include <gsdk.h>
@@ -22,19 +23,62 @@
 // db
 #include <key_value/key_value.h>
 
+// data
+static key_value_db *p_key_value_db = NULL;
+
+// forward declarations
+/** !
+ * Ask the server to shut down, so it writes its snapshot and hot set
+ *
+ * @param signal the signal
+ *
+ * @return void
+ */
+void key_value_db_server_signal ( int signal );
+
+// function definitions
+void key_value_db_server_signal ( int signal )
+{
+
+    // unused
+    (void) signal;
+
+    // shut down
+    key_value_db_stop(p_key_value_db);
+
+    // done
+    return;
+}
+
 // entry point
 int main ( int argc, const char *argv[] )
 {
 
-    // initialized data
-    key_value_db *p_key_value_db = NULL;
-
     // construct an db server
-    key_value_db_construct(&p_key_value_db);
+    if ( 0 == key_value_db_construct(&p_key_value_db) ) goto failed_to_construct_db;
 
-    // keep network up
-    sleep(300);
+    // shut down cleanly on interrupt, and on docker stop
+    signal(SIGINT,  key_value_db_server_signal);
+    signal(SIGTERM, key_value_db_server_signal);
+
+    // keep network up until shutdown
+    key_value_db_wait(p_key_value_db);
 
     // success
     return EXIT_SUCCESS;
+
+    // error handling
+    {
+
+        // key value db errors
+        {
+            failed_to_construct_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to construct db server in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return EXIT_FAILURE;
+        }
+    }
 }
@@ -0,0 +1,1042 @@
+/** !
+ * B+tree of string keys
+ *
+ * @file src/b_plus_tree.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/b_plus_tree.h>
+
+// structure declarations
+struct b_plus_tree_node_s;
+struct b_plus_tree_leaf_s;
+struct b_plus_tree_inner_s;
+
+// type definitions
+typedef struct b_plus_tree_node_s  b_plus_tree_node;
+typedef struct b_plus_tree_leaf_s  b_plus_tree_leaf;
+typedef struct b_plus_tree_inner_s b_plus_tree_inner;
+
+// structure definitions
+// the part of a node a search reads. every key of the node starts with the
+// prefix, and each head is the next 8 bytes of a key, big endian, so heads
+// order like their keys
+struct b_plus_tree_node_s
+{
+    bool               leaf;
+    unsigned char      prefix;  // the length of the prefix
+    unsigned short     count;   // keys of a leaf, separators of an inner node
+    char               _prefix[B_PLUS_TREE_KEY_MAX];
+    unsigned long long _heads[B_PLUS_TREE_FANOUT];
+};
+
+// the keys of a leaf are read from its values, only when two heads are equal
+struct b_plus_tree_leaf_s
+{
+    b_plus_tree_node  _node;
+    void             *_values[B_PLUS_TREE_FANOUT];
+    b_plus_tree_leaf *p_next,
+                     *p_prev;
+};
+
+// child i holds the keys from separator i - 1, up to separator i
+struct b_plus_tree_inner_s
+{
+    b_plus_tree_node  _node;
+    b_plus_tree_node *_children[B_PLUS_TREE_FANOUT + 1];
+    char              _keys[B_PLUS_TREE_FANOUT][B_PLUS_TREE_KEY_MAX];
+};
+
+struct b_plus_tree_s
+{
+    b_plus_tree_node   *p_root;
+    fn_b_plus_tree_key *pfn_key;
+    size_t              count,
+                        height,
+                        leaves,
+                        inners;
+};
+
+// the path from the root to a leaf
+struct b_plus_tree_path_s
+{
+    b_plus_tree_inner *_inners[B_PLUS_TREE_DEPTH_MAX];
+    size_t             _slots[B_PLUS_TREE_DEPTH_MAX],
+                       depth;
+};
+
+static unsigned long long b_plus_tree_head ( const char *p_suffix )
+{
+
+    // initialized data
+    unsigned long long head  = 0;
+    bool               ended = false;
+
+    // pack the next 8 bytes, and zeros after the end of the key
+    for (size_t i = 0; i < 8; i++)
+    {
+        if ( false == ended && '\0' == p_suffix[i] ) ended = true;
+        head = ( head << 8 ) | ( ( ended ) ? 0 : (unsigned char) p_suffix[i] );
+    }
+
+    // done
+    return head;
+}
+
+static const char *b_plus_tree_key ( b_plus_tree *p_b_plus_tree, const b_plus_tree_node *p_node, size_t i )
+{
+
+    // done
+    return ( p_node->leaf ) ? p_b_plus_tree->pfn_key(( (const b_plus_tree_leaf *) p_node )->_values[i])
+                            : ( (const b_plus_tree_inner *) p_node )->_keys[i];
+}
+
+static int b_plus_tree_compare ( b_plus_tree *p_b_plus_tree, const b_plus_tree_node *p_node, size_t i, const char *p_key, unsigned long long head )
+{
+
+    // most keys differ in their heads
+    if ( head != p_node->_heads[i] ) return ( head < p_node->_heads[i] ) ? -1 : 1;
+
+    // the key ended inside the head, and so did the other one
+    if ( 0 == ( head & 0xff ) ) return 0;
+
+    // both keys go on past the head
+    return strcmp(p_key + p_node->prefix + 8, b_plus_tree_key(p_b_plus_tree, p_node, i) + p_node->prefix + 8);
+}
+
+static size_t b_plus_tree_locate ( b_plus_tree *p_b_plus_tree, const b_plus_tree_node *p_node, const char *p_key, bool *p_found )
+{
+
+    // initialized data
+    unsigned long long head  = 0;
+    size_t             lo    = 0,
+                       hi    = p_node->count,
+                       mid   = 0;
+    int                order = strncmp(p_key, p_node->_prefix, p_node->prefix);
+
+    // not found, yet
+    *p_found = false;
+
+    // a key without the prefix is before, or after, every key of the node
+    if ( order ) return ( order < 0 ) ? 0 : p_node->count;
+
+    // the head of the key
+    head = b_plus_tree_head(p_key + p_node->prefix);
+
+    // find the first key that is not before the key
+    while ( lo < hi )
+    {
+        mid   = ( lo + hi ) / 2,
+        order = b_plus_tree_compare(p_b_plus_tree, p_node, mid, p_key, head);
+        if ( 0 == order ) { *p_found = true; return mid; }
+        if ( order > 0 ) lo = mid + 1;
+        else             hi = mid;
+    }
+
+    // done
+    return lo;
+}
+
+static size_t b_plus_tree_child ( b_plus_tree *p_b_plus_tree, const b_plus_tree_inner *p_inner, const char *p_key )
+{
+
+    // initialized data
+    bool   found = false;
+    size_t i     = b_plus_tree_locate(p_b_plus_tree, &p_inner->_node, p_key, &found);
+
+    // a key equal to a separator is in the child after it
+    return i + found;
+}
+
+static void b_plus_tree_rehead ( b_plus_tree *p_b_plus_tree, b_plus_tree_node *p_node )
+{
+
+    // initialized data
+    size_t prefix = 0;
+
+    // the prefix the first, and the last key share, which every key between them shares
+    if ( p_node->count )
+    {
+
+        // initialized data
+        const char *p_first = b_plus_tree_key(p_b_plus_tree, p_node, 0),
+                   *p_last  = b_plus_tree_key(p_b_plus_tree, p_node, p_node->count - 1u);
+
+        // measure the prefix
+        while ( p_first[prefix] && p_first[prefix] == p_last[prefix] ) prefix++;
+
+        // store the prefix
+        memcpy(p_node->_prefix, p_first, prefix);
+    }
+
+    // store the length
+    p_node->prefix = (unsigned char) prefix;
+
+    // the head of each key, after the prefix
+    for (size_t i = 0; i < p_node->count; i++)
+        p_node->_heads[i] = b_plus_tree_head(b_plus_tree_key(p_b_plus_tree, p_node, i) + prefix);
+
+    // done
+    return;
+}
+
+static void b_plus_tree_separator ( char *p_separator, const char *p_last, const char *p_first )
+{
+
+    // initialized data
+    size_t shared = 0;
+
+    // the shortest prefix of the first key on the right that is after the last key on the left
+    while ( p_last[shared] && p_last[shared] == p_first[shared] ) shared++;
+
+    // copy it
+    memcpy(p_separator, p_first, shared + 1);
+    p_separator[shared + 1] = '\0';
+
+    // done
+    return;
+}
+
+static b_plus_tree_leaf *b_plus_tree_leaf_construct ( b_plus_tree *p_b_plus_tree )
+{
+
+    // initialized data
+    b_plus_tree_leaf *p_leaf = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEX, 0, sizeof(b_plus_tree_leaf));
+
+    // error check
+    if ( NULL == p_leaf ) return NULL;
+
+    // initialize the leaf
+    memset(p_leaf, 0, sizeof(b_plus_tree_leaf));
+    p_leaf->_node.leaf = true;
+
+    // count the leaf
+    p_b_plus_tree->leaves++;
+
+    // done
+    return p_leaf;
+}
+
+static b_plus_tree_inner *b_plus_tree_inner_construct ( b_plus_tree *p_b_plus_tree )
+{
+
+    // initialized data
+    b_plus_tree_inner *p_inner = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEX, 0, sizeof(b_plus_tree_inner));
+
+    // error check
+    if ( NULL == p_inner ) return NULL;
+
+    // initialize the inner node
+    memset(p_inner, 0, sizeof(b_plus_tree_inner));
+
+    // count the inner node
+    p_b_plus_tree->inners++;
+
+    // done
+    return p_inner;
+}
+
+static void b_plus_tree_node_destroy ( b_plus_tree *p_b_plus_tree, b_plus_tree_node *p_node )
+{
+
+    // uncount the node
+    if ( p_node->leaf ) p_b_plus_tree->leaves--;
+    else                p_b_plus_tree->inners--;
+
+    // release the node
+    p_node = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEX, p_node, 0);
+
+    // done
+    return;
+}
+
+static void b_plus_tree_node_release ( b_plus_tree *p_b_plus_tree, b_plus_tree_node *p_node )
+{
+
+    // release the children first. the tree is at most B_PLUS_TREE_DEPTH_MAX levels deep
+    if ( false == p_node->leaf )
+        for (size_t i = 0; i <= p_node->count; i++)
+            b_plus_tree_node_release(p_b_plus_tree, ( (b_plus_tree_inner *) p_node )->_children[i]);
+
+    // release the node
+    b_plus_tree_node_destroy(p_b_plus_tree, p_node);
+
+    // done
+    return;
+}
+
+static void b_plus_tree_descend ( b_plus_tree *p_b_plus_tree, const char *p_key, struct b_plus_tree_path_s *p_path, b_plus_tree_leaf **pp_leaf )
+{
+
+    // initialized data
+    b_plus_tree_node *p_node = p_b_plus_tree->p_root;
+
+    // from the root
+    p_path->depth = 0;
+
+    // to the leaf that holds the key, or would
+    while ( false == p_node->leaf )
+    {
+
+        // initialized data
+        b_plus_tree_inner *p_inner = (b_plus_tree_inner *) p_node;
+        size_t             slot    = b_plus_tree_child(p_b_plus_tree, p_inner, p_key);
+
+        // record the step
+        p_path->_inners[p_path->depth] = p_inner,
+        p_path->_slots[p_path->depth]  = slot,
+        p_path->depth++;
+
+        // next level
+        p_node = p_inner->_children[slot];
+    }
+
+    // return a pointer to the caller
+    *pp_leaf = (b_plus_tree_leaf *) p_node;
+
+    // done
+    return;
+}
+
+static void b_plus_tree_inner_put ( b_plus_tree_inner *p_inner, size_t i, const char *p_separator, b_plus_tree_node *p_child )
+{
+
+    // make room for the separator, and the child after it
+    memmove(&p_inner->_keys[i + 1], &p_inner->_keys[i], ( p_inner->_node.count - i ) * sizeof(p_inner->_keys[0]));
+    memmove(&p_inner->_children[i + 2], &p_inner->_children[i + 1], ( p_inner->_node.count - i ) * sizeof(p_inner->_children[0]));
+
+    // store them
+    strcpy(p_inner->_keys[i], p_separator);
+    p_inner->_children[i + 1] = p_child;
+    p_inner->_node.count++;
+
+    // done
+    return;
+}
+
+static void b_plus_tree_inner_take ( b_plus_tree_inner *p_inner, size_t i )
+{
+
+    // close the gap of the separator, and the child after it
+    memmove(&p_inner->_keys[i], &p_inner->_keys[i + 1], ( p_inner->_node.count - i - 1u ) * sizeof(p_inner->_keys[0]));
+    memmove(&p_inner->_children[i + 1], &p_inner->_children[i + 2], ( p_inner->_node.count - i - 1u ) * sizeof(p_inner->_children[0]));
+    p_inner->_node.count--;
+
+    // done
+    return;
+}
+
+static void b_plus_tree_split ( b_plus_tree *p_b_plus_tree, struct b_plus_tree_path_s *p_path, char *p_separator, b_plus_tree_node *p_right, bool append, b_plus_tree_inner **pp_spares )
+{
+
+    // add the separator, and the new node, to each parent, splitting full parents
+    while ( p_path->depth )
+    {
+
+        // initialized data
+        b_plus_tree_inner *p_inner  = p_path->_inners[--p_path->depth],
+                          *p_split  = NULL;
+        size_t             slot     = p_path->_slots[p_path->depth],
+                           middle   = 0;
+        char               _keys[B_PLUS_TREE_FANOUT + 1][B_PLUS_TREE_KEY_MAX];
+        b_plus_tree_node  *_children[B_PLUS_TREE_FANOUT + 2];
+
+        // room in the parent
+        if ( p_inner->_node.count < B_PLUS_TREE_FANOUT )
+        {
+            b_plus_tree_inner_put(p_inner, slot, p_separator, p_right);
+            b_plus_tree_rehead(p_b_plus_tree, &p_inner->_node);
+
+            // done
+            return;
+        }
+
+        // still appending, if the new node is the last child
+        append = append && B_PLUS_TREE_FANOUT == slot;
+
+        // lay out every separator, and every child
+        memcpy(_keys, p_inner->_keys, slot * sizeof(_keys[0]));
+        strcpy(_keys[slot], p_separator);
+        memcpy(&_keys[slot + 1], &p_inner->_keys[slot], ( B_PLUS_TREE_FANOUT - slot ) * sizeof(_keys[0]));
+        memcpy(_children, p_inner->_children, ( slot + 1 ) * sizeof(_children[0]));
+        _children[slot + 1] = p_right;
+        memcpy(&_children[slot + 2], &p_inner->_children[slot + 1], ( B_PLUS_TREE_FANOUT - slot ) * sizeof(_children[0]));
+
+        // an append leaves the node full, otherwise it is split in half
+        middle  = ( append ) ? B_PLUS_TREE_FANOUT - 1 : B_PLUS_TREE_FANOUT / 2,
+        p_split = *pp_spares++;
+
+        // the left half keeps the separators before the middle
+        memcpy(p_inner->_keys, _keys, middle * sizeof(_keys[0]));
+        memcpy(p_inner->_children, _children, ( middle + 1 ) * sizeof(_children[0]));
+        p_inner->_node.count = (unsigned short) middle;
+
+        // the right half takes the separators after it
+        memcpy(p_split->_keys, &_keys[middle + 1], ( B_PLUS_TREE_FANOUT - middle ) * sizeof(_keys[0]));
+        memcpy(p_split->_children, &_children[middle + 1], ( B_PLUS_TREE_FANOUT - middle + 1 ) * sizeof(_children[0]));
+        p_split->_node.count = (unsigned short) ( B_PLUS_TREE_FANOUT - middle );
+
+        // update the heads
+        b_plus_tree_rehead(p_b_plus_tree, &p_inner->_node);
+        b_plus_tree_rehead(p_b_plus_tree, &p_split->_node);
+
+        // the middle separator moves up
+        strcpy(p_separator, _keys[middle]);
+        p_right = &p_split->_node;
+    }
+
+    // the root split, so the tree grows a level
+    {
+
+        // initialized data
+        b_plus_tree_inner *p_root = *pp_spares;
+
+        // the old root, and the new node
+        strcpy(p_root->_keys[0], p_separator);
+        p_root->_children[0] = p_b_plus_tree->p_root,
+        p_root->_children[1] = p_right,
+        p_root->_node.count  = 1;
+        b_plus_tree_rehead(p_b_plus_tree, &p_root->_node);
+
+        // store the root
+        p_b_plus_tree->p_root = &p_root->_node;
+        p_b_plus_tree->height++;
+    }
+
+    // done
+    return;
+}
+
+static bool b_plus_tree_leaf_fix ( b_plus_tree *p_b_plus_tree, b_plus_tree_inner *p_parent, size_t left )
+{
+
+    // initialized data
+    b_plus_tree_leaf *p_left  = (b_plus_tree_leaf *) p_parent->_children[left],
+                     *p_right = (b_plus_tree_leaf *) p_parent->_children[left + 1];
+    size_t            total   = (size_t) p_left->_node.count + p_right->_node.count,
+                      keep    = total / 2;
+
+    // merge the right leaf into the left one
+    if ( total <= B_PLUS_TREE_FANOUT )
+    {
+
+        // move the values
+        memcpy(&p_left->_values[p_left->_node.count], p_right->_values, p_right->_node.count * sizeof(void *));
+        p_left->_node.count = (unsigned short) total;
+
+        // unlink the right leaf
+        p_left->p_next = p_right->p_next;
+        if ( p_right->p_next ) p_right->p_next->p_prev = p_left;
+
+        // drop it from the parent
+        b_plus_tree_inner_take(p_parent, left);
+        b_plus_tree_node_destroy(p_b_plus_tree, &p_right->_node);
+        b_plus_tree_rehead(p_b_plus_tree, &p_left->_node);
+        b_plus_tree_rehead(p_b_plus_tree, &p_parent->_node);
+
+        // the parent lost a separator
+        return true;
+    }
+
+    // share the values evenly
+    if ( p_left->_node.count > keep )
+    {
+
+        // initialized data
+        size_t moved = p_left->_node.count - keep;
+
+        // from the end of the left leaf, to the front of the right one
+        memmove(&p_right->_values[moved], p_right->_values, p_right->_node.count * sizeof(void *));
+        memcpy(p_right->_values, &p_left->_values[keep], moved * sizeof(void *));
+        p_left->_node.count   = (unsigned short) keep,
+        p_right->_node.count += (unsigned short) moved;
+    }
+    else
+    {
+
+        // initialized data
+        size_t moved = keep - p_left->_node.count;
+
+        // from the front of the right leaf, to the end of the left one
+        memcpy(&p_left->_values[p_left->_node.count], p_right->_values, moved * sizeof(void *));
+        memmove(p_right->_values, &p_right->_values[moved], ( p_right->_node.count - moved ) * sizeof(void *));
+        p_left->_node.count   = (unsigned short) keep,
+        p_right->_node.count -= (unsigned short) moved;
+    }
+
+    // update the heads, and the separator between the leaves
+    b_plus_tree_rehead(p_b_plus_tree, &p_left->_node);
+    b_plus_tree_rehead(p_b_plus_tree, &p_right->_node);
+    b_plus_tree_separator(p_parent->_keys[left], b_plus_tree_key(p_b_plus_tree, &p_left->_node, keep - 1), b_plus_tree_key(p_b_plus_tree, &p_right->_node, 0));
+    b_plus_tree_rehead(p_b_plus_tree, &p_parent->_node);
+
+    // the parent kept its separators
+    return false;
+}
+
+static bool b_plus_tree_inner_fix ( b_plus_tree *p_b_plus_tree, b_plus_tree_inner *p_parent, size_t left )
+{
+
+    // initialized data
+    b_plus_tree_inner *p_left  = (b_plus_tree_inner *) p_parent->_children[left],
+                      *p_right = (b_plus_tree_inner *) p_parent->_children[left + 1];
+    size_t             count   = p_left->_node.count;
+
+    // merge the right node, and the separator between them, into the left one
+    if ( count + p_right->_node.count + 1 <= B_PLUS_TREE_FANOUT )
+    {
+
+        // move the separators, and the children
+        strcpy(p_left->_keys[count], p_parent->_keys[left]);
+        memcpy(&p_left->_keys[count + 1], p_right->_keys, p_right->_node.count * sizeof(p_right->_keys[0]));
+        memcpy(&p_left->_children[count + 1], p_right->_children, ( p_right->_node.count + 1u ) * sizeof(p_right->_children[0]));
+        p_left->_node.count = (unsigned short) ( count + p_right->_node.count + 1 );
+
+        // drop the right node from the parent
+        b_plus_tree_inner_take(p_parent, left);
+        b_plus_tree_node_destroy(p_b_plus_tree, &p_right->_node);
+        b_plus_tree_rehead(p_b_plus_tree, &p_left->_node);
+        b_plus_tree_rehead(p_b_plus_tree, &p_parent->_node);
+
+        // the parent lost a separator
+        return true;
+    }
+
+    // rotate a child from the left node, through the parent, to the right node
+    if ( p_left->_node.count > p_right->_node.count )
+    {
+        memmove(&p_right->_keys[1], p_right->_keys, p_right->_node.count * sizeof(p_right->_keys[0]));
+        memmove(&p_right->_children[1], p_right->_children, ( p_right->_node.count + 1u ) * sizeof(p_right->_children[0]));
+        strcpy(p_right->_keys[0], p_parent->_keys[left]);
+        p_right->_children[0] = p_left->_children[count];
+        strcpy(p_parent->_keys[left], p_left->_keys[count - 1]);
+        p_left->_node.count--,
+        p_right->_node.count++;
+    }
+
+    // rotate a child from the right node, through the parent, to the left node
+    else
+    {
+        strcpy(p_left->_keys[count], p_parent->_keys[left]);
+        p_left->_children[count + 1] = p_right->_children[0];
+        strcpy(p_parent->_keys[left], p_right->_keys[0]);
+        memmove(p_right->_keys, &p_right->_keys[1], ( p_right->_node.count - 1u ) * sizeof(p_right->_keys[0]));
+        memmove(p_right->_children, &p_right->_children[1], p_right->_node.count * sizeof(p_right->_children[0]));
+        p_left->_node.count++,
+        p_right->_node.count--;
+    }
+
+    // update the heads
+    b_plus_tree_rehead(p_b_plus_tree, &p_left->_node);
+    b_plus_tree_rehead(p_b_plus_tree, &p_right->_node);
+    b_plus_tree_rehead(p_b_plus_tree, &p_parent->_node);
+
+    // the parent kept its separators
+    return false;
+}
+
+int b_plus_tree_construct ( b_plus_tree **pp_b_plus_tree, fn_b_plus_tree_key *pfn_key )
+{
+
+    // argument check
+    if ( NULL == pp_b_plus_tree ) goto no_b_plus_tree;
+    if ( NULL ==        pfn_key ) goto no_key;
+
+    // initialized data
+    b_plus_tree      *p_b_plus_tree = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEX, 0, sizeof(b_plus_tree));
+    b_plus_tree_leaf *p_leaf        = NULL;
+
+    // error check
+    if ( NULL == p_b_plus_tree ) goto no_mem;
+
+    // initialize the tree
+    memset(p_b_plus_tree, 0, sizeof(b_plus_tree));
+    p_b_plus_tree->pfn_key = pfn_key,
+    p_b_plus_tree->height  = 1;
+
+    // an empty leaf is the root
+    p_leaf = b_plus_tree_leaf_construct(p_b_plus_tree);
+    if ( NULL == p_leaf ) goto no_root;
+    p_b_plus_tree->p_root = &p_leaf->_node;
+
+    // return a pointer to the caller
+    *pp_b_plus_tree = p_b_plus_tree;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_b_plus_tree:
+                #ifndef NDEBUG
+                    log_error("[b plus tree] Null pointer provided for parameter \"pp_b_plus_tree\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[b plus tree] Null pointer provided for parameter \"pfn_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_root:
+
+                // release the tree
+                p_b_plus_tree = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEX, p_b_plus_tree, 0);
+
+                // fall through
+                goto no_mem;
+
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int b_plus_tree_search ( b_plus_tree *p_b_plus_tree, const char *p_key, void **pp_value )
+{
+
+    // argument check
+    if ( NULL == p_b_plus_tree ) goto no_b_plus_tree;
+    if ( NULL ==         p_key ) goto no_key;
+    if ( NULL ==      pp_value ) goto no_value;
+
+    // initialized data
+    b_plus_tree_node *p_node = p_b_plus_tree->p_root;
+    bool              found  = false;
+    size_t            i      = 0;
+
+    // to the leaf that would hold the key
+    while ( false == p_node->leaf )
+        p_node = ( (b_plus_tree_inner *) p_node )->_children[b_plus_tree_child(p_b_plus_tree, (b_plus_tree_inner *) p_node, p_key)];
+
+    // search the leaf
+    i = b_plus_tree_locate(p_b_plus_tree, p_node, p_key, &found);
+    if ( false == found ) return 0;
+
+    // return the value to the caller
+    *pp_value = ( (b_plus_tree_leaf *) p_node )->_values[i];
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_b_plus_tree:
+                #ifndef NDEBUG
+                    log_error("[b plus tree] Null pointer provided for parameter \"p_b_plus_tree\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[b plus tree] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_value:
+                #ifndef NDEBUG
+                    log_error("[b plus tree] Null pointer provided for parameter \"pp_value\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int b_plus_tree_range ( b_plus_tree *p_b_plus_tree, const char *p_first, fn_b_plus_tree_value *pfn_value, void *p_parameter )
+{
+
+    // argument check
+    if ( NULL == p_b_plus_tree ) goto no_b_plus_tree;
+    if ( NULL ==     pfn_value ) goto no_value;
+
+    // initialized data
+    b_plus_tree_node *p_node = p_b_plus_tree->p_root;
+    b_plus_tree_leaf *p_leaf = NULL;
+    bool              found  = false;
+    size_t            i      = 0;
+
+    // to the leaf that holds the first key
+    while ( false == p_node->leaf )
+        p_node = ( (b_plus_tree_inner *) p_node )->_children[( p_first ) ? b_plus_tree_child(p_b_plus_tree, (b_plus_tree_inner *) p_node, p_first) : 0];
+
+    // the first key at or after the key
+    p_leaf = (b_plus_tree_leaf *) p_node;
+    if ( p_first ) i = b_plus_tree_locate(p_b_plus_tree, p_node, p_first, &found);
+
+    // walk the leaves
+    for (; p_leaf; p_leaf = p_leaf->p_next, i = 0)
+        for (; i < p_leaf->_node.count; i++)
+            if ( 0 == pfn_value(p_leaf->_values[i], p_parameter) ) return 0;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_b_plus_tree:
+                #ifndef NDEBUG
+                    log_error("[b plus tree] Null pointer provided for parameter \"p_b_plus_tree\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_value:
+                #ifndef NDEBUG
+                    log_error("[b plus tree] Null pointer provided for parameter \"pfn_value\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+void b_plus_tree_statistics_get ( b_plus_tree *p_b_plus_tree, b_plus_tree_statistics *p_statistics )
+{
+
+    // argument check
+    if ( NULL == p_b_plus_tree || NULL == p_statistics ) return;
+
+    // copy the statistics
+    p_statistics->count  = p_b_plus_tree->count,
+    p_statistics->height = p_b_plus_tree->height,
+    p_statistics->leaves = p_b_plus_tree->leaves,
+    p_statistics->inners = p_b_plus_tree->inners;
+
+    // done
+    return;
+}
+
+int b_plus_tree_insert ( b_plus_tree *p_b_plus_tree, void *p_value )
+{
+
+    // argument check
+    if ( NULL == p_b_plus_tree ) goto no_b_plus_tree;
+    if ( NULL ==       p_value ) goto no_value;
+
+    // initialized data
+    struct b_plus_tree_path_s  _path       = { 0 };
+    b_plus_tree_leaf          *p_leaf      = NULL,
+                              *p_right     = NULL,
+                              *p_target    = NULL;
+    b_plus_tree_inner         *_spares[B_PLUS_TREE_DEPTH_MAX] = { 0 };
+    const char                *p_key       = p_b_plus_tree->pfn_key(p_value);
+    char                       _separator[B_PLUS_TREE_KEY_MAX];
+    bool                       found       = false,
+                               append      = false;
+    size_t                     i           = 0,
+                               split       = 0,
+                               spares      = 0;
+
+    // error check
+    if ( strlen(p_key) >= B_PLUS_TREE_KEY_MAX ) goto key_too_long;
+
+    // find the leaf, and the position of the key
+    b_plus_tree_descend(p_b_plus_tree, p_key, &_path, &p_leaf);
+    i = b_plus_tree_locate(p_b_plus_tree, &p_leaf->_node, p_key, &found);
+
+    // error check
+    if ( found ) goto already_a_key;
+
+    // room in the leaf
+    if ( p_leaf->_node.count < B_PLUS_TREE_FANOUT )
+    {
+
+        // make room for the value
+        memmove(&p_leaf->_values[i + 1], &p_leaf->_values[i], ( p_leaf->_node.count - i ) * sizeof(void *));
+        memmove(&p_leaf->_node._heads[i + 1], &p_leaf->_node._heads[i], ( p_leaf->_node.count - i ) * sizeof(unsigned long long));
+
+        // store the value
+        p_leaf->_values[i] = p_value;
+        p_leaf->_node.count++;
+
+        // a key without the prefix shortens it, otherwise only its own head is new
+        if ( strncmp(p_key, p_leaf->_node._prefix, p_leaf->_node.prefix) ) b_plus_tree_rehead(p_b_plus_tree, &p_leaf->_node);
+        else                                                              p_leaf->_node._heads[i] = b_plus_tree_head(p_key + p_leaf->_node.prefix);
+
+        // increment the counter
+        p_b_plus_tree->count++;
+
+        // success
+        return 1;
+    }
+
+    // a key after every key of the tree leaves the full leaf behind, otherwise it is split in half
+    append = NULL == p_leaf->p_next && B_PLUS_TREE_FANOUT == i,
+    split  = ( append ) ? B_PLUS_TREE_FANOUT : B_PLUS_TREE_FANOUT / 2;
+
+    // the full parents split too, and the root grows a level if every parent is full
+    while ( spares < _path.depth && B_PLUS_TREE_FANOUT == _path._inners[_path.depth - 1 - spares]->_node.count ) spares++;
+    if ( spares == _path.depth )
+    {
+
+        // error check
+        if ( B_PLUS_TREE_DEPTH_MAX == p_b_plus_tree->height ) goto too_deep;
+
+        // a new root
+        spares++;
+    }
+
+    // allocate every node the split needs, before anything moves, so the split can not fail half way
+    for (size_t j = 0; j < spares; j++)
+        if ( NULL == ( _spares[j] = b_plus_tree_inner_construct(p_b_plus_tree) ) ) goto no_spares;
+    p_right = b_plus_tree_leaf_construct(p_b_plus_tree);
+    if ( NULL == p_right ) goto no_spares;
+
+    // the right leaf takes the values after the split
+    memcpy(p_right->_values, &p_leaf->_values[split], ( B_PLUS_TREE_FANOUT - split ) * sizeof(void *));
+    p_right->_node.count = (unsigned short) ( B_PLUS_TREE_FANOUT - split ),
+    p_leaf->_node.count  = (unsigned short) split;
+
+    // link the right leaf
+    p_right->p_next = p_leaf->p_next,
+    p_right->p_prev = p_leaf;
+    if ( p_leaf->p_next ) p_leaf->p_next->p_prev = p_right;
+    p_leaf->p_next = p_right;
+
+    // store the value, in whichever half it belongs to
+    if ( i <= split && split < B_PLUS_TREE_FANOUT ) p_target = p_leaf;
+    else                                            p_target = p_right, i -= split;
+    memmove(&p_target->_values[i + 1], &p_target->_values[i], ( p_target->_node.count - i ) * sizeof(void *));
+    p_target->_values[i] = p_value;
+    p_target->_node.count++;
+    p_b_plus_tree->count++;
+
+    // update the heads
+    b_plus_tree_rehead(p_b_plus_tree, &p_leaf->_node);
+    b_plus_tree_rehead(p_b_plus_tree, &p_right->_node);
+
+    // add the right leaf to the parent
+    b_plus_tree_separator(_separator, b_plus_tree_key(p_b_plus_tree, &p_leaf->_node, p_leaf->_node.count - 1u), b_plus_tree_key(p_b_plus_tree, &p_right->_node, 0));
+    b_plus_tree_split(p_b_plus_tree, &_path, _separator, &p_right->_node, append, _spares);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_b_plus_tree:
+                #ifndef NDEBUG
+                    log_error("[b plus tree] Null pointer provided for parameter \"p_b_plus_tree\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_value:
+                #ifndef NDEBUG
+                    log_error("[b plus tree] Null pointer provided for parameter \"p_value\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // b plus tree errors
+        {
+            key_too_long:
+                #ifndef NDEBUG
+                    log_error("[b plus tree] Key is longer than %d characters in call to function \"%s\"\n", B_PLUS_TREE_KEY_MAX - 1, __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            already_a_key:
+                #ifndef NDEBUG
+                    log_error("[b plus tree] Key \"%s\" is already in the tree in call to function \"%s\"\n", p_key, __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            too_deep:
+                #ifndef NDEBUG
+                    log_error("[b plus tree] Tree is deeper than %d levels in call to function \"%s\"\n", B_PLUS_TREE_DEPTH_MAX, __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_spares:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // release the nodes that were allocated. nothing moved
+                for (size_t j = 0; j < spares; j++)
+                    if ( _spares[j] ) b_plus_tree_node_destroy(p_b_plus_tree, &_spares[j]->_node);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int b_plus_tree_remove ( b_plus_tree *p_b_plus_tree, const char *p_key, void **pp_value )
+{
+
+    // argument check
+    if ( NULL == p_b_plus_tree ) goto no_b_plus_tree;
+    if ( NULL ==         p_key ) goto no_key;
+
+    // initialized data
+    struct b_plus_tree_path_s  _path   = { 0 };
+    b_plus_tree_leaf          *p_leaf  = NULL;
+    b_plus_tree_node          *p_node  = NULL;
+    bool                       found   = false;
+    size_t                     i       = 0;
+
+    // find the leaf, and the position of the key
+    b_plus_tree_descend(p_b_plus_tree, p_key, &_path, &p_leaf);
+    i = b_plus_tree_locate(p_b_plus_tree, &p_leaf->_node, p_key, &found);
+
+    // not a key
+    if ( false == found ) return 0;
+
+    // return the value to the caller
+    if ( pp_value ) *pp_value = p_leaf->_values[i];
+
+    // close the gap. the remaining keys still share the prefix
+    memmove(&p_leaf->_values[i], &p_leaf->_values[i + 1], ( p_leaf->_node.count - i - 1u ) * sizeof(void *));
+    memmove(&p_leaf->_node._heads[i], &p_leaf->_node._heads[i + 1], ( p_leaf->_node.count - i - 1u ) * sizeof(unsigned long long));
+    p_leaf->_node.count--;
+    p_b_plus_tree->count--;
+
+    // a node under the minimum borrows from, or merges with, a sibling, which may leave its parent under the minimum
+    for (p_node = &p_leaf->_node; _path.depth && p_node->count < B_PLUS_TREE_MIN; p_node = &_path._inners[_path.depth]->_node)
+    {
+
+        // initialized data
+        b_plus_tree_inner *p_parent = _path._inners[--_path.depth];
+        size_t             slot     = _path._slots[_path.depth],
+                           left     = ( slot ) ? slot - 1 : 0;
+        bool               merged   = false;
+
+        // a root with one child has no sibling to fix it with
+        if ( 0 == p_parent->_node.count ) break;
+
+        // fix the node, with the sibling before it, or else the one after it
+        merged = ( p_node->leaf ) ? b_plus_tree_leaf_fix(p_b_plus_tree, p_parent, left)
+                                  : b_plus_tree_inner_fix(p_b_plus_tree, p_parent, left);
+
+        // the parent kept its separators
+        if ( false == merged ) break;
+    }
+
+    // a root with one child is replaced by the child
+    while ( false == p_b_plus_tree->p_root->leaf && 0 == p_b_plus_tree->p_root->count )
+    {
+
+        // initialized data
+        b_plus_tree_node *p_root = p_b_plus_tree->p_root;
+
+        // the child is the root
+        p_b_plus_tree->p_root = ( (b_plus_tree_inner *) p_root )->_children[0];
+        b_plus_tree_node_destroy(p_b_plus_tree, p_root);
+        p_b_plus_tree->height--;
+    }
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_b_plus_tree:
+                #ifndef NDEBUG
+                    log_error("[b plus tree] Null pointer provided for parameter \"p_b_plus_tree\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[b plus tree] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int b_plus_tree_destroy ( b_plus_tree **pp_b_plus_tree )
+{
+
+    // argument check
+    if ( NULL == pp_b_plus_tree ) goto no_b_plus_tree;
+
+    // initialized data
+    b_plus_tree *p_b_plus_tree = *pp_b_plus_tree;
+
+    // no more pointer for the caller
+    *pp_b_plus_tree = NULL;
+
+    // nothing to do
+    if ( NULL == p_b_plus_tree ) return 1;
+
+    // release the nodes
+    b_plus_tree_node_release(p_b_plus_tree, p_b_plus_tree->p_root);
+
+    // release the tree
+    p_b_plus_tree = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEX, p_b_plus_tree, 0);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_b_plus_tree:
+                #ifndef NDEBUG
+                    log_error("[b plus tree] Null pointer provided for parameter \"pp_b_plus_tree\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
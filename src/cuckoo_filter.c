@@ -0,0 +1,485 @@
+/** !
+ * Cuckoo filter
+ *
+ * @file src/cuckoo_filter.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/cuckoo_filter.h>
+
+// structure definitions
+struct cuckoo_filter_s
+{
+
+    // each bucket holds up to four 16 bit fingerprints. zero is an empty slot
+    unsigned short (*p_buckets)[CUCKOO_FILTER_SLOTS];
+    size_t           mask,
+                     count;
+
+    // the fingerprint left over when a kick chain runs out. the filter is full while it is set
+    unsigned short victim;
+    size_t         victim_bucket;
+    bool           full;
+
+    // the tables that filled up before this one. their keys stay there, and new keys go here
+    cuckoo_filter *p_older;
+};
+
+static unsigned long long cuckoo_filter_hash ( const char *p_key, size_t length )
+{
+
+    // initialized data
+    unsigned long long h = 0xcbf29ce484222325ULL;
+
+    // FNV-1a
+    for (size_t i = 0; i < length; i++) h ^= (unsigned char) p_key[i], h *= 0x100000001b3ULL;
+
+    // mix the high bits into the low bits, which pick the bucket
+    h ^= h >> 33, h *= 0xff51afd7ed558ccdULL, h ^= h >> 33;
+
+    // done
+    return h;
+}
+
+static unsigned short cuckoo_filter_fingerprint ( unsigned long long hash )
+{
+
+    // initialized data
+    unsigned short fingerprint = (unsigned short) ( hash >> 40 );
+
+    // zero marks an empty slot
+    return ( fingerprint ) ? fingerprint : 1;
+}
+
+static size_t cuckoo_filter_alternate ( cuckoo_filter *p_cuckoo_filter, size_t bucket, unsigned short fingerprint )
+{
+
+    // the other bucket depends only on this one and the fingerprint, so either finds the other
+    return ( bucket ^ ( fingerprint * 0x5bd1e995UL ) ) & p_cuckoo_filter->mask;
+}
+
+static bool cuckoo_filter_bucket_add ( cuckoo_filter *p_cuckoo_filter, size_t bucket, unsigned short fingerprint )
+{
+
+    // find an empty slot
+    for (size_t i = 0; i < CUCKOO_FILTER_SLOTS; i++)
+    {
+        if ( p_cuckoo_filter->p_buckets[bucket][i] ) continue;
+
+        // store the fingerprint
+        p_cuckoo_filter->p_buckets[bucket][i] = fingerprint;
+
+        // success
+        return true;
+    }
+
+    // the bucket is full
+    return false;
+}
+
+static bool cuckoo_filter_bucket_find ( cuckoo_filter *p_cuckoo_filter, size_t bucket, unsigned short fingerprint )
+{
+
+    // search the slots
+    for (size_t i = 0; i < CUCKOO_FILTER_SLOTS; i++)
+        if ( fingerprint == p_cuckoo_filter->p_buckets[bucket][i] ) return true;
+
+    // not found
+    return false;
+}
+
+static bool cuckoo_filter_table_contains ( cuckoo_filter *p_cuckoo_filter, unsigned long long hash, unsigned short fingerprint )
+{
+
+    // initialized data
+    size_t bucket    = hash & p_cuckoo_filter->mask,
+           alternate = cuckoo_filter_alternate(p_cuckoo_filter, bucket, fingerprint);
+
+    // the victim
+    if ( p_cuckoo_filter->full && fingerprint == p_cuckoo_filter->victim && ( bucket == p_cuckoo_filter->victim_bucket || alternate == p_cuckoo_filter->victim_bucket ) ) return true;
+
+    // search both buckets
+    return cuckoo_filter_bucket_find(p_cuckoo_filter, bucket, fingerprint) || cuckoo_filter_bucket_find(p_cuckoo_filter, alternate, fingerprint);
+}
+
+static bool cuckoo_filter_table_remove ( cuckoo_filter *p_cuckoo_filter, unsigned long long hash, unsigned short fingerprint )
+{
+
+    // initialized data
+    size_t buckets[2] = { 0 };
+
+    // the two buckets the fingerprint may be in
+    buckets[0] = hash & p_cuckoo_filter->mask,
+    buckets[1] = cuckoo_filter_alternate(p_cuckoo_filter, buckets[0], fingerprint);
+
+    // the victim
+    if ( p_cuckoo_filter->full && fingerprint == p_cuckoo_filter->victim && ( buckets[0] == p_cuckoo_filter->victim_bucket || buckets[1] == p_cuckoo_filter->victim_bucket ) )
+    {
+        p_cuckoo_filter->full = false,
+        p_cuckoo_filter->count--;
+
+        // success
+        return true;
+    }
+
+    // search both buckets
+    for (size_t b = 0; b < 2; b++)
+        for (size_t i = 0; i < CUCKOO_FILTER_SLOTS; i++)
+        {
+            if ( fingerprint != p_cuckoo_filter->p_buckets[buckets[b]][i] ) continue;
+
+            // clear the slot
+            p_cuckoo_filter->p_buckets[buckets[b]][i] = 0,
+            p_cuckoo_filter->count--;
+
+            // the victim may fit in the freed slot
+            if ( p_cuckoo_filter->full && ( buckets[b] == p_cuckoo_filter->victim_bucket || buckets[b] == cuckoo_filter_alternate(p_cuckoo_filter, p_cuckoo_filter->victim_bucket, p_cuckoo_filter->victim) ) )
+                p_cuckoo_filter->p_buckets[buckets[b]][i] = p_cuckoo_filter->victim,
+                p_cuckoo_filter->full                     = false;
+
+            // success
+            return true;
+        }
+
+    // not found
+    return false;
+}
+
+static bool cuckoo_filter_grow ( cuckoo_filter *p_cuckoo_filter )
+{
+
+    // initialized data
+    cuckoo_filter   *p_older             = key_value_memory_allocator(KEY_VALUE_MEMORY_FILTER, 0, sizeof(cuckoo_filter));
+    size_t           buckets             = 2 * ( p_cuckoo_filter->mask + 1 );
+    unsigned short (*p_buckets)[CUCKOO_FILTER_SLOTS] = NULL;
+
+    // error check
+    if ( NULL == p_older ) return false;
+
+    // allocate a table twice as large
+    p_buckets = key_value_memory_allocator(KEY_VALUE_MEMORY_FILTER, 0, buckets * sizeof(*p_buckets));
+    if ( NULL == p_buckets )
+    {
+        p_older = key_value_memory_allocator(KEY_VALUE_MEMORY_FILTER, p_older, 0);
+
+        // error
+        return false;
+    }
+    memset(p_buckets, 0, buckets * sizeof(*p_buckets));
+
+    // the full table moves behind the new one, with every key it holds
+    *p_older = *p_cuckoo_filter;
+    memset(p_cuckoo_filter, 0, sizeof(cuckoo_filter));
+    p_cuckoo_filter->p_buckets = p_buckets,
+    p_cuckoo_filter->mask      = buckets - 1,
+    p_cuckoo_filter->p_older   = p_older;
+
+    // success
+    return true;
+}
+
+int cuckoo_filter_construct ( cuckoo_filter **pp_cuckoo_filter, size_t capacity )
+{
+
+    // argument check
+    if ( NULL == pp_cuckoo_filter ) goto no_cuckoo_filter;
+
+    // initialized data
+    cuckoo_filter *p_cuckoo_filter = key_value_memory_allocator(KEY_VALUE_MEMORY_FILTER, 0, sizeof(cuckoo_filter));
+    size_t         buckets         = 1;
+
+    // error check
+    if ( NULL == p_cuckoo_filter ) goto no_mem;
+
+    // initialize the filter
+    memset(p_cuckoo_filter, 0, sizeof(cuckoo_filter));
+
+    // round the bucket count up to a power of two
+    while ( buckets * CUCKOO_FILTER_SLOTS < capacity ) buckets <<= 1;
+
+    // allocate the buckets
+    p_cuckoo_filter->p_buckets = key_value_memory_allocator(KEY_VALUE_MEMORY_FILTER, 0, buckets * sizeof(*p_cuckoo_filter->p_buckets));
+    if ( NULL == p_cuckoo_filter->p_buckets ) goto no_buckets;
+    memset(p_cuckoo_filter->p_buckets, 0, buckets * sizeof(*p_cuckoo_filter->p_buckets));
+    p_cuckoo_filter->mask = buckets - 1;
+
+    // return a pointer to the caller
+    *pp_cuckoo_filter = p_cuckoo_filter;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_cuckoo_filter:
+                #ifndef NDEBUG
+                    log_error("[cuckoo filter] Null pointer provided for parameter \"pp_cuckoo_filter\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_buckets:
+
+                // release the filter
+                p_cuckoo_filter = key_value_memory_allocator(KEY_VALUE_MEMORY_FILTER, p_cuckoo_filter, 0);
+
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int cuckoo_filter_add ( cuckoo_filter *p_cuckoo_filter, const char *p_key, size_t length )
+{
+
+    // argument check
+    if ( NULL == p_cuckoo_filter ) goto no_cuckoo_filter;
+    if ( NULL ==           p_key ) goto no_key;
+
+    // initialized data
+    unsigned long long hash        = cuckoo_filter_hash(p_key, length);
+    unsigned short     fingerprint = cuckoo_filter_fingerprint(hash);
+    size_t             bucket      = hash & p_cuckoo_filter->mask;
+
+    // no room. the next table is twice as large, so the keys already added stay put
+    if ( p_cuckoo_filter->full && false == cuckoo_filter_grow(p_cuckoo_filter) ) return 0;
+
+    // count the fingerprint. from here on, it is either in a bucket, or the victim
+    p_cuckoo_filter->count++;
+
+    // either bucket has room
+    if ( cuckoo_filter_bucket_add(p_cuckoo_filter, bucket, fingerprint) ) return 1;
+    bucket = cuckoo_filter_alternate(p_cuckoo_filter, bucket, fingerprint);
+    if ( cuckoo_filter_bucket_add(p_cuckoo_filter, bucket, fingerprint) ) return 1;
+
+    // kick fingerprints to their other bucket until one lands in an empty slot
+    for (size_t kick = 0; kick < CUCKOO_FILTER_KICKS; kick++)
+    {
+
+        // initialized data
+        size_t         slot    = ( hash >> ( kick % 32 ) ) % CUCKOO_FILTER_SLOTS;
+        unsigned short evicted = p_cuckoo_filter->p_buckets[bucket][slot];
+
+        // swap the fingerprint in
+        p_cuckoo_filter->p_buckets[bucket][slot] = fingerprint,
+        fingerprint                              = evicted;
+
+        // move the evicted fingerprint to its other bucket
+        bucket = cuckoo_filter_alternate(p_cuckoo_filter, bucket, fingerprint);
+        if ( cuckoo_filter_bucket_add(p_cuckoo_filter, bucket, fingerprint) ) return 1;
+    }
+
+    // keep the fingerprint that is left over, so no key is lost
+    p_cuckoo_filter->victim        = fingerprint,
+    p_cuckoo_filter->victim_bucket = bucket,
+    p_cuckoo_filter->full          = true;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_cuckoo_filter:
+                #ifndef NDEBUG
+                    log_error("[cuckoo filter] Null pointer provided for parameter \"p_cuckoo_filter\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[cuckoo filter] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int cuckoo_filter_remove ( cuckoo_filter *p_cuckoo_filter, const char *p_key, size_t length )
+{
+
+    // argument check
+    if ( NULL == p_cuckoo_filter ) goto no_cuckoo_filter;
+    if ( NULL ==           p_key ) goto no_key;
+
+    // initialized data
+    unsigned long long   hash        = cuckoo_filter_hash(p_key, length);
+    unsigned short       fingerprint = cuckoo_filter_fingerprint(hash);
+    cuckoo_filter      **pp_table    = &p_cuckoo_filter->p_older;
+
+    // the newest table
+    if ( cuckoo_filter_table_remove(p_cuckoo_filter, hash, fingerprint) ) return 1;
+
+    // the older tables
+    for (; *pp_table; pp_table = &(*pp_table)->p_older)
+    {
+
+        // initialized data
+        cuckoo_filter *p_table = *pp_table;
+
+        // not in this table
+        if ( false == cuckoo_filter_table_remove(p_table, hash, fingerprint) ) continue;
+
+        // release an older table once it empties
+        if ( 0 == p_table->count )
+            *pp_table          = p_table->p_older,
+            p_table->p_buckets = key_value_memory_allocator(KEY_VALUE_MEMORY_FILTER, p_table->p_buckets, 0),
+            p_table            = key_value_memory_allocator(KEY_VALUE_MEMORY_FILTER, p_table, 0);
+
+        // success
+        return 1;
+    }
+
+    // not found
+    return 0;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_cuckoo_filter:
+                #ifndef NDEBUG
+                    log_error("[cuckoo filter] Null pointer provided for parameter \"p_cuckoo_filter\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[cuckoo filter] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+bool cuckoo_filter_contains ( cuckoo_filter *p_cuckoo_filter, const char *p_key, size_t length )
+{
+
+    // argument check. without a filter, every key may be present
+    if ( NULL == p_cuckoo_filter ) return true;
+    if ( NULL ==           p_key ) return false;
+
+    // initialized data
+    unsigned long long hash        = cuckoo_filter_hash(p_key, length);
+    unsigned short     fingerprint = cuckoo_filter_fingerprint(hash);
+
+    // search every table, newest first
+    for (cuckoo_filter *p_table = p_cuckoo_filter; p_table; p_table = p_table->p_older)
+        if ( cuckoo_filter_table_contains(p_table, hash, fingerprint) ) return true;
+
+    // not found
+    return false;
+}
+
+bool cuckoo_filter_full ( cuckoo_filter *p_cuckoo_filter )
+{
+
+    // argument check
+    if ( NULL == p_cuckoo_filter ) return false;
+
+    // done
+    return p_cuckoo_filter->full;
+}
+
+size_t cuckoo_filter_count ( cuckoo_filter *p_cuckoo_filter )
+{
+
+    // argument check
+    if ( NULL == p_cuckoo_filter ) return 0;
+
+    // initialized data
+    size_t count = 0;
+
+    // every table
+    for (cuckoo_filter *p_table = p_cuckoo_filter; p_table; p_table = p_table->p_older) count += p_table->count;
+
+    // done
+    return count;
+}
+
+size_t cuckoo_filter_capacity ( cuckoo_filter *p_cuckoo_filter )
+{
+
+    // argument check
+    if ( NULL == p_cuckoo_filter ) return 0;
+
+    // initialized data
+    size_t capacity = 0;
+
+    // every table
+    for (cuckoo_filter *p_table = p_cuckoo_filter; p_table; p_table = p_table->p_older) capacity += ( p_table->mask + 1 ) * CUCKOO_FILTER_SLOTS;
+
+    // done
+    return capacity;
+}
+
+int cuckoo_filter_destroy ( cuckoo_filter **pp_cuckoo_filter )
+{
+
+    // argument check
+    if ( NULL == pp_cuckoo_filter ) goto no_cuckoo_filter;
+
+    // initialized data
+    cuckoo_filter *p_cuckoo_filter = *pp_cuckoo_filter;
+
+    // no more pointer for caller
+    *pp_cuckoo_filter = NULL;
+
+    // release every table
+    while ( p_cuckoo_filter )
+    {
+
+        // initialized data
+        cuckoo_filter *p_older = p_cuckoo_filter->p_older;
+
+        // release the table
+        p_cuckoo_filter->p_buckets = key_value_memory_allocator(KEY_VALUE_MEMORY_FILTER, p_cuckoo_filter->p_buckets, 0);
+        p_cuckoo_filter            = key_value_memory_allocator(KEY_VALUE_MEMORY_FILTER, p_cuckoo_filter, 0);
+
+        // next table
+        p_cuckoo_filter = p_older;
+    }
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_cuckoo_filter:
+                #ifndef NDEBUG
+                    log_error("[cuckoo filter] Null pointer provided for parameter \"pp_cuckoo_filter\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
@@ -0,0 +1,619 @@
+/** !
+ * Shared compression dictionaries, trained from sample values
+ *
+ * @file src/dictionary.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/dictionary.h>
+
+// structure declarations
+struct dictionary_segment_s;
+
+// type definitions
+typedef struct dictionary_segment_s dictionary_segment;
+
+// structure definitions
+struct dictionary_s
+{
+
+    // the owner, and each value packed with the dictionary, hold a reference
+    size_t references;
+
+    // the last position of each 4 byte prefix, plus one. zero is an empty slot
+    unsigned short _table[1 << DICTIONARY_TABLE_BITS];
+
+    size_t length;
+    char   _text[];
+};
+
+// a piece of a sample, and how common its substrings are
+struct dictionary_segment_s
+{
+    const char         *p_text;
+    size_t              length;
+    unsigned long long  score;
+};
+
+// data
+static dictionary_statistics _dictionary_statistics = { 0 };
+
+static unsigned long long dictionary_time_ns ( void )
+{
+
+    // initialized data
+    struct timespec _now = { 0 };
+
+    // monotonic time
+    clock_gettime(CLOCK_MONOTONIC, &_now);
+
+    // done
+    return (unsigned long long) _now.tv_sec * 1000000000ULL + (unsigned long long) _now.tv_nsec;
+}
+
+static size_t dictionary_hash ( const char *p_text )
+{
+
+    // initialized data
+    unsigned int word = 0;
+
+    // the next 4 bytes
+    memcpy(&word, p_text, sizeof(word));
+
+    // done
+    return ( word * 2654435761U ) >> ( 32 - DICTIONARY_TABLE_BITS );
+}
+
+static size_t dictionary_kmer ( const char *p_text )
+{
+
+    // initialized data
+    unsigned long long word = 0;
+
+    // the next 8 bytes
+    memcpy(&word, p_text, DICTIONARY_KMER);
+
+    // done
+    return (size_t) ( ( word * 0x9e3779b97f4a7c15ULL ) >> ( 64 - DICTIONARY_COUNT_BITS ) );
+}
+
+static unsigned long long dictionary_segment_score ( const dictionary_segment *p_segment, const unsigned int *p_counts )
+{
+
+    // initialized data
+    unsigned long long score = 0;
+
+    // substrings seen once are no use to any other value
+    for (size_t i = 0; i + DICTIONARY_KMER <= p_segment->length; i++)
+        if ( p_counts[dictionary_kmer(&p_segment->p_text[i])] > 1 ) score += p_counts[dictionary_kmer(&p_segment->p_text[i])] - 1;
+
+    // done
+    return score;
+}
+
+static int dictionary_segment_compare ( const void *p_a, const void *p_b )
+{
+
+    // initialized data
+    const dictionary_segment *p_left  = p_a,
+                             *p_right = p_b;
+
+    // highest score first
+    return ( p_left->score < p_right->score ) - ( p_left->score > p_right->score );
+}
+
+int dictionary_train ( dictionary **pp_dictionary, const char *const *pp_samples, const size_t *p_lengths, size_t count, size_t capacity )
+{
+
+    // argument check
+    if ( NULL == pp_dictionary             ) goto no_dictionary;
+    if ( count && NULL == pp_samples       ) goto no_samples;
+    if ( count && NULL == p_lengths        ) goto no_lengths;
+    if ( capacity > DICTIONARY_SIZE_MAX    ) capacity = DICTIONARY_SIZE_MAX;
+
+    // initialized data
+    dictionary         *p_dictionary = key_value_memory_allocator(KEY_VALUE_MEMORY_VALUES, 0, sizeof(dictionary) + capacity);
+    unsigned int       *p_counts     = NULL;
+    dictionary_segment *p_segments   = NULL;
+    size_t              segments     = 0,
+                        used         = 0;
+
+    // error check
+    if ( NULL == p_dictionary ) goto no_mem;
+
+    // initialize the dictionary
+    memset(p_dictionary, 0, sizeof(dictionary));
+    p_dictionary->references = 1;
+
+    // nothing to learn from
+    if ( 0 == count || 0 == capacity ) goto done;
+
+    // count every substring of every sample
+    p_counts = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, 0, sizeof(unsigned int) << DICTIONARY_COUNT_BITS);
+    if ( NULL == p_counts ) goto no_counts;
+    memset(p_counts, 0, sizeof(unsigned int) << DICTIONARY_COUNT_BITS);
+    for (size_t s = 0; s < count; s++)
+    {
+        for (size_t i = 0; i + DICTIONARY_KMER <= p_lengths[s]; i++) p_counts[dictionary_kmer(&pp_samples[s][i])]++;
+        segments += p_lengths[s] / ( DICTIONARY_SEGMENT / 2 ) + 1;
+    }
+
+    // cut the samples into overlapping segments
+    p_segments = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, 0, segments * sizeof(dictionary_segment));
+    if ( NULL == p_segments ) goto no_segments;
+    segments = 0;
+    for (size_t s = 0; s < count; s++)
+    {
+        for (size_t i = 0; i < p_lengths[s]; i += DICTIONARY_SEGMENT / 2)
+        {
+            p_segments[segments] = (dictionary_segment)
+            {
+                .p_text = &pp_samples[s][i],
+                .length = ( p_lengths[s] - i < DICTIONARY_SEGMENT ) ? p_lengths[s] - i : DICTIONARY_SEGMENT
+            };
+            p_segments[segments].score = dictionary_segment_score(&p_segments[segments], p_counts);
+            if ( p_segments[segments].score ) segments++;
+            if ( i + DICTIONARY_SEGMENT >= p_lengths[s] ) break;
+        }
+    }
+
+    // the most common segments first
+    qsort(p_segments, segments, sizeof(dictionary_segment), dictionary_segment_compare);
+
+    // fill the dictionary from the back, so the most common segments are the
+    // last ones in it, and win the hash table. a segment that is mostly
+    // covered by the ones picked before it waits for the next pass, with
+    // the score of what it has left
+    for (size_t pass = 0; pass < DICTIONARY_PASSES && segments && used < capacity; pass++)
+    {
+
+        // initialized data
+        size_t kept = 0;
+
+        // each segment, most common first
+        for (size_t i = 0; i < segments && used < capacity; i++)
+        {
+
+            // initialized data
+            dictionary_segment *p_segment = &p_segments[i];
+            unsigned long long  score     = dictionary_segment_score(p_segment, p_counts);
+
+            // covered, or too long for what is left
+            if ( 0 == score || p_segment->length > capacity - used ) continue;
+
+            // mostly covered
+            if ( score * 2 < p_segment->score ) { p_segment->score = score, p_segments[kept++] = *p_segment; continue; }
+
+            // add the segment
+            used += p_segment->length;
+            memcpy(&p_dictionary->_text[capacity - used], p_segment->p_text, p_segment->length);
+
+            // its substrings are covered from here on
+            for (size_t j = 0; j + DICTIONARY_KMER <= p_segment->length; j++) p_counts[dictionary_kmer(&p_segment->p_text[j])] = 0;
+        }
+
+        // the rest, by what they have left
+        segments = kept;
+        qsort(p_segments, segments, sizeof(dictionary_segment), dictionary_segment_compare);
+    }
+
+    // move the segments to the front
+    memmove(p_dictionary->_text, &p_dictionary->_text[capacity - used], used);
+    p_dictionary->length = used;
+
+    // index every position. later positions replace earlier ones
+    for (size_t i = 0; i + DICTIONARY_MATCH_MIN <= used; i++) p_dictionary->_table[dictionary_hash(&p_dictionary->_text[i])] = (unsigned short) ( i + 1 );
+
+    // release the scratch space
+    p_segments = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_segments, 0);
+    p_counts   = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_counts, 0);
+
+    done:
+
+    // return a pointer to the caller
+    *pp_dictionary = p_dictionary;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_dictionary:
+                #ifndef NDEBUG
+                    log_error("[dictionary] Null pointer provided for parameter \"pp_dictionary\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_samples:
+                #ifndef NDEBUG
+                    log_error("[dictionary] Null pointer provided for parameter \"pp_samples\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_lengths:
+                #ifndef NDEBUG
+                    log_error("[dictionary] Null pointer provided for parameter \"p_lengths\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_segments:
+
+                // release the counts
+                p_counts = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_counts, 0);
+
+                // fall through
+                goto no_counts;
+
+            no_counts:
+
+                // release the dictionary
+                p_dictionary = key_value_memory_allocator(KEY_VALUE_MEMORY_VALUES, p_dictionary, 0);
+
+                // fall through
+                goto no_mem;
+
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+void dictionary_retain ( dictionary *p_dictionary, size_t raw, size_t packed )
+{
+
+    // take a reference
+    __atomic_add_fetch(&p_dictionary->references, 1, __ATOMIC_RELAXED);
+
+    // account for the value
+    __atomic_add_fetch(&_dictionary_statistics.values, 1, __ATOMIC_RELAXED),
+    __atomic_add_fetch(&_dictionary_statistics.raw_bytes, raw, __ATOMIC_RELAXED),
+    __atomic_add_fetch(&_dictionary_statistics.packed_bytes, packed, __ATOMIC_RELAXED);
+
+    // done
+    return;
+}
+
+void dictionary_release ( dictionary *p_dictionary, size_t raw, size_t packed )
+{
+
+    // account for the value
+    __atomic_sub_fetch(&_dictionary_statistics.values, 1, __ATOMIC_RELAXED),
+    __atomic_sub_fetch(&_dictionary_statistics.raw_bytes, raw, __ATOMIC_RELAXED),
+    __atomic_sub_fetch(&_dictionary_statistics.packed_bytes, packed, __ATOMIC_RELAXED);
+
+    // drop the reference
+    dictionary_destroy(&p_dictionary);
+
+    // done
+    return;
+}
+
+static size_t dictionary_common ( const char *p_a, const char *p_b, size_t limit )
+{
+
+    // initialized data
+    size_t length = 0;
+
+    // count the matching bytes
+    while ( length < limit && p_a[length] == p_b[length] ) length++;
+
+    // done
+    return length;
+}
+
+static bool dictionary_literals ( const char *p_text, size_t length, char *p_buffer, size_t capacity, size_t *p_out )
+{
+
+    // runs of up to DICTIONARY_LITERAL_MAX bytes, each behind a count
+    while ( length )
+    {
+
+        // initialized data
+        size_t run = ( length < DICTIONARY_LITERAL_MAX ) ? length : DICTIONARY_LITERAL_MAX;
+
+        // error check
+        if ( *p_out + 1 + run > capacity ) return false;
+
+        // write the run
+        p_buffer[(*p_out)++] = (char) ( run - 1 );
+        memcpy(&p_buffer[*p_out], p_text, run);
+        *p_out += run, p_text += run, length -= run;
+    }
+
+    // done
+    return true;
+}
+
+int dictionary_compress ( const dictionary *p_dictionary, const char *p_text, size_t length, char *p_buffer, size_t capacity, size_t *p_length )
+{
+
+    // argument check
+    if ( NULL == p_dictionary ) return 0;
+    if ( NULL ==       p_text ) return 0;
+    if ( NULL ==     p_buffer ) return 0;
+    if ( length > DICTIONARY_INPUT_MAX ) return 0;
+
+    // initialized data
+    unsigned short     _table[1 << DICTIONARY_TABLE_BITS] = { 0 };
+    unsigned long long start                              = dictionary_time_ns();
+    size_t             i                                  = 0,
+                       anchor                             = 0,
+                       out                                = 0;
+
+    // greedy matching
+    while ( i + DICTIONARY_MATCH_MIN <= length )
+    {
+
+        // initialized data
+        size_t h        = dictionary_hash(&p_text[i]),
+               limit    = ( length - i < DICTIONARY_MATCH_MAX ) ? length - i : DICTIONARY_MATCH_MAX,
+               best     = 0,
+               distance = 0;
+
+        // an earlier occurrence in the value
+        if ( _table[h] )
+        {
+
+            // initialized data
+            size_t j       = _table[h] - 1U,
+                   matched = dictionary_common(&p_text[j], &p_text[i], limit);
+
+            // keep the match
+            if ( matched >= DICTIONARY_MATCH_MIN ) best = matched, distance = i - j;
+        }
+
+        // an occurrence in the dictionary, which ends where the value starts
+        if ( p_dictionary->_table[h] )
+        {
+
+            // initialized data
+            size_t j       = p_dictionary->_table[h] - 1U,
+                   span    = p_dictionary->length - j,
+                   matched = dictionary_common(&p_dictionary->_text[j], &p_text[i], ( span < limit ) ? span : limit);
+
+            // keep the longer match
+            if ( matched >= DICTIONARY_MATCH_MIN && matched > best ) best = matched, distance = span + i;
+        }
+
+        // remember this position
+        _table[h] = (unsigned short) ( i + 1 );
+
+        // no match
+        if ( 0 == best ) { i++; continue; }
+
+        // write the literals before the match, then the match
+        if ( false == dictionary_literals(&p_text[anchor], i - anchor, p_buffer, capacity, &out) ) goto too_long;
+        if ( out + 3 > capacity ) goto too_long;
+        p_buffer[out++] = (char) ( 0x80 | ( best - DICTIONARY_MATCH_MIN ) ),
+        p_buffer[out++] = (char) ( distance & 0xFF ),
+        p_buffer[out++] = (char) ( distance >> 8 );
+
+        // remember the positions inside the match
+        for (size_t k = i + 1; k < i + best && k + DICTIONARY_MATCH_MIN <= length; k++) _table[dictionary_hash(&p_text[k])] = (unsigned short) ( k + 1 );
+        i += best, anchor = i;
+    }
+
+    // write the trailing literals
+    if ( false == dictionary_literals(&p_text[anchor], length - anchor, p_buffer, capacity, &out) ) goto too_long;
+
+    // account for the time
+    __atomic_add_fetch(&_dictionary_statistics.compressions, 1, __ATOMIC_RELAXED),
+    __atomic_add_fetch(&_dictionary_statistics.compress_ns, dictionary_time_ns() - start, __ATOMIC_RELAXED);
+
+    // return the length to the caller
+    *p_length = out;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // dictionary errors
+        {
+            too_long:
+
+                // the value does not compress to capacity bytes. the time still counts
+                __atomic_add_fetch(&_dictionary_statistics.compressions, 1, __ATOMIC_RELAXED),
+                __atomic_add_fetch(&_dictionary_statistics.compress_ns, dictionary_time_ns() - start, __ATOMIC_RELAXED);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int dictionary_decompress ( const dictionary *p_dictionary, const char *p_packed, size_t packed, char *p_buffer, size_t length )
+{
+
+    // argument check
+    if ( NULL == p_dictionary ) goto no_dictionary;
+    if ( NULL ==     p_packed ) goto no_packed;
+    if ( NULL ==     p_buffer ) goto no_buffer;
+
+    // initialized data
+    unsigned long long start = dictionary_time_ns();
+    size_t             i     = 0,
+                       out   = 0;
+
+    // each run of literals, or match
+    while ( i < packed )
+    {
+
+        // initialized data
+        unsigned char control = (unsigned char) p_packed[i++];
+
+        // literals
+        if ( 0 == ( control & 0x80 ) )
+        {
+
+            // initialized data
+            size_t run = (size_t) control + 1;
+
+            // error check
+            if ( i + run > packed || out + run > length ) goto corrupt;
+
+            // copy the literals
+            memcpy(&p_buffer[out], &p_packed[i], run);
+            i += run, out += run;
+        }
+
+        // a match
+        else
+        {
+
+            // initialized data
+            size_t run      = (size_t) ( control & 0x7F ) + DICTIONARY_MATCH_MIN,
+                   distance = 0;
+
+            // error check
+            if ( i + 2 > packed || out + run > length ) goto corrupt;
+
+            // the distance back from here, through the value and into the dictionary
+            distance = (size_t) (unsigned char) p_packed[i] | (size_t) (unsigned char) p_packed[i + 1] << 8;
+            i += 2;
+
+            // error check
+            if ( 0 == distance || distance > out + p_dictionary->length ) goto corrupt;
+
+            // copy the match. it may start in the dictionary, and it may overlap itself
+            for (size_t k = 0; k < run; k++, out++)
+                p_buffer[out] = ( distance > out ) ? p_dictionary->_text[p_dictionary->length - ( distance - out )] : p_buffer[out - distance];
+        }
+    }
+
+    // error check
+    if ( out != length ) goto corrupt;
+
+    // account for the time
+    __atomic_add_fetch(&_dictionary_statistics.decompressions, 1, __ATOMIC_RELAXED),
+    __atomic_add_fetch(&_dictionary_statistics.decompress_ns, dictionary_time_ns() - start, __ATOMIC_RELAXED);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_dictionary:
+                #ifndef NDEBUG
+                    log_error("[dictionary] Null pointer provided for parameter \"p_dictionary\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_packed:
+                #ifndef NDEBUG
+                    log_error("[dictionary] Null pointer provided for parameter \"p_packed\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_buffer:
+                #ifndef NDEBUG
+                    log_error("[dictionary] Null pointer provided for parameter \"p_buffer\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // dictionary errors
+        {
+            corrupt:
+                #ifndef NDEBUG
+                    log_error("[dictionary] Corrupt value in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+size_t dictionary_length ( const dictionary *p_dictionary )
+{
+
+    // done
+    return ( p_dictionary ) ? p_dictionary->length : 0;
+}
+
+void dictionary_statistics_get ( dictionary_statistics *p_statistics )
+{
+
+    // argument check
+    if ( NULL == p_statistics ) return;
+
+    // copy the counters
+    p_statistics->values         = __atomic_load_n(&_dictionary_statistics.values, __ATOMIC_RELAXED),
+    p_statistics->raw_bytes      = __atomic_load_n(&_dictionary_statistics.raw_bytes, __ATOMIC_RELAXED),
+    p_statistics->packed_bytes   = __atomic_load_n(&_dictionary_statistics.packed_bytes, __ATOMIC_RELAXED),
+    p_statistics->compressions   = __atomic_load_n(&_dictionary_statistics.compressions, __ATOMIC_RELAXED),
+    p_statistics->compress_ns    = __atomic_load_n(&_dictionary_statistics.compress_ns, __ATOMIC_RELAXED),
+    p_statistics->decompressions = __atomic_load_n(&_dictionary_statistics.decompressions, __ATOMIC_RELAXED),
+    p_statistics->decompress_ns  = __atomic_load_n(&_dictionary_statistics.decompress_ns, __ATOMIC_RELAXED);
+
+    // done
+    return;
+}
+
+int dictionary_destroy ( dictionary **pp_dictionary )
+{
+
+    // argument check
+    if ( NULL == pp_dictionary ) goto no_dictionary;
+
+    // initialized data
+    dictionary *p_dictionary = *pp_dictionary;
+
+    // no more pointer for caller
+    *pp_dictionary = NULL;
+
+    // nothing to release
+    if ( NULL == p_dictionary ) return 1;
+
+    // release the dictionary with the last reference
+    if ( 0 == __atomic_sub_fetch(&p_dictionary->references, 1, __ATOMIC_ACQ_REL) )
+        p_dictionary = key_value_memory_allocator(KEY_VALUE_MEMORY_VALUES, p_dictionary, 0);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_dictionary:
+                #ifndef NDEBUG
+                    log_error("[dictionary] Null pointer provided for parameter \"pp_dictionary\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/** !
+ * Approximate LRU / LFU eviction
+ *
+ * @file src/eviction.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/eviction.h>
+
+static unsigned char eviction_meta_decayed ( const eviction_meta *p_eviction_meta, unsigned int now )
+{
+
+    // initialized data
+    unsigned int periods = 0;
+
+    // clock went backwards
+    if ( now <= p_eviction_meta->clock ) return p_eviction_meta->counter;
+
+    // one decrement per elapsed decay period
+    periods = ( now - p_eviction_meta->clock ) / EVICTION_LFU_DECAY_TIME;
+
+    // done
+    return ( periods >= p_eviction_meta->counter ) ? 0 : (unsigned char) ( p_eviction_meta->counter - periods );
+}
+
+void eviction_meta_init ( eviction_meta *p_eviction_meta, unsigned int now )
+{
+
+    // new records start warm, so they are not evicted before a second access
+    p_eviction_meta->clock   = now,
+    p_eviction_meta->counter = EVICTION_LFU_INIT;
+
+    // done
+    return;
+}
+
+void eviction_meta_touch ( eviction_meta *p_eviction_meta, unsigned int now, unsigned long long random )
+{
+
+    // initialized data
+    unsigned char counter = eviction_meta_decayed(p_eviction_meta, now);
+    double        base    = ( counter > EVICTION_LFU_INIT ) ? (double) ( counter - EVICTION_LFU_INIT ) : 0.0;
+    double        p       = 1.0 / ( base * EVICTION_LFU_LOG_FACTOR + 1.0 );
+
+    // logarithmic increment
+    if ( counter < 255 && (double) ( random >> 11 ) * ( 1.0 / 9007199254740992.0 ) < p ) counter++;
+
+    // store the access
+    p_eviction_meta->clock   = now,
+    p_eviction_meta->counter = counter;
+
+    // done
+    return;
+}
+
+unsigned long long eviction_meta_score ( const eviction_meta *p_eviction_meta, eviction_policy policy, unsigned int now )
+{
+
+    // initialized data
+    unsigned long long idle = ( now > p_eviction_meta->clock ) ? now - p_eviction_meta->clock : 0;
+
+    // least frequently used, ties broken by idle time
+    if ( EVICTION_POLICY_LFU == policy )
+        return ( (unsigned long long) ( 255 - eviction_meta_decayed(p_eviction_meta, now) ) << 32 ) | ( idle & 0xFFFFFFFF );
+
+    // least recently used
+    return idle;
+}
+
+unsigned long long eviction_random ( unsigned long long *p_state )
+{
+
+    // initialized data
+    unsigned long long x = *p_state;
+
+    // xorshift64
+    x ^= x << 13,
+    x ^= x >> 7,
+    x ^= x << 17;
+
+    // store the state
+    *p_state = x;
+
+    // done
+    return x;
+}
+
+int eviction_policy_parse ( const char *p_name, eviction_policy *p_policy )
+{
+
+    // argument check
+    if ( NULL ==   p_name ) return 0;
+    if ( NULL == p_policy ) return 0;
+
+    // least recently used
+    if ( 0 == strcmp(p_name, "lru") ) *p_policy = EVICTION_POLICY_LRU;
+
+    // least frequently used
+    else if ( 0 == strcmp(p_name, "lfu") ) *p_policy = EVICTION_POLICY_LFU;
+
+    // error
+    else return 0;
+
+    // success
+    return 1;
+}
+
+const char *eviction_policy_name ( eviction_policy policy )
+{
+
+    // done
+    return ( EVICTION_POLICY_LFU == policy ) ? "lfu" : "lru";
+}
@@ -0,0 +1,962 @@
+/** !
+ * Self sizing W-TinyLFU front cache
+ *
+ * @file src/front_cache.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/front_cache.h>
+
+// enumeration definitions
+enum front_cache_segment_e
+{
+    FRONT_CACHE_WINDOW    = 0,
+    FRONT_CACHE_PROBATION = 1,
+    FRONT_CACHE_PROTECTED = 2,
+    FRONT_CACHE_SEGMENTS  = 3
+};
+
+// structure declarations
+struct front_cache_entry_s;
+
+// type definitions
+typedef struct front_cache_entry_s front_cache_entry;
+
+// structure definitions
+struct front_cache_entry_s
+{
+    const char         *p_key;
+    void               *p_value;
+    unsigned long long  hash;
+    front_cache_entry  *p_chain,
+                       *p_prev,
+                       *p_next;
+    unsigned char       segment;
+};
+
+struct front_cache_s
+{
+
+    // each segment is an LRU list, most recently used at the head
+    struct
+    {
+        front_cache_entry _sentinel;
+        size_t            count;
+    } segments[FRONT_CACHE_SEGMENTS];
+
+    // chained hash table
+    front_cache_entry **pp_buckets;
+    size_t              bucket_mask;
+
+    // released entries, reused before allocating
+    front_cache_entry *p_free;
+
+    // count min sketch of 4 bit counters, 16 to a word
+    struct
+    {
+        unsigned long long *p_table;
+        size_t              mask,
+                            additions,
+                            sample_size;
+    } sketch;
+
+    // sizing
+    size_t capacity,
+           capacity_max,
+           window_capacity,
+           protected_capacity;
+
+    // hill climber
+    struct
+    {
+        size_t hits,
+               misses;
+        double previous_rate,
+               resize_rate;
+        long   window_step;
+        int    direction;
+        size_t idle_periods;
+    } climber;
+
+    front_cache_statistics _statistics;
+};
+
+static unsigned long long front_cache_hash ( const char *p_key )
+{
+
+    // initialized data
+    unsigned long long h = 0xcbf29ce484222325ULL;
+
+    // FNV-1a
+    while ( *p_key ) h ^= (unsigned char) *p_key++, h *= 0x100000001b3ULL;
+
+    // done
+    return h;
+}
+
+static unsigned long long front_cache_rehash ( unsigned long long h, size_t row )
+{
+
+    // spread the hash differently for each row
+    h += 0x9e3779b97f4a7c15ULL * ( row + 1 );
+    h  = ( h ^ ( h >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+    h  = ( h ^ ( h >> 27 ) ) * 0x94d049bb133111ebULL;
+
+    // done
+    return h ^ ( h >> 31 );
+}
+
+static unsigned int front_cache_frequency ( front_cache *p_front_cache, unsigned long long hash )
+{
+
+    // initialized data
+    unsigned int frequency = 15;
+
+    // the estimate is the smallest counter
+    for (size_t row = 0; row < 4; row++)
+    {
+
+        // initialized data
+        unsigned long long h     = front_cache_rehash(hash, row);
+        unsigned long long word  = p_front_cache->sketch.p_table[h & p_front_cache->sketch.mask];
+        unsigned int       count = ( word >> ( ( h >> 60 ) << 2 ) ) & 0xF;
+
+        // smaller?
+        if ( count < frequency ) frequency = count;
+    }
+
+    // done
+    return frequency;
+}
+
+static void front_cache_increment ( front_cache *p_front_cache, unsigned long long hash )
+{
+
+    // increment each row
+    for (size_t row = 0; row < 4; row++)
+    {
+
+        // initialized data
+        unsigned long long  h      = front_cache_rehash(hash, row);
+        unsigned long long *p_word = &p_front_cache->sketch.p_table[h & p_front_cache->sketch.mask];
+        unsigned int        shift  = (unsigned int) ( ( h >> 60 ) << 2 );
+
+        // saturate at 15
+        if ( ( ( *p_word >> shift ) & 0xF ) < 15 ) *p_word += 1ULL << shift;
+    }
+
+    // age the sketch, so that stale popularity fades
+    if ( ++p_front_cache->sketch.additions >= p_front_cache->sketch.sample_size )
+    {
+
+        // halve every counter
+        for (size_t i = 0; i <= p_front_cache->sketch.mask; i++)
+            p_front_cache->sketch.p_table[i] = ( p_front_cache->sketch.p_table[i] >> 1 ) & 0x7777777777777777ULL;
+
+        p_front_cache->sketch.additions /= 2;
+    }
+
+    // done
+    return;
+}
+
+static void front_cache_unlink ( front_cache *p_front_cache, front_cache_entry *p_entry )
+{
+
+    // unlink the entry from its segment
+    p_entry->p_prev->p_next = p_entry->p_next,
+    p_entry->p_next->p_prev = p_entry->p_prev;
+    p_front_cache->segments[p_entry->segment].count--;
+
+    // done
+    return;
+}
+
+static void front_cache_push ( front_cache *p_front_cache, front_cache_entry *p_entry, unsigned char segment )
+{
+
+    // initialized data
+    front_cache_entry *p_sentinel = &p_front_cache->segments[segment]._sentinel;
+
+    // link the entry at the head of the segment
+    p_entry->segment        = segment,
+    p_entry->p_prev         = p_sentinel,
+    p_entry->p_next         = p_sentinel->p_next,
+    p_sentinel->p_next->p_prev = p_entry,
+    p_sentinel->p_next      = p_entry;
+    p_front_cache->segments[segment].count++;
+
+    // done
+    return;
+}
+
+static void front_cache_append ( front_cache *p_front_cache, front_cache_entry *p_entry, unsigned char segment )
+{
+
+    // initialized data
+    front_cache_entry *p_sentinel = &p_front_cache->segments[segment]._sentinel;
+
+    // link the entry at the tail of the segment
+    p_entry->segment           = segment,
+    p_entry->p_next            = p_sentinel,
+    p_entry->p_prev            = p_sentinel->p_prev,
+    p_sentinel->p_prev->p_next = p_entry,
+    p_sentinel->p_prev         = p_entry;
+    p_front_cache->segments[segment].count++;
+
+    // done
+    return;
+}
+
+static front_cache_entry *front_cache_tail ( front_cache *p_front_cache, unsigned char segment )
+{
+
+    // initialized data
+    front_cache_entry *p_sentinel = &p_front_cache->segments[segment]._sentinel;
+
+    // done
+    return ( p_sentinel->p_prev == p_sentinel ) ? NULL : p_sentinel->p_prev;
+}
+
+static front_cache_entry **front_cache_bucket ( front_cache *p_front_cache, const char *p_key, unsigned long long hash )
+{
+
+    // initialized data
+    front_cache_entry **pp_entry = &p_front_cache->pp_buckets[hash & p_front_cache->bucket_mask];
+
+    // walk the chain
+    while ( *pp_entry && ( (*pp_entry)->hash != hash || 0 != strcmp((*pp_entry)->p_key, p_key) ) )
+        pp_entry = &(*pp_entry)->p_chain;
+
+    // done
+    return pp_entry;
+}
+
+static void front_cache_release ( front_cache *p_front_cache, front_cache_entry *p_entry )
+{
+
+    // unlink the entry from the hash table
+    *front_cache_bucket(p_front_cache, p_entry->p_key, p_entry->hash) = p_entry->p_chain;
+
+    // unlink the entry from its segment
+    front_cache_unlink(p_front_cache, p_entry);
+
+    // keep the entry for the next insert
+    p_entry->p_chain       = p_front_cache->p_free,
+    p_front_cache->p_free  = p_entry;
+
+    // done
+    return;
+}
+
+static size_t front_cache_main_count ( front_cache *p_front_cache )
+{
+
+    // done
+    return p_front_cache->segments[FRONT_CACHE_PROBATION].count + p_front_cache->segments[FRONT_CACHE_PROTECTED].count;
+}
+
+static void front_cache_admit ( front_cache *p_front_cache, front_cache_entry *p_candidate )
+{
+
+    // initialized data
+    front_cache_entry *p_victim = NULL;
+
+    // room in the main region
+    if ( front_cache_main_count(p_front_cache) < p_front_cache->capacity - p_front_cache->window_capacity )
+    {
+        front_cache_push(p_front_cache, p_candidate, FRONT_CACHE_PROBATION);
+
+        // done
+        return;
+    }
+
+    // the victim is the least recently used probationary entry
+    p_victim = front_cache_tail(p_front_cache, FRONT_CACHE_PROBATION);
+    if ( NULL == p_victim ) p_victim = front_cache_tail(p_front_cache, FRONT_CACHE_PROTECTED);
+
+    // admit the candidate only if it is used more often than the victim
+    if ( p_victim && front_cache_frequency(p_front_cache, p_candidate->hash) > front_cache_frequency(p_front_cache, p_victim->hash) )
+    {
+
+        // evict the victim
+        front_cache_release(p_front_cache, p_victim);
+        p_front_cache->_statistics.evicted++;
+
+        // admit the candidate
+        front_cache_push(p_front_cache, p_candidate, FRONT_CACHE_PROBATION);
+        p_front_cache->_statistics.admitted++;
+    }
+
+    // reject the candidate
+    else
+    {
+
+        // put the candidate somewhere front_cache_release can unlink it from
+        front_cache_push(p_front_cache, p_candidate, FRONT_CACHE_PROBATION);
+        front_cache_release(p_front_cache, p_candidate);
+        p_front_cache->_statistics.rejected++;
+    }
+
+    // done
+    return;
+}
+
+static void front_cache_fit ( front_cache *p_front_cache )
+{
+
+    // initialized data
+    front_cache_entry *p_entry = NULL;
+
+    // overflow from the window competes for the main region
+    while ( p_front_cache->segments[FRONT_CACHE_WINDOW].count > p_front_cache->window_capacity )
+    {
+        p_entry = front_cache_tail(p_front_cache, FRONT_CACHE_WINDOW);
+        front_cache_unlink(p_front_cache, p_entry);
+        front_cache_admit(p_front_cache, p_entry);
+    }
+
+    // overflow from the protected segment is demoted
+    while ( p_front_cache->segments[FRONT_CACHE_PROTECTED].count > p_front_cache->protected_capacity )
+    {
+        p_entry = front_cache_tail(p_front_cache, FRONT_CACHE_PROTECTED);
+        front_cache_unlink(p_front_cache, p_entry);
+        front_cache_push(p_front_cache, p_entry, FRONT_CACHE_PROBATION);
+    }
+
+    // overflow from the main region is evicted
+    while ( front_cache_main_count(p_front_cache) > p_front_cache->capacity - p_front_cache->window_capacity )
+    {
+        p_entry = front_cache_tail(p_front_cache, FRONT_CACHE_PROBATION);
+        if ( NULL == p_entry ) p_entry = front_cache_tail(p_front_cache, FRONT_CACHE_PROTECTED);
+        front_cache_release(p_front_cache, p_entry);
+        p_front_cache->_statistics.evicted++;
+    }
+
+    // done
+    return;
+}
+
+static void front_cache_size ( front_cache *p_front_cache, size_t capacity, size_t window_capacity )
+{
+
+    // clamp the capacity
+    if ( capacity < FRONT_CACHE_CAPACITY_MIN           ) capacity = FRONT_CACHE_CAPACITY_MIN;
+    if ( capacity > p_front_cache->capacity_max        ) capacity = p_front_cache->capacity_max;
+
+    // clamp the window between one entry, and a fifth of the cache
+    if ( window_capacity < 1                           ) window_capacity = 1;
+    if ( window_capacity > capacity / 5                ) window_capacity = capacity / 5;
+
+    // store the sizes. four fifths of the main region is protected
+    p_front_cache->capacity           = capacity,
+    p_front_cache->window_capacity    = window_capacity,
+    p_front_cache->protected_capacity = ( capacity - window_capacity ) * 4 / 5;
+
+    // evict whatever no longer fits
+    front_cache_fit(p_front_cache);
+
+    // done
+    return;
+}
+
+static void front_cache_climb ( front_cache *p_front_cache )
+{
+
+    // initialized data
+    size_t accesses = p_front_cache->climber.hits + p_front_cache->climber.misses;
+    double rate     = 0.0,
+           change   = 0.0;
+    long   largest  = (long) ( p_front_cache->capacity / 5 / 4 ),
+           step     = p_front_cache->climber.window_step;
+
+    // sample once per capacity worth of accesses
+    if ( accesses < p_front_cache->capacity ) return;
+
+    // compute the hit rate of the sample
+    rate   = (double) p_front_cache->climber.hits / (double) accesses,
+    change = rate - p_front_cache->climber.previous_rate;
+
+    // the window moves at most a quarter of its range, between one entry and a fifth of the cache, per sample
+    if ( largest < 1 ) largest = 1;
+
+    // window. a shift in the workload starts over with the largest step
+    if ( change > 0.05 || change < -0.05 )
+        step = ( step < 0 ) ? -largest : largest;
+
+    // keep stepping in the same direction while the hit rate improves, and
+    // turn back with half the step when it falls, to settle on the best window
+    else if ( change < 0 )
+        step = -step / 2;
+
+    // store the step
+    if ( step == 0 )        step = ( p_front_cache->climber.window_step < 0 ) ? 1 : -1;
+    if ( step >  largest )  step =  largest;
+    if ( step < -largest )  step = -largest;
+    p_front_cache->climber.window_step = step;
+
+    // capacity. keep growing while growth pays for itself, and give it back when it does not
+    if ( 1 == p_front_cache->climber.direction )
+    {
+        if ( rate < p_front_cache->climber.resize_rate + 0.01 )
+            p_front_cache->climber.direction = -1;
+        else
+            p_front_cache->climber.resize_rate = rate;
+    }
+    else if ( 0 == p_front_cache->climber.direction && p_front_cache->climber.misses )
+    {
+
+        // probe for more capacity when the cache is full, and has been stable for a while
+        if
+        (
+            ++p_front_cache->climber.idle_periods >= 16 &&
+            p_front_cache->segments[FRONT_CACHE_WINDOW].count + front_cache_main_count(p_front_cache) >= p_front_cache->capacity &&
+            p_front_cache->capacity < p_front_cache->capacity_max
+        )
+            p_front_cache->climber.direction    = 1,
+            p_front_cache->climber.resize_rate  = rate,
+            p_front_cache->climber.idle_periods = 0;
+    }
+
+    // resize
+    {
+
+        // initialized data
+        size_t  capacity = p_front_cache->capacity;
+        long    window   = (long) p_front_cache->window_capacity + p_front_cache->climber.window_step;
+
+        // grow, or shrink, by an eighth
+        if (  1 == p_front_cache->climber.direction ) capacity += capacity / 8;
+        if ( -1 == p_front_cache->climber.direction ) capacity -= capacity / 9, p_front_cache->climber.direction = 0;
+
+        // resize the cache
+        front_cache_size(p_front_cache, capacity, ( window < 1 ) ? 1 : (size_t) window);
+
+        // stop growing at the budget
+        if ( p_front_cache->capacity == p_front_cache->capacity_max && 1 == p_front_cache->climber.direction )
+            p_front_cache->climber.direction = 0;
+    }
+
+    // start the next sample
+    p_front_cache->climber.previous_rate = rate,
+    p_front_cache->climber.hits          = 0,
+    p_front_cache->climber.misses        = 0;
+
+    // done
+    return;
+}
+
+int front_cache_construct ( front_cache **pp_front_cache, size_t capacity, size_t budget )
+{
+
+    // argument check
+    if ( NULL == pp_front_cache ) goto no_front_cache;
+
+    // initialized data
+    front_cache *p_front_cache = key_value_memory_allocator(KEY_VALUE_MEMORY_CACHE, 0, sizeof(front_cache));
+    size_t       capacity_max  = 0,
+                 buckets       = 1,
+                 words         = 1;
+
+    // error check
+    if ( NULL == p_front_cache ) goto no_mem;
+
+    // initialize the cache
+    memset(p_front_cache, 0, sizeof(front_cache));
+
+    // each entry costs an entry, a bucket, and a sketch word
+    capacity_max = budget / ( sizeof(front_cache_entry) + sizeof(front_cache_entry *) + sizeof(unsigned long long) );
+    if ( capacity_max < FRONT_CACHE_CAPACITY_MIN ) capacity_max = FRONT_CACHE_CAPACITY_MIN;
+
+    // size the hash table, and the sketch, for the largest capacity
+    while ( buckets < capacity_max ) buckets <<= 1;
+    while ( words   < capacity_max ) words   <<= 1;
+
+    // allocate the hash table
+    p_front_cache->pp_buckets = key_value_memory_allocator(KEY_VALUE_MEMORY_CACHE, 0, buckets * sizeof(front_cache_entry *));
+    if ( NULL == p_front_cache->pp_buckets ) goto no_mem;
+    memset(p_front_cache->pp_buckets, 0, buckets * sizeof(front_cache_entry *));
+    p_front_cache->bucket_mask = buckets - 1;
+
+    // allocate the sketch
+    p_front_cache->sketch.p_table = key_value_memory_allocator(KEY_VALUE_MEMORY_CACHE, 0, words * sizeof(unsigned long long));
+    if ( NULL == p_front_cache->sketch.p_table ) goto no_mem;
+    memset(p_front_cache->sketch.p_table, 0, words * sizeof(unsigned long long));
+    p_front_cache->sketch.mask        = words - 1,
+    p_front_cache->sketch.sample_size = 10 * capacity_max;
+
+    // initialize each segment
+    for (size_t i = 0; i < FRONT_CACHE_SEGMENTS; i++)
+        p_front_cache->segments[i]._sentinel.p_next = &p_front_cache->segments[i]._sentinel,
+        p_front_cache->segments[i]._sentinel.p_prev = &p_front_cache->segments[i]._sentinel;
+
+    // initialize the hill climber. the first sample sizes the step
+    p_front_cache->climber.window_step = 1;
+
+    // size the cache, with a one percent window
+    p_front_cache->capacity_max = capacity_max;
+    front_cache_size(p_front_cache, capacity, capacity / 100);
+
+    // return a pointer to the caller
+    *pp_front_cache = p_front_cache;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_front_cache:
+                #ifndef NDEBUG
+                    log_error("[front cache] Null pointer provided for parameter \"pp_front_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int front_cache_find ( front_cache *p_front_cache, const char *p_key, void **pp_value )
+{
+
+    // argument check
+    if ( NULL == p_front_cache ) goto no_front_cache;
+    if ( NULL ==         p_key ) goto no_key;
+    if ( NULL ==      pp_value ) goto no_value;
+
+    // initialized data
+    unsigned long long  hash    = front_cache_hash(p_key);
+    front_cache_entry  *p_entry = *front_cache_bucket(p_front_cache, p_key, hash);
+
+    // count the access, hit or miss
+    front_cache_increment(p_front_cache, hash);
+
+    // miss
+    if ( NULL == p_entry )
+    {
+        p_front_cache->_statistics.misses++,
+        p_front_cache->climber.misses++;
+
+        // adapt
+        front_cache_climb(p_front_cache);
+
+        // done
+        return 0;
+    }
+
+    // a second hit promotes a probationary entry
+    front_cache_unlink(p_front_cache, p_entry);
+    front_cache_push(p_front_cache, p_entry, ( FRONT_CACHE_WINDOW == p_entry->segment ) ? FRONT_CACHE_WINDOW : FRONT_CACHE_PROTECTED);
+
+    // demote protected overflow
+    if ( FRONT_CACHE_PROTECTED == p_entry->segment ) front_cache_fit(p_front_cache);
+
+    // hit
+    p_front_cache->_statistics.hits++,
+    p_front_cache->climber.hits++;
+
+    // return the value to the caller
+    *pp_value = p_entry->p_value;
+
+    // adapt
+    front_cache_climb(p_front_cache);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_front_cache:
+                #ifndef NDEBUG
+                    log_error("[front cache] Null pointer provided for parameter \"p_front_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[front cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_value:
+                #ifndef NDEBUG
+                    log_error("[front cache] Null pointer provided for parameter \"pp_value\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int front_cache_insert ( front_cache *p_front_cache, const char *p_key, void *p_value )
+{
+
+    // argument check
+    if ( NULL == p_front_cache ) goto no_front_cache;
+    if ( NULL ==         p_key ) goto no_key;
+
+    // initialized data
+    unsigned long long   hash     = front_cache_hash(p_key);
+    front_cache_entry  **pp_entry = front_cache_bucket(p_front_cache, p_key, hash);
+    front_cache_entry   *p_entry  = *pp_entry;
+
+    // already cached
+    if ( p_entry )
+    {
+        p_entry->p_value = p_value;
+
+        // success
+        return 1;
+    }
+
+    // reuse a released entry
+    if ( p_front_cache->p_free )
+        p_entry = p_front_cache->p_free,
+        p_front_cache->p_free = p_entry->p_chain;
+
+    // allocate a new entry
+    else
+    {
+        p_entry = key_value_memory_allocator(KEY_VALUE_MEMORY_CACHE, 0, sizeof(front_cache_entry));
+        if ( NULL == p_entry ) goto no_mem;
+    }
+
+    // populate the entry
+    p_entry->p_key   = p_key,
+    p_entry->p_value = p_value,
+    p_entry->hash    = hash,
+    p_entry->p_chain = NULL;
+
+    // link the entry into the hash table, and the window
+    *pp_entry = p_entry;
+    front_cache_push(p_front_cache, p_entry, FRONT_CACHE_WINDOW);
+
+    // window overflow competes for the main region
+    front_cache_fit(p_front_cache);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_front_cache:
+                #ifndef NDEBUG
+                    log_error("[front cache] Null pointer provided for parameter \"p_front_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[front cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int front_cache_warm ( front_cache *p_front_cache, const char *p_key, void *p_value, unsigned int frequency )
+{
+
+    // argument check
+    if ( NULL == p_front_cache ) goto no_front_cache;
+    if ( NULL ==         p_key ) goto no_key;
+
+    // initialized data
+    unsigned long long   hash     = front_cache_hash(p_key);
+    front_cache_entry  **pp_entry = front_cache_bucket(p_front_cache, p_key, hash);
+    front_cache_entry   *p_entry  = *pp_entry;
+    size_t               main     = p_front_cache->capacity - p_front_cache->window_capacity;
+
+    // already cached
+    if ( p_entry )
+    {
+        p_entry->p_value = p_value;
+
+        // success
+        return 1;
+    }
+
+    // the main region is full
+    if ( front_cache_main_count(p_front_cache) >= main ) return 0;
+
+    // raise the sketch estimate to the recorded frequency
+    for (unsigned int i = front_cache_frequency(p_front_cache, hash); i < frequency && i < 15; i++)
+        front_cache_increment(p_front_cache, hash);
+
+    // reuse a released entry
+    if ( p_front_cache->p_free )
+        p_entry = p_front_cache->p_free,
+        p_front_cache->p_free = p_entry->p_chain;
+
+    // allocate a new entry
+    else
+    {
+        p_entry = key_value_memory_allocator(KEY_VALUE_MEMORY_CACHE, 0, sizeof(front_cache_entry));
+        if ( NULL == p_entry ) goto no_mem;
+    }
+
+    // populate the entry
+    p_entry->p_key   = p_key,
+    p_entry->p_value = p_value,
+    p_entry->hash    = hash,
+    p_entry->p_chain = NULL;
+
+    // link the entry into the hash table
+    *pp_entry = p_entry;
+
+    // the hot set is listed hottest first, so each entry goes behind the last
+    front_cache_append(p_front_cache, p_entry, ( p_front_cache->segments[FRONT_CACHE_PROTECTED].count < p_front_cache->protected_capacity ) ? FRONT_CACHE_PROTECTED : FRONT_CACHE_PROBATION);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_front_cache:
+                #ifndef NDEBUG
+                    log_error("[front cache] Null pointer provided for parameter \"p_front_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[front cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int front_cache_remove ( front_cache *p_front_cache, const char *p_key )
+{
+
+    // argument check
+    if ( NULL == p_front_cache ) goto no_front_cache;
+    if ( NULL ==         p_key ) goto no_key;
+
+    // initialized data
+    front_cache_entry *p_entry = *front_cache_bucket(p_front_cache, p_key, front_cache_hash(p_key));
+
+    // not cached
+    if ( NULL == p_entry ) return 1;
+
+    // release the entry
+    front_cache_release(p_front_cache, p_entry);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_front_cache:
+                #ifndef NDEBUG
+                    log_error("[front cache] Null pointer provided for parameter \"p_front_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[front cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int front_cache_statistics_get ( front_cache *p_front_cache, front_cache_statistics *p_statistics )
+{
+
+    // argument check
+    if ( NULL == p_front_cache ) return 0;
+    if ( NULL ==  p_statistics ) return 0;
+
+    // copy the counters
+    *p_statistics = p_front_cache->_statistics;
+
+    // fill in the sizes
+    p_statistics->size         = p_front_cache->segments[FRONT_CACHE_WINDOW].count + front_cache_main_count(p_front_cache),
+    p_statistics->capacity     = p_front_cache->capacity,
+    p_statistics->capacity_max = p_front_cache->capacity_max,
+    p_statistics->window       = p_front_cache->window_capacity;
+
+    // success
+    return 1;
+}
+
+size_t front_cache_hot ( front_cache *p_front_cache, const char **pp_keys, unsigned int *p_frequencies, size_t max )
+{
+
+    // argument check
+    if ( NULL == p_front_cache ) return 0;
+    if ( NULL ==       pp_keys ) return 0;
+    if ( NULL == p_frequencies ) return 0;
+
+    // initialized data
+    static const unsigned char _order[FRONT_CACHE_SEGMENTS] = { FRONT_CACHE_PROTECTED, FRONT_CACHE_PROBATION, FRONT_CACHE_WINDOW };
+    size_t                     _offsets[16]                 = { 0 },
+                               quantity                     = 0;
+
+    // the counters are four bits wide, so a counting sort orders the keys by
+    // frequency, and keeps segment, then recency, order between equals
+    for (size_t pass = 0; pass < 2; pass++)
+    {
+
+        // walk each segment, most recently used first
+        for (size_t i = 0; i < FRONT_CACHE_SEGMENTS; i++)
+        {
+
+            // initialized data
+            front_cache_entry *p_sentinel = &p_front_cache->segments[_order[i]]._sentinel;
+
+            for (front_cache_entry *p_entry = p_sentinel->p_next; p_entry != p_sentinel; p_entry = p_entry->p_next)
+            {
+
+                // initialized data
+                unsigned int frequency = front_cache_frequency(p_front_cache, p_entry->hash);
+                size_t       slot      = 0;
+
+                // count the keys at each frequency
+                if ( 0 == pass )
+                {
+                    _offsets[15 - frequency]++;
+                    continue;
+                }
+
+                // place the key behind the hotter ones
+                slot = _offsets[15 - frequency]++;
+                if ( slot < max )
+                    pp_keys[slot]       = p_entry->p_key,
+                    p_frequencies[slot] = frequency;
+            }
+        }
+
+        // the first slot of each frequency, hottest first
+        if ( 0 == pass )
+            for (size_t f = 0; f < 16; f++)
+                quantity    += _offsets[f],
+                _offsets[f]  = quantity - _offsets[f];
+    }
+
+    // done
+    return ( quantity < max ) ? quantity : max;
+}
+
+int front_cache_destroy ( front_cache **pp_front_cache )
+{
+
+    // argument check
+    if ( NULL == pp_front_cache ) goto no_front_cache;
+
+    // initialized data
+    front_cache *p_front_cache = *pp_front_cache;
+
+    // no more pointer for caller
+    *pp_front_cache = NULL;
+
+    // release each cached entry
+    for (size_t i = 0; i < FRONT_CACHE_SEGMENTS; i++)
+        while ( front_cache_tail(p_front_cache, (unsigned char) i) )
+            front_cache_release(p_front_cache, front_cache_tail(p_front_cache, (unsigned char) i));
+
+    // release each free entry
+    while ( p_front_cache->p_free )
+    {
+
+        // initialized data
+        front_cache_entry *p_entry = p_front_cache->p_free;
+
+        // release the entry
+        p_front_cache->p_free = p_entry->p_chain;
+        p_entry = key_value_memory_allocator(KEY_VALUE_MEMORY_CACHE, p_entry, 0);
+    }
+
+    // release the cache
+    p_front_cache->pp_buckets     = key_value_memory_allocator(KEY_VALUE_MEMORY_CACHE, p_front_cache->pp_buckets, 0);
+    p_front_cache->sketch.p_table = key_value_memory_allocator(KEY_VALUE_MEMORY_CACHE, p_front_cache->sketch.p_table, 0);
+    p_front_cache                 = key_value_memory_allocator(KEY_VALUE_MEMORY_CACHE, p_front_cache, 0);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_front_cache:
+                #ifndef NDEBUG
+                    log_error("[front cache] Null pointer provided for parameter \"pp_front_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
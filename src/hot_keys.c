@@ -0,0 +1,269 @@
+/** !
+ * Heavy hitters, with a count min sketch and a top K list
+ *
+ * @file src/hot_keys.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/hot_keys.h>
+
+// structure definitions
+struct hot_keys_s
+{
+
+    // count min sketch. each row is indexed by a different hash
+    unsigned int _sketch[HOT_KEYS_DEPTH][HOT_KEYS_WIDTH];
+
+    // the keys with the highest estimates, in no order
+    hot_keys_entry _top[HOT_KEYS_TOP];
+    size_t         top_count;
+
+    // halving. the span is the time the counts covered at the last
+    // halving, weighted like the counts, in milliseconds
+    unsigned long long interval,
+                       decayed;
+    double             span;
+};
+
+static unsigned long long hot_keys_hash ( const char *p_key )
+{
+
+    // initialized data
+    unsigned long long h = 0xcbf29ce484222325ULL;
+
+    // FNV-1a
+    while ( *p_key ) h ^= (unsigned char) *p_key++, h *= 0x100000001b3ULL;
+
+    // done
+    return h;
+}
+
+static size_t hot_keys_column ( unsigned long long hash, size_t row )
+{
+
+    // spread the hash differently for each row
+    hash += 0x9e3779b97f4a7c15ULL * ( row + 1 );
+    hash  = ( hash ^ ( hash >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+    hash  = ( hash ^ ( hash >> 27 ) ) * 0x94d049bb133111ebULL;
+
+    // done
+    return ( hash ^ ( hash >> 31 ) ) & ( HOT_KEYS_WIDTH - 1 );
+}
+
+int hot_keys_construct ( hot_keys **pp_hot_keys, unsigned long long interval, unsigned long long now )
+{
+
+    // argument check
+    if ( NULL == pp_hot_keys ) goto no_hot_keys;
+
+    // initialized data
+    hot_keys *p_hot_keys = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, 0, sizeof(hot_keys));
+
+    // error check
+    if ( NULL == p_hot_keys ) goto no_mem;
+
+    // initialize the tracker
+    memset(p_hot_keys, 0, sizeof(hot_keys));
+    p_hot_keys->interval = interval ? interval : 1,
+    p_hot_keys->decayed  = now;
+
+    // return a pointer to the caller
+    *pp_hot_keys = p_hot_keys;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_hot_keys:
+                #ifndef NDEBUG
+                    log_error("[hot keys] Null pointer provided for parameter \"pp_hot_keys\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+void hot_keys_record ( hot_keys *p_hot_keys, const char *p_key )
+{
+
+    // argument check
+    if ( NULL == p_hot_keys || NULL == p_key ) return;
+
+    // initialized data
+    unsigned long long hash                     = hot_keys_hash(p_key);
+    size_t             columns[HOT_KEYS_DEPTH]  = { 0 };
+    unsigned int       estimate                 = ~0U;
+    hot_keys_entry    *p_coldest                = NULL;
+
+    // the estimate is the smallest counter
+    for (size_t row = 0; row < HOT_KEYS_DEPTH; row++)
+    {
+        columns[row] = hot_keys_column(hash, row);
+        if ( p_hot_keys->_sketch[row][columns[row]] < estimate ) estimate = p_hot_keys->_sketch[row][columns[row]];
+    }
+
+    // saturated
+    if ( ~0U == estimate ) return;
+
+    // only raise the smallest counters, so that collisions inflate the estimate less
+    estimate++;
+    for (size_t row = 0; row < HOT_KEYS_DEPTH; row++)
+        if ( p_hot_keys->_sketch[row][columns[row]] < estimate ) p_hot_keys->_sketch[row][columns[row]] = estimate;
+
+    // already in the top list
+    for (size_t i = 0; i < p_hot_keys->top_count; i++)
+    {
+
+        // initialized data
+        hot_keys_entry *p_entry = &p_hot_keys->_top[i];
+
+        // match?
+        if ( hash == p_entry->hash && 0 == strncmp(p_entry->_key, p_key, HOT_KEYS_KEY_MAX - 1) )
+        {
+            p_entry->count = estimate;
+
+            // done
+            return;
+        }
+
+        // colder?
+        if ( NULL == p_coldest || p_entry->count < p_coldest->count ) p_coldest = p_entry;
+    }
+
+    // room in the top list
+    if ( p_hot_keys->top_count < HOT_KEYS_TOP ) p_coldest = &p_hot_keys->_top[p_hot_keys->top_count++];
+
+    // colder than the coldest key of a full list
+    else if ( estimate <= p_coldest->count ) return;
+
+    // replace the coldest key
+    strncpy(p_coldest->_key, p_key, HOT_KEYS_KEY_MAX - 1);
+    p_coldest->_key[HOT_KEYS_KEY_MAX - 1] = '\0';
+    p_coldest->hash  = hash,
+    p_coldest->count = estimate;
+
+    // done
+    return;
+}
+
+void hot_keys_decay ( hot_keys *p_hot_keys, unsigned long long now )
+{
+
+    // argument check
+    if ( NULL == p_hot_keys ) return;
+
+    // not yet
+    if ( now - p_hot_keys->decayed < p_hot_keys->interval ) return;
+
+    // halve the sketch
+    for (size_t row = 0; row < HOT_KEYS_DEPTH; row++)
+        for (size_t column = 0; column < HOT_KEYS_WIDTH; column++)
+            p_hot_keys->_sketch[row][column] >>= 1;
+
+    // halve the top list, and drop keys that went cold
+    for (size_t i = 0; i < p_hot_keys->top_count; )
+    {
+        p_hot_keys->_top[i].count >>= 1;
+
+        // keep the key
+        if ( p_hot_keys->_top[i].count ) { i++; continue; }
+
+        // swap the last key into the hole
+        p_hot_keys->_top[i] = p_hot_keys->_top[--p_hot_keys->top_count];
+    }
+
+    // record the halving
+    p_hot_keys->span    = ( p_hot_keys->span + (double) ( now - p_hot_keys->decayed ) ) / 2.0,
+    p_hot_keys->decayed = now;
+
+    // done
+    return;
+}
+
+size_t hot_keys_top ( hot_keys *p_hot_keys, hot_keys_entry *p_entries, unsigned long long now )
+{
+
+    // argument check
+    if ( NULL == p_hot_keys ) return 0;
+    if ( NULL ==  p_entries ) return 0;
+
+    // initialized data
+    double seconds = ( p_hot_keys->span + (double) ( now - p_hot_keys->decayed ) ) / 1000.0;
+
+    // too soon to tell
+    if ( seconds < 0.001 ) seconds = 0.001;
+
+    // copy the top list, and compute the rates
+    for (size_t i = 0; i < p_hot_keys->top_count; i++)
+        p_entries[i]      = p_hot_keys->_top[i],
+        p_entries[i].rate = (double) p_entries[i].count / seconds;
+
+    // sort the top list, hottest first
+    for (size_t i = 1; i < p_hot_keys->top_count; i++)
+    {
+
+        // initialized data
+        hot_keys_entry _entry = p_entries[i];
+        size_t         j      = i;
+
+        // insertion sort
+        while ( j && p_entries[j - 1].count < _entry.count ) p_entries[j] = p_entries[j - 1], j--;
+        p_entries[j] = _entry;
+    }
+
+    // done
+    return p_hot_keys->top_count;
+}
+
+int hot_keys_destroy ( hot_keys **pp_hot_keys )
+{
+
+    // argument check
+    if ( NULL == pp_hot_keys ) goto no_hot_keys;
+
+    // initialized data
+    hot_keys *p_hot_keys = *pp_hot_keys;
+
+    // no more pointer for caller
+    *pp_hot_keys = NULL;
+
+    // release the tracker
+    p_hot_keys = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_hot_keys, 0);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_hot_keys:
+                #ifndef NDEBUG
+                    log_error("[hot keys] Null pointer provided for parameter \"pp_hot_keys\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
@@ -0,0 +1,491 @@
+/** !
+ * JSON path locator over serialized values
+ *
+ * @file src/json_path.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/json_path.h>
+
+// preprocessor definitions
+#define JSON_PATH_ERROR     ( (size_t) -1 )
+#define JSON_PATH_DEPTH_MAX 64
+
+static size_t json_path_skip_blank ( const char *p_text, size_t length, size_t i )
+{
+
+    // skip whitespace
+    while ( i < length && isspace((unsigned char) p_text[i]) ) i++;
+
+    // done
+    return i;
+}
+
+static size_t json_path_skip_value ( const char *p_text, size_t length, size_t i )
+{
+
+    // initialized data
+    size_t depth = 0;
+    bool   quote = false;
+
+    // bounds check
+    if ( i >= length ) return JSON_PATH_ERROR;
+
+    // string
+    if ( '"' == p_text[i] )
+    {
+        for (i++;;)
+        {
+
+            // skip the plain run, many bytes at a time
+            i = tokenizer_string_end(p_text, length, i);
+
+            // unterminated
+            if ( i >= length ) return JSON_PATH_ERROR;
+
+            // end of the string
+            if ( '"' == p_text[i] ) return i + 1;
+
+            // skip the escape sequence, or control character
+            i += ( '\\' == p_text[i] ) ? 2 : 1;
+        }
+    }
+
+    // array, or object
+    if ( '[' == p_text[i] || '{' == p_text[i] )
+    {
+        for (; i < length; i++)
+        {
+
+            // initialized data
+            char c = p_text[i];
+
+            // inside a string
+            if ( quote )
+            {
+                if      ( '\\' == c ) i++;
+                else if ( '"'  == c ) quote = false;
+            }
+
+            // outside a string
+            else if ( '"' == c             ) quote = true;
+            else if ( '[' == c || '{' == c ) depth++;
+            else if ( ']' == c || '}' == c ) if ( 0 == --depth ) return i + 1;
+        }
+
+        // unterminated
+        return JSON_PATH_ERROR;
+    }
+
+    // number, boolean, or null
+    while ( i < length && !isspace((unsigned char) p_text[i]) && ',' != p_text[i] && ']' != p_text[i] && '}' != p_text[i] ) i++;
+
+    // done
+    return i;
+}
+
+static int json_path_member ( const char *p_text, size_t length, size_t *p_offset, size_t *p_span, const char *p_name, size_t name_length )
+{
+
+    // initialized data
+    size_t i   = *p_offset,
+           end = *p_offset + *p_span;
+
+    // error check
+    if ( '{' != p_text[i] ) return 0;
+
+    // walk each member
+    for (i++;;)
+    {
+
+        // initialized data
+        size_t key = 0, key_end = 0, value = 0, value_end = 0;
+
+        // end of the object?
+        i = json_path_skip_blank(p_text, end, i);
+        if ( i >= end || '}' == p_text[i] || '"' != p_text[i] ) return 0;
+
+        // the key
+        key     = i + 1;
+        key_end = json_path_skip_value(p_text, end, i);
+        if ( JSON_PATH_ERROR == key_end ) return 0;
+
+        // the separator
+        i = json_path_skip_blank(p_text, end, key_end);
+        if ( i >= end || ':' != p_text[i] ) return 0;
+
+        // the value
+        value     = json_path_skip_blank(p_text, end, i + 1);
+        value_end = json_path_skip_value(p_text, end, value);
+        if ( JSON_PATH_ERROR == value_end ) return 0;
+
+        // match?
+        if ( key_end - 1 - key == name_length && 0 == memcmp(&p_text[key], p_name, name_length) )
+        {
+            *p_offset = value,
+            *p_span   = value_end - value;
+
+            // success
+            return 1;
+        }
+
+        // next member
+        i = json_path_skip_blank(p_text, end, value_end);
+        if ( i < end && ',' == p_text[i] ) i++;
+    }
+
+    (void) length;
+}
+
+static int json_path_element ( const char *p_text, size_t length, size_t *p_offset, size_t *p_span, size_t index )
+{
+
+    // initialized data
+    size_t i   = *p_offset,
+           end = *p_offset + *p_span;
+
+    // error check
+    if ( '[' != p_text[i] ) return 0;
+
+    // walk each element
+    for (i++;; index--)
+    {
+
+        // initialized data
+        size_t value_end = 0;
+
+        // end of the array?
+        i = json_path_skip_blank(p_text, end, i);
+        if ( i >= end || ']' == p_text[i] ) return 0;
+
+        // the element
+        value_end = json_path_skip_value(p_text, end, i);
+        if ( JSON_PATH_ERROR == value_end ) return 0;
+
+        // match?
+        if ( 0 == index )
+        {
+            *p_offset = i,
+            *p_span   = value_end - i;
+
+            // success
+            return 1;
+        }
+
+        // next element
+        i = json_path_skip_blank(p_text, end, value_end);
+        if ( i < end && ',' == p_text[i] ) i++;
+    }
+
+    (void) length;
+}
+
+int json_path_locate ( const char *p_text, size_t length, const char *p_path, size_t path_length, size_t *p_offset, size_t *p_span )
+{
+
+    // argument check
+    if ( NULL ==   p_text ) return 0;
+    if ( NULL ==   p_path ) return 0;
+    if ( NULL == p_offset ) return 0;
+    if ( NULL ==   p_span ) return 0;
+
+    // initialized data
+    size_t offset = json_path_skip_blank(p_text, length, 0),
+           span   = 0,
+           i      = 0;
+
+    // the root value
+    span = json_path_skip_value(p_text, length, offset);
+    if ( JSON_PATH_ERROR == span ) return 0;
+    span -= offset;
+
+    // optional root
+    if ( i < path_length && '$' == p_path[i] ) i++;
+
+    // walk each segment
+    while ( i < path_length )
+    {
+
+        // .name
+        if ( '.' == p_path[i] )
+        {
+
+            // initialized data
+            size_t name = ++i;
+
+            // find the end of the name
+            while ( i < path_length && '.' != p_path[i] && '[' != p_path[i] ) i++;
+
+            // descend
+            if ( 0 == json_path_member(p_text, length, &offset, &span, &p_path[name], i - name) ) return 0;
+        }
+
+        // [index]
+        else if ( '[' == p_path[i] )
+        {
+
+            // initialized data
+            size_t index = 0;
+
+            // parse the index
+            for (i++; i < path_length && isdigit((unsigned char) p_path[i]); i++) index = index * 10 + (size_t) ( p_path[i] - '0' );
+
+            // error check
+            if ( i >= path_length || ']' != p_path[i] ) return 0;
+            i++;
+
+            // descend
+            if ( 0 == json_path_element(p_text, length, &offset, &span, index) ) return 0;
+        }
+
+        // error
+        else return 0;
+    }
+
+    // return the span to the caller
+    *p_offset = offset,
+    *p_span   = span;
+
+    // success
+    return 1;
+}
+
+int json_path_split ( const char *p_path, size_t path_length, size_t *p_parent_length, const char **pp_name, size_t *p_name_length )
+{
+
+    // initialized data
+    size_t i = path_length;
+
+    // find the start of the last segment
+    while ( i && '.' != p_path[i - 1] && '[' != p_path[i - 1] && ']' != p_path[i - 1] ) i--;
+
+    // not a name?
+    if ( 0 == i || '.' != p_path[i - 1] || i == path_length ) return 0;
+
+    // return the split to the caller
+    *p_parent_length = i - 1,
+    *pp_name         = &p_path[i],
+    *p_name_length   = path_length - i;
+
+    // success
+    return 1;
+}
+
+bool json_path_empty ( const char *p_text, size_t span )
+{
+
+    // done
+    return json_path_skip_blank(p_text, span, 1) >= span - 1;
+}
+
+static void json_path_emit ( char *p_out, size_t *p_o, const char *p_text, size_t start, size_t end )
+{
+
+    // validate only?
+    if ( NULL == p_out ) return;
+
+    // copy the span. the output never overtakes the input
+    memmove(&p_out[*p_o], &p_text[start], end - start);
+    *p_o += end - start;
+
+    // done
+    return;
+}
+
+static size_t json_path_validate ( const char *p_text, size_t length, size_t i, size_t depth, char *p_out, size_t *p_o )
+{
+
+    // bounds check
+    i = json_path_skip_blank(p_text, length, i);
+    if ( i >= length || depth > JSON_PATH_DEPTH_MAX ) return JSON_PATH_ERROR;
+
+    // string
+    if ( '"' == p_text[i] )
+    {
+
+        // initialized data
+        size_t start = i;
+
+        for (i++;;)
+        {
+
+            // skip the plain run, many bytes at a time
+            i = tokenizer_string_end(p_text, length, i);
+
+            // unterminated
+            if ( i >= length ) return JSON_PATH_ERROR;
+
+            // end of the string
+            if ( '"' == p_text[i] ) break;
+
+            // control characters must be escaped
+            if ( (unsigned char) p_text[i] < 0x20 ) return JSON_PATH_ERROR;
+
+            // skip the escape sequence
+            i += 2;
+        }
+
+        // copy the string
+        json_path_emit(p_out, p_o, p_text, start, i + 1);
+
+        // done
+        return i + 1;
+    }
+
+    // array, or object
+    if ( '[' == p_text[i] || '{' == p_text[i] )
+    {
+
+        // initialized data
+        char close = ( '[' == p_text[i] ) ? ']' : '}';
+
+        // copy the opening bracket
+        json_path_emit(p_out, p_o, p_text, i, i + 1);
+
+        // empty?
+        i = json_path_skip_blank(p_text, length, i + 1);
+        if ( i < length && close == p_text[i] ) goto close;
+
+        // each element, or member
+        for (;;)
+        {
+
+            // the key
+            if ( '}' == close )
+            {
+                if ( i >= length || '"' != p_text[i] ) return JSON_PATH_ERROR;
+                i = json_path_validate(p_text, length, i, depth + 1, p_out, p_o);
+                if ( JSON_PATH_ERROR == i ) return JSON_PATH_ERROR;
+                i = json_path_skip_blank(p_text, length, i);
+                if ( i >= length || ':' != p_text[i] ) return JSON_PATH_ERROR;
+                json_path_emit(p_out, p_o, p_text, i, i + 1);
+                i++;
+            }
+
+            // the value
+            i = json_path_validate(p_text, length, i, depth + 1, p_out, p_o);
+            if ( JSON_PATH_ERROR == i ) return JSON_PATH_ERROR;
+
+            // the separator
+            i = json_path_skip_blank(p_text, length, i);
+            if ( i >= length            ) return JSON_PATH_ERROR;
+            if ( close == p_text[i]     ) goto close;
+            if ( ','   != p_text[i]     ) return JSON_PATH_ERROR;
+            json_path_emit(p_out, p_o, p_text, i, i + 1);
+            i = json_path_skip_blank(p_text, length, i + 1);
+        }
+
+        close:
+
+        // copy the closing bracket
+        json_path_emit(p_out, p_o, p_text, i, i + 1);
+
+        // done
+        return i + 1;
+    }
+
+    // literals
+    if ( length - i >= 4 && 0 == memcmp(&p_text[i], "true",  4) ) return json_path_emit(p_out, p_o, p_text, i, i + 4), i + 4;
+    if ( length - i >= 5 && 0 == memcmp(&p_text[i], "false", 5) ) return json_path_emit(p_out, p_o, p_text, i, i + 5), i + 5;
+    if ( length - i >= 4 && 0 == memcmp(&p_text[i], "null",  4) ) return json_path_emit(p_out, p_o, p_text, i, i + 4), i + 4;
+
+    // number
+    {
+
+        // initialized data
+        size_t start = i;
+
+        // sign, and integer part
+        if ( '-' == p_text[i] ) i++;
+        if ( i >= length || !isdigit((unsigned char) p_text[i]) ) return JSON_PATH_ERROR;
+        if ( '0' == p_text[i++] && i < length && isdigit((unsigned char) p_text[i]) ) return JSON_PATH_ERROR;
+        while ( i < length && isdigit((unsigned char) p_text[i]) ) i++;
+
+        // fraction
+        if ( i < length && '.' == p_text[i] )
+        {
+            if ( ++i >= length || !isdigit((unsigned char) p_text[i]) ) return JSON_PATH_ERROR;
+            while ( i < length && isdigit((unsigned char) p_text[i]) ) i++;
+        }
+
+        // exponent
+        if ( i < length && ( 'e' == p_text[i] || 'E' == p_text[i] ) )
+        {
+            if ( ++i < length && ( '+' == p_text[i] || '-' == p_text[i] ) ) i++;
+            if ( i >= length || !isdigit((unsigned char) p_text[i]) ) return JSON_PATH_ERROR;
+            while ( i < length && isdigit((unsigned char) p_text[i]) ) i++;
+        }
+
+        // copy the number
+        json_path_emit(p_out, p_o, p_text, start, i);
+
+        // done
+        return i;
+    }
+}
+
+static int json_path_type ( const char *p_text, size_t length, unsigned char *p_type )
+{
+
+    // classify the value by its first character
+    switch ( p_text[0] )
+    {
+        case '{': *p_type = JSON_VALUE_OBJECT;  break;
+        case '[': *p_type = JSON_VALUE_ARRAY;   break;
+        case '"': *p_type = JSON_VALUE_STRING;  break;
+        case 't':
+        case 'f': *p_type = JSON_VALUE_BOOLEAN; break;
+        case 'n': *p_type = JSON_VALUE_NULL;    break;
+        default:
+            *p_type = ( memchr(p_text, '.', length) || memchr(p_text, 'e', length) || memchr(p_text, 'E', length) )
+                    ? JSON_VALUE_NUMBER
+                    : JSON_VALUE_INTEGER;
+    }
+
+    // success
+    return 1;
+}
+
+int json_path_classify ( const char *p_text, size_t length, unsigned char *p_type )
+{
+
+    // argument check
+    if ( NULL == p_text ) return 0;
+    if ( NULL == p_type ) return 0;
+
+    // initialized data
+    size_t start = json_path_skip_blank(p_text, length, 0),
+           end   = json_path_validate(p_text, length, start, 0, NULL, NULL);
+
+    // error check
+    if ( JSON_PATH_ERROR == end ) return 0;
+    if ( json_path_skip_blank(p_text, length, end) != length ) return 0;
+
+    // done
+    return json_path_type(&p_text[start], end - start, p_type);
+}
+
+int json_path_minify ( char *p_text, size_t length, size_t *p_length, unsigned char *p_type )
+{
+
+    // argument check
+    if ( NULL ==   p_text ) return 0;
+    if ( NULL == p_length ) return 0;
+    if ( NULL ==   p_type ) return 0;
+
+    // initialized data
+    size_t o   = 0,
+           end = json_path_validate(p_text, length, 0, 0, p_text, &o);
+
+    // error check
+    if ( JSON_PATH_ERROR == end ) return 0;
+    if ( json_path_skip_blank(p_text, length, end) != length ) return 0;
+
+    // return the length to the caller
+    *p_length = o;
+
+    // done
+    return json_path_type(p_text, o, p_type);
+}
@@ -9,19 +9,293 @@
 // header
 #include <key_value/key_value.h>
 
+// enumeration definitions
+enum key_value_db_stage_e
+{
+    KEY_VALUE_DB_STAGE_RECEIVE   = 0,
+    KEY_VALUE_DB_STAGE_QUEUE     = 1,
+    KEY_VALUE_DB_STAGE_PARSE     = 2,
+    KEY_VALUE_DB_STAGE_LOOKUP    = 3,
+    KEY_VALUE_DB_STAGE_SERIALIZE = 4,
+    KEY_VALUE_DB_STAGE_SEND      = 5,
+    KEY_VALUE_DB_STAGE_QUANTITY
+};
+
+// structure declarations
+struct key_value_connection_s;
+struct key_value_db_slow_request_s;
+struct key_value_db_index_keys_s;
+struct key_value_db_find_s;
+struct key_value_db_scan_page_s;
+struct key_value_db_snapshot_file_s;
+
+// type definitions
+typedef enum   key_value_db_stage_e         key_value_db_stage;
+typedef struct key_value_connection_s       key_value_connection;
+typedef struct key_value_db_slow_request_s  key_value_db_slow_request;
+typedef struct key_value_db_index_keys_s    key_value_db_index_keys;
+typedef struct key_value_db_find_s          key_value_db_find;
+typedef struct key_value_db_scan_page_s     key_value_db_scan_page;
+typedef struct key_value_db_snapshot_file_s key_value_db_snapshot_file;
+
+// data
+static const char *_key_value_db_stage_names[KEY_VALUE_DB_STAGE_QUANTITY] =
+{
+    [KEY_VALUE_DB_STAGE_RECEIVE]   = "receive",
+    [KEY_VALUE_DB_STAGE_QUEUE]     = "queue",
+    [KEY_VALUE_DB_STAGE_PARSE]     = "parse",
+    [KEY_VALUE_DB_STAGE_LOOKUP]    = "lookup",
+    [KEY_VALUE_DB_STAGE_SERIALIZE] = "serialize",
+    [KEY_VALUE_DB_STAGE_SEND]      = "send"
+};
+
 // structure definitions
+struct key_value_connection_s
+{
+    socket_tcp         _socket;
+    socket_ip_address  ip_address;
+    socket_port        port_number;
+    key_value_db      *p_key_value_db;
+    parallel_thread   *p_thread;
+
+    // responses, and pushed frames, are sent under this lock
+    mutex _send_lock;
+
+    // pushed frames wait here, so the database lock never waits on the send
+    // lock. whoever holds the send lock sends them when it lets go
+    struct
+    {
+        mutex  _lock;
+        char   _frames[KEY_VALUE_DB_PUSH_PENDING];
+        size_t length;
+    } pending;
+
+    // closed connections get no more pushes. finished connections are reaped by the listener
+    bool closed,
+         finished;
+
+    // accepted on the unix domain socket, so it may switch to shared memory rings
+    bool local;
+
+    // requests and responses, in shared memory, once the client asks for rings
+    struct
+    {
+        void   *p_region;
+        size_t  size;
+        ring   *p_requests,
+               *p_responses;
+    } shm;
+
+    // when the connection was accepted, in ticks
+    unsigned long long accepted;
+
+    // received bytes, reused by every request. a frame may arrive across
+    // several reads, and one read may hold several frames
+    struct
+    {
+        char               *p_data;
+        size_t              capacity,
+                            offset,
+                            length;
+        unsigned long long  stamp,  // when the first unread byte arrived, in microseconds
+                            last;   // when the last bytes arrived, in microseconds
+    } receive;
+
+    // key prefixes that push a frame when a matching key changes
+    struct
+    {
+        char   _prefixes[KEY_VALUE_DB_WATCH_MAX][63+1];
+        size_t count;
+    } watch;
+
+    key_value_connection *p_next;
+};
+
+struct key_value_db_slow_request_s
+{
+    unsigned long long id,
+                       time,                                // milliseconds since the epoch
+                       total,                               // microseconds
+                       _stages[KEY_VALUE_DB_STAGE_QUANTITY]; // microseconds
+    char               _command[15+1],
+                       _key[63+1];
+    socket_ip_address  ip_address;
+    socket_port        port_number;
+};
+
+// the keys in the tables that an index matches, while an index is backfilled
+struct key_value_db_index_keys_s
+{
+    secondary_index *p_index;
+    char            *p_keys;  // LSM_KEY_MAX bytes per key
+    size_t           count,
+                     capacity;
+};
+
+// the response to a find, while the index is walked
+struct key_value_db_find_s
+{
+    char   *p_response;
+    size_t  length,
+            skip,
+            found;
+    bool    more;
+};
+
+// the keys a scan reads, while the keyspace, the tables, and the saved
+// versions are walked. the smallest keys after the cursor are kept, in order
+struct key_value_db_scan_page_s
+{
+    const char *p_pattern,
+               *p_after;
+    char        _keys[KEY_VALUE_DB_SCAN_COUNT][63+1];
+    size_t      count,
+                literal;  // the characters of the pattern before its first wildcard
+    bool        more;
+};
+
+// a snapshot, while the index is walked. keys are written in order, so a
+// reload appends to the index
+struct key_value_db_snapshot_file_s
+{
+    FILE               *p_f;
+    unsigned long long  now;
+    size_t              keys;
+};
+
 struct key_value_db_s
 {
     bool running;
 
-    cache       *p_cache;
-    binary_tree *p_binary_tree;
+    mutex         _lock;
+    front_cache  *p_front_cache;
+    b_plus_tree  *p_index;
+    timing_wheel *p_timing_wheel;
+
+    // commit sequence. each write, or batch of writes, takes the next one
+    unsigned long long sequence;
+    bool               batching;
+
+    // versions that open snapshots still read. while one is open, each write
+    // saves the version it replaces
+    mvcc *p_mvcc;
+
+    // the lsm tree, when properties are backed by tables. the index is
+    // its memtable, and the properties the tables do not hold yet are dirty
+    struct
+    {
+        lsm    *p_lsm;
+        size_t  dirty,
+                prefetches;
+    } storage;
+
+    // where the snapshot, the hot set, and the tables are kept
+    struct
+    {
+        char _snapshot[FILENAME_MAX],
+             _hot_set[FILENAME_MAX],
+             _lsm[FILENAME_MAX];
+    } paths;
+
+    // every key, in memory or in the tables. a get for a key the filter
+    // rules out is a definite miss
+    cuckoo_filter *p_filter;
+
+    // the most read, and most written, keys
+    struct
+    {
+        hot_keys *p_reads,
+                 *p_writes;
+    } hot_keys;
+
+    // the dictionary new out of line values are packed with, or null pointer
+    // while compression is off. packed values hold their own reference
+    struct
+    {
+        dictionary *p_dictionary;
+    } compression;
+
+    // secondary indexes, kept up to date by every write, and every delete
+    struct
+    {
+        secondary_index *_indexes[KEY_VALUE_DB_INDEX_MAX];
+        size_t           count;
+    } indexes;
+
+    // requests slower than the threshold, in a ring. the request being
+    // processed marks where its lookup, and its serialization, started
+    struct
+    {
+        unsigned long long         threshold,  // microseconds, or 0 to record nothing
+                                   id,
+                                   lookup,
+                                   serialize;
+        double                     ticks_per_us;
+        const char                *p_command,
+                                  *p_key;
+        key_value_db_slow_request  _requests[KEY_VALUE_DB_SLOWLOG_MAX];
+        size_t                     count,
+                                   next;
+    } slowlog;
+
+    // every property, for sampling
+    struct
+    {
+        key_value_property **pp_properties;
+        size_t               count,
+                             capacity;
+    } keyspace;
+
+    struct
+    {
+        size_t             used,
+                           max;
+        eviction_policy    policy;
+        unsigned long long random;
+    } memory;
+
+    // shutdown. a stop request, or an idle server, writes the snapshot and the hot set
+    volatile sig_atomic_t stopping;
+    unsigned long long    last_request;
+
+    // opened in the caller's process, without a network. never idle
+    bool embedded;
+
+    // admission control
+    struct
+    {
+        size_t             max_connections,
+                           max_in_flight,
+                           connections;
+
+        // queue delay, CoDel style. when the smallest delay of an interval is
+        // over the target, requests that waited longer than the target are shed
+        unsigned long long interval_end,
+                           min_delay;
+        bool               overloaded;
+    } admission;
+
+    // a stored buffer that is sent after the response, instead of being copied into it
+    struct
+    {
+        const char *p_buffer,
+                   *p_text;
+        size_t      length;
+    } attachment;
 
     struct 
     {
-        thread_pool     *p_thread_pool;
-        socket_tcp       _socket;
-        parallel_thread *p_listener_thread;
+        thread_pool          *p_thread_pool;
+        socket_tcp            _socket;
+        parallel_thread      *p_listener_thread;
+
+        // co-located clients connect to the unix domain socket
+        int                   unix_socket;
+        parallel_thread      *p_unix_thread;
+
+        // every open connection, and the one whose request is being processed
+        key_value_connection *p_connections,
+                             *p_current;
     } network;
 
     struct
@@ -30,18 +304,60 @@ struct key_value_db_s
         {
             size_t get,
                    set,
+                   del,
                    err;
         } request;
+
+        size_t expired;
+
+        struct
+        {
+            size_t keys,
+                   bytes;
+        } evicted;
+
+        // connection buffer allocations. flat while requests are served
+        size_t buffer_allocations;
+
+        struct
+        {
+            size_t connections,
+                   in_flight,
+                   queue_delay;
+        } rejected;
+
+        // gets that found nothing, the ones the filter answered, and the ones it let through
+        struct
+        {
+            size_t gets,
+                   filtered,
+                   false_positives;
+        } miss;
     } counter;
 
     parallel_thread *p_shutdown;
+    parallel_thread *p_cron;
 };
 
 struct key_value_property_s
 {
-    char _name[63+1];
-    char _value[255+1];
-    json_value *p_value;
+    char            _name[63+1];
+    key_value_value _value;
+
+    // absolute expiry time in milliseconds, or 0 if the property never expires
+    unsigned long long  expires;
+    timing_wheel_timer _expiry;
+
+    // memory accounting, and eviction
+    size_t         size,
+                   index;
+    eviction_meta _eviction;
+
+    // commit sequence of the last write
+    unsigned long long version;
+
+    // the tables hold this exact property, so it can be evicted without losing it
+    bool durable;
 };
 
 int key_value_db_process
@@ -51,376 +367,7677 @@ int key_value_db_process
     char *p_response, size_t *p_response_len
 );
 
+char *key_value_db_parse_token ( char *p_request, size_t request_len, size_t *p_cur );
+char *key_value_db_parse_value ( char *p_request, size_t request_len, size_t *p_cur );
+bool  key_value_db_parse_expiry ( char *p_value, long long *p_seconds );
+bool  key_value_db_parse_integer ( const char *p_text, long long *p_integer );
+bool  key_value_db_parse_unsigned ( const char *p_text, unsigned long long *p_integer );
+
+int key_value_db_process_set_value
+(
+    key_value_db       *p_key_value_db,
+    char               *p_key,
+    key_value_value    *p_value,
+    unsigned long long  expires,
+
+    char *p_response, size_t *p_response_len
+);
+
+int key_value_db_snapshot_write ( key_value_db *p_key_value_db, const char *p_path, size_t *p_keys );
+int key_value_db_hot_set_write ( key_value_db *p_key_value_db, const char *p_path, size_t *p_keys );
+int key_value_db_flush ( key_value_db *p_key_value_db, size_t *p_keys );
+unsigned long long key_value_db_time_ms ( void );
+unsigned long long key_value_db_monotonic_ms ( void );
+void key_value_db_detach ( key_value_db *p_key_value_db, const char **pp_buffer, const char **pp_text, size_t *p_length );
+size_t key_value_db_escape ( char *p_buffer, const char *p_key );
+void key_value_db_prefetch ( key_value_db *p_key_value_db, const char *p_request, size_t len );
+void key_value_db_storage_close ( key_value_db *p_key_value_db );
+bool key_value_db_path ( char *p_path, const char *p_directory, const char *p_name );
+void key_value_db_release ( key_value_db *p_key_value_db );
+
+// the response to a get that finds nothing
+static const char _key_value_db_miss[] = "{\"okay\":false}";
+
 void *key_value_db_shutdown ( void *p_kvdb )
 {
     
     // initialized data
-    key_value_db *p_key_value_db = p_kvdb;
+    key_value_db    *p_key_value_db = p_kvdb;
+    struct timespec  _tick          = { .tv_sec = 0, .tv_nsec = KEY_VALUE_DB_TICK_MS * 1000000 };
+    bool             idle           = false;
+
+    // wait for a stop request, or for the server to go idle
+    while ( false == idle )
+    {
+
+        // wait for the next tick
+        nanosleep(&_tick, NULL);
+
+        // lock
+        mutex_lock(&p_key_value_db->_lock);
+
+        // stop requested, or idle?
+        idle = p_key_value_db->stopping ||
+               ( false == p_key_value_db->embedded && KEY_VALUE_DB_IDLE_SHUTDOWN && key_value_db_time_ms() - p_key_value_db->last_request >= KEY_VALUE_DB_IDLE_SHUTDOWN * 1000ULL );
+
+        // refuse requests from here on, so nothing is written after the snapshot
+        if ( idle ) p_key_value_db->stopping = 1;
+
+        // unlock
+        mutex_unlock(&p_key_value_db->_lock);
+    }
+
+    // logs
+    log_info("[key value db] Shutting down\n");
+
+    // lock
+    mutex_lock(&p_key_value_db->_lock);
+
+    // write the snapshot, or flush the memtable to the tables
+    if ( p_key_value_db->storage.p_lsm ) key_value_db_flush(p_key_value_db, NULL);
+    else                                 key_value_db_snapshot_write(p_key_value_db, p_key_value_db->paths._snapshot, NULL);
+
+    // write the hot set
+    key_value_db_hot_set_write(p_key_value_db, p_key_value_db->paths._hot_set, NULL);
+
+    // stop compacting, and close the tables once no prefetch reads them
+    key_value_db_storage_close(p_key_value_db);
+
+    // remove the unix domain socket
+    #ifndef _WIN64
+        if ( false == p_key_value_db->embedded ) unlink(KEY_VALUE_DB_UNIX_SOCKET);
+    #endif
 
+    // clear the running flag
+    p_key_value_db->running = false;
+
+    // unlock
+    mutex_unlock(&p_key_value_db->_lock);
 
     // success
     return (void *)1;
 }
 
-void *key_value_property_key_accessor ( key_value_property *p_property )
+unsigned long long key_value_db_time_ms ( void )
 {
 
-    // argument check
-    if ( NULL == p_property ) return NULL;
+    // initialized data
+    struct timespec _now = { 0 };
+
+    // wall clock time, so expiry times are meaningful across restarts
+    clock_gettime(CLOCK_REALTIME, &_now);
 
     // done
-    return p_property->_name;
+    return (unsigned long long) _now.tv_sec * 1000 + (unsigned long long) _now.tv_nsec / 1000000;
 }
 
-int key_value_property_comparator ( key_value_property *p_a, key_value_property *p_b )
+unsigned long long key_value_db_monotonic_ms ( void )
 {
 
-    // argument check
-    if ( NULL == p_a ) return 1;
-    if ( NULL == p_b ) return -1;
+    // initialized data
+    struct timespec _now = { 0 };
+
+    // monotonic time, so the timing wheel never jumps with the wall clock
+    clock_gettime(CLOCK_MONOTONIC, &_now);
 
     // done
-    return strcmp(p_a->_name, p_b->_name);
+    return (unsigned long long) _now.tv_sec * 1000 + (unsigned long long) _now.tv_nsec / 1000000;
 }
 
-int key_value_property_equality ( key_value_property *p_a, key_value_property *p_b )
+unsigned long long key_value_db_time_us ( void )
 {
 
+    // initialized data
+    struct timespec _now = { 0 };
+
+    // monotonic time, for measuring delays
+    clock_gettime(CLOCK_MONOTONIC, &_now);
+
     // done
-    return ( 0 == key_value_property_comparator(p_a, p_b) );
+    return (unsigned long long) _now.tv_sec * 1000000 + (unsigned long long) _now.tv_nsec / 1000;
 }
 
-int key_value_db_server_accept ( socket_tcp _socket_tcp, socket_ip_address ip_address, socket_port port_number, key_value_db *p_key_value_db )
+unsigned long long key_value_db_ticks ( void )
 {
 
-    // initialized data
-    size_t      len      = 0;
-    char       *p_buffer = 0;
-    json_value *p_value  = 0;
-    char _response_buf[4096] = {0}; 
-    size_t response_len = 0;
-
-    // log the connection
-    log_info("[key value db] Accepted incoming connection from %hhu.%hhu.%hhu.%hhu:%hu\n", 
-            (ip_address >> 24) & 0xFF, 
-            (ip_address >> 16) & 0xFF, 
-            (ip_address >>  8) & 0xFF, 
-            (ip_address >>  0) & 0xFF, 
-            
-            port_number
-    );
+    // the time stamp counter, which is read without a system call
+    #if ( defined(__x86_64__) || defined(__i386__) ) && defined(__GNUC__)
+        return __rdtsc();
 
-    while (1)
+    // nanoseconds
+    #else
     {
 
-        // parse the request
-        {
-
-            // get the length of the request
-            if ( 0 == socket_tcp_receive(_socket_tcp, &len, sizeof(size_t)) ) goto disconnected;
-
-            // error check
-            if ( 4096 < len ) goto too_long;
+        // initialized data
+        struct timespec _now = { 0 };
 
-            // allocate a buffer for the rest of the message
-            p_buffer = default_allocator(0, len);
-            if ( NULL == p_buffer ) goto no_mem;
+        // monotonic time
+        clock_gettime(CLOCK_MONOTONIC, &_now);
 
-            memset(p_buffer, 0, len);
+        // done
+        return (unsigned long long) _now.tv_sec * 1000000000 + (unsigned long long) _now.tv_nsec;
+    }
+    #endif
+}
 
-            // receive the rest of the message
-            if ( 0 == socket_tcp_receive(_socket_tcp, p_buffer, len) ) goto disconnected;
-        }
+double key_value_db_ticks_per_us ( void )
+{
 
-        // process the request
-        {
-            
-            // exit?
-            if ( 0 == strcmp(p_buffer, "exit") ) goto clean_disconnect;
+    // initialized data
+    struct timespec    _wait = { .tv_sec = 0, .tv_nsec = 10000000 };
+    unsigned long long ticks = key_value_db_ticks(),
+                       us    = key_value_db_time_us();
 
-            // process
-            key_value_db_process(
-                p_key_value_db, 
-                p_buffer, len, 
-                _response_buf + sizeof(size_t), &response_len
-            );
-        }
+    // count the ticks over a short wait
+    nanosleep(&_wait, NULL);
+    ticks = key_value_db_ticks() - ticks,
+    us    = key_value_db_time_us() - us;
 
-        // serialize the response
-        {
+    // done
+    return ( us && ticks ) ? (double) ticks / (double) us : 1000.0;
+}
 
-            // set the length
-            *(size_t *)_response_buf = response_len;
-            
-            // send the result
-            socket_tcp_send(_socket_tcp, _response_buf, sizeof(size_t) + response_len);
-        }
+void key_value_db_slowlog_mark ( unsigned long long *p_mark )
+{
 
-        memset(_response_buf, 0, sizeof(_response_buf));
-        p_buffer = default_allocator(p_buffer, 0);
-    }
+    // only the first mark of a stage counts
+    if ( 0 == *p_mark ) *p_mark = key_value_db_ticks();
 
-    clean_disconnect:
+    // done
+    return;
+}
 
-    // close the socket
-    {
-        // initialized data
-        char _buf[4096] = {0}; 
+unsigned long long key_value_db_elapsed_ns ( key_value_db *p_key_value_db, unsigned long long since )
+{
 
-        // set the length
-        *(size_t *)_buf = 4;
-        strncpy(_buf + sizeof(size_t), "exit", 4);
-        len = 4;
+    // convert the ticks since the mark
+    return (unsigned long long) ( (double) ( key_value_db_ticks() - since ) * 1000.0 / p_key_value_db->slowlog.ticks_per_us );
+}
 
-        // send the result
-        socket_tcp_send(_socket_tcp, _buf, sizeof(size_t) + len);
+void key_value_db_slowlog_record
+(
+    key_value_db         *p_key_value_db,
+    key_value_connection *p_connection,
+    const char           *p_command,
+    size_t                command_bound,
+    const char           *p_key,
+    size_t                key_bound,
+    unsigned long long    _marks[KEY_VALUE_DB_STAGE_QUANTITY + 1]
+)
+{
 
-        // close the socket
-        socket_tcp_destroy(&_socket_tcp);
+    // initialized data
+    key_value_db_slow_request *p_request = NULL;
+    double                     per_us    = 0;
+
+    // lock
+    mutex_lock(&p_key_value_db->_lock);
+
+    // take the oldest slot
+    per_us    = p_key_value_db->slowlog.ticks_per_us,
+    p_request = &p_key_value_db->slowlog._requests[p_key_value_db->slowlog.next];
+    p_key_value_db->slowlog.next = ( p_key_value_db->slowlog.next + 1 ) % KEY_VALUE_DB_SLOWLOG_MAX;
+    if ( p_key_value_db->slowlog.count < KEY_VALUE_DB_SLOWLOG_MAX ) p_key_value_db->slowlog.count++;
+
+    // record the request
+    memset(p_request, 0, sizeof(key_value_db_slow_request));
+    p_request->id          = ++p_key_value_db->slowlog.id,
+    p_request->time        = key_value_db_time_ms(),
+    p_request->total       = (unsigned long long) ( (double) ( _marks[KEY_VALUE_DB_STAGE_QUANTITY] - _marks[0] ) / per_us ),
+    p_request->ip_address  = p_connection->ip_address,
+    p_request->port_number = p_connection->port_number;
+
+    // each stage lasts until the next stage that was marked
+    for (size_t i = 0, j = 1; i < KEY_VALUE_DB_STAGE_QUANTITY; i = j++)
+    {
+        while ( j < KEY_VALUE_DB_STAGE_QUANTITY && 0 == _marks[j] ) j++;
+        if ( _marks[i] ) p_request->_stages[i] = (unsigned long long) ( (double) ( _marks[j] - _marks[i] ) / per_us );
     }
 
-    disconnected:
-    // log the disconnect
-    log_info("[key value db] Connection closed from %hhu.%hhu.%hhu.%hhu:%hu\n", 
-            (ip_address >> 24) & 0xFF, 
-            (ip_address >> 16) & 0xFF, 
-            (ip_address >>  8) & 0xFF, 
-            (ip_address >>  0) & 0xFF, 
-            
-            port_number
-    );
-
-    // success
-    return 1;
+    // copy the command, and the first operand, up to the first character that is blank, or needs escaping
+    while ( p_key && key_bound && isblank((unsigned char) *p_key) ) p_key++, key_bound--;
+    for (size_t i = 0; p_command && i < command_bound && i < sizeof(p_request->_command) - 1 && isgraph((unsigned char) p_command[i]) && '"' != p_command[i] && '\\' != p_command[i]; i++) p_request->_command[i] = p_command[i];
+    for (size_t i = 0; p_key && i < key_bound && i < sizeof(p_request->_key) - 1 && isgraph((unsigned char) p_key[i]) && '"' != p_key[i] && '\\' != p_key[i]; i++) p_request->_key[i] = p_key[i];
 
-    // error handling
-    {
+    // unlock
+    mutex_unlock(&p_key_value_db->_lock);
 
-        // socket errors
-        {
-            too_long:
-            no_mem:
-            parse_error:
-                return 0;
-        }
-    }
+    // done
+    return;
 }
 
-int key_value_db_listener ( key_value_db *p_key_value_db )
+bool key_value_property_expired ( key_value_property *p_property, unsigned long long now )
 {
 
-    // log a message
-    log_info("[key value db] Listening for incoming connections...\n");
-
-    // listen for incoming connections
-    while ( p_key_value_db->running )
-        socket_tcp_listen(p_key_value_db->network._socket, (fn_socket_tcp_accept *)key_value_db_server_accept, p_key_value_db);
-
-    // success
-    return 1;
+    // done
+    return ( p_property->expires && p_property->expires <= now );
 }
 
-int key_value_db_construct ( key_value_db **pp_key_value_db )
+int key_value_db_expire_at ( key_value_db *p_key_value_db, key_value_property *p_property, unsigned long long expires )
 {
 
-    // argument check
-    if ( NULL == pp_key_value_db ) goto no_key_value_db;
+    // store the expiry time
+    p_property->expires = expires;
 
-    // initialized data
-    key_value_db *p_key_value_db = default_allocator(0, sizeof(key_value_db));
+    // persistent property
+    if ( 0 == expires ) return timing_wheel_remove(p_key_value_db->p_timing_wheel, &p_property->_expiry);
 
-    // error check
-    if ( NULL == p_key_value_db ) goto no_mem;
+    // initialized data
+    unsigned long long now   = key_value_db_time_ms(),
+                       delay = ( expires > now ) ? expires - now : 0;
 
-    // construct networking stuff
-    {
-        
-        // construct a thread pool
-        thread_pool_construct(&p_key_value_db->network.p_thread_pool, 4);
+    // arm the timer on the first tick at, or after, the expiry time. the wheel
+    // turns with the monotonic clock, so the time left is carried over to it
+    p_property->_expiry.p_data = p_property;
 
-        // construct a socket
-        socket_tcp_create(&p_key_value_db->network._socket, socket_address_family_ipv4, 6713);
+    // done
+    return timing_wheel_add(p_key_value_db->p_timing_wheel, &p_property->_expiry, ( key_value_db_monotonic_ms() + delay + KEY_VALUE_DB_TICK_MS - 1 ) / KEY_VALUE_DB_TICK_MS);
+}
 
-        // construct a listener thread
-        parallel_thread_start(&p_key_value_db->network.p_listener_thread, (fn_parallel_task *)key_value_db_listener, p_key_value_db);
-    }
+bool key_value_connection_watching ( key_value_connection *p_connection, const char *p_key )
+{
 
-    // construct database stuff
-    {
+    // search the prefixes
+    for (size_t i = 0; i < p_connection->watch.count; i++)
+        if ( 0 == strncmp(p_key, p_connection->watch._prefixes[i], strlen(p_connection->watch._prefixes[i])) ) return true;
 
-        // construct an LRU cache
-        cache_construct
-        (
-            &p_key_value_db->p_cache, 
-            1024,
-            (fn_equality *) key_value_property_equality,
-            (fn_key_accessor *) key_value_property_key_accessor
-        );
+    // done
+    return false;
+}
 
-        // construct a binary tree
-        binary_tree_construct
-        (
-            &p_key_value_db->p_binary_tree, 
-            (fn_comparator *) key_value_property_comparator, 
-            (fn_key_accessor *) key_value_property_key_accessor,
-            512
-        );
-    }
+#ifndef _WIN64
+void key_value_connection_push_send ( key_value_connection *p_connection, const char *p_frames, size_t length )
+{
 
-    // TODO: construct a shutdown thread
-    // parallel_thread_start(&p_key_value_db->p_shutdown, key_value_db_shutdown, p_key_value_db);
+    // initialized data
+    ssize_t sent = 0;
 
-    // set the running flag
-    p_key_value_db->running = true;
+    // never wait on a watcher
+    if ( p_connection->shm.p_responses )
+        sent = ( ring_try_write(p_connection->shm.p_responses, p_frames, length) ) ? (ssize_t) length : -1;
+    else
+        do sent = send(p_connection->_socket, p_frames, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+        while ( sent < 0 && EINTR == errno );
 
-    // return a pointer to the caller
-    *pp_key_value_db = p_key_value_db;
+    // a watcher that can not keep up is disconnected, so its client drops
+    // its cache, instead of silently missing an invalidation
+    if ( (size_t) sent != length ) goto fell_behind;
 
-    // success
-    return 1;
+    // done
+    return;
 
     // error handling
     {
 
-        // argument errors
+        // key value db errors
         {
-            no_key_value_db:
-                #ifndef NDEBUG
-                    log_error("[key value db] Null pointer provided for parameter \"pp_key_value_db\" in call to function \"%s\"", __FUNCTION__);
-                #endif
+            fell_behind:
+
+                // logs
+                log_error("[key value db] Disconnecting a watcher that fell behind\n");
+
+                // close the connection
+                shutdown(p_connection->_socket, SHUT_RDWR);
+                ring_close(p_connection->shm.p_responses);
+                p_connection->closed = true;
+
+                // error
+                return;
+        }
+    }
+}
+#endif
+
+void key_value_connection_drain ( key_value_connection *p_connection )
+{
+
+    #ifndef _WIN64
+
+        // send the pending frames, unless another thread holds the send lock.
+        // that thread drains them when it lets go
+        for (;;)
+        {
+
+            // initialized data
+            bool pending = false;
+
+            // anything to send?
+            mutex_lock(&p_connection->pending._lock);
+            pending = ( 0 != p_connection->pending.length );
+            mutex_unlock(&p_connection->pending._lock);
+            if ( false == pending ) break;
+
+            // someone else is sending
+            if ( 0 != pthread_mutex_trylock(&p_connection->_send_lock) ) break;
+
+            // send the pending frames. the send does not wait, so holding the pending lock is fine
+            mutex_lock(&p_connection->pending._lock);
+            if ( p_connection->pending.length && false == p_connection->closed )
+                key_value_connection_push_send(p_connection, p_connection->pending._frames, p_connection->pending.length);
+            p_connection->pending.length = 0;
+            mutex_unlock(&p_connection->pending._lock);
+
+            // unlock
+            mutex_unlock(&p_connection->_send_lock);
+        }
+    #else
+        (void) p_connection;
+    #endif
+
+    // done
+    return;
+}
+
+void key_value_connection_push ( key_value_connection *p_connection, char *p_frame, size_t length )
+{
+
+    // set the length
+    *(size_t *)p_frame = length;
+
+    #ifdef _WIN64
+
+        // lock
+        mutex_lock(&p_connection->_send_lock);
+
+        // send the frame
+        if ( 0 == socket_tcp_send(p_connection->_socket, p_frame, sizeof(size_t) + length) ) p_connection->closed = true;
+
+        // unlock
+        mutex_unlock(&p_connection->_send_lock);
+    #else
+
+        // queue the frame. a watcher that has let too many frames pile up is disconnected
+        mutex_lock(&p_connection->pending._lock);
+        if ( p_connection->pending.length + sizeof(size_t) + length > sizeof(p_connection->pending._frames) )
+            log_error("[key value db] Disconnecting a watcher that fell behind\n"),
+            shutdown(p_connection->_socket, SHUT_RDWR),
+            ring_close(p_connection->shm.p_responses),
+            p_connection->closed = true;
+        else
+            memcpy(&p_connection->pending._frames[p_connection->pending.length], p_frame, sizeof(size_t) + length),
+            p_connection->pending.length += sizeof(size_t) + length;
+        mutex_unlock(&p_connection->pending._lock);
+
+        // send it now, if no response is being sent
+        key_value_connection_drain(p_connection);
+    #endif
+
+    // done
+    return;
+}
+
+void key_value_db_notify ( key_value_db *p_key_value_db, const char *p_key, const key_value_property *p_property )
+{
+
+    // initialized data
+    char   _frame[sizeof(size_t) + 6 * B_PLUS_TREE_KEY_MAX + KEY_VALUE_DB_WATCH_VALUE + 64];
+    char  *p_frame = _frame + sizeof(size_t);
+    size_t length  = 0;
+
+    // push a frame to each connection watching the key
+    for (key_value_connection *p_connection = p_key_value_db->network.p_connections; p_connection; p_connection = p_connection->p_next)
+    {
+
+        // skip closed connections, and connections that are not watching the key
+        if ( p_connection->closed || false == key_value_connection_watching(p_connection, p_key) ) continue;
+
+        // serialize the frame once
+        if ( 0 == length )
+        {
+
+            // initialized data
+            size_t      value_length = 0;
+            const char *p_text       = ( p_property ) ? key_value_value_text(&p_property->_value, &value_length) : NULL;
+
+            // the escaped key
+            memcpy(p_frame, "{\"watch\":\"", 10);
+            length  = 10 + key_value_db_escape(p_frame + 10, p_key);
+            p_frame[length++] = '"';
+
+            // the key was removed
+            if ( NULL == p_property )
+                p_frame[length++] = '}';
+
+            // the key changed, and the new value is small enough to push
+            else if ( value_length <= KEY_VALUE_DB_WATCH_VALUE )
+                length += (size_t) sprintf(p_frame + length, ",\"version\":%llu,\"value\":", p_property->version),
+                memcpy(&p_frame[length], p_text, value_length),
+                length += value_length,
+                p_frame[length++] = '}';
+
+            // the key changed
+            else
+                length += (size_t) sprintf(p_frame + length, ",\"version\":%llu}", p_property->version);
+        }
+
+        // push the frame
+        key_value_connection_push(p_connection, _frame, length);
+    }
+
+    // done
+    return;
+}
+
+int key_value_db_keyspace_add ( key_value_db *p_key_value_db, key_value_property *p_property )
+{
+
+    // grow the keyspace
+    if ( p_key_value_db->keyspace.count == p_key_value_db->keyspace.capacity )
+    {
+
+        // initialized data
+        size_t               capacity       = p_key_value_db->keyspace.capacity ? p_key_value_db->keyspace.capacity * 2 : 1024;
+        key_value_property **pp_properties  = key_value_memory_allocator(KEY_VALUE_MEMORY_KEYSPACE, p_key_value_db->keyspace.pp_properties, capacity * sizeof(key_value_property *));
+
+        // error check
+        if ( NULL == pp_properties ) return 0;
+
+        // store the keyspace
+        p_key_value_db->keyspace.pp_properties = pp_properties,
+        p_key_value_db->keyspace.capacity      = capacity;
+    }
+
+    // append the property
+    p_property->index = p_key_value_db->keyspace.count;
+    p_key_value_db->keyspace.pp_properties[p_key_value_db->keyspace.count++] = p_property;
+
+    // account for the property
+    p_key_value_db->memory.used += p_property->size;
+
+    // success
+    return 1;
+}
+
+void key_value_db_keyspace_remove ( key_value_db *p_key_value_db, key_value_property *p_property )
+{
+
+    // initialized data
+    key_value_property *p_last = p_key_value_db->keyspace.pp_properties[--p_key_value_db->keyspace.count];
+
+    // swap the last property into the hole
+    p_key_value_db->keyspace.pp_properties[p_property->index] = p_last,
+    p_last->index = p_property->index;
+
+    // account for the property
+    p_key_value_db->memory.used -= p_property->size;
+
+    // done
+    return;
+}
+
+int key_value_db_remove ( key_value_db *p_key_value_db, key_value_property *p_property )
+{
+
+    // remove the property from the keyspace
+    key_value_db_keyspace_remove(p_key_value_db, p_property);
+
+    // remove the property from the cache
+    front_cache_remove(p_key_value_db->p_front_cache, p_property->_name);
+
+    // remove the property from the index
+    b_plus_tree_remove(p_key_value_db->p_index, p_property->_name, NULL);
+
+    // trace the removal. the time is since the lookup started, if a request is running one
+    if ( KEY_VALUE_DB_PROBE_ENABLED(index__remove) )
+        KEY_VALUE_DB_PROBE3(index__remove, p_property->_name, p_property->size, ( p_key_value_db->slowlog.lookup ) ? key_value_db_elapsed_ns(p_key_value_db, p_key_value_db->slowlog.lookup) : 0);
+
+    // disarm the expiry timer
+    timing_wheel_remove(p_key_value_db->p_timing_wheel, &p_property->_expiry);
+
+    // release the property
+    key_value_value_free(&p_property->_value);
+    p_property = key_value_memory_allocator(KEY_VALUE_MEMORY_PROPERTIES, p_property, 0);
+
+    // success
+    return 1;
+}
+
+void key_value_db_preserve ( key_value_db *p_key_value_db, const char *p_key, key_value_property *p_property )
+{
+
+    // initialized data
+    key_value_value    _value     = { 0 };
+    unsigned long long superseded = ( p_key_value_db->batching ) ? p_key_value_db->sequence : p_key_value_db->sequence + 1,
+                       expires    = 0,
+                       version    = 0;
+
+    // no snapshot reads the old version
+    if ( false == mvcc_pinned(p_key_value_db->p_mvcc) ) return;
+
+    // in memory
+    if ( p_property )
+    {
+        mvcc_save(p_key_value_db->p_mvcc, p_key, superseded, &p_property->_value, p_property->version, p_property->expires);
+
+        // done
+        return;
+    }
+
+    // only in the tables, or not a key
+    if ( p_key_value_db->storage.p_lsm && lsm_get(p_key_value_db->storage.p_lsm, p_key, &_value, &expires, &version) )
+        mvcc_save(p_key_value_db->p_mvcc, p_key, superseded, &_value, version, expires),
+        key_value_value_free(&_value);
+    else
+        mvcc_save(p_key_value_db->p_mvcc, p_key, superseded, NULL, 0, 0);
+
+    // done
+    return;
+}
+
+int key_value_db_delete ( key_value_db *p_key_value_db, key_value_property *p_property )
+{
+
+    // the snapshots keep the key
+    key_value_db_preserve(p_key_value_db, p_property->_name, p_property);
+
+    // tell the watchers
+    key_value_db_notify(p_key_value_db, p_property->_name, NULL);
+
+    // hide the older records in the tables
+    if ( p_key_value_db->storage.p_lsm )
+        lsm_delete(p_key_value_db->storage.p_lsm, p_property->_name),
+        p_key_value_db->storage.dirty += LSM_KEY_MAX;
+
+    // the key is gone
+    if ( p_key_value_db->p_filter ) cuckoo_filter_remove(p_key_value_db->p_filter, p_property->_name, strlen(p_property->_name));
+    for (size_t i = 0; i < p_key_value_db->indexes.count; i++) secondary_index_remove(p_key_value_db->indexes._indexes[i], p_property->_name);
+
+    // done
+    return key_value_db_remove(p_key_value_db, p_property);
+}
+
+int key_value_db_filter_key ( const char *p_key, size_t length, void *p_filter )
+{
+
+    // add the key
+    return cuckoo_filter_add(p_filter, p_key, length);
+}
+
+int key_value_db_filter_build ( key_value_db *p_key_value_db, size_t capacity )
+{
+
+    // initialized data
+    cuckoo_filter *p_filter = NULL;
+    bool           built    = true;
+
+    // construct a filter. it grows as keys are added
+    if ( 0 == cuckoo_filter_construct(&p_filter, capacity) ) return 0;
+
+    // the keys in memory
+    for (size_t i = 0; i < p_key_value_db->keyspace.count && built; i++)
+        built = ( 1 == cuckoo_filter_add(p_filter, p_key_value_db->keyspace.pp_properties[i]->_name, strlen(p_key_value_db->keyspace.pp_properties[i]->_name)) );
+
+    // the keys in the tables, once each. a table that can not be read leaves the server without a filter
+    if ( built && p_key_value_db->storage.p_lsm ) built = ( 1 == lsm_keys(p_key_value_db->storage.p_lsm, key_value_db_filter_key, p_filter) );
+    if ( false == built ) cuckoo_filter_destroy(&p_filter);
+
+    // replace the filter. without one, every get searches the index
+    cuckoo_filter_destroy(&p_key_value_db->p_filter);
+    p_key_value_db->p_filter = p_filter;
+
+    // done
+    return built;
+}
+
+void key_value_db_filter_add ( key_value_db *p_key_value_db, const char *p_key )
+{
+
+    // the filter grows in place. without memory to grow, drop it, since a filter
+    // that misses a key would answer gets for it wrongly
+    if ( p_key_value_db->p_filter && 0 == cuckoo_filter_add(p_key_value_db->p_filter, p_key, strlen(p_key)) )
+        cuckoo_filter_destroy(&p_key_value_db->p_filter);
+
+    // done
+    return;
+}
+
+void key_value_db_index_update ( key_value_db *p_key_value_db, key_value_property *p_property )
+{
+
+    // initialized data
+    size_t      length = 0;
+    const char *p_text = NULL;
+
+    // no indexes
+    if ( 0 == p_key_value_db->indexes.count ) return;
+
+    // the serialized value
+    p_text = key_value_value_text(&p_property->_value, &length);
+
+    // each index whose pattern matches the key
+    for (size_t i = 0; i < p_key_value_db->indexes.count; i++)
+        secondary_index_update(p_key_value_db->indexes._indexes[i], p_property->_name, p_text, length);
+
+    // done
+    return;
+}
+
+int key_value_db_index_key ( const char *p_key, size_t length, void *p_parameter )
+{
+
+    // initialized data
+    key_value_db_index_keys *p_keys             = p_parameter;
+    char                    *p_data             = NULL,
+                             _key[LSM_KEY_MAX]  = { 0 };
+
+    // keys in the tables are not terminated
+    if ( length >= LSM_KEY_MAX ) return 1;
+    memcpy(_key, p_key, length);
+
+    // not indexed by this index
+    if ( false == secondary_index_match(p_keys->p_index, _key) ) return 1;
+
+    // grow the list
+    if ( p_keys->count == p_keys->capacity )
+    {
+        p_data = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_keys->p_keys, ( p_keys->capacity ? 2 * p_keys->capacity : 64 ) * LSM_KEY_MAX);
+        if ( NULL == p_data ) return 0;
+        p_keys->p_keys    = p_data,
+        p_keys->capacity  = ( p_keys->capacity ) ? 2 * p_keys->capacity : 64;
+    }
+
+    // copy the key
+    memcpy(&p_keys->p_keys[p_keys->count * LSM_KEY_MAX], p_key, length);
+    p_keys->p_keys[p_keys->count++ * LSM_KEY_MAX + length] = '\0';
+
+    // done
+    return 1;
+}
+
+int key_value_db_index_backfill ( key_value_db *p_key_value_db, secondary_index *p_index )
+{
+
+    // initialized data
+    key_value_db_index_keys  _keys       = { .p_index = p_index };
+    key_value_property      *p_property  = NULL;
+    key_value_value          _value      = { 0 };
+    unsigned long long       expires     = 0,
+                             version     = 0,
+                             now         = key_value_db_time_ms();
+    size_t                   length      = 0;
+    const char              *p_text      = NULL;
+    int                      result      = 1;
+
+    // the keys in memory
+    for (size_t i = 0; i < p_key_value_db->keyspace.count; i++)
+    {
+        p_property = p_key_value_db->keyspace.pp_properties[i];
+        if ( key_value_property_expired(p_property, now) ) continue;
+        p_text     = key_value_value_text(&p_property->_value, &length);
+        secondary_index_update(p_index, p_property->_name, p_text, length);
+    }
+
+    // memory only
+    if ( NULL == p_key_value_db->storage.p_lsm ) return 1;
+
+    // the matching keys in the tables. the tables are read after the list is
+    // made, because they are locked while it is
+    result = lsm_keys(p_key_value_db->storage.p_lsm, key_value_db_index_key, &_keys);
+
+    // the keys that are only in the tables
+    for (size_t i = 0; i < _keys.count; i++)
+    {
+
+        // initialized data
+        const char *p_key = &_keys.p_keys[i * LSM_KEY_MAX];
+
+        // already indexed from memory
+        if ( b_plus_tree_search(p_key_value_db->p_index, p_key, (void **)&p_property) ) continue;
+
+        // read the newest record. deleted, and expired, keys are skipped
+        if ( 0 == lsm_get(p_key_value_db->storage.p_lsm, p_key, &_value, &expires, &version) ) continue;
+        if ( 0 == expires || expires > now )
+            p_text = key_value_value_text(&_value, &length),
+            secondary_index_update(p_index, p_key, p_text, length);
+        key_value_value_free(&_value);
+    }
+
+    // release the list
+    _keys.p_keys = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, _keys.p_keys, 0);
+
+    // done
+    return result;
+}
+
+void key_value_db_pack ( key_value_db *p_key_value_db, key_value_value *p_value )
+{
+
+    // pack the value, while compression is on
+    if ( p_key_value_db->compression.p_dictionary ) key_value_value_pack(p_value, p_key_value_db->compression.p_dictionary);
+
+    // done
+    return;
+}
+
+int key_value_db_compression_train ( key_value_db *p_key_value_db )
+{
+
+    // initialized data
+    dictionary   *p_dictionary = NULL;
+    const char  **pp_samples   = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, 0, KEY_VALUE_DB_DICTIONARY_SAMPLES * sizeof(const char *));
+    size_t       *p_lengths    = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, 0, KEY_VALUE_DB_DICTIONARY_SAMPLES * sizeof(size_t));
+    char         *p_samples    = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, 0, KEY_VALUE_DB_DICTIONARY_SAMPLES * KEY_VALUE_VALUE_PACK_MAX);
+    size_t        count        = 0,
+                  used         = 0,
+                  stride       = p_key_value_db->keyspace.count / KEY_VALUE_DB_DICTIONARY_SAMPLES + 1;
+
+    // error check
+    if ( NULL == pp_samples || NULL == p_lengths || NULL == p_samples ) goto no_mem;
+
+    // sample the values that could be packed, evenly across the keyspace. a
+    // packed value is decompressed into its own sample
+    for (size_t i = 0; i < p_key_value_db->keyspace.count && count < KEY_VALUE_DB_DICTIONARY_SAMPLES; i += stride)
+    {
+
+        // initialized data
+        key_value_value *p_value = &p_key_value_db->keyspace.pp_properties[i]->_value;
+        size_t           length  = key_value_value_length(p_value);
+
+        // inline, and long, values are never packed
+        if ( length <= KEY_VALUE_VALUE_INLINE || length > KEY_VALUE_VALUE_PACK_MAX ) continue;
+
+        // copy the sample
+        pp_samples[count] = &p_samples[used],
+        p_lengths[count]  = key_value_value_serialize(p_value, &p_samples[used]);
+        used += p_lengths[count++];
+    }
+
+    // train the dictionary
+    if ( 0 == dictionary_train(&p_dictionary, pp_samples, p_lengths, count, KEY_VALUE_DB_DICTIONARY) ) goto failed_to_train;
+
+    // release the samples
+    p_samples  = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_samples, 0);
+    p_lengths  = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_lengths, 0);
+    pp_samples = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, pp_samples, 0);
+
+    // replace the dictionary. values packed with the old one keep it
+    dictionary_destroy(&p_key_value_db->compression.p_dictionary);
+    p_key_value_db->compression.p_dictionary = p_dictionary;
+
+    // pack every value in memory with the new dictionary
+    for (size_t i = 0; i < p_key_value_db->keyspace.count; i++)
+    {
+
+        // initialized data
+        key_value_property *p_property = p_key_value_db->keyspace.pp_properties[i];
+
+        // pack the value, and account for its new size
+        key_value_db_pack(p_key_value_db, &p_property->_value);
+        p_key_value_db->memory.used -= p_property->size;
+        p_property->size             = sizeof(key_value_property) + key_value_value_heap_size(&p_property->_value);
+        p_key_value_db->memory.used += p_property->size;
+    }
+
+    // logs
+    log_info("[key value db] Trained a %zu byte dictionary from %zu values\n", dictionary_length(p_dictionary), count);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // key value db errors
+        {
+            failed_to_train:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to train a dictionary in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // release the samples
+                goto no_mem;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // release the samples
+                p_samples  = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_samples, 0);
+                p_lengths  = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_lengths, 0);
+                pp_samples = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, pp_samples, 0);
 
                 // error
                 return 0;
         }
+    }
+}
+
+void key_value_db_dirty ( key_value_db *p_key_value_db, key_value_property *p_property )
+{
+
+    // every write passes through here
+    hot_keys_record(p_key_value_db->hot_keys.p_writes, p_property->_name);
+    key_value_db_index_update(p_key_value_db, p_property);
+
+    // the tables no longer hold this property
+    p_property->durable = false;
+
+    // count towards the next flush
+    if ( p_key_value_db->storage.p_lsm ) p_key_value_db->storage.dirty += p_property->size;
+
+    // done
+    return;
+}
+
+int key_value_db_flush ( key_value_db *p_key_value_db, size_t *p_keys )
+{
+
+    // initialized data
+    lsm_entry          *p_entries  = NULL;
+    char               *p_unpacked = NULL;
+    size_t              count      = 0,
+                        unpacked   = 0;
+    unsigned long long  now        = key_value_db_time_ms();
+
+    // memory only
+    if ( NULL == p_key_value_db->storage.p_lsm ) return 1;
+
+    // room for every property
+    if ( p_key_value_db->keyspace.count )
+    {
+        p_entries = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, 0, p_key_value_db->keyspace.count * sizeof(lsm_entry));
+        if ( NULL == p_entries ) goto no_mem;
+    }
+
+    // every value is borrowed at once, so packed values are decompressed into their own space
+    for (size_t i = 0; i < p_key_value_db->keyspace.count; i++)
+    {
+
+        // initialized data
+        key_value_property *p_property = p_key_value_db->keyspace.pp_properties[i];
+
+        // count the bytes of dirty, packed, properties
+        if ( p_property->durable || key_value_property_expired(p_property, now) ) continue;
+        if ( key_value_value_packed(&p_property->_value) ) unpacked += key_value_value_length(&p_property->_value);
+    }
+
+    // room for the packed values
+    if ( unpacked )
+    {
+        p_unpacked = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, 0, unpacked);
+        if ( NULL == p_unpacked ) goto no_unpacked;
+        unpacked = 0;
+    }
+
+    // gather the dirty properties. expired properties are about to be deleted
+    for (size_t i = 0; i < p_key_value_db->keyspace.count; i++)
+    {
+
+        // initialized data
+        key_value_property *p_property = p_key_value_db->keyspace.pp_properties[i];
+
+        // skip clean, and expired, properties
+        if ( p_property->durable || key_value_property_expired(p_property, now) ) continue;
+
+        // borrow the key
+        p_entries[count].p_key   = p_property->_name,
+        p_entries[count].expires = p_property->expires,
+        p_entries[count].version = p_property->version,
+        p_entries[count].type    = p_property->_value.type;
+
+        // decompress a packed value
+        if ( key_value_value_packed(&p_property->_value) )
+            p_entries[count].p_value = &p_unpacked[unpacked],
+            p_entries[count].length  = key_value_value_serialize(&p_property->_value, &p_unpacked[unpacked]),
+            unpacked                += p_entries[count].length;
+
+        // borrow the value
+        else
+            p_entries[count].p_value = key_value_value_text(&p_property->_value, &p_entries[count].length);
+        count++;
+    }
+
+    // write a level 0 table, with the pending deletes
+    if ( 0 == lsm_flush(p_key_value_db->storage.p_lsm, p_entries, count, p_key_value_db->sequence) ) goto failed_to_flush;
+
+    // the tables hold every property that was written
+    for (size_t i = 0; i < p_key_value_db->keyspace.count; i++)
+        if ( false == key_value_property_expired(p_key_value_db->keyspace.pp_properties[i], now) )
+            p_key_value_db->keyspace.pp_properties[i]->durable = true;
+    p_key_value_db->storage.dirty = 0;
+
+    // release the records
+    p_unpacked = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_unpacked, 0);
+    p_entries  = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_entries, 0);
+
+    // return the quantity of keys to the caller
+    if ( p_keys ) *p_keys = count;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // key value db errors
+        {
+            failed_to_flush:
+                log_error("[key value db] Failed to flush the memtable in call to function \"%s\"\n", __FUNCTION__);
+
+                // release the records
+                p_unpacked = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_unpacked, 0);
+                p_entries  = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_entries, 0);
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_unpacked:
+
+                // release the records
+                p_entries = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_entries, 0);
+
+                // fall through
+                goto no_mem;
+
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_evict ( key_value_db *p_key_value_db, key_value_property *p_keep )
+{
+
+    // initialized data
+    unsigned int now = (unsigned int) ( key_value_db_time_ms() / 1000 );
+
+    // flush a full memtable
+    if ( p_key_value_db->storage.p_lsm && p_key_value_db->storage.dirty >= KEY_VALUE_DB_LSM_MEMTABLE ) key_value_db_flush(p_key_value_db, NULL);
+
+    // evict until the keyspace fits, or only the property being written, if any, is left
+    while
+    (
+        p_key_value_db->memory.max                               &&
+        p_key_value_db->memory.used > p_key_value_db->memory.max &&
+        p_key_value_db->keyspace.count > (size_t) ( ( p_keep ) ? 1 : 0 )
+    )
+    {
+
+        // initialized data
+        key_value_property *p_victim = NULL;
+        unsigned long long  best     = 0;
+
+        // sample the keyspace, and keep the best victim
+        for (size_t i = 0; i < EVICTION_SAMPLES; i++)
+        {
+
+            // initialized data
+            key_value_property *p_candidate = p_key_value_db->keyspace.pp_properties[eviction_random(&p_key_value_db->memory.random) % p_key_value_db->keyspace.count];
+            unsigned long long  score       = eviction_meta_score(&p_candidate->_eviction, p_key_value_db->memory.policy, now);
+
+            // skip the property being written
+            if ( p_candidate == p_keep ) continue;
+
+            // with tables behind the keyspace, prefer victims that can leave memory without a flush
+            if ( p_victim && p_key_value_db->storage.p_lsm && p_victim->durable != p_candidate->durable )
+            {
+                if ( p_candidate->durable ) p_victim = p_candidate, best = score;
+                continue;
+            }
+
+            // better victim?
+            if ( NULL == p_victim || score > best ) p_victim = p_candidate, best = score;
+        }
+
+        // every sample was the property being written
+        if ( NULL == p_victim ) continue;
+
+        // logs
+        log_info("[key value db] Evicted key \"%s\"\n", p_victim->_name);
+
+        // with tables behind the keyspace, a victim only leaves memory, once the tables hold it
+        if ( p_key_value_db->storage.p_lsm && false == p_victim->durable && 0 == key_value_db_flush(p_key_value_db, NULL) ) break;
+
+        // trace the eviction, with the seconds since the victim was last read
+        KEY_VALUE_DB_PROBE4(evict, p_victim->_name, p_victim->size, now - p_victim->_eviction.clock, best);
+
+        // increment counters
+        p_key_value_db->counter.evicted.keys++,
+        p_key_value_db->counter.evicted.bytes += p_victim->size;
+
+        // remove the property
+        if ( p_key_value_db->storage.p_lsm ) key_value_db_remove(p_key_value_db, p_victim);
+        else                                 key_value_db_delete(p_key_value_db, p_victim);
+    }
+
+    // success
+    return 1;
+}
+
+int key_value_db_lookup ( key_value_db *p_key_value_db, const char *p_key, key_value_property **pp_property )
+{
+
+    // initialized data
+    key_value_property *p_property = NULL;
+    key_value_value     _value     = { 0 };
+    unsigned long long  expires    = 0,
+                        version    = 0;
+
+    // the lookup starts
+    key_value_db_slowlog_mark(&p_key_value_db->slowlog.lookup);
+
+    // in memory
+    if ( b_plus_tree_search(p_key_value_db->p_index, p_key, (void **)pp_property) ) return 1;
+
+    // memory only, or not in the tables
+    if ( NULL == p_key_value_db->storage.p_lsm ) return 0;
+    if ( 0 == lsm_get(p_key_value_db->storage.p_lsm, p_key, &_value, &expires, &version) ) return 0;
+
+    // expired on disk. compaction drops the record
+    if ( expires && expires <= key_value_db_time_ms() ) goto expired;
+
+    // allocate a property
+    p_property = key_value_memory_allocator(KEY_VALUE_MEMORY_PROPERTIES, 0, sizeof(key_value_property));
+    if ( NULL == p_property ) goto no_mem;
+    memset(p_property, 0, sizeof(key_value_property));
+
+    // copy the key
+    strncpy(p_property->_name, p_key, sizeof(p_property->_name) - 1);
+
+    // take over the value, and pack it. the tables already hold it
+    p_property->_value  = _value;
+    key_value_db_pack(p_key_value_db, &p_property->_value);
+    p_property->size    = sizeof(key_value_property) + key_value_value_heap_size(&p_property->_value),
+    p_property->version = version,
+    p_property->durable = true;
+
+    // add the property to the keyspace
+    eviction_meta_init(&p_property->_eviction, (unsigned int) ( key_value_db_time_ms() / 1000 ));
+    if ( 0 == key_value_db_keyspace_add(p_key_value_db, p_property) ) goto failed_to_store_value;
+
+    // insert the property
+    if ( 0 == b_plus_tree_insert(p_key_value_db->p_index, p_property) ) goto failed_to_index;
+
+    // trace the insertion
+    if ( KEY_VALUE_DB_PROBE_ENABLED(index__insert) )
+        KEY_VALUE_DB_PROBE3(index__insert, p_property->_name, p_property->size, key_value_db_elapsed_ns(p_key_value_db, p_key_value_db->slowlog.lookup));
+
+    // arm the expiry timer
+    if ( expires ) key_value_db_expire_at(p_key_value_db, p_property, expires);
+
+    // return a pointer to the caller. the cron makes room for it, so a read never flushes
+    *pp_property = p_property;
+
+    // success
+    return 1;
+
+    // this branch handles records that expired on disk
+    expired:
+
+        // release the value
+        key_value_value_free(&_value);
+
+        // not found
+        return 0;
+
+    // error handling
+    {
+
+        // standard library errors
+        {
+            failed_to_index:
+
+                // take the property back out of the keyspace
+                key_value_db_keyspace_remove(p_key_value_db, p_property);
+
+                // fall through
+                goto failed_to_store_value;
+
+            failed_to_store_value:
+
+                // release the property
+                p_property = key_value_memory_allocator(KEY_VALUE_MEMORY_PROPERTIES, p_property, 0);
+
+                // fall through
+                goto no_mem;
+
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // release the value
+                key_value_value_free(&_value);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+void key_value_db_prefetch ( key_value_db *p_key_value_db, const char *p_request, size_t len )
+{
+
+    // initialized data
+    lsm    *p_lsm             = NULL;
+    char    _key[LSM_KEY_MAX] = { 0 };
+    size_t  cur               = 0,
+            start             = 0;
+
+    // memory only, or the tables are about to close
+    if ( NULL == __atomic_load_n(&p_key_value_db->storage.p_lsm, __ATOMIC_RELAXED) || p_key_value_db->stopping ) return;
+
+    // skip leading blanks
+    while ( cur < len && isblank(p_request[cur]) ) cur++;
+
+    // find the command
+    start = cur,
+    cur   = tokenizer_token_end(p_request, len, cur);
+
+    // only commands that name a single key read from the tables
+    switch ( tokenizer_verb_parse(&p_request[start], cur - start) )
+    {
+        case TOKENIZER_VERB_GET:
+        case TOKENIZER_VERB_TTL:
+        case TOKENIZER_VERB_VERSION:
+        case TOKENIZER_VERB_EXPIRE:
+        case TOKENIZER_VERB_INCR:
+        case TOKENIZER_VERB_DECR:
+        case TOKENIZER_VERB_INCRBY:
+        case TOKENIZER_VERB_DECRBY:
+        case TOKENIZER_VERB_CAS:
+        case TOKENIZER_VERB_JGET:
+        case TOKENIZER_VERB_JSET:
+        case TOKENIZER_VERB_JAPPEND:
+            break;
+
+        default:
+            return;
+    }
+
+    // skip the blanks before the key
+    while ( cur < len && isblank(p_request[cur]) ) cur++;
+
+    // find the key
+    start = cur,
+    cur   = tokenizer_token_end(p_request, len, cur);
+
+    // no key, or a key the tables can not hold
+    if ( cur == start || cur - start >= sizeof(_key) ) return;
+
+    // copy the key
+    memcpy(_key, &p_request[start], cur - start);
+
+    // pin the tables, so shutdown waits for the prefetch before it closes them
+    __atomic_add_fetch(&p_key_value_db->storage.prefetches, 1, __ATOMIC_SEQ_CST);
+    p_lsm = __atomic_load_n(&p_key_value_db->storage.p_lsm, __ATOMIC_SEQ_CST);
+
+    // read the blocks that hold it into the block cache, so the lookup under the lock finds them
+    if ( p_lsm && false == p_key_value_db->stopping ) lsm_prefetch(p_lsm, _key);
+
+    // unpin the tables
+    __atomic_sub_fetch(&p_key_value_db->storage.prefetches, 1, __ATOMIC_SEQ_CST);
+
+    // done
+    return;
+}
+
+void key_value_db_storage_close ( key_value_db *p_key_value_db )
+{
+
+    // initialized data
+    struct timespec  _wait = { .tv_sec = 0, .tv_nsec = 1000000 };
+    lsm             *p_lsm = __atomic_exchange_n(&p_key_value_db->storage.p_lsm, NULL, __ATOMIC_SEQ_CST);
+
+    // memory only
+    if ( NULL == p_lsm ) return;
+
+    // wait for the prefetches that found the tables before they were taken away
+    while ( __atomic_load_n(&p_key_value_db->storage.prefetches, __ATOMIC_SEQ_CST) ) nanosleep(&_wait, NULL);
+
+    // stop compacting, and close the tables
+    lsm_destroy(&p_lsm);
+
+    // done
+    return;
+}
+
+bool key_value_db_path ( char *p_path, const char *p_directory, const char *p_name )
+{
+
+    // initialized data
+    int length = ( p_directory ) ? snprintf(p_path, FILENAME_MAX, "%s/%s", p_directory, p_name)
+                                 : snprintf(p_path, FILENAME_MAX, "%s", p_name);
+
+    // leave room for the temporary file written beside it
+    return length > 0 && (size_t) length + sizeof(".tmp") <= FILENAME_MAX;
+}
+
+void key_value_db_release ( key_value_db *p_key_value_db )
+{
+
+    // stop compacting, and close the tables
+    key_value_db_storage_close(p_key_value_db);
+
+    // release the secondary indexes
+    for (size_t i = 0; i < p_key_value_db->indexes.count; i++) secondary_index_destroy(&p_key_value_db->indexes._indexes[i]);
+
+    // release the structures that point to the properties
+    if ( p_key_value_db->p_front_cache ) front_cache_destroy(&p_key_value_db->p_front_cache);
+    if ( p_key_value_db->p_index ) b_plus_tree_destroy(&p_key_value_db->p_index);
+    if ( p_key_value_db->p_timing_wheel ) timing_wheel_destroy(&p_key_value_db->p_timing_wheel);
+
+    // release every property
+    for (size_t i = 0; i < p_key_value_db->keyspace.count; i++)
+    {
+
+        // initialized data
+        key_value_property *p_property = p_key_value_db->keyspace.pp_properties[i];
+
+        // release the property
+        key_value_value_free(&p_property->_value);
+        p_property = key_value_memory_allocator(KEY_VALUE_MEMORY_PROPERTIES, p_property, 0);
+    }
+    p_key_value_db->keyspace.pp_properties = key_value_memory_allocator(KEY_VALUE_MEMORY_KEYSPACE, p_key_value_db->keyspace.pp_properties, 0);
+
+    // release the versions, the filter, the hot keys, and the dictionary
+    mvcc_destroy(&p_key_value_db->p_mvcc);
+    cuckoo_filter_destroy(&p_key_value_db->p_filter);
+    if ( p_key_value_db->hot_keys.p_reads ) hot_keys_destroy(&p_key_value_db->hot_keys.p_reads);
+    if ( p_key_value_db->hot_keys.p_writes ) hot_keys_destroy(&p_key_value_db->hot_keys.p_writes);
+    dictionary_destroy(&p_key_value_db->compression.p_dictionary);
+
+    // release the lock
+    mutex_destroy(&p_key_value_db->_lock);
+
+    // release the database
+    p_key_value_db = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_key_value_db, 0);
+
+    // done
+    return;
+}
+
+void *key_value_db_cron ( void *p_kvdb )
+{
+
+    // initialized data
+    key_value_db    *p_key_value_db = p_kvdb;
+    struct timespec  _tick          = { .tv_sec = 0, .tv_nsec = KEY_VALUE_DB_TICK_MS * 1000000 };
+
+    while ( p_key_value_db->running )
+    {
+
+        // wait for the next tick
+        nanosleep(&_tick, NULL);
+
+        // lock
+        mutex_lock(&p_key_value_db->_lock);
+
+        // initialized data
+        unsigned long long  now      = key_value_db_time_ms();
+        timing_wheel_timer *p_timer  = NULL;
+        size_t              budget   = KEY_VALUE_DB_EXPIRE_BUDGET;
+
+        // move due timers onto the expired list
+        timing_wheel_advance(p_key_value_db->p_timing_wheel, key_value_db_monotonic_ms() / KEY_VALUE_DB_TICK_MS);
+
+        // reclaim a bounded quantity of properties, and leave the rest for the next tick
+        while ( budget && timing_wheel_expired(p_key_value_db->p_timing_wheel, &p_timer) )
+        {
+
+            // initialized data
+            key_value_property *p_property = p_timer->p_data;
+
+            // the wall clock went back since the timer was armed, so wait for the rest
+            if ( false == key_value_property_expired(p_property, now) )
+            {
+                key_value_db_expire_at(p_key_value_db, p_property, p_property->expires);
+
+                // next timer
+                continue;
+            }
+
+            // logs
+            log_info("[key value db] Expired key \"%s\"\n", p_property->_name);
+
+            // remove the property
+            key_value_db_delete(p_key_value_db, p_property);
+
+            // increment counters
+            p_key_value_db->counter.expired++;
+
+            budget--;
+        }
+
+        // flush a full memtable, when writes did not
+        if ( p_key_value_db->storage.p_lsm && p_key_value_db->storage.dirty >= KEY_VALUE_DB_LSM_MEMTABLE ) key_value_db_flush(p_key_value_db, NULL);
+
+        // make room for the keys reads brought in from the tables
+        if ( p_key_value_db->storage.p_lsm ) key_value_db_evict(p_key_value_db, NULL);
+
+        // close the snapshots no one reads, and drop the versions they pinned
+        mvcc_snapshot_expire(p_key_value_db->p_mvcc, now, KEY_VALUE_DB_MVCC_IDLE);
+
+        // age the hot keys
+        hot_keys_decay(p_key_value_db->hot_keys.p_reads, now),
+        hot_keys_decay(p_key_value_db->hot_keys.p_writes, now);
+
+        // unlock
+        mutex_unlock(&p_key_value_db->_lock);
+    }
+
+    // success
+    return (void *)1;
+}
+
+int key_value_db_snapshot_property ( void *p_value, void *p_parameter )
+{
+
+    // initialized data
+    key_value_property         *p_property = p_value;
+    key_value_db_snapshot_file *p_snapshot = p_parameter;
+    size_t                      length     = 0;
+    const char                 *p_text     = NULL;
+
+    // skip expired properties
+    if ( key_value_property_expired(p_property, p_snapshot->now) ) return 1;
+
+    // write the command
+    p_text = key_value_value_text(&p_property->_value, &length);
+    fprintf(p_snapshot->p_f, "set %s ", p_property->_name);
+    fwrite(p_text, 1, length, p_snapshot->p_f);
+
+    // write the remaining time to live, rounded up
+    if ( p_property->expires ) fprintf(p_snapshot->p_f, " ex %llu", ( p_property->expires - p_snapshot->now + 999 ) / 1000);
+
+    fputc('\n', p_snapshot->p_f);
+    p_snapshot->keys++;
+
+    // done
+    return 1;
+}
+
+int key_value_db_snapshot_write ( key_value_db *p_key_value_db, const char *p_path, size_t *p_keys )
+{
+
+    // initialized data
+    char                        _temporary[FILENAME_MAX] = { 0 };
+    FILE                       *p_f                      = NULL;
+    key_value_db_snapshot_file  _snapshot                = { .now = key_value_db_time_ms() };
+    size_t                      keys                     = 0;
+
+    // write beside the snapshot, and rename over it when complete
+    snprintf(_temporary, sizeof(_temporary), "%s.tmp", p_path);
+    p_f = fopen(_temporary, "w");
+    if ( NULL == p_f ) goto failed_to_open_file;
+
+    // write each property as a set command, in the same format as a seed file
+    _snapshot.p_f = p_f;
+    b_plus_tree_range(p_key_value_db->p_index, NULL, key_value_db_snapshot_property, &_snapshot);
+    keys = _snapshot.keys;
+
+    // error check
+    if ( fflush(p_f) || ferror(p_f) ) goto failed_to_write_file;
+
+    // close the file
+    fclose(p_f);
+
+    // replace the previous snapshot
+    if ( rename(_temporary, p_path) ) goto failed_to_rename_file;
+
+    // logs
+    log_info("[key value db] Wrote %zu keys to \"%s\"\n", keys, p_path);
+
+    // return the quantity of keys to the caller
+    if ( p_keys ) *p_keys = keys;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // standard library errors
+        {
+            failed_to_open_file:
+                log_error("[standard library] Failed to open file \"%s\" in call to function \"%s\"\n", _temporary, __FUNCTION__);
+
+                // error
+                return 0;
+
+            failed_to_write_file:
+                log_error("[standard library] Failed to write file \"%s\" in call to function \"%s\"\n", _temporary, __FUNCTION__);
+
+                // release the file
+                fclose(p_f);
+                remove(_temporary);
+
+                // error
+                return 0;
+
+            failed_to_rename_file:
+                log_error("[standard library] Failed to rename file \"%s\" in call to function \"%s\"\n", _temporary, __FUNCTION__);
+
+                // the previous file is kept
+                remove(_temporary);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_hot_set_write ( key_value_db *p_key_value_db, const char *p_path, size_t *p_keys )
+{
+
+    // initialized data
+    char                     _temporary[FILENAME_MAX] = { 0 };
+    FILE                    *p_f                      = NULL;
+    front_cache_statistics   _cache_stats             = { 0 };
+    const char             **pp_keys                  = NULL;
+    unsigned int            *p_frequencies            = NULL;
+    size_t                   keys                     = 0;
+
+    // size the lists for every cached key
+    front_cache_statistics_get(p_key_value_db->p_front_cache, &_cache_stats);
+    if ( _cache_stats.size )
+    {
+        pp_keys       = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, 0, _cache_stats.size * sizeof(const char *)),
+        p_frequencies = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, 0, _cache_stats.size * sizeof(unsigned int));
+        if ( NULL == pp_keys || NULL == p_frequencies ) goto no_mem;
+    }
+
+    // list the cached keys, hottest first
+    keys = front_cache_hot(p_key_value_db->p_front_cache, pp_keys, p_frequencies, _cache_stats.size);
+
+    // write beside the hot set, and rename over it when complete
+    snprintf(_temporary, sizeof(_temporary), "%s.tmp", p_path);
+    p_f = fopen(_temporary, "w");
+    if ( NULL == p_f ) goto failed_to_open_file;
+
+    // write each key, and its frequency
+    for (size_t i = 0; i < keys; i++)
+        fprintf(p_f, "%s %u\n", pp_keys[i], p_frequencies[i]);
+
+    // error check
+    if ( fflush(p_f) || ferror(p_f) ) goto failed_to_write_file;
+
+    // close the file
+    fclose(p_f);
+
+    // replace the previous hot set
+    if ( rename(_temporary, p_path) ) goto failed_to_rename_file;
+
+    // logs
+    log_info("[key value db] Wrote %zu hot keys to \"%s\"\n", keys, p_path);
+
+    // release the lists
+    if ( pp_keys       ) pp_keys       = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, pp_keys, 0);
+    if ( p_frequencies ) p_frequencies = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_frequencies, 0);
+
+    // return the quantity of keys to the caller
+    if ( p_keys ) *p_keys = keys;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            failed_to_open_file:
+                log_error("[standard library] Failed to open file \"%s\" in call to function \"%s\"\n", _temporary, __FUNCTION__);
+
+                // done
+                goto failed;
+
+            failed_to_write_file:
+                log_error("[standard library] Failed to write file \"%s\" in call to function \"%s\"\n", _temporary, __FUNCTION__);
+
+                // release the file
+                fclose(p_f);
+                remove(_temporary);
+
+                // done
+                goto failed;
+
+            failed_to_rename_file:
+                log_error("[standard library] Failed to rename file \"%s\" in call to function \"%s\"\n", _temporary, __FUNCTION__);
+
+                // the previous file is kept
+                remove(_temporary);
+
+                // done
+                goto failed;
+
+            failed:
+
+                // release the lists
+                if ( pp_keys       ) pp_keys       = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, pp_keys, 0);
+                if ( p_frequencies ) p_frequencies = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_frequencies, 0);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_snapshot_load ( key_value_db *p_key_value_db, const char *p_path )
+{
+
+    // initialized data
+    FILE    *p_f             = fopen(p_path, "r");
+    char    *p_line          = NULL,
+             _response[KEY_VALUE_DB_FRAME_SMALL] = { 0 };
+    size_t   capacity        = 0,
+             response_len    = 0,
+             keys            = 0;
+    ssize_t  length          = 0;
+
+    // no snapshot
+    if ( NULL == p_f ) return 1;
+
+    // replay each set command
+    while ( ( length = getline(&p_line, &capacity, p_f) ) > 0 )
+    {
+
+        // initialized data
+        const char *p_attached     = NULL,
+                   *p_attachment   = NULL;
+        size_t      attachment_len = 0;
+
+        // strip the newline
+        if ( '\n' == p_line[length - 1] ) p_line[--length] = '\0';
+        if ( 0 == length ) continue;
+
+        // process the command
+        if ( key_value_db_process(p_key_value_db, p_line, (size_t) length, _response, &response_len) ) keys++;
+
+        // nobody is listening for the response
+        key_value_db_detach(p_key_value_db, &p_attached, &p_attachment, &attachment_len);
+        key_value_value_release(p_attached);
+    }
+
+    // release the line
+    free(p_line);
+
+    // close the file
+    fclose(p_f);
+
+    // logs
+    log_info("[key value db] Loaded %zu keys from \"%s\"\n", keys, p_path);
+
+    // success
+    return 1;
+}
+
+int key_value_db_hot_set_load ( key_value_db *p_key_value_db, const char *p_path )
+{
+
+    // initialized data
+    FILE         *p_f       = fopen(p_path, "r");
+    char          _key[63+1] = { 0 };
+    unsigned int  frequency = 0;
+    size_t        keys      = 0;
+
+    // no hot set
+    if ( NULL == p_f ) return 1;
+
+    // read each key, and its frequency
+    while ( 2 == fscanf(p_f, "%63s %u", _key, &frequency) )
+    {
+
+        // initialized data
+        key_value_property *p_property = NULL;
+
+        // walk the index to the property, which pulls the pages on its path into memory
+        if ( 0 == key_value_db_lookup(p_key_value_db, _key, &p_property) ) continue;
+
+        // place the property in the cache, until it is full
+        if ( 0 == front_cache_warm(p_key_value_db->p_front_cache, p_property->_name, p_property, frequency) ) break;
+
+        keys++;
+    }
+
+    // close the file
+    fclose(p_f);
+
+    // logs
+    log_info("[key value db] Prefetched %zu hot keys from \"%s\"\n", keys, p_path);
+
+    // success
+    return 1;
+}
+
+void *key_value_property_key_accessor ( key_value_property *p_property )
+{
+
+    // argument check
+    if ( NULL == p_property ) return NULL;
+
+    // done
+    return p_property->_name;
+}
+
+int key_value_property_comparator ( key_value_property *p_a, key_value_property *p_b )
+{
+
+    // argument check
+    if ( NULL == p_a ) return 1;
+    if ( NULL == p_b ) return -1;
+
+    // done
+    return strcmp(p_a->_name, p_b->_name);
+}
+
+int key_value_property_equality ( key_value_property *p_a, key_value_property *p_b )
+{
+
+    // done
+    return ( 0 == key_value_property_comparator(p_a, p_b) );
+}
+
+void key_value_db_detach ( key_value_db *p_key_value_db, const char **pp_buffer, const char **pp_text, size_t *p_length )
+{
+
+    // move the attachment to the caller
+    *pp_buffer = p_key_value_db->attachment.p_buffer,
+    *pp_text   = p_key_value_db->attachment.p_text,
+    *p_length  = p_key_value_db->attachment.length;
+
+    // clear the attachment
+    p_key_value_db->attachment.p_buffer = NULL,
+    p_key_value_db->attachment.p_text   = NULL,
+    p_key_value_db->attachment.length   = 0;
+
+    // done
+    return;
+}
+
+#ifndef _WIN64
+bool key_value_connection_alive ( key_value_connection *p_connection )
+{
+
+    // initialized data
+    char    peek   = 0;
+    ssize_t result = 0;
+
+    // either side closed a ring
+    if ( ring_closed(p_connection->shm.p_requests) || ring_closed(p_connection->shm.p_responses) ) return false;
+
+    // the client went away, without closing its rings
+    do result = recv(p_connection->_socket, &peek, 1, MSG_PEEK | MSG_DONTWAIT);
+    while ( result < 0 && EINTR == errno );
+
+    // done
+    return ( result > 0 ) || ( result < 0 && ( EAGAIN == errno || EWOULDBLOCK == errno ) );
+}
+
+size_t key_value_connection_ring_read ( key_value_connection *p_connection, void *p_data, size_t capacity )
+{
+
+    // wait for requests, and check on the client between waits
+    while ( 1 )
+    {
+
+        // initialized data
+        size_t received = ring_read(p_connection->shm.p_requests, p_data, capacity, KEY_VALUE_DB_RING_POLL_MS);
+
+        // done
+        if ( received ) return received;
+
+        // error check
+        if ( false == key_value_connection_alive(p_connection) ) return 0;
+    }
+}
+
+int key_value_connection_ring_write ( key_value_connection *p_connection, const void *p_data, size_t length )
+{
+
+    // initialized data
+    unsigned long long deadline = key_value_db_monotonic_ms() + KEY_VALUE_DB_RING_STALL_MS;
+
+    // write until every byte is in the ring. the send lock is held, but pushes
+    // only try it, and queue behind it, so the wait never holds up the database
+    while ( length )
+    {
+
+        // initialized data
+        size_t written = ring_write(p_connection->shm.p_responses, p_data, length, KEY_VALUE_DB_RING_POLL_MS);
+
+        // error check
+        if ( 0 == written && false == key_value_connection_alive(p_connection) ) return 0;
+
+        // a client that stops reading its responses is dropped, as a dead one is
+        if ( written ) deadline = key_value_db_monotonic_ms() + KEY_VALUE_DB_RING_STALL_MS;
+        else if ( key_value_db_monotonic_ms() >= deadline ) goto stalled;
+
+        // skip the written bytes
+        p_data  = (const char *) p_data + written,
+        length -= written;
+    }
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // ring errors
+        {
+            stalled:
+                #ifndef NDEBUG
+                    log_error("[key value db] Client stopped reading its response ring in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+#endif
+
+int key_value_db_server_send ( key_value_connection *p_connection, char *p_frame, size_t response_len, const char *p_attachment, size_t attachment_len )
+{
+
+    // initialized data
+    socket_tcp _socket_tcp = p_connection->_socket;
+
+    // set the length. an attachment is followed by the closing brace
+    *(size_t *)p_frame = response_len + ( p_attachment ? attachment_len + 1 : 0 );
+
+    #ifndef _WIN64
+
+        // write each part to the response ring
+        if ( p_connection->shm.p_responses )
+            return key_value_connection_ring_write(p_connection, p_frame, sizeof(size_t) + response_len) &&
+                   ( NULL == p_attachment || key_value_connection_ring_write(p_connection, p_attachment, attachment_len) ) &&
+                   ( NULL == p_attachment || key_value_connection_ring_write(p_connection, "}", 1) );
+    #endif
+
+    // the response is in the frame
+    if ( NULL == p_attachment ) return socket_tcp_send(_socket_tcp, p_frame, sizeof(size_t) + response_len);
+
+    // send each part
+    #ifdef _WIN64
+        return socket_tcp_send(_socket_tcp, p_frame, sizeof(size_t) + response_len) &&
+               socket_tcp_send(_socket_tcp, p_attachment, attachment_len)           &&
+               socket_tcp_send(_socket_tcp, "}", 1);
+
+    // gather the parts into one system call
+    #else
+    {
+
+        // initialized data
+        struct iovec  _iov[3] =
+        {
+            { .iov_base = p_frame,              .iov_len = sizeof(size_t) + response_len },
+            { .iov_base = (void *) p_attachment, .iov_len = attachment_len                },
+            { .iov_base = "}",                  .iov_len = 1                             }
+        };
+        struct iovec *p_iov   = _iov;
+        int           count   = 3;
+
+        // send until every part is written
+        while ( count )
+        {
+
+            // initialized data
+            ssize_t sent = writev(_socket_tcp, p_iov, count);
+
+            // error check
+            if ( sent < 0 )
+            {
+                if ( EINTR == errno ) continue;
+
+                // error
+                return 0;
+            }
+
+            // skip the parts that were written
+            while ( count && (size_t) sent >= p_iov->iov_len ) sent -= (ssize_t) p_iov->iov_len, p_iov++, count--;
+
+            // skip the written bytes of a partly written part
+            if ( count ) p_iov->iov_base = (char *) p_iov->iov_base + sent, p_iov->iov_len -= (size_t) sent;
+        }
+
+        // success
+        return 1;
+    }
+    #endif
+}
+
+int key_value_connection_fill ( key_value_connection *p_connection, size_t quantity )
+{
+
+    // receive until the quantity is buffered
+    while ( p_connection->receive.length - p_connection->receive.offset < quantity )
+    {
+
+        // initialized data
+        size_t received = 0;
+        bool   empty    = ( p_connection->receive.offset == p_connection->receive.length );
+
+        // grow the buffer. a request and its terminator are always contiguous
+        if ( quantity + 2 > p_connection->receive.capacity )
+        {
+
+            // initialized data
+            size_t  capacity = ( quantity + 2 > 2 * p_connection->receive.capacity ) ? quantity + 2 : 2 * p_connection->receive.capacity;
+            char   *p_data   = key_value_memory_allocator(KEY_VALUE_MEMORY_CONNECTIONS, p_connection->receive.p_data, capacity);
+
+            // error check
+            if ( NULL == p_data ) return 0;
+
+            // store the buffer
+            p_connection->receive.p_data   = p_data,
+            p_connection->receive.capacity = capacity;
+
+            // count the allocation
+            __atomic_add_fetch(&p_connection->p_key_value_db->counter.buffer_allocations, 1, __ATOMIC_RELAXED);
+        }
+
+        // move the unread bytes to the front, to make room behind them
+        if ( p_connection->receive.offset + quantity + 2 > p_connection->receive.capacity )
+            memmove(p_connection->receive.p_data, &p_connection->receive.p_data[p_connection->receive.offset], p_connection->receive.length - p_connection->receive.offset),
+            p_connection->receive.length -= p_connection->receive.offset,
+            p_connection->receive.offset  = 0;
+
+        #ifdef _WIN64
+
+            // receive exactly the missing bytes
+            received = p_connection->receive.offset + quantity - p_connection->receive.length;
+            if ( 0 == socket_tcp_receive(p_connection->_socket, &p_connection->receive.p_data[p_connection->receive.length], received) ) return 0;
+        #else
+        {
+
+            // initialized data
+            ssize_t result = 0;
+
+            // receive whatever has arrived, which may be part of a frame, or several frames.
+            // the last byte is kept free, for the terminator of a request that ends the buffer
+            if ( p_connection->shm.p_requests )
+                result = (ssize_t) key_value_connection_ring_read(p_connection, &p_connection->receive.p_data[p_connection->receive.length], p_connection->receive.capacity - p_connection->receive.length - 1);
+            else
+                do result = recv(p_connection->_socket, &p_connection->receive.p_data[p_connection->receive.length], p_connection->receive.capacity - p_connection->receive.length - 1, 0);
+                while ( result < 0 && EINTR == errno );
+
+            // error check
+            if ( result <= 0 ) return 0;
+
+            received = (size_t) result;
+        }
+        #endif
+
+        // update the length, and note when the bytes arrived. a frame is
+        // stamped when its first bytes arrive, not when its last bytes do
+        p_connection->receive.length += received,
+        p_connection->receive.last    = key_value_db_time_us();
+        if ( empty ) p_connection->receive.stamp = p_connection->receive.last;
+    }
+
+    // success
+    return 1;
+}
+
+void key_value_connection_consumed ( key_value_connection *p_connection )
+{
+
+    // a fill stops at the end of the frame it waits for, so only the last
+    // read can hold bytes past it. the next frame started arriving then
+    if ( p_connection->receive.offset < p_connection->receive.length ) p_connection->receive.stamp = p_connection->receive.last;
+
+    // done
+    return;
+}
+
+int key_value_connection_read ( key_value_connection *p_connection, void *p_data, size_t quantity )
+{
+
+    // initialized data
+    size_t buffered = p_connection->receive.length - p_connection->receive.offset;
+
+    // take the buffered bytes first
+    if ( buffered > quantity ) buffered = quantity;
+    memcpy(p_data, &p_connection->receive.p_data[p_connection->receive.offset], buffered);
+    p_connection->receive.offset += buffered;
+    key_value_connection_consumed(p_connection);
+
+    #ifndef _WIN64
+
+        // take the rest from the request ring
+        if ( p_connection->shm.p_requests )
+            for (size_t received = 0; buffered < quantity; buffered += received)
+                if ( 0 == ( received = key_value_connection_ring_read(p_connection, (char *) p_data + buffered, quantity - buffered) ) ) return 0;
+    #endif
+
+    // receive the rest straight into the destination
+    if ( quantity > buffered ) return socket_tcp_receive(p_connection->_socket, (char *) p_data + buffered, quantity - buffered);
+
+    // success
+    return 1;
+}
+
+size_t key_value_connection_pending ( key_value_connection *p_connection, size_t limit )
+{
+
+    // initialized data
+    size_t offset  = p_connection->receive.offset,
+           pending = 0,
+           length  = 0;
+
+    // count the complete requests that are already buffered, up to one over the limit
+    while ( pending <= limit && p_connection->receive.length - offset >= sizeof(size_t) )
+    {
+
+        // get the length of the request
+        memcpy(&length, &p_connection->receive.p_data[offset], sizeof(size_t));
+
+        // incomplete
+        if ( p_connection->receive.length - offset - sizeof(size_t) < length ) break;
+
+        // skip the request
+        offset += sizeof(size_t) + length,
+        pending++;
+    }
+
+    // done
+    return pending;
+}
+
+bool key_value_db_shed ( key_value_db *p_key_value_db, key_value_connection *p_connection, unsigned long long arrival )
+{
+
+    // initialized data
+    unsigned long long now   = key_value_db_time_us(),
+                       delay = ( now > arrival ) ? now - arrival : 0;
+
+    // too many requests are queued behind this one
+    if ( key_value_connection_pending(p_connection, p_key_value_db->admission.max_in_flight) > p_key_value_db->admission.max_in_flight )
+    {
+        p_key_value_db->counter.rejected.in_flight++;
+
+        // shed
+        return true;
+    }
+
+    // start the next interval. an interval without requests is not overloaded
+    if ( now >= p_key_value_db->admission.interval_end )
+        p_key_value_db->admission.overloaded   = ( ~0ULL != p_key_value_db->admission.min_delay && p_key_value_db->admission.min_delay > KEY_VALUE_DB_SHED_TARGET_US ),
+        p_key_value_db->admission.min_delay    = ~0ULL,
+        p_key_value_db->admission.interval_end = now + KEY_VALUE_DB_SHED_INTERVAL_US;
+
+    // track the smallest delay of the interval
+    if ( delay < p_key_value_db->admission.min_delay ) p_key_value_db->admission.min_delay = delay;
+
+    // a standing queue sheds anything over the target, and a burst only what waited a whole interval
+    if ( delay > ( p_key_value_db->admission.overloaded ? KEY_VALUE_DB_SHED_TARGET_US : KEY_VALUE_DB_SHED_INTERVAL_US ) )
+    {
+        p_key_value_db->counter.rejected.queue_delay++;
+
+        // shed
+        return true;
+    }
+
+    // admit
+    return false;
+}
+
+int key_value_db_server_stream
+(
+    key_value_connection *p_connection,
+    size_t                len,
+    unsigned long long    arrival,
+    key_value_db         *p_key_value_db,
+
+    char *p_response, size_t *p_response_len,
+    const char **pp_attached, const char **pp_attachment, size_t *p_attachment_len
+)
+{
+
+    // initialized data
+    char                _head[KEY_VALUE_DB_FRAME_HEAD + 1] = { 0 };
+    char               *p_command                          = NULL,
+                       *p_key                              = NULL,
+                       *p_text                             = NULL;
+    size_t              cur                                = 0,
+                        length                             = 0,
+                        head_length                        = 0;
+    long long           seconds                            = 0;
+    unsigned long long  expires                            = 0;
+    unsigned char       type                               = 0;
+    key_value_value     _value                             = { 0 };
+
+    // receive the head of the request
+    if ( 0 == key_value_connection_read(p_connection, _head, KEY_VALUE_DB_FRAME_HEAD) ) return 0;
+
+    // parse the command, and the key
+    p_command = key_value_db_parse_token(_head, KEY_VALUE_DB_FRAME_HEAD, &cur);
+    p_key     = key_value_db_parse_token(_head, KEY_VALUE_DB_FRAME_HEAD, &cur);
+
+    // only sets are streamed, and the key must fit in the head
+    if ( NULL == p_command || NULL == p_key || 0 != strcmp(p_command, "set") || cur > KEY_VALUE_DB_FRAME_HEAD ) goto not_streamable;
+
+    // skip the blanks before the value
+    while ( cur < KEY_VALUE_DB_FRAME_HEAD && isblank(_head[cur]) ) cur++;
+
+    // allocate the value's final buffer, and a null terminator
+    length      = len - cur,
+    head_length = KEY_VALUE_DB_FRAME_HEAD - cur,
+    p_text      = key_value_value_allocate(length + 1);
+    if ( NULL == p_text ) goto no_mem;
+
+    // receive the value straight into its buffer
+    memcpy(p_text, &_head[cur], head_length);
+    if ( 0 == key_value_connection_read(p_connection, p_text + head_length, length - head_length) ) goto disconnected;
+    p_text[length] = '\0';
+
+    // strip the optional expiry
+    if ( key_value_db_parse_expiry(p_text, &seconds) )
+    {
+
+        // error check
+        if ( seconds <= 0 ) goto bad_value;
+
+        // compute the expiry time, and the new length
+        expires = key_value_db_time_ms() + (unsigned long long) seconds * 1000,
+        length  = strlen(p_text);
+    }
+
+    // strip trailing whitespace
+    while ( length && isspace((unsigned char) p_text[length - 1]) ) length--;
+
+    // validate the value in one pass
+    if ( 0 == json_path_classify(p_text, length, &type) ) goto bad_value;
+
+    // the value takes over the buffer
+    key_value_value_adopt(&_value, p_text, length, type);
+
+    // lock
+    mutex_lock(&p_key_value_db->_lock);
+
+    // refuse writes once shutdown has started
+    if ( p_key_value_db->stopping )
+    {
+
+        // unlock
+        mutex_unlock(&p_key_value_db->_lock);
+
+        // release the value
+        key_value_value_free(&_value);
+
+        // done
+        goto failed;
+    }
+
+    // shed load
+    if ( key_value_db_shed(p_key_value_db, p_connection, arrival) )
+    {
+
+        // unlock
+        mutex_unlock(&p_key_value_db->_lock);
+
+        // release the value
+        key_value_value_free(&_value);
+
+        // done
+        goto busy;
+    }
+
+    // the server is not idle
+    p_key_value_db->last_request = key_value_db_time_ms();
+
+    // process the set command. a failed write counts as an error
+    if ( key_value_db_process_set_value(p_key_value_db, p_key, &_value, expires, p_response, p_response_len) )
+        p_key_value_db->counter.request.set++;
+
+    // take the attachment
+    key_value_db_detach(p_key_value_db, pp_attached, pp_attachment, p_attachment_len);
+
+    // unlock
+    mutex_unlock(&p_key_value_db->_lock);
+
+    // success
+    return 1;
+
+    // this branch drains a request that is too long to buffer
+    not_streamable:
+    {
+
+        // initialized data
+        char   _drain[KEY_VALUE_DB_FRAME_SMALL];
+        size_t remaining = len - KEY_VALUE_DB_FRAME_HEAD;
+
+        // logs
+        log_error("[key value db] Only set requests may exceed %d bytes\n", KEY_VALUE_DB_FRAME_SMALL);
+
+        // discard the rest of the request
+        while ( remaining )
+        {
+
+            // initialized data
+            size_t chunk = ( remaining < sizeof(_drain) ) ? remaining : sizeof(_drain);
+
+            // receive a chunk
+            if ( 0 == key_value_connection_read(p_connection, _drain, chunk) ) return 0;
+
+            // update the remaining length
+            remaining -= chunk;
+        }
+
+        // done
+        goto failed;
+    }
+
+    // error handling
+    {
+
+        // key value db errors
+        {
+            bad_value:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to parse streamed value of key \"%s\" in call to function \"%s\"\n", p_key, __FUNCTION__);
+                #endif
+
+                // release the buffer
+                key_value_value_release(p_text);
+
+                // done
+                goto failed;
+
+            failed:
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // lock
+                mutex_lock(&p_key_value_db->_lock);
+
+                // increment counters
+                p_key_value_db->counter.request.err++;
+
+                // unlock
+                mutex_unlock(&p_key_value_db->_lock);
+
+                // error
+                return 1;
+
+            busy:
+
+                // copy the busy message to the response buffer
+                memcpy(p_response, "{\"okay\":false,\"busy\":true}", 26);
+                *p_response_len = 26;
+
+                // error
+                return 1;
+        }
+
+        // socket errors
+        {
+            disconnected:
+
+                // release the buffer
+                key_value_value_release(p_text);
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+#ifndef _WIN64
+int key_value_db_server_ring ( key_value_connection *p_connection )
+{
+
+    // initialized data
+    static size_t   serial      = 0;
+    char            _name[64]   = { 0 },
+                    _frame[sizeof(size_t) + 64] = { 0 };
+    union
+    {
+        char           _buffer[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr _header;
+    }               _control    = { 0 };
+    size_t          size        = 2 * ring_size(KEY_VALUE_DB_RING_CAPACITY),
+                    length      = 0;
+    int             descriptor  = -1;
+    void           *p_region    = MAP_FAILED;
+    ssize_t         sent        = 0;
+    struct iovec    _iov        = { 0 };
+    struct msghdr   _message    = { 0 };
+    struct cmsghdr *p_header    = NULL;
+
+    // create the shared memory. the name is removed at once, so only the descriptor reaches it
+    snprintf(_name, sizeof(_name), "/key_value_db.%ld.%zu", (long) getpid(), __atomic_add_fetch(&serial, 1, __ATOMIC_RELAXED));
+    descriptor = shm_open(_name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if ( descriptor < 0 ) goto failed_to_open_shared_memory;
+    shm_unlink(_name);
+
+    // map the shared memory
+    if ( ftruncate(descriptor, (off_t) size) ) goto failed_to_map_shared_memory;
+    p_region = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    if ( MAP_FAILED == p_region ) goto failed_to_map_shared_memory;
+
+    // lock. a watch push must not find half a transport
+    mutex_lock(&p_connection->_send_lock);
+
+    // construct the request ring, then the response ring
+    if ( 0 == ring_construct(&p_connection->shm.p_requests, p_region, KEY_VALUE_DB_RING_CAPACITY) ) goto failed_to_construct_rings;
+    if ( 0 == ring_construct(&p_connection->shm.p_responses, (char *) p_region + ring_size(KEY_VALUE_DB_RING_CAPACITY), KEY_VALUE_DB_RING_CAPACITY) ) goto failed_to_construct_rings;
+
+    // serialize the response
+    length = (size_t) sprintf(_frame + sizeof(size_t), "{\"okay\":true,\"value\":{\"capacity\":%d}}", KEY_VALUE_DB_RING_CAPACITY);
+    *(size_t *)_frame = length;
+
+    // the response carries the descriptor
+    _iov     = (struct iovec)  { .iov_base = _frame, .iov_len = sizeof(size_t) + length },
+    _message = (struct msghdr) { .msg_iov = &_iov, .msg_iovlen = 1, .msg_control = _control._buffer, .msg_controllen = sizeof(_control._buffer) },
+    p_header = CMSG_FIRSTHDR(&_message);
+    p_header->cmsg_level = SOL_SOCKET,
+    p_header->cmsg_type  = SCM_RIGHTS,
+    p_header->cmsg_len   = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(p_header), &descriptor, sizeof(int));
+
+    // send the response on the socket. every later frame uses the rings
+    do sent = sendmsg(p_connection->_socket, &_message, MSG_NOSIGNAL);
+    while ( sent < 0 && EINTR == errno );
+    if ( (size_t) sent != sizeof(size_t) + length ) goto failed_to_send;
+
+    // store the region
+    p_connection->shm.p_region = p_region,
+    p_connection->shm.size     = size;
+
+    // unlock, and send what was pushed meanwhile
+    mutex_unlock(&p_connection->_send_lock);
+    key_value_connection_drain(p_connection);
+
+    // the mapping keeps the memory
+    close(descriptor);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // standard library errors
+        {
+            failed_to_open_shared_memory:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to open shared memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            failed_to_map_shared_memory:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to map shared memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto release_descriptor;
+
+            failed_to_send:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to send the shared memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto release_rings;
+        }
+
+        // ring errors
+        {
+            failed_to_construct_rings:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to construct rings in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto release_rings;
+        }
+
+        release_rings:
+
+            // the connection goes on with the socket
+            if ( p_connection->shm.p_requests  ) ring_destroy(&p_connection->shm.p_requests);
+            if ( p_connection->shm.p_responses ) ring_destroy(&p_connection->shm.p_responses);
+            mutex_unlock(&p_connection->_send_lock);
+            key_value_connection_drain(p_connection);
+            munmap(p_region, size);
+
+        release_descriptor:
+
+            // close the shared memory
+            close(descriptor);
+
+            // error
+            return 0;
+    }
+}
+#endif
+
+void *key_value_db_connection ( void *p_conn )
+{
+
+    // initialized data
+    key_value_connection *p_connection   = p_conn;
+    key_value_db         *p_key_value_db = p_connection->p_key_value_db;
+    size_t                len            = 0;
+    char                 *p_buffer       = 0,
+                          next           = '\0';
+    unsigned long long    arrival        = 0;
+    char _response_buf[4096] = {0}; 
+    size_t response_len = 0;
+
+    // log the connection
+    log_info("[key value db] Accepted incoming connection from %hhu.%hhu.%hhu.%hhu:%hu\n", 
+            (p_connection->ip_address >> 24) & 0xFF, 
+            (p_connection->ip_address >> 16) & 0xFF, 
+            (p_connection->ip_address >>  8) & 0xFF, 
+            (p_connection->ip_address >>  0) & 0xFF, 
+            
+            p_connection->port_number
+    );
+
+    while (1)
+    {
+
+        // initialized data
+        const char         *p_attachment   = NULL,
+                           *p_attached     = NULL,
+                           *p_command      = NULL,
+                           *p_key          = NULL;
+        size_t              attachment_len = 0,
+                            command_bound  = 0,
+                            key_bound      = 0;
+        unsigned long long  _marks[KEY_VALUE_DB_STAGE_QUANTITY + 1] = { 0 };
+
+        // parse the request
+        {
+
+            // get the length of the request
+            if ( 0 == key_value_connection_fill(p_connection, sizeof(size_t)) ) goto disconnected;
+            memcpy(&len, &p_connection->receive.p_data[p_connection->receive.offset], sizeof(size_t));
+            p_connection->receive.offset += sizeof(size_t);
+
+            // when the request started arriving
+            arrival = p_connection->receive.stamp;
+
+            // error check
+            if ( KEY_VALUE_DB_FRAME_MAX < len ) goto disconnected;
+
+            // the request starts arriving
+            _marks[KEY_VALUE_DB_STAGE_RECEIVE] = key_value_db_ticks();
+
+            // stream large values straight into their final allocation
+            if ( KEY_VALUE_DB_FRAME_SMALL < len )
+            {
+
+                // process the request
+                if ( 0 == key_value_db_server_stream(p_connection, len, arrival, p_key_value_db, _response_buf + sizeof(size_t), &response_len, &p_attached, &p_attachment, &attachment_len) ) goto disconnected;
+
+                // the whole request is received, and processed, before the response is sent
+                p_command                       = "set",
+                command_bound                   = 3,
+                _marks[KEY_VALUE_DB_STAGE_SEND] = key_value_db_ticks();
+
+                // done
+                goto respond;
+            }
+
+            // buffer the rest of the message
+            if ( 0 == key_value_connection_fill(p_connection, len) ) goto disconnected;
+            _marks[KEY_VALUE_DB_STAGE_QUEUE] = key_value_db_ticks();
+
+            // the request is parsed in place
+            p_buffer                      = &p_connection->receive.p_data[p_connection->receive.offset],
+            p_connection->receive.offset += len;
+            key_value_connection_consumed(p_connection);
+        }
+
+        // process the request
+        {
+            
+            // exit?
+            if ( 4 == len && 0 == memcmp(p_buffer, "exit", 4) ) goto clean_disconnect;
+
+            #ifndef _WIN64
+
+                // a local client asks to move to shared memory rings
+                if ( 4 == len && 0 == memcmp(p_buffer, "ring", 4) && p_connection->local && NULL == p_connection->shm.p_region )
+                {
+
+                    // the response went with the descriptor
+                    if ( key_value_db_server_ring(p_connection) ) continue;
+
+                    // the client stays on the socket
+                    memcpy(_response_buf + sizeof(size_t), "{\"okay\":false}", 14),
+                    response_len = 14;
+
+                    // done
+                    goto respond;
+                }
+            #endif
+
+            // read the table blocks the request needs before the lock is taken
+            key_value_db_prefetch(p_key_value_db, p_buffer, len);
+
+            // lock
+            mutex_lock(&p_key_value_db->_lock);
+            _marks[KEY_VALUE_DB_STAGE_PARSE] = key_value_db_ticks();
+
+            // shed load with a fast rejection
+            if ( key_value_db_shed(p_key_value_db, p_connection, arrival) )
+                memcpy(_response_buf + sizeof(size_t), "{\"okay\":false,\"busy\":true}", 26),
+                response_len = 26;
+
+            // process
+            else
+            {
+
+                // terminate the request. the byte after it may start the next
+                // request, so it is put back after the request is processed
+                next          = p_buffer[len],
+                p_buffer[len] = '\0';
+
+                p_key_value_db->network.p_current = p_connection;
+                p_key_value_db->slowlog.lookup    = 0,
+                p_key_value_db->slowlog.serialize = 0,
+                p_key_value_db->slowlog.p_command = NULL,
+                p_key_value_db->slowlog.p_key     = NULL;
+                key_value_db_process(
+                    p_key_value_db, 
+                    p_buffer, len, 
+                    _response_buf + sizeof(size_t), &response_len
+                );
+                p_key_value_db->network.p_current = NULL;
+
+                // take the stages the request marked
+                _marks[KEY_VALUE_DB_STAGE_LOOKUP]    = p_key_value_db->slowlog.lookup,
+                _marks[KEY_VALUE_DB_STAGE_SERIALIZE] = p_key_value_db->slowlog.serialize,
+                p_command                            = p_key_value_db->slowlog.p_command,
+                p_key                                = p_key_value_db->slowlog.p_key,
+                command_bound                        = ( p_command ) ? len - (size_t) ( p_command - p_buffer ) : 0,
+                key_bound                            = ( p_key ) ? len - (size_t) ( p_key - p_buffer ) : 0;
+
+                // put back the first byte of the next request
+                p_buffer[len] = next;
+            }
+
+            // take the attachment
+            key_value_db_detach(p_key_value_db, &p_attached, &p_attachment, &attachment_len);
+
+            // unlock
+            _marks[KEY_VALUE_DB_STAGE_SEND] = key_value_db_ticks();
+            mutex_unlock(&p_key_value_db->_lock);
+        }
+
+        respond:
+
+        // send the response, gathering the attachment from the stored buffer
+        mutex_lock(&p_connection->_send_lock);
+        key_value_db_server_send(p_connection, _response_buf, response_len, p_attachment, attachment_len);
+        mutex_unlock(&p_connection->_send_lock);
+        key_value_connection_drain(p_connection);
+        _marks[KEY_VALUE_DB_STAGE_QUANTITY] = key_value_db_ticks();
+
+        // drop the reference to the stored buffer
+        key_value_value_release(p_attached);
+
+        // record a slow request. the request is still in the receive buffer
+        if
+        (
+            p_key_value_db->slowlog.threshold &&
+            (double) ( _marks[KEY_VALUE_DB_STAGE_QUANTITY] - _marks[KEY_VALUE_DB_STAGE_RECEIVE] ) >= (double) p_key_value_db->slowlog.threshold * p_key_value_db->slowlog.ticks_per_us
+        )
+            key_value_db_slowlog_record(p_key_value_db, p_connection, p_command, command_bound, p_key, key_bound, _marks);
+    }
+
+    clean_disconnect:
+
+    // say goodbye
+    {
+        // initialized data
+        char _buf[4096] = {0}; 
+
+        // set the length
+        strncpy(_buf + sizeof(size_t), "exit", 4);
+        len = 4;
+
+        // send the result
+        mutex_lock(&p_connection->_send_lock);
+        key_value_db_server_send(p_connection, _buf, len, NULL, 0);
+        mutex_unlock(&p_connection->_send_lock);
+    }
+
+    disconnected:
+
+    // wake a client waiting on the rings
+    ring_close(p_connection->shm.p_requests),
+    ring_close(p_connection->shm.p_responses);
+
+    // log the disconnect
+    log_info("[key value db] Connection closed from %hhu.%hhu.%hhu.%hhu:%hu\n", 
+            (p_connection->ip_address >> 24) & 0xFF, 
+            (p_connection->ip_address >> 16) & 0xFF, 
+            (p_connection->ip_address >>  8) & 0xFF, 
+            (p_connection->ip_address >>  0) & 0xFF, 
+            
+            p_connection->port_number
+    );
+
+    // trace the disconnect, with the lifetime of the connection
+    if ( KEY_VALUE_DB_PROBE_ENABLED(connection__close) )
+        KEY_VALUE_DB_PROBE3(connection__close, p_connection->ip_address, p_connection->port_number, key_value_db_elapsed_ns(p_key_value_db, p_connection->accepted));
+
+    // the listener closes the socket, and releases the connection
+    mutex_lock(&p_key_value_db->_lock);
+    p_connection->closed   = true,
+    p_connection->finished = true;
+    p_key_value_db->admission.connections--;
+    mutex_unlock(&p_key_value_db->_lock);
+
+    // success
+    return (void *)1;
+}
+
+int key_value_db_server_admit ( socket_tcp _socket_tcp, socket_ip_address ip_address, socket_port port_number, bool local, key_value_db *p_key_value_db )
+{
+
+    // initialized data
+    key_value_connection *p_connection = NULL;
+    bool                  full         = false;
+
+    // lock
+    mutex_lock(&p_key_value_db->_lock);
+
+    // reserve a connection, unless the limit is reached
+    full = p_key_value_db->admission.connections >= p_key_value_db->admission.max_connections;
+    if ( full ) p_key_value_db->counter.rejected.connections++;
+    else        p_key_value_db->admission.connections++;
+
+    // unlock
+    mutex_unlock(&p_key_value_db->_lock);
+
+    // error check
+    if ( full ) goto too_many_connections;
+
+    // allocate the connection
+    p_connection = key_value_memory_allocator(KEY_VALUE_MEMORY_CONNECTIONS, 0, sizeof(key_value_connection));
+    if ( NULL == p_connection ) goto no_mem;
+
+    // populate the connection
+    memset(p_connection, 0, sizeof(key_value_connection));
+    p_connection->_socket        = _socket_tcp,
+    p_connection->ip_address     = ip_address,
+    p_connection->port_number    = port_number,
+    p_connection->p_key_value_db = p_key_value_db,
+    p_connection->local          = local,
+    p_connection->accepted       = key_value_db_ticks();
+    mutex_create(&p_connection->_send_lock);
+    mutex_create(&p_connection->pending._lock);
+
+    // allocate the receive buffer, which every request on the connection reuses
+    p_connection->receive.p_data   = key_value_memory_allocator(KEY_VALUE_MEMORY_CONNECTIONS, 0, KEY_VALUE_DB_RECEIVE_BUFFER),
+    p_connection->receive.capacity = KEY_VALUE_DB_RECEIVE_BUFFER;
+    if ( NULL == p_connection->receive.p_data ) goto no_mem;
+    __atomic_add_fetch(&p_key_value_db->counter.buffer_allocations, 1, __ATOMIC_RELAXED);
+
+    // lock
+    mutex_lock(&p_key_value_db->_lock);
+
+    // add the connection to the list
+    p_connection->p_next                  = p_key_value_db->network.p_connections,
+    p_key_value_db->network.p_connections = p_connection;
+
+    // serve the connection on its own thread, so one client never waits for another
+    if ( 0 == parallel_thread_start(&p_connection->p_thread, (fn_parallel_task *)key_value_db_connection, p_connection) )
+    {
+
+        // remove the connection from the list
+        p_key_value_db->network.p_connections = p_connection->p_next;
+
+        // unlock
+        mutex_unlock(&p_key_value_db->_lock);
+
+        // done
+        goto failed_to_start_thread;
+    }
+
+    // trace the connection, with the quantity of open connections
+    KEY_VALUE_DB_PROBE3(connection__accept, ip_address, port_number, p_key_value_db->admission.connections);
+
+    // unlock
+    mutex_unlock(&p_key_value_db->_lock);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // key value db errors
+        {
+            too_many_connections:
+            {
+
+                // initialized data
+                char _frame[sizeof(size_t) + 26] = { 0 };
+
+                // logs
+                log_error("[key value db] Refused a connection over the limit of %zu\n", p_key_value_db->admission.max_connections);
+
+                // tell the client to back off
+                *(size_t *)_frame = 26;
+                memcpy(_frame + sizeof(size_t), "{\"okay\":false,\"busy\":true}", 26);
+                socket_tcp_send(_socket_tcp, _frame, sizeof(_frame));
+
+                // close the socket
+                socket_tcp_destroy(&_socket_tcp);
+
+                // error
+                return 0;
+            }
+        }
+
+        // parallel errors
+        {
+            failed_to_start_thread:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to start connection thread in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto release_connection;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto release_connection;
+        }
+
+        release_connection:
+
+            // release the connection
+            if ( p_connection )
+            {
+                if ( p_connection->receive.p_data ) p_connection->receive.p_data = key_value_memory_allocator(KEY_VALUE_MEMORY_CONNECTIONS, p_connection->receive.p_data, 0);
+                mutex_destroy(&p_connection->_send_lock);
+                mutex_destroy(&p_connection->pending._lock);
+                p_connection = key_value_memory_allocator(KEY_VALUE_MEMORY_CONNECTIONS, p_connection, 0);
+            }
+
+            // give back the reservation
+            mutex_lock(&p_key_value_db->_lock);
+            p_key_value_db->admission.connections--;
+            mutex_unlock(&p_key_value_db->_lock);
+
+            // close the socket
+            socket_tcp_destroy(&_socket_tcp);
+
+            // error
+            return 0;
+    }
+}
+
+int key_value_db_server_accept ( socket_tcp _socket_tcp, socket_ip_address ip_address, socket_port port_number, key_value_db *p_key_value_db )
+{
+
+    // done
+    return key_value_db_server_admit(_socket_tcp, ip_address, port_number, false, p_key_value_db);
+}
+
+void key_value_db_reap ( key_value_db *p_key_value_db )
+{
+
+    // lock
+    mutex_lock(&p_key_value_db->_lock);
+
+    // release each finished connection
+    for (key_value_connection **pp_connection = &p_key_value_db->network.p_connections; *pp_connection; )
+    {
+
+        // initialized data
+        key_value_connection *p_connection = *pp_connection;
+
+        // still serving
+        if ( false == p_connection->finished )
+        {
+            pp_connection = &p_connection->p_next;
+            continue;
+        }
+
+        // remove the connection from the list
+        *pp_connection = p_connection->p_next;
+
+        // the thread has nothing left to do but return
+        parallel_thread_join(&p_connection->p_thread);
+
+        // release the rings
+        #ifndef _WIN64
+            if ( p_connection->shm.p_region )
+                ring_destroy(&p_connection->shm.p_requests),
+                ring_destroy(&p_connection->shm.p_responses),
+                munmap(p_connection->shm.p_region, p_connection->shm.size);
+        #endif
+
+        // release the connection
+        socket_tcp_destroy(&p_connection->_socket);
+        mutex_destroy(&p_connection->_send_lock);
+        mutex_destroy(&p_connection->pending._lock);
+        p_connection->receive.p_data = key_value_memory_allocator(KEY_VALUE_MEMORY_CONNECTIONS, p_connection->receive.p_data, 0);
+        p_connection = key_value_memory_allocator(KEY_VALUE_MEMORY_CONNECTIONS, p_connection, 0);
+    }
+
+    // unlock
+    mutex_unlock(&p_key_value_db->_lock);
+
+    // done
+    return;
+}
+
+int key_value_db_listener ( key_value_db *p_key_value_db )
+{
+
+    // log a message
+    log_info("[key value db] Listening for incoming connections...\n");
+
+    // listen for incoming connections
+    while ( p_key_value_db->running )
+    {
+
+        // release finished connections
+        key_value_db_reap(p_key_value_db);
+
+        // accept the next connection
+        socket_tcp_listen(p_key_value_db->network._socket, (fn_socket_tcp_accept *)key_value_db_server_accept, p_key_value_db);
+    }
+
+    // success
+    return 1;
+}
+
+#ifndef _WIN64
+int key_value_db_unix_listener ( key_value_db *p_key_value_db )
+{
+
+    // initialized data
+    struct sockaddr_un _address = { .sun_family = AF_UNIX };
+    struct timespec    _backoff = { .tv_sec = 0, .tv_nsec = KEY_VALUE_DB_TICK_MS * 1000000 };
+
+    // bind the socket, replacing the one a previous server left behind
+    strncpy(_address.sun_path, KEY_VALUE_DB_UNIX_SOCKET, sizeof(_address.sun_path) - 1);
+    unlink(KEY_VALUE_DB_UNIX_SOCKET);
+    p_key_value_db->network.unix_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if ( p_key_value_db->network.unix_socket < 0 ) goto failed_to_listen;
+    if ( bind(p_key_value_db->network.unix_socket, (struct sockaddr *) &_address, sizeof(_address)) ) goto failed_to_listen;
+    if ( listen(p_key_value_db->network.unix_socket, 128) ) goto failed_to_listen;
+
+    // log a message
+    log_info("[key value db] Listening for local connections on %s\n", KEY_VALUE_DB_UNIX_SOCKET);
+
+    // listen for local connections
+    while ( p_key_value_db->running )
+    {
+
+        // initialized data
+        int descriptor = accept(p_key_value_db->network.unix_socket, NULL, NULL);
+
+        // error check
+        if ( descriptor < 0 )
+        {
+
+            // the socket was closed, or can not accept anymore
+            if ( EBADF == errno || EINVAL == errno || ENOTSOCK == errno ) break;
+
+            // out of descriptors, or memory. release finished connections, and wait, instead of spinning
+            if ( EMFILE == errno || ENFILE == errno || ENOBUFS == errno || ENOMEM == errno )
+                key_value_db_reap(p_key_value_db),
+                nanosleep(&_backoff, NULL);
+
+            // try again
+            continue;
+        }
+
+        // release finished connections
+        key_value_db_reap(p_key_value_db);
+
+        // serve the connection. a local client has no address
+        key_value_db_server_admit((socket_tcp) descriptor, 0, 0, true, p_key_value_db);
+    }
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // standard library errors
+        {
+            failed_to_listen:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to listen on \"%s\" in call to function \"%s\"\n", KEY_VALUE_DB_UNIX_SOCKET, __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+#endif
+
+int key_value_db_create ( key_value_db **pp_key_value_db, const char *p_directory, bool embedded )
+{
+
+    // argument check
+    if ( NULL == pp_key_value_db ) goto no_key_value_db;
+
+    // initialized data
+    key_value_db *p_key_value_db = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, 0, sizeof(key_value_db));
+
+    // error check
+    if ( NULL == p_key_value_db ) goto no_mem;
+
+    // initialize the database
+    memset(p_key_value_db, 0, sizeof(key_value_db));
+
+    // the files are kept in the directory, or in the working directory
+    if ( false == key_value_db_path(p_key_value_db->paths._snapshot, p_directory, KEY_VALUE_DB_SNAPSHOT)   ||
+         false == key_value_db_path(p_key_value_db->paths._hot_set,  p_directory, KEY_VALUE_DB_HOT_SET)    ||
+         false == key_value_db_path(p_key_value_db->paths._lsm,      p_directory, KEY_VALUE_DB_LSM_DIRECTORY) ) goto directory_too_long;
+
+    // choose the widest tokenizer the processor supports
+    tokenizer_init();
+
+    // construct database stuff
+    {
+
+        // construct a lock
+        mutex_create(&p_key_value_db->_lock);
+
+        // construct a front cache
+        front_cache_construct
+        (
+            &p_key_value_db->p_front_cache, 
+            KEY_VALUE_DB_CACHE_CAPACITY,
+            KEY_VALUE_DB_CACHE_BUDGET
+        );
+
+        // construct an index
+        if ( 0 == b_plus_tree_construct(&p_key_value_db->p_index, (fn_b_plus_tree_key *) key_value_property_key_accessor) ) goto failed_to_construct_index;
+
+        // construct a timing wheel
+        timing_wheel_construct(&p_key_value_db->p_timing_wheel, key_value_db_monotonic_ms() / KEY_VALUE_DB_TICK_MS);
+
+        // construct a version store
+        mvcc_construct(&p_key_value_db->p_mvcc);
+
+        // back the keyspace with tables, if a previous run did, and carry on its commit
+        // sequence. serving without tables that can not be opened would lose their keys
+        if ( lsm_exists(p_key_value_db->paths._lsm) )
+        {
+            if ( 0 == lsm_construct(&p_key_value_db->storage.p_lsm, p_key_value_db->paths._lsm, KEY_VALUE_DB_BLOCK_CACHE) ) goto failed_to_open_tables;
+            p_key_value_db->sequence = lsm_sequence(p_key_value_db->storage.p_lsm);
+        }
+
+        // construct a negative lookup filter, with the keys in the tables
+        key_value_db_filter_build(p_key_value_db, KEY_VALUE_DB_FILTER_CAPACITY);
+
+        // slow log
+        p_key_value_db->slowlog.threshold    = KEY_VALUE_DB_SLOWLOG_THRESHOLD,
+        p_key_value_db->slowlog.ticks_per_us = key_value_db_ticks_per_us();
+
+        // admission limits
+        p_key_value_db->admission.max_connections = KEY_VALUE_DB_MAX_CONNECTIONS,
+        p_key_value_db->admission.max_in_flight   = KEY_VALUE_DB_MAX_IN_FLIGHT;
+
+        // memory limit
+        p_key_value_db->memory.max    = KEY_VALUE_DB_MAXMEMORY,
+        p_key_value_db->memory.policy = EVICTION_POLICY_LRU,
+        p_key_value_db->memory.random = key_value_db_time_ms() | 1;
+    }
+
+    // restore the previous run, before accepting traffic
+    {
+
+        // load the snapshot. the tables already hold everything, if there are tables
+        if ( NULL == p_key_value_db->storage.p_lsm ) key_value_db_snapshot_load(p_key_value_db, p_key_value_db->paths._snapshot);
+
+        // prefetch the hot set into the index, and the cache
+        key_value_db_hot_set_load(p_key_value_db, p_key_value_db->paths._hot_set);
+
+        // the restore is not traffic
+        memset(&p_key_value_db->counter, 0, sizeof(p_key_value_db->counter));
+        p_key_value_db->last_request = key_value_db_time_ms();
+
+        // track hot keys from here on
+        hot_keys_construct(&p_key_value_db->hot_keys.p_reads, KEY_VALUE_DB_HOT_KEYS_HALF_LIFE, p_key_value_db->last_request);
+        hot_keys_construct(&p_key_value_db->hot_keys.p_writes, KEY_VALUE_DB_HOT_KEYS_HALF_LIFE, p_key_value_db->last_request);
+    }
+
+    // set the running flag
+    p_key_value_db->running  = true,
+    p_key_value_db->embedded = embedded;
+
+    // construct a cron thread
+    parallel_thread_start(&p_key_value_db->p_cron, (fn_parallel_task *)key_value_db_cron, p_key_value_db);
+
+    // construct a shutdown thread
+    parallel_thread_start(&p_key_value_db->p_shutdown, (fn_parallel_task *)key_value_db_shutdown, p_key_value_db);
+
+    // construct networking stuff, unless the caller's process is the only client
+    if ( false == embedded )
+    {
+        
+        // construct a thread pool
+        thread_pool_construct(&p_key_value_db->network.p_thread_pool, 4);
+
+        // construct a socket
+        socket_tcp_create(&p_key_value_db->network._socket, socket_address_family_ipv4, 6713);
+
+        // construct a listener thread
+        parallel_thread_start(&p_key_value_db->network.p_listener_thread, (fn_parallel_task *)key_value_db_listener, p_key_value_db);
+
+        // construct a listener thread for local clients
+        #ifndef _WIN64
+            parallel_thread_start(&p_key_value_db->network.p_unix_thread, (fn_parallel_task *)key_value_db_unix_listener, p_key_value_db);
+        #endif
+    }
+
+    // return a pointer to the caller
+    *pp_key_value_db = p_key_value_db;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"pp_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            failed_to_construct_key_sets:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to construct key sets in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            directory_too_long:
+                #ifndef NDEBUG
+                    log_error("[key value db] Parameter \"p_directory\" is too long in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // release the database
+                p_key_value_db = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_key_value_db, 0);
+
+                // error
+                return 0;
+        }
+
+        // storage errors
+        {
+            failed_to_open_tables:
+                log_error("[key value db] Failed to open the tables in \"%s\" in call to function \"%s\"\n", p_key_value_db->paths._lsm, __FUNCTION__);
+
+                // release the database
+                key_value_db_release(p_key_value_db);
+
+                // error
+                return 0;
+        }
+
+        // index errors
+        {
+            failed_to_construct_index:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to construct index in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // release the database
+                key_value_db_release(p_key_value_db);
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_construct ( key_value_db **pp_key_value_db )
+{
+
+    // a server, in its working directory
+    return key_value_db_create(pp_key_value_db, NULL, false);
+}
+
+int key_value_db_open ( key_value_db **pp_key_value_db, const char *p_directory )
+{
+
+    // a database in the caller's process
+    return key_value_db_create(pp_key_value_db, p_directory, true);
+}
+
+void key_value_db_stop ( key_value_db *p_key_value_db )
+{
+
+    // the shutdown thread notices on its next tick
+    if ( p_key_value_db ) p_key_value_db->stopping = 1;
+
+    // done
+    return;
+}
+
+int key_value_db_wait ( key_value_db *p_key_value_db )
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+
+    // wait for the shutdown thread, unless a previous wait already did
+    if ( p_key_value_db->p_shutdown ) parallel_thread_join(&p_key_value_db->p_shutdown);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_close ( key_value_db **pp_key_value_db )
+{
+
+    // argument check
+    if ( NULL ==  pp_key_value_db ) goto no_key_value_db;
+    if ( NULL == *pp_key_value_db ) goto no_key_value_db;
+
+    // initialized data
+    key_value_db *p_key_value_db = *pp_key_value_db;
+
+    // a server's listeners run until its process exits
+    if ( false == p_key_value_db->embedded ) goto not_embedded;
+
+    // no more pointer for caller
+    *pp_key_value_db = NULL;
+
+    // write the snapshot, or flush the tables, and wait for the shutdown thread
+    key_value_db_stop(p_key_value_db);
+    key_value_db_wait(p_key_value_db);
+
+    // the cron thread stops with the running flag
+    if ( p_key_value_db->p_cron ) parallel_thread_join(&p_key_value_db->p_cron);
+
+    // release the database
+    key_value_db_release(p_key_value_db);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"pp_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            not_embedded:
+                #ifndef NDEBUG
+                    log_error("[key value db] Only a database opened with key_value_db_open can be closed, in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_info
+( 
+    key_value_db *p_key_value_db, 
+    
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    front_cache_statistics  _cache_stats = { 0 };
+    lsm_statistics          _lsm_stats   = { 0 };
+    dictionary_statistics   _dict_stats  = { 0 };
+    b_plus_tree_statistics  _index_stats = { 0 };
+    mvcc_snapshot           _snapshots[MVCC_SNAPSHOT_MAX];
+
+    // logs
+    log_info("[key value db] [info]\n");
+
+    // get the shape of the index
+    b_plus_tree_statistics_get(p_key_value_db->p_index, &_index_stats);
+
+    // get the compression statistics
+    dictionary_statistics_get(&_dict_stats);
+
+    // get the cache statistics
+    front_cache_statistics_get(p_key_value_db->p_front_cache, &_cache_stats);
+
+    // get the table statistics
+    if ( p_key_value_db->storage.p_lsm ) lsm_statistics_get(p_key_value_db->storage.p_lsm, &_lsm_stats);
+
+    // serialize the response
+    *p_response_len = 1 + sprintf(p_response,  
+        "{\"okay\":true,\"value\":{\"get\":%zu,\"set\":%zu,\"del\":%zu,\"err\":%zu,\"keys\":%zu,\"expires\":%zu,\"expired\":%zu,"
+        "\"used_memory\":%zu,\"maxmemory\":%zu,\"maxmemory_policy\":\"%s\",\"evicted_keys\":%zu,\"evicted_bytes\":%zu,"
+        "\"cache_hits\":%zu,\"cache_misses\":%zu,\"cache_admitted\":%zu,\"cache_rejected\":%zu,\"cache_evicted\":%zu,"
+        "\"cache_size\":%zu,\"cache_capacity\":%zu,\"cache_window\":%zu,\"tokenizer\":\"%s\",\"buffer_allocations\":%zu,"
+        "\"connections\":%zu,\"rejected_connections\":%zu,\"rejected_in_flight\":%zu,\"rejected_queue_delay\":%zu,"
+        "\"storage\":\"%s\",\"lsm_tables\":%zu,\"lsm_bytes\":%zu,\"lsm_dirty\":%zu,\"lsm_flushes\":%zu,\"lsm_compactions\":%zu,"
+        "\"lsm_bloom_skips\":%zu,\"block_cache_hits\":%zu,\"block_cache_misses\":%zu,"
+        "\"get_misses\":%zu,\"miss_rate\":%.4f,\"filter_rejections\":%zu,\"filter_false_positives\":%zu,"
+        "\"filter_false_positive_rate\":%.4f,\"filter_keys\":%zu,\"filter_capacity\":%zu,"
+        "\"compression\":\"%s\",\"dictionary_bytes\":%zu,\"packed_values\":%zu,\"packed_raw_bytes\":%zu,\"packed_bytes\":%zu,"
+        "\"compression_ratio\":%.2f,\"compressions\":%llu,\"compress_ns\":%llu,\"decompressions\":%llu,\"decompress_ns\":%llu,"
+        "\"sequence\":%llu,\"snapshots\":%zu,\"versions\":%zu,"
+        "\"index_height\":%zu,\"index_leaves\":%zu,\"index_inners\":%zu,\"index_fill\":%.2f}}",
+
+        p_key_value_db->counter.request.get,
+        p_key_value_db->counter.request.set,
+        p_key_value_db->counter.request.del,
+        p_key_value_db->counter.request.err,
+        p_key_value_db->keyspace.count,
+        timing_wheel_count(p_key_value_db->p_timing_wheel),
+        p_key_value_db->counter.expired,
+        p_key_value_db->memory.used,
+        p_key_value_db->memory.max,
+        eviction_policy_name(p_key_value_db->memory.policy),
+        p_key_value_db->counter.evicted.keys,
+        p_key_value_db->counter.evicted.bytes,
+        _cache_stats.hits,
+        _cache_stats.misses,
+        _cache_stats.admitted,
+        _cache_stats.rejected,
+        _cache_stats.evicted,
+        _cache_stats.size,
+        _cache_stats.capacity,
+        _cache_stats.window,
+        tokenizer_implementation(),
+        __atomic_load_n(&p_key_value_db->counter.buffer_allocations, __ATOMIC_RELAXED),
+        p_key_value_db->admission.connections,
+        p_key_value_db->counter.rejected.connections,
+        p_key_value_db->counter.rejected.in_flight,
+        p_key_value_db->counter.rejected.queue_delay,
+        ( p_key_value_db->storage.p_lsm ) ? "lsm" : "memory",
+        _lsm_stats.tables,
+        _lsm_stats.bytes,
+        p_key_value_db->storage.dirty,
+        _lsm_stats.flushes,
+        _lsm_stats.compactions,
+        _lsm_stats.bloom_skips,
+        _lsm_stats.block_hits,
+        _lsm_stats.block_misses,
+        p_key_value_db->counter.miss.gets,
+        ( p_key_value_db->counter.request.get ) ? (double) p_key_value_db->counter.miss.gets / (double) p_key_value_db->counter.request.get : 0.0,
+        p_key_value_db->counter.miss.filtered,
+        p_key_value_db->counter.miss.false_positives,
+        ( p_key_value_db->counter.miss.gets ) ? (double) p_key_value_db->counter.miss.false_positives / (double) p_key_value_db->counter.miss.gets : 0.0,
+        cuckoo_filter_count(p_key_value_db->p_filter),
+        cuckoo_filter_capacity(p_key_value_db->p_filter),
+        ( p_key_value_db->compression.p_dictionary ) ? "on" : "off",
+        dictionary_length(p_key_value_db->compression.p_dictionary),
+        _dict_stats.values,
+        _dict_stats.raw_bytes,
+        _dict_stats.packed_bytes,
+        ( _dict_stats.packed_bytes ) ? (double) _dict_stats.raw_bytes / (double) _dict_stats.packed_bytes : 1.0,
+        _dict_stats.compressions,
+        ( _dict_stats.compressions ) ? _dict_stats.compress_ns / _dict_stats.compressions : 0,
+        _dict_stats.decompressions,
+        ( _dict_stats.decompressions ) ? _dict_stats.decompress_ns / _dict_stats.decompressions : 0,
+        p_key_value_db->sequence,
+        mvcc_snapshots(p_key_value_db->p_mvcc, _snapshots),
+        mvcc_count(p_key_value_db->p_mvcc),
+        _index_stats.height,
+        _index_stats.leaves,
+        _index_stats.inners,
+        ( _index_stats.leaves ) ? (double) _index_stats.count / (double) ( _index_stats.leaves * B_PLUS_TREE_FANOUT ) : 0.0
+    );
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_info_hot_keys
+( 
+    key_value_db *p_key_value_db, 
+    
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    hot_keys_entry      _entries[HOT_KEYS_TOP] = { 0 };
+    hot_keys           *p_trackers[2]          = { p_key_value_db->hot_keys.p_reads, p_key_value_db->hot_keys.p_writes };
+    const char         *p_names[2]             = { "reads", "writes" };
+    unsigned long long  now                    = key_value_db_time_ms();
+    size_t              length                 = 0;
+
+    // logs
+    log_info("[key value db] [info] hotkeys\n");
+
+    // serialize the response
+    length += (size_t) sprintf(p_response + length, "{\"okay\":true,\"value\":{");
+
+    // each tracker
+    for (size_t t = 0; t < 2; t++)
+    {
+
+        // initialized data
+        size_t count = hot_keys_top(p_trackers[t], _entries, now);
+
+        // hottest first
+        length += (size_t) sprintf(p_response + length, "%s\"%s\":[", ( t ) ? "," : "", p_names[t]);
+        for (size_t i = 0; i < count; i++)
+        {
+
+            // the response is full. leave room for the rest of the trackers
+            if ( length + 6 * strlen(_entries[i]._key) + KEY_VALUE_DB_HOT_KEYS_ENTRY > KEY_VALUE_DB_RESPONSE_MAX - KEY_VALUE_DB_HOT_KEYS_ENTRY ) break;
+
+            // the key, escaped
+            length += (size_t) sprintf(p_response + length, "%s{\"key\":\"", ( i ) ? "," : "");
+            length += key_value_db_escape(p_response + length, _entries[i]._key);
+            length += (size_t) sprintf(p_response + length, "\",\"count\":%llu,\"rate\":%.2f}", _entries[i].count, _entries[i].rate);
+        }
+        length += (size_t) sprintf(p_response + length, "]");
+    }
+
+    // done
+    length += (size_t) sprintf(p_response + length, "}}");
+    *p_response_len = length;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_info_memory
+( 
+    key_value_db *p_key_value_db, 
+    
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    key_value_memory_usage _usage[KEY_VALUE_MEMORY_QUANTITY] = { 0 };
+    size_t                 keys       = p_key_value_db->keyspace.count,
+                           resident   = key_value_memory_resident(),
+                           tracked    = 0,
+                           overhead   = 0,
+                           per_key    = 0,
+                           length     = 0;
+
+    // logs
+    log_info("[key value db] [info] memory\n");
+
+    // total each subsystem
+    for (size_t tag = 0; tag < KEY_VALUE_MEMORY_QUANTITY; tag++)
+    {
+        key_value_memory_usage_get((key_value_memory_tag) tag, &_usage[tag]);
+        tracked  += _usage[tag].bytes,
+        overhead += _usage[tag].overhead;
+    }
+
+    // the structures each key needs, besides an out of line value
+    per_key += _usage[KEY_VALUE_MEMORY_PROPERTIES].bytes + _usage[KEY_VALUE_MEMORY_PROPERTIES].overhead +
+               _usage[KEY_VALUE_MEMORY_KEYSPACE].bytes   + _usage[KEY_VALUE_MEMORY_KEYSPACE].overhead   +
+               _usage[KEY_VALUE_MEMORY_CACHE].bytes      + _usage[KEY_VALUE_MEMORY_CACHE].overhead      +
+               _usage[KEY_VALUE_MEMORY_FILTER].bytes     + _usage[KEY_VALUE_MEMORY_FILTER].overhead     +
+               _usage[KEY_VALUE_MEMORY_INDEX].bytes      + _usage[KEY_VALUE_MEMORY_INDEX].overhead;
+
+    // serialize the totals. the ratio is above 1 by the memory the process
+    // holds outside of its allocations, or the allocator holds on to
+    length += (size_t) sprintf(p_response + length,
+        "{\"okay\":true,\"value\":{"
+            "\"resident\":%zu,"
+            "\"tracked\":%zu,"
+            "\"overhead\":%zu,"
+            "\"untracked\":%zu,"
+            "\"internal_fragmentation\":%.4f,"
+            "\"fragmentation_ratio\":%.2f,"
+            "\"keys\":%zu,"
+            "\"per_key_overhead\":%.1f,"
+            "\"value_bytes_per_key\":%.1f,"
+            "\"subsystems\":{",
+        resident,
+        tracked,
+        overhead,
+        ( resident > tracked + overhead ) ? resident - tracked - overhead : 0,
+        ( tracked + overhead ) ? (double) overhead / (double) ( tracked + overhead ) : 0.0,
+        ( tracked + overhead && resident ) ? (double) resident / (double) ( tracked + overhead ) : 0.0,
+        keys,
+        ( keys ) ? (double) per_key / (double) keys : 0.0,
+        ( keys ) ? (double) _usage[KEY_VALUE_MEMORY_VALUES].bytes / (double) keys : 0.0
+    );
+
+    // each subsystem
+    for (size_t tag = 0; tag < KEY_VALUE_MEMORY_QUANTITY; tag++)
+        length += (size_t) sprintf(p_response + length,
+            "%s\"%s\":{\"bytes\":%zu,\"objects\":%zu,\"overhead\":%zu,\"allocations\":%llu}",
+            ( tag ) ? "," : "",
+            key_value_memory_tag_name((key_value_memory_tag) tag),
+            _usage[tag].bytes,
+            _usage[tag].objects,
+            _usage[tag].overhead,
+            _usage[tag].allocations
+        );
+
+    // close the subsystems, the value, and the response
+    length += (size_t) sprintf(p_response + length, "}}}");
+    *p_response_len = length;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_slowlog
+( 
+    key_value_db *p_key_value_db, 
+    char         *p_argument,
+    
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    size_t quantity = KEY_VALUE_DB_SLOWLOG_REPLY,
+           length   = 0;
+
+    // logs
+    log_info("[key value db] [slowlog]\n");
+
+    // forget every slow request
+    if ( p_argument && 0 == strcmp(p_argument, "reset") )
+    {
+        p_key_value_db->slowlog.count = 0;
+
+        // serialize the response
+        *p_response_len = sprintf(p_response, "{\"okay\":true}");
+
+        // success
+        return 1;
+    }
+
+    // the newest requests. each one takes a few hundred bytes of the response
+    if ( p_argument ) quantity = strtoull(p_argument, NULL, 10);
+    if ( quantity > KEY_VALUE_DB_SLOWLOG_REPLY     ) quantity = KEY_VALUE_DB_SLOWLOG_REPLY;
+    if ( quantity > p_key_value_db->slowlog.count ) quantity = p_key_value_db->slowlog.count;
+
+    // serialize the response, newest first
+    length += (size_t) sprintf(p_response + length, "{\"okay\":true,\"value\":[");
+    for (size_t i = 0; i < quantity; i++)
+    {
+
+        // initialized data
+        key_value_db_slow_request *p_request = &p_key_value_db->slowlog._requests[( p_key_value_db->slowlog.next + KEY_VALUE_DB_SLOWLOG_MAX - 1 - i ) % KEY_VALUE_DB_SLOWLOG_MAX];
+
+        // the request
+        length += (size_t) sprintf(p_response + length, 
+            "%s{\"id\":%llu,\"time\":%llu,\"command\":\"%s\",\"key\":\"%s\",\"client\":\"%hhu.%hhu.%hhu.%hhu:%hu\",\"total_us\":%llu",
+            ( i ) ? "," : "",
+            p_request->id,
+            p_request->time,
+            p_request->_command,
+            p_request->_key,
+            (p_request->ip_address >> 24) & 0xFF, 
+            (p_request->ip_address >> 16) & 0xFF, 
+            (p_request->ip_address >>  8) & 0xFF, 
+            (p_request->ip_address >>  0) & 0xFF, 
+            p_request->port_number,
+            p_request->total
+        );
+
+        // the stages
+        for (size_t j = 0; j < KEY_VALUE_DB_STAGE_QUANTITY; j++)
+            length += (size_t) sprintf(p_response + length, ",\"%s_us\":%llu", _key_value_db_stage_names[j], p_request->_stages[j]);
+
+        length += (size_t) sprintf(p_response + length, "}");
+    }
+
+    // done
+    length += (size_t) sprintf(p_response + length, "]}");
+    *p_response_len = length;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_write
+( 
+    key_value_db *p_key_value_db, 
+    
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    size_t keys     = 0,
+           hot_keys = 0;
+
+    // logs
+    log_info("[key value db] [write]\n");
+
+    // write the snapshot, or flush the memtable to the tables, and the hot set
+    if ( p_key_value_db->storage.p_lsm )
+    {
+        if ( 0 == key_value_db_flush(p_key_value_db, &keys) ) goto failed_to_write;
+    }
+    else if ( 0 == key_value_db_snapshot_write(p_key_value_db, p_key_value_db->paths._snapshot, &keys) ) goto failed_to_write;
+    if ( 0 == key_value_db_hot_set_write(p_key_value_db, p_key_value_db->paths._hot_set, &hot_keys) ) goto failed_to_write;
+
+    // serialize the response
+    *p_response_len = sprintf(p_response, "{\"okay\":true,\"value\":{\"keys\":%zu,\"hot\":%zu}}", keys, hot_keys);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            failed_to_write:
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+secondary_index *key_value_db_index_get ( key_value_db *p_key_value_db, const char *p_name, size_t *p_i )
+{
+
+    // search the indexes
+    for (size_t i = 0; i < p_key_value_db->indexes.count; i++)
+    {
+        if ( strcmp(secondary_index_name(p_key_value_db->indexes._indexes[i]), p_name) ) continue;
+        if ( p_i ) *p_i = i;
+        return p_key_value_db->indexes._indexes[i];
+    }
+
+    // not an index
+    return NULL;
+}
+
+size_t key_value_db_index_describe ( secondary_index *p_index, char *p_buffer )
+{
+
+    // done
+    return (size_t) sprintf(p_buffer, "{\"name\":\"%s\",\"pattern\":\"%s\",\"path\":\"%s\",\"keys\":%zu}",
+        secondary_index_name(p_index),
+        secondary_index_pattern(p_index),
+        secondary_index_path(p_index),
+        secondary_index_count(p_index)
+    );
+}
+
+bool key_value_db_index_text ( const char *p_text )
+{
+
+    // the definition is echoed in responses, without escapes
+    for (; *p_text; p_text++) if ( '"' == *p_text || '\\' == *p_text || (unsigned char) *p_text < 0x20 ) return false;
+
+    // done
+    return true;
+}
+
+int key_value_db_process_index
+( 
+    key_value_db *p_key_value_db, 
+    const char   *p_name,
+    const char   *p_pattern,
+    const char   *p_path,
+    
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    secondary_index *p_index = NULL;
+    size_t           length  = 0,
+                     i       = 0;
+
+    // logs
+    log_info("[key value db] [index] \"%s\"\n", ( p_name ) ? p_name : "");
+
+    // list every index
+    if ( NULL == p_name )
+    {
+        length += (size_t) sprintf(p_response, "{\"okay\":true,\"value\":[");
+        for (i = 0; i < p_key_value_db->indexes.count; i++)
+            length += (size_t) sprintf(p_response + length, "%s", ( i ) ? "," : ""),
+            length += key_value_db_index_describe(p_key_value_db->indexes._indexes[i], p_response + length);
+        length += (size_t) sprintf(p_response + length, "]}");
+
+        // done
+        goto done;
+    }
+
+    // drop an index
+    if ( 0 == strcmp(p_name, "drop") )
+    {
+
+        // error check
+        if ( NULL == p_pattern || p_path ) goto bad_definition;
+        if ( NULL == ( p_index = key_value_db_index_get(p_key_value_db, p_pattern, &i) ) ) goto no_such_index;
+
+        // swap the last index into the hole
+        p_key_value_db->indexes._indexes[i] = p_key_value_db->indexes._indexes[--p_key_value_db->indexes.count];
+        secondary_index_destroy(&p_index);
+
+        // serialize the response
+        length = (size_t) sprintf(p_response, "{\"okay\":true,\"value\":%zu}", p_key_value_db->indexes.count);
+
+        // done
+        goto done;
+    }
+
+    // describe an index
+    if ( NULL == p_pattern )
+    {
+
+        // error check
+        if ( NULL == ( p_index = key_value_db_index_get(p_key_value_db, p_name, NULL) ) ) goto no_such_index;
+
+        // done
+        goto describe;
+    }
+
+    // error check
+    if ( NULL == p_path                                                  ) goto bad_definition;
+    if ( false == key_value_db_index_text(p_name)                        ) goto bad_definition;
+    if ( false == key_value_db_index_text(p_pattern)                     ) goto bad_definition;
+    if ( false == key_value_db_index_text(p_path)                        ) goto bad_definition;
+    if ( key_value_db_index_get(p_key_value_db, p_name, NULL)            ) goto index_exists;
+    if ( KEY_VALUE_DB_INDEX_MAX == p_key_value_db->indexes.count         ) goto too_many_indexes;
+
+    // define the index
+    if ( 0 == secondary_index_construct(&p_index, p_name, p_pattern, p_path) ) goto bad_definition;
+
+    // index the keys that are already stored
+    if ( 0 == key_value_db_index_backfill(p_key_value_db, p_index) ) goto failed_to_backfill;
+
+    // every write from here on keeps it up to date
+    p_key_value_db->indexes._indexes[p_key_value_db->indexes.count++] = p_index;
+
+    describe:
+
+    // serialize the response
+    length += (size_t) sprintf(p_response, "{\"okay\":true,\"value\":");
+    length += key_value_db_index_describe(p_index, p_response + length);
+    length += (size_t) sprintf(p_response + length, "}");
+
+    done:
+
+    // store the length
+    *p_response_len = length;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            bad_definition:
+                #ifndef NDEBUG
+                    log_error("[key value db] Bad index definition in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            no_such_index:
+                #ifndef NDEBUG
+                    log_error("[key value db] No such index in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            index_exists:
+                #ifndef NDEBUG
+                    log_error("[key value db] Index \"%s\" already exists in call to function \"%s\"\n", p_name, __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            too_many_indexes:
+                #ifndef NDEBUG
+                    log_error("[key value db] Too many indexes in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            failed_to_backfill:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to read the tables in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // release the index
+                secondary_index_destroy(&p_index);
+
+                // done
+                goto failed;
+
+            failed:
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+size_t key_value_db_escape ( char *p_buffer, const char *p_key )
+{
+
+    // initialized data
+    size_t length = 0;
+
+    // copy the key, escaping it. each character takes at most 6 bytes
+    for (; *p_key; p_key++)
+    {
+        if      ( '"' == *p_key || '\\' == *p_key ) p_buffer[length++] = '\\', p_buffer[length++] = *p_key;
+        else if ( (unsigned char) *p_key < 0x20 )   length += (size_t) sprintf(p_buffer + length, "\\u%04x", (unsigned char) *p_key);
+        else                                        p_buffer[length++] = *p_key;
+    }
+
+    // done
+    return length;
+}
+
+int key_value_db_find_key ( const char *p_key, void *p_parameter )
+{
+
+    // initialized data
+    key_value_db_find *p_find = p_parameter;
+
+    // before the offset
+    if ( p_find->skip ) { p_find->skip--; return 1; }
+
+    // the response is full. the key is counted, and the client asks again from here
+    if ( p_find->length + 6 * strlen(p_key) + 4 > KEY_VALUE_DB_FIND_MAX ) { p_find->more = true; return 0; }
+
+    // open the string
+    p_find->length += (size_t) sprintf(p_find->p_response + p_find->length, "%s\"", ( p_find->found++ ) ? "," : "");
+
+    // copy the key, escaping it
+    p_find->length += key_value_db_escape(p_find->p_response + p_find->length, p_key);
+
+    // close the string
+    p_find->p_response[p_find->length++] = '"';
+
+    // done
+    return 1;
+}
+
+int key_value_db_process_find
+( 
+    key_value_db *p_key_value_db, 
+    const char   *p_name,
+    char         *p_value,
+    size_t        offset,
+    
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==         p_name ) goto no_name;
+    if ( NULL ==        p_value ) goto no_value;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    secondary_index   *p_index = key_value_db_index_get(p_key_value_db, p_name, NULL);
+    key_value_db_find  _find   = { .p_response = p_response, .skip = offset };
+    size_t             length  = 0;
+    unsigned char      type    = 0;
+
+    // logs
+    log_info("[key value db] [find] \"%s\" %s\n", p_name, p_value);
+
+    // error check
+    if ( NULL == p_index ) goto no_such_index;
+
+    // indexed values are minified, so the value is too
+    if ( 0 == json_path_minify(p_value, strlen(p_value), &length, &type) ) goto bad_value;
+
+    // the lookup starts
+    key_value_db_slowlog_mark(&p_key_value_db->slowlog.lookup);
+
+    // collect the keys
+    _find.length = (size_t) sprintf(p_response, "{\"okay\":true,\"value\":[");
+    secondary_index_find(p_index, p_value, length, key_value_db_find_key, &_find);
+
+    // a full response says where the next one starts
+    if ( _find.more ) _find.length += (size_t) sprintf(p_response + _find.length, "],\"next\":%zu}", offset + _find.found);
+    else              _find.length += (size_t) sprintf(p_response + _find.length, "]}");
+    *p_response_len = _find.length;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_name:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_name\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_value:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_value\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            no_such_index:
+                #ifndef NDEBUG
+                    log_error("[key value db] No such index \"%s\" in call to function \"%s\"\n", p_name, __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            bad_value:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to parse find value in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            failed:
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_watch
+( 
+    key_value_db *p_key_value_db, 
+    char         *p_prefix,
+    
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==       p_prefix ) goto no_prefix;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    key_value_connection *p_connection = p_key_value_db->network.p_current;
+
+    // logs
+    log_info("[key value db] [watch] \"%s\"\n", p_prefix);
+
+    // error check
+    if ( NULL == p_connection                                          ) goto no_connection;
+    if ( KEY_VALUE_DB_WATCH_MAX == p_connection->watch.count           ) goto too_many_watches;
+    if ( strlen(p_prefix) >= sizeof(p_connection->watch._prefixes[0])  ) goto prefix_too_long;
+
+    // store the prefix
+    strcpy(p_connection->watch._prefixes[p_connection->watch.count++], p_prefix);
+
+    // serialize the response
+    *p_response_len = sprintf(p_response, "{\"okay\":true,\"value\":%zu}", p_connection->watch.count);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_prefix:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_prefix\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            no_connection:
+                #ifndef NDEBUG
+                    log_error("[key value db] Watch requested outside of a connection in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            too_many_watches:
+                #ifndef NDEBUG
+                    log_error("[key value db] A connection may watch at most %d prefixes in call to function \"%s\"\n", KEY_VALUE_DB_WATCH_MAX, __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            prefix_too_long:
+                #ifndef NDEBUG
+                    log_error("[key value db] Prefix \"%s\" is too long in call to function \"%s\"\n", p_prefix, __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            failed:
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_respond_value
+(
+    key_value_db          *p_key_value_db,
+    const char            *p_prefix,
+    const key_value_value *p_value,
+    size_t                 offset,
+    size_t                 length,
+
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // initialized data
+    size_t      prefix_length = strlen(p_prefix),
+                text_length   = 0;
+    const char *p_buffer      = NULL;
+
+    // serialization starts
+    key_value_db_slowlog_mark(&p_key_value_db->slowlog.serialize);
+
+    // write the prefix
+    memcpy(p_response, p_prefix, prefix_length);
+
+    // large fragments are sent from the stored buffer, and the sender closes the object
+    if
+    (
+        length >= KEY_VALUE_DB_ATTACH_MIN                &&
+        false == p_key_value_db->batching                &&
+        NULL  == p_key_value_db->attachment.p_buffer     &&
+        NULL  != ( p_buffer = key_value_value_retain(p_value) )
+    )
+    {
+        p_key_value_db->attachment.p_buffer = p_buffer,
+        p_key_value_db->attachment.p_text   = p_key_value_db->attachment.p_buffer + offset,
+        p_key_value_db->attachment.length   = length;
+        *p_response_len = prefix_length;
+
+        // success
+        return 1;
+    }
+
+    // a fragment that can not be attached must fit in the response
+    if ( prefix_length + length + 1 > KEY_VALUE_DB_RESPONSE_MAX ) goto fragment_too_long;
+
+    // small fragments are copied. a whole packed value is decompressed straight into the response
+    if ( 0 == offset && key_value_value_length(p_value) == length ) key_value_value_serialize(p_value, p_response + prefix_length);
+    else                                                            memcpy(p_response + prefix_length, &key_value_value_text(p_value, &text_length)[offset], length);
+    memcpy(p_response + prefix_length + length, "}", 1);
+    *p_response_len = prefix_length + length + 1;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // key value db errors
+        {
+            fragment_too_long:
+                #ifndef NDEBUG
+                    log_error("[key value db] Fragment of %zu bytes does not fit in a response in call to function \"%s\"\n", length, __FUNCTION__);
+                #endif
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+const key_value_value *key_value_db_read_at ( key_value_db *p_key_value_db, const mvcc_snapshot *p_snapshot, const char *p_key, key_value_value *p_scratch, unsigned long long *p_version )
+{
+
+    // initialized data
+    const mvcc_version *p_saved    = mvcc_read(p_key_value_db->p_mvcc, p_key, p_snapshot->sequence);
+    key_value_property *p_property = NULL;
+    unsigned long long  expires    = 0;
+
+    // written since the snapshot. a key expires as of the time the snapshot was opened
+    if ( p_saved )
+    {
+        if ( false == p_saved->found || ( p_saved->expires && p_saved->expires <= p_snapshot->time ) ) return NULL;
+        *p_version = p_saved->version;
+
+        // done
+        return &p_saved->_value;
+    }
+
+    // not written since the snapshot, so the current version is the one it reads
+    if ( b_plus_tree_search(p_key_value_db->p_index, p_key, (void **)&p_property) )
+    {
+        if ( p_property->expires && p_property->expires <= p_snapshot->time ) return NULL;
+        *p_version = p_property->version;
+
+        // done
+        return &p_property->_value;
+    }
+
+    // memory only, or not in the tables
+    if ( NULL == p_key_value_db->storage.p_lsm ) return NULL;
+    if ( 0 == lsm_get(p_key_value_db->storage.p_lsm, p_key, p_scratch, &expires, p_version) ) return NULL;
+
+    // expired on disk
+    if ( expires && expires <= p_snapshot->time )
+    {
+        key_value_value_free(p_scratch);
+
+        // done
+        return NULL;
+    }
+
+    // done
+    return p_scratch;
+}
+
+int key_value_db_scan_key ( const char *p_key, void *p_parameter )
+{
+
+    // initialized data
+    key_value_db_scan_page *p_scan = p_parameter;
+    size_t                  lo     = 0,
+                            hi     = p_scan->count,
+                            mid    = 0;
+    int                     order  = 0;
+
+    // too long, before the cursor, or not matched
+    if ( strlen(p_key) > 63                                                   ) return 1;
+    if ( p_scan->p_after && strcmp(p_key, p_scan->p_after) <= 0               ) return 1;
+    if ( p_scan->p_pattern && false == secondary_index_glob(p_scan->p_pattern, p_key) ) return 1;
+
+    // after every key of a full page
+    if ( KEY_VALUE_DB_SCAN_COUNT == p_scan->count && strcmp(p_key, p_scan->_keys[p_scan->count - 1]) >= 0 )
+    {
+        if ( strcmp(p_key, p_scan->_keys[p_scan->count - 1]) ) p_scan->more = true;
+
+        // done
+        return 1;
+    }
+
+    // find where the key goes. a key may be in memory, the tables, and the saved versions
+    while ( lo < hi )
+    {
+        mid   = ( lo + hi ) / 2,
+        order = strcmp(p_scan->_keys[mid], p_key);
+        if ( 0 == order ) return 1;
+        if ( order < 0 ) lo = mid + 1;
+        else             hi = mid;
+    }
+
+    // a full page drops its last key
+    if ( KEY_VALUE_DB_SCAN_COUNT == p_scan->count ) p_scan->count--, p_scan->more = true;
+
+    // insert the key
+    memmove(p_scan->_keys[lo + 1], p_scan->_keys[lo], ( p_scan->count - lo ) * sizeof(p_scan->_keys[0]));
+    strcpy(p_scan->_keys[lo], p_key);
+    p_scan->count++;
+
+    // done
+    return 1;
+}
+
+int key_value_db_scan_table_key ( const char *p_key, size_t length, void *p_parameter )
+{
+
+    // initialized data
+    char _key[63+1] = { 0 };
+
+    // too long
+    if ( length > 63 ) return 1;
+
+    // keys in the tables are not terminated
+    memcpy(_key, p_key, length);
+
+    // done
+    return key_value_db_scan_key(_key, p_parameter);
+}
+
+int key_value_db_scan_property ( void *p_value, void *p_parameter )
+{
+
+    // initialized data
+    key_value_property     *p_property = p_value;
+    key_value_db_scan_page *p_scan     = p_parameter;
+
+    // past the keys that start with the literal part of the pattern
+    if ( p_scan->literal && strncmp(p_property->_name, p_scan->p_pattern, p_scan->literal) > 0 ) return 0;
+
+    // past the last key of a full page, and so is every key after it
+    if ( KEY_VALUE_DB_SCAN_COUNT == p_scan->count && strcmp(p_property->_name, p_scan->_keys[p_scan->count - 1]) > 0 )
+    {
+        p_scan->more = true;
+
+        // done
+        return 0;
+    }
+
+    // done
+    return key_value_db_scan_key(p_property->_name, p_parameter);
+}
+
+void key_value_db_scan_index ( key_value_db *p_key_value_db, key_value_db_scan_page *p_scan )
+{
+
+    // initialized data
+    char        _first[63+1] = { 0 };
+    const char *p_first      = p_scan->p_after;
+
+    // the keys a pattern matches start with the characters before its first wildcard
+    if ( p_scan->p_pattern )
+    {
+        p_scan->literal = strcspn(p_scan->p_pattern, "*?");
+        strncpy(_first, p_scan->p_pattern, ( p_scan->literal < 63 ) ? p_scan->literal : 63);
+    }
+
+    // start at the cursor, or at the literal part of the pattern, whichever is later
+    if ( p_scan->literal && ( NULL == p_first || strcmp(_first, p_first) > 0 ) ) p_first = _first;
+
+    // walk the index in order, until the page is full
+    b_plus_tree_range(p_key_value_db->p_index, p_first, key_value_db_scan_property, p_scan);
+
+    // done
+    return;
+}
+
+int key_value_db_process_snapshot
+( 
+    key_value_db *p_key_value_db, 
+    const char   *p_operation,
+    const char   *p_id,
+    
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    mvcc_snapshot      _snapshots[MVCC_SNAPSHOT_MAX] = { 0 };
+    unsigned long long now                           = key_value_db_time_ms();
+    size_t             length                        = 0,
+                       count                         = 0,
+                       id                            = 0;
+
+    // logs
+    log_info("[key value db] [snapshot] %s\n", ( p_operation ) ? p_operation : "");
+
+    // open a snapshot. it takes a commit sequence of its own, so every later
+    // write, and every later delete, is after it
+    if ( NULL == p_operation )
+    {
+
+        // error check
+        if ( 0 == mvcc_snapshot_open(p_key_value_db->p_mvcc, p_key_value_db->sequence + 1, now, &id) ) goto too_many_snapshots;
+
+        // take the commit sequence
+        p_key_value_db->sequence++;
+
+        // serialize the response
+        length = (size_t) sprintf(p_response, "{\"okay\":true,\"value\":{\"id\":%zu,\"sequence\":%llu}}", id, p_key_value_db->sequence);
+
+        // done
+        goto done;
+    }
+
+    // list every snapshot
+    if ( 0 == strcmp(p_operation, "list") )
+    {
+
+        // error check
+        if ( p_id ) goto bad_request;
+
+        // serialize the response
+        count   = mvcc_snapshots(p_key_value_db->p_mvcc, _snapshots);
+        length += (size_t) sprintf(p_response, "{\"okay\":true,\"value\":[");
+        for (size_t i = 0; i < count; i++)
+            length += (size_t) sprintf(p_response + length, "%s{\"id\":%zu,\"sequence\":%llu,\"age\":%llu,\"idle\":%llu}",
+                ( i ) ? "," : "",
+                _snapshots[i].id,
+                _snapshots[i].sequence,
+                now - _snapshots[i].time,
+                now - _snapshots[i].used
+            );
+        length += (size_t) sprintf(p_response + length, "]}");
+
+        // done
+        goto done;
+    }
+
+    // close a snapshot
+    if ( 0 == strcmp(p_operation, "drop") )
+    {
+
+        // error check
+        if ( NULL == p_id ) goto bad_request;
+        if ( 0 == mvcc_snapshot_close(p_key_value_db->p_mvcc, strtoull(p_id, NULL, 10)) ) goto no_such_snapshot;
+
+        // serialize the response
+        length = (size_t) sprintf(p_response, "{\"okay\":true,\"value\":%zu}", mvcc_snapshots(p_key_value_db->p_mvcc, _snapshots));
+
+        // done
+        goto done;
+    }
+
+    // error
+    goto bad_request;
+
+    done:
+
+    // store the length
+    *p_response_len = length;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            bad_request:
+                #ifndef NDEBUG
+                    log_error("[key value db] Bad snapshot request in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            too_many_snapshots:
+                #ifndef NDEBUG
+                    log_error("[key value db] Too many snapshots in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            no_such_snapshot:
+                #ifndef NDEBUG
+                    log_error("[key value db] No such snapshot \"%s\" in call to function \"%s\"\n", p_id, __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            failed:
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_get_at
+( 
+    key_value_db *p_key_value_db, 
+    char         *p_key, 
+    const char   *p_id,
+    
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==          p_key ) goto no_key;
+    if ( NULL ==           p_id ) goto no_id;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    mvcc_snapshot          _snapshot = { 0 };
+    key_value_value        _scratch  = { 0 };
+    const key_value_value *p_value   = NULL;
+    unsigned long long     version   = 0;
+
+    // logs
+    log_info("[key value db] [get] \"%s\" at snapshot %s\n", p_key, p_id);
+
+    // error check
+    if ( 0 == mvcc_snapshot_get(p_key_value_db->p_mvcc, strtoull(p_id, NULL, 10), key_value_db_time_ms(), &_snapshot) ) goto no_such_snapshot;
+
+    // the lookup starts
+    key_value_db_slowlog_mark(&p_key_value_db->slowlog.lookup);
+
+    // read the version the snapshot sees
+    p_value = key_value_db_read_at(p_key_value_db, &_snapshot, p_key, &_scratch, &version);
+    if ( NULL == p_value ) goto not_a_key;
+
+    // serialize the response. an attachment holds its own reference
+    key_value_db_respond_value(p_key_value_db, "{\"okay\":true,\"value\":", p_value, 0, key_value_value_length(p_value), p_response, p_response_len);
+    key_value_value_free(&_scratch);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_id:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_id\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            no_such_snapshot:
+                #ifndef NDEBUG
+                    log_error("[key value db] No such snapshot \"%s\" in call to function \"%s\"\n", p_id, __FUNCTION__);
+                #endif
+
+                // fall through
+                goto not_a_key;
+
+            // a miss is not logged
+            not_a_key:
+
+                // copy the miss response to the response buffer
+                memcpy(p_response, _key_value_db_miss, sizeof(_key_value_db_miss) - 1);
+                *p_response_len = sizeof(_key_value_db_miss) - 1;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_scan
+( 
+    key_value_db *p_key_value_db, 
+    const char   *p_id,
+    const char   *p_pattern,
+    const char   *p_after,
+    
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==           p_id ) goto no_id;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    mvcc_snapshot          _snapshot = { 0 };
+    key_value_db_scan_page _scan     = { .p_pattern = p_pattern, .p_after = p_after };
+    key_value_value        _scratch  = { 0 };
+    const key_value_value *p_value   = NULL;
+    unsigned long long     version   = 0;
+    size_t                 length    = 0,
+                           found     = 0,
+                           read      = 0,
+                           value_len = 0;
+
+    // logs
+    log_info("[key value db] [scan] %s \"%s\"\n", p_id, ( p_pattern ) ? p_pattern : "*");
+
+    // error check
+    if ( 0 == mvcc_snapshot_get(p_key_value_db->p_mvcc, strtoull(p_id, NULL, 10), key_value_db_time_ms(), &_snapshot) ) goto no_such_snapshot;
+
+    // the lookup starts
+    key_value_db_slowlog_mark(&p_key_value_db->slowlog.lookup);
+
+    // the next keys, from memory, the tables, and the versions only snapshots read
+    key_value_db_scan_index(p_key_value_db, &_scan);
+    if ( p_key_value_db->storage.p_lsm && 0 == lsm_keys(p_key_value_db->storage.p_lsm, key_value_db_scan_table_key, &_scan) ) goto failed_to_read_tables;
+    mvcc_keys(p_key_value_db->p_mvcc, key_value_db_scan_key, &_scan);
+
+    // open the response
+    length = (size_t) sprintf(p_response, "{\"okay\":true,\"value\":[");
+
+    // read each key as of the snapshot
+    for (read = 0; read < _scan.count; read++)
+    {
+
+        // initialized data
+        const char *p_key = _scan._keys[read];
+
+        // not a key when the snapshot was opened
+        if ( NULL == ( p_value = key_value_db_read_at(p_key_value_db, &_snapshot, p_key, &_scratch, &version) ) ) continue;
+
+        // large values are left for a get
+        value_len = key_value_value_length(p_value);
+        if ( value_len > KEY_VALUE_DB_SCAN_VALUE ) value_len = 0;
+
+        // the response is full. the client asks again from the last key read
+        if ( length + 6 * strlen(p_key) + value_len + 64 > KEY_VALUE_DB_SCAN_MAX )
+        {
+            key_value_value_free(&_scratch);
+            _scan.more = true;
+
+            // done
+            break;
+        }
+
+        // the key, and its version
+        length += (size_t) sprintf(p_response + length, "%s{\"key\":\"", ( found++ ) ? "," : "");
+        length += key_value_db_escape(p_response + length, p_key);
+        length += (size_t) sprintf(p_response + length, "\",\"version\":%llu", version);
+
+        // the value
+        if ( value_len )
+            length += (size_t) sprintf(p_response + length, ",\"value\":"),
+            length += key_value_value_serialize(p_value, p_response + length);
+        p_response[length++] = '}';
+
+        // release the value read from the tables
+        key_value_value_free(&_scratch);
+    }
+
+    // a full page says where the next one starts
+    if ( _scan.more && read )
+        length += (size_t) sprintf(p_response + length, "],\"next\":\""),
+        length += key_value_db_escape(p_response + length, _scan._keys[read - 1]),
+        length += (size_t) sprintf(p_response + length, "\"}");
+    else
+        length += (size_t) sprintf(p_response + length, "]}");
+
+    // store the length
+    *p_response_len = length;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_id:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_id\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            no_such_snapshot:
+                #ifndef NDEBUG
+                    log_error("[key value db] No such snapshot \"%s\" in call to function \"%s\"\n", p_id, __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            failed_to_read_tables:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to read the tables in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            failed:
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_fetch ( key_value_db *p_key_value_db, const char *p_key, key_value_property **pp_property )
+{
+
+    // initialized data
+    key_value_property *p_value = NULL;
+
+    // the lookup starts
+    key_value_db_slowlog_mark(&p_key_value_db->slowlog.lookup);
+
+    // a definite miss touches neither the cache, nor the index
+    if ( false == cuckoo_filter_contains(p_key_value_db->p_filter, p_key, strlen(p_key)) ) goto filtered;
+
+    // search the cache
+    if ( 0 == front_cache_find(p_key_value_db->p_front_cache, p_key, (void **)&p_value) ) goto not_in_cache;
+    
+    // logs
+    log_info("[key value db] Found key \"%s\" in cache \n", p_key);
+
+    // trace the hit
+    if ( KEY_VALUE_DB_PROBE_ENABLED(cache__hit) )
+        KEY_VALUE_DB_PROBE2(cache__hit, p_key, key_value_db_elapsed_ns(p_key_value_db, p_key_value_db->slowlog.lookup));
+
+    found:
+
+    // lazy expiry
+    if ( key_value_property_expired(p_value, key_value_db_time_ms()) )
+    {
+
+        // logs
+        log_info("[key value db] Expired key \"%s\"\n", p_key);
+
+        // remove the property
+        key_value_db_delete(p_key_value_db, p_value);
+
+        // increment counters
+        p_key_value_db->counter.expired++;
+
+        // done
+        goto not_a_key;
+    }
+
+    // record the access. only keys that exist are counted, so misses can not crowd out the hot keys
+    eviction_meta_touch(&p_value->_eviction, (unsigned int) ( key_value_db_time_ms() / 1000 ), eviction_random(&p_key_value_db->memory.random));
+    hot_keys_record(p_key_value_db->hot_keys.p_reads, p_key);
+
+    // return a pointer to the caller
+    *pp_property = p_value;
+
+    // success
+    return 1;
+
+    // this branch handles cache misses
+    not_in_cache:
+    {
+
+        // search the index, and the tables. the filter let this miss through
+        if ( 0 == key_value_db_lookup(p_key_value_db, p_key, &p_value) )
+        {
+            p_key_value_db->counter.miss.false_positives++;
+            p_value = NULL;
+        }
+
+        // trace the miss, and whether the index had the key
+        if ( KEY_VALUE_DB_PROBE_ENABLED(cache__miss) )
+            KEY_VALUE_DB_PROBE4(cache__miss, p_key, key_value_db_elapsed_ns(p_key_value_db, p_key_value_db->slowlog.lookup), NULL != p_value, false);
+
+        // not a key
+        if ( NULL == p_value ) goto not_a_key;
+        
+        // logs
+        log_info("[key value db] Found key \"%s\" in tree\n", p_key);
+        
+        // logs
+        log_info("[key value db] Adding key \"%s\" to cache\n", p_key);
+    
+        // add the value to the cache
+        front_cache_insert(p_key_value_db->p_front_cache, p_value->_name, p_value);
+
+        // done
+        goto found;
+    }
+
+    // this branch handles keys the filter rules out
+    filtered:
+    {
+
+        // increment counters
+        p_key_value_db->counter.miss.filtered++;
+
+        // trace the miss
+        if ( KEY_VALUE_DB_PROBE_ENABLED(cache__miss) )
+            KEY_VALUE_DB_PROBE4(cache__miss, p_key, key_value_db_elapsed_ns(p_key_value_db, p_key_value_db->slowlog.lookup), false, true);
+
+        // done
+        goto not_a_key;
+    }
+
+    // a miss is not logged. probes are mostly misses
+    not_a_key:
+
+        // increment counters
+        p_key_value_db->counter.miss.gets++;
+
+        // not found
+        return 0;
+}
+
+int key_value_db_process_get
+( 
+    key_value_db *p_key_value_db, 
+    char         *p_key, 
+    
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==          p_key ) goto no_key;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    key_value_property *p_value = NULL;
+    size_t              length  = 0;
+
+    // logs
+    log_info("[key value db] [get] \"%s\"\n", p_key);
+
+    // find the property
+    if ( 0 == key_value_db_fetch(p_key_value_db, p_key, &p_value) ) goto not_a_key;
+
+    // serialize the response
+    length = key_value_value_length(&p_value->_value);
+    key_value_db_respond_value(p_key_value_db, "{\"okay\":true,\"value\":", &p_value->_value, 0, length, p_response, p_response_len);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+
+            // a miss is not logged
+            not_a_key:
+
+                // copy the miss response to the response buffer
+                memcpy(p_response, _key_value_db_miss, sizeof(_key_value_db_miss) - 1);
+                *p_response_len = sizeof(_key_value_db_miss) - 1;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_store
+(
+    key_value_db        *p_key_value_db,
+    const char          *p_key,
+    key_value_value     *p_value,
+    unsigned long long   expires,
+    key_value_property **pp_property
+)
+{
+
+    // initialized data
+    key_value_property *p_property = NULL;
+    bool                replaced   = false;
+
+    // the lookup starts
+    key_value_db_slowlog_mark(&p_key_value_db->slowlog.lookup);
+
+    // search the tree
+    if ( 0 == b_plus_tree_search(p_key_value_db->p_index, p_key, (void **)&p_property) ) p_property = NULL;
+
+    // the snapshots keep the version this write replaces
+    key_value_db_preserve(p_key_value_db, p_key, p_property);
+
+    // replace the value of an existing property, in place. it stays in the
+    // keyspace, the index, and the cache, so the write can not fail half way
+    if ( p_property )
+    {
+
+        // disarm the expiry timer
+        timing_wheel_remove(p_key_value_db->p_timing_wheel, &p_property->_expiry);
+        p_property->expires = 0;
+
+        // release the old value
+        p_key_value_db->memory.used -= p_property->size;
+        key_value_value_free(&p_property->_value);
+
+        replaced = true;
+    }
+
+    // a new key needs a property, which joins the keyspace, and the index,
+    // before it takes over the value
+    else
+    {
+        p_property = key_value_memory_allocator(KEY_VALUE_MEMORY_PROPERTIES, 0, sizeof(key_value_property));
+        if (NULL == p_property) goto no_mem;
+
+        memset(p_property, 0, sizeof(key_value_property));
+
+        // copy the key
+        strncpy(p_property->_name, p_key, sizeof(p_property->_name) - 1);
+        p_property->_name[sizeof(p_property->_name) - 1] = '\0';
+
+        // add the property to the keyspace
+        if ( 0 == key_value_db_keyspace_add(p_key_value_db, p_property) ) goto failed_to_store_value;
+
+        // insert the property
+        if ( 0 == b_plus_tree_insert(p_key_value_db->p_index, p_property) ) goto failed_to_index;
+    }
+
+    // take over the value, and pack it
+    p_property->_value = *p_value,
+    p_value->length    = 0;
+    key_value_db_pack(p_key_value_db, &p_property->_value);
+    p_property->size = sizeof(key_value_property) + key_value_value_heap_size(&p_property->_value);
+    p_key_value_db->memory.used += p_property->size;
+
+    // stamp the commit sequence. a batch shares one
+    p_property->version = ( p_key_value_db->batching ) ? p_key_value_db->sequence : ++p_key_value_db->sequence;
+    key_value_db_dirty(p_key_value_db, p_property);
+
+    // the write counts as a fresh access
+    eviction_meta_init(&p_property->_eviction, (unsigned int) ( key_value_db_time_ms() / 1000 ));
+
+    // trace the insertion
+    if ( KEY_VALUE_DB_PROBE_ENABLED(index__insert) )
+        KEY_VALUE_DB_PROBE3(index__insert, p_property->_name, p_property->size, key_value_db_elapsed_ns(p_key_value_db, p_key_value_db->slowlog.lookup));
+
+    // a new key joins the filter. a key that is only in the tables may be added
+    // again, which costs a slot, but never hides a key
+    if ( false == replaced ) key_value_db_filter_add(p_key_value_db, p_property->_name);
+
+    // arm the expiry timer
+    if ( expires ) key_value_db_expire_at(p_key_value_db, p_property, expires);
+
+    // stay under the memory limit. a batch evicts once it is written, so it never evicts its own writes
+    if ( false == p_key_value_db->batching ) key_value_db_evict(p_key_value_db, p_property);
+
+    // tell the watchers
+    key_value_db_notify(p_key_value_db, p_property->_name, p_property);
+
+    // return a pointer to the caller
+    if ( pp_property ) *pp_property = p_property;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // standard library errors
+        {
+            failed_to_index:
+
+                // take the property back out of the keyspace
+                key_value_db_keyspace_remove(p_key_value_db, p_property);
+
+                // fall through
+                goto failed_to_store_value;
+
+            failed_to_store_value:
+
+                // release the property. it never took over the value
+                p_property = key_value_memory_allocator(KEY_VALUE_MEMORY_PROPERTIES, p_property, 0);
+
+                // fall through
+                goto no_mem;
+
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // release the value, unless the property took it over
+                key_value_value_free(p_value);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_set_value
+(
+    key_value_db       *p_key_value_db,
+    char               *p_key,
+    key_value_value    *p_value,
+    unsigned long long  expires,
+
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==          p_key ) goto no_key;
+    if ( NULL ==        p_value ) goto no_value;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    key_value_property *p_property = NULL;
+
+    // logs
+    log_info("[key value db] [set] \"%s\"\n", p_key);
+
+    // store the value
+    if ( 0 == key_value_db_store(p_key_value_db, p_key, p_value, expires, &p_property) ) goto failed_to_store_value;
+
+    // the response carries the version of the write, not the value
+    *p_response_len = (size_t) sprintf(p_response, "{\"okay\":true,\"value\":{\"version\":%llu}}", p_property->version);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_value:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_value\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            failed_to_store_value:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to store value of key \"%s\" in call to function \"%s\"\n", p_key, __FUNCTION__);
+                #endif
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // increment counters
+                p_key_value_db->counter.request.err++;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_expire
+(
+    key_value_db *p_key_value_db,
+    char         *p_key,
+    long long     seconds,
+
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==          p_key ) goto no_key;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    key_value_property *p_property = NULL;
+    unsigned long long  now        = key_value_db_time_ms();
+
+    // logs
+    log_info("[key value db] [expire] \"%s\" %lld\n", p_key, seconds);
+
+    // search the tree, and the tables
+    if ( 0 == key_value_db_lookup(p_key_value_db, p_key, &p_property) ) goto not_a_key;
+
+    // already expired?
+    if ( key_value_property_expired(p_property, now) ) goto not_a_key;
+
+    // a non positive expiry removes the property right away
+    if ( seconds <= 0 )
+    {
+        key_value_db_delete(p_key_value_db, p_property);
+        p_key_value_db->counter.expired++;
+    }
+
+    // arm the expiry timer. the snapshots keep the old expiry
+    else
+        key_value_db_preserve(p_key_value_db, p_property->_name, p_property),
+        key_value_db_expire_at(p_key_value_db, p_property, now + (unsigned long long) seconds * 1000),
+        key_value_db_dirty(p_key_value_db, p_property);
+
+    // serialize the response
+    *p_response_len = sprintf(p_response, "{\"okay\":true,\"value\":%lld}", seconds);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            not_a_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] Key \"%s\" not found in call to function \"%s\"\n", p_key, __FUNCTION__);
+                #endif
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_ttl
+(
+    key_value_db *p_key_value_db,
+    char         *p_key,
+
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==          p_key ) goto no_key;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    key_value_property *p_property = NULL;
+    unsigned long long  now        = key_value_db_time_ms();
+    long long           ttl        = -1;
+
+    // logs
+    log_info("[key value db] [ttl] \"%s\"\n", p_key);
+
+    // search the tree, and the tables
+    if ( 0 == key_value_db_lookup(p_key_value_db, p_key, &p_property) ) goto not_a_key;
+
+    // already expired?
+    if ( key_value_property_expired(p_property, now) ) goto not_a_key;
+
+    // compute the remaining seconds, rounded up
+    if ( p_property->expires ) ttl = (long long) ( ( p_property->expires - now + 999 ) / 1000 );
+
+    // serialize the response
+    *p_response_len = sprintf(p_response, "{\"okay\":true,\"value\":%lld}", ttl);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            not_a_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] Key \"%s\" not found in call to function \"%s\"\n", p_key, __FUNCTION__);
+                #endif
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_incr
+(
+    key_value_db *p_key_value_db,
+    char         *p_key,
+    long long     delta,
+
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==          p_key ) goto no_key;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    key_value_property *p_property = NULL;
+    key_value_value     _value     = { 0 };
+    long long           integer    = 0,
+                        result     = 0;
+    char                _text[32]  = { 0 };
+
+    // logs
+    log_info("[key value db] [incr] \"%s\" %lld\n", p_key, delta);
+
+    // search the tree, and the tables
+    if ( key_value_db_lookup(p_key_value_db, p_key, &p_property) && !key_value_property_expired(p_property, key_value_db_time_ms()) )
+    {
+
+        // error check
+        if ( 0 == key_value_value_integer(&p_property->_value, &integer) ) goto not_an_integer;
+        if ( __builtin_add_overflow(integer, delta, &result) ) goto overflow;
+
+        // update the value in place, so the expiry survives. integers are always inline
+        key_value_db_preserve(p_key_value_db, p_property->_name, p_property);
+        key_value_value_from_text(&p_property->_value, _text, (size_t) sprintf(_text, "%lld", result), JSON_VALUE_INTEGER);
+        p_property->version = ( p_key_value_db->batching ) ? p_key_value_db->sequence : ++p_key_value_db->sequence;
+        key_value_db_dirty(p_key_value_db, p_property);
+
+        // tell the watchers
+        key_value_db_notify(p_key_value_db, p_property->_name, p_property);
+
+        // serialize the response
+        *p_response_len = sprintf(p_response, "{\"okay\":true,\"value\":%lld}", result);
+
+        // success
+        return 1;
+    }
+
+    // a missing key counts from zero
+    key_value_value_from_text(&_value, _text, (size_t) sprintf(_text, "%lld", delta), JSON_VALUE_INTEGER);
+
+    // store the value
+    if ( 0 == key_value_db_process_set_value(p_key_value_db, p_key, &_value, 0, p_response, p_response_len) ) return 0;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            not_an_integer:
+                #ifndef NDEBUG
+                    log_error("[key value db] Value of key \"%s\" is not an integer in call to function \"%s\"\n", p_key, __FUNCTION__);
+                #endif
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+
+            overflow:
+                #ifndef NDEBUG
+                    log_error("[key value db] Value of key \"%s\" would overflow in call to function \"%s\"\n", p_key, __FUNCTION__);
+                #endif
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_cas
+(
+    key_value_db    *p_key_value_db,
+    char            *p_key,
+    const char      *p_expected,
+    size_t           expected_len,
+    unsigned char    expected_type,
+    key_value_value *p_value,
+
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==          p_key ) goto no_key;
+    if ( NULL ==     p_expected ) goto no_expected;
+    if ( NULL ==        p_value ) goto no_value;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    key_value_property *p_property  = NULL;
+    size_t              current_len = 0;
+    const char         *p_current   = NULL;
+    bool                found       = false;
+
+    // logs
+    log_info("[key value db] [cas] \"%s\"\n", p_key);
+
+    // search the tree, and the tables
+    found = key_value_db_lookup(p_key_value_db, p_key, &p_property) &&
+            !key_value_property_expired(p_property, key_value_db_time_ms());
+
+    // a missing key matches null
+    if ( false == found )
+    {
+        if ( JSON_VALUE_NULL != expected_type ) goto mismatch;
+    }
+
+    // compare minified serializations
+    else
+    {
+        p_current = key_value_value_text(&p_property->_value, &current_len);
+        if ( expected_len != current_len || 0 != memcmp(p_expected, p_current, current_len) ) goto mismatch;
+    }
+
+    // store the new value, keeping the expiry
+    if ( 0 == key_value_db_process_set_value(p_key_value_db, p_key, p_value, found ? p_property->expires : 0, p_response, p_response_len) ) return 0;
+
+    // success
+    return 1;
+
+    // this branch reports the current value, so the caller can retry without a get
+    mismatch:
+    {
+
+        // logs
+        log_info("[key value db] Compare and set of key \"%s\" failed\n", p_key);
+
+        // release the new value
+        key_value_value_free(p_value);
+
+        // serialize the response
+        if ( found )
+        {
+            p_current = key_value_value_text(&p_property->_value, &current_len);
+            key_value_db_respond_value(p_key_value_db, "{\"okay\":false,\"value\":", &p_property->_value, 0, current_len, p_response, p_response_len);
+        }
+        else
+        {
+            memcpy(p_response, "{\"okay\":false,\"value\":null}", 27);
+            *p_response_len = 27;
+        }
+
+        // error
+        return 0;
+    }
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_expected:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_expected\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_value:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_value\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_jget
+(
+    key_value_db *p_key_value_db,
+    char         *p_key,
+    char         *p_path,
+
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==          p_key ) goto no_key;
+    if ( NULL ==         p_path ) goto no_path;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    key_value_property *p_property = NULL;
+    const char         *p_text     = NULL;
+    size_t              length     = 0,
+                        offset     = 0,
+                        span       = 0;
+
+    // logs
+    log_info("[key value db] [jget] \"%s\" %s\n", p_key, p_path);
+
+    // search the tree, and the tables
+    if ( 0 == key_value_db_lookup(p_key_value_db, p_key, &p_property) ) goto no_such_key;
+    if ( key_value_property_expired(p_property, key_value_db_time_ms()) ) goto no_such_key;
+
+    // count the read
+    hot_keys_record(p_key_value_db->hot_keys.p_reads, p_key);
+
+    // find the fragment, without parsing the rest of the document
+    p_text = key_value_value_text(&p_property->_value, &length);
+    if ( 0 == json_path_locate(p_text, length, p_path, strlen(p_path), &offset, &span) ) goto no_such_path;
+
+    // touch the property
+    eviction_meta_touch(&p_property->_eviction, (unsigned int) ( key_value_db_time_ms() / 1000 ), eviction_random(&p_key_value_db->memory.random));
+
+    // serialize the response. only the fragment is shipped
+    key_value_db_respond_value(p_key_value_db, "{\"okay\":true,\"value\":", &p_property->_value, offset, span, p_response, p_response_len);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_path:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_path\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            no_such_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] No such key \"%s\" in call to function \"%s\"\n", p_key, __FUNCTION__);
+                #endif
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+
+            no_such_path:
+                #ifndef NDEBUG
+                    log_error("[key value db] No such path \"%s\" in key \"%s\" in call to function \"%s\"\n", p_path, p_key, __FUNCTION__);
+                #endif
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_jset
+(
+    key_value_db *p_key_value_db,
+    char         *p_key,
+    char         *p_path,
+    const char   *p_fragment,
+    size_t        fragment_length,
+    unsigned char type,
+    bool          append,
+
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==          p_key ) goto no_key;
+    if ( NULL ==         p_path ) goto no_path;
+    if ( NULL ==     p_fragment ) goto no_fragment;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    key_value_property *p_property                           = NULL;
+    const char         *p_text                               = NULL,
+                       *p_name                               = NULL;
+    char                _insert[KEY_VALUE_VALUE_MAX + 256]   = { 0 };
+    size_t              length                               = 0,
+                        path_length                          = strlen(p_path),
+                        parent_length                        = 0,
+                        name_length                          = 0,
+                        offset                               = 0,
+                        span                                 = 0,
+                        prefix                               = 0;
+
+    // logs
+    log_info("[key value db] [%s] \"%s\" %s\n", append ? "jappend" : "jset", p_key, p_path);
+
+    // search the tree, and the tables
+    if ( 0 == key_value_db_lookup(p_key_value_db, p_key, &p_property) ) goto no_such_key;
+    if ( key_value_property_expired(p_property, key_value_db_time_ms()) ) goto no_such_key;
+
+    // initialized data
+    p_text = key_value_value_text(&p_property->_value, &length);
+
+    // append to an array
+    if ( append )
+    {
+
+        // find the array
+        if ( 0 == json_path_locate(p_text, length, p_path, path_length, &offset, &span) ) goto no_such_path;
+        if ( '[' != p_text[offset] ) goto no_such_path;
+
+        // insert before the closing bracket
+        if ( false == json_path_empty(&p_text[offset], span) ) _insert[prefix++] = ',';
+        offset += span - 1,
+        span    = 0;
+    }
+
+    // replace an existing value
+    else if ( json_path_locate(p_text, length, p_path, path_length, &offset, &span) ) ;
+
+    // add a member to an object
+    else
+    {
+
+        // find the object
+        if ( 0 == json_path_split(p_path, path_length, &parent_length, &p_name, &name_length) ) goto no_such_path;
+        if ( name_length > 255 - 4 ) goto no_such_path;
+        if ( memchr(p_name, '"', name_length) || memchr(p_name, '\\', name_length) ) goto no_such_path;
+        if ( 0 == json_path_locate(p_text, length, p_path, parent_length, &offset, &span) ) goto no_such_path;
+        if ( '{' != p_text[offset] ) goto no_such_path;
+
+        // insert before the closing brace
+        if ( false == json_path_empty(&p_text[offset], span) ) _insert[prefix++] = ',';
+        _insert[prefix++] = '"';
+        memcpy(&_insert[prefix], p_name, name_length);
+        prefix += name_length;
+        _insert[prefix++] = '"';
+        _insert[prefix++] = ':';
+        offset += span - 1,
+        span    = 0;
+    }
+
+    // error check. the response echoes the fragment
+    if ( prefix + fragment_length > sizeof(_insert) ) goto no_such_path;
+    if ( 21 + fragment_length + 1 > KEY_VALUE_DB_RESPONSE_MAX ) goto fragment_too_long;
+
+    // copy the fragment after the separator
+    memcpy(&_insert[prefix], p_fragment, fragment_length);
+
+    // edit the serialized document in place. the snapshots keep the old document
+    key_value_db_preserve(p_key_value_db, p_property->_name, p_property);
+    if ( 0 == key_value_value_splice(&p_property->_value, offset, span, _insert, prefix + fragment_length) ) goto failed_to_store_value;
+
+    // the root was replaced
+    if ( 0 == offset && span == length ) p_property->_value.type = type;
+    key_value_db_pack(p_key_value_db, &p_property->_value);
+
+    // account for the new size
+    p_key_value_db->memory.used -= p_property->size;
+    p_property->size             = sizeof(key_value_property) + key_value_value_heap_size(&p_property->_value);
+    p_key_value_db->memory.used += p_property->size;
+
+    // stamp the commit sequence
+    p_property->version = ( p_key_value_db->batching ) ? p_key_value_db->sequence : ++p_key_value_db->sequence;
+    key_value_db_dirty(p_key_value_db, p_property);
+
+    // stay under the memory limit
+    key_value_db_evict(p_key_value_db, p_property);
+
+    // tell the watchers
+    key_value_db_notify(p_key_value_db, p_property->_name, p_property);
+
+    // serialize the response. only the fragment that changed is shipped
+    memcpy(p_response, "{\"okay\":true,\"value\":", 21);
+    memcpy(p_response + 21, &_insert[prefix], fragment_length);
+    memcpy(p_response + 21 + fragment_length, "}", 1);
+    *p_response_len = 21 + fragment_length + 1;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_path:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_path\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_fragment:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_fragment\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            no_such_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] No such key \"%s\" in call to function \"%s\"\n", p_key, __FUNCTION__);
+                #endif
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+
+            no_such_path:
+                #ifndef NDEBUG
+                    log_error("[key value db] No such path \"%s\" in key \"%s\" in call to function \"%s\"\n", p_path, p_key, __FUNCTION__);
+                #endif
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+
+            fragment_too_long:
+                #ifndef NDEBUG
+                    log_error("[key value db] Fragment of %zu bytes does not fit in a response in call to function \"%s\"\n", fragment_length, __FUNCTION__);
+                #endif
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+
+            failed_to_store_value:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to store value of key \"%s\" in call to function \"%s\"\n", p_key, __FUNCTION__);
+                #endif
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_version
+(
+    key_value_db *p_key_value_db,
+    char         *p_key,
+
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==          p_key ) goto no_key;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    key_value_property *p_property = NULL;
+    unsigned long long  version    = 0;
+
+    // logs
+    log_info("[key value db] [version] \"%s\"\n", p_key);
+
+    // a missing key is version 0
+    if ( key_value_db_lookup(p_key_value_db, p_key, &p_property) && !key_value_property_expired(p_property, key_value_db_time_ms()) )
+        version = p_property->version;
+
+    // serialize the response
+    *p_response_len = sprintf(p_response, "{\"okay\":true,\"value\":%llu}", version);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_batch
+(
+    key_value_db *p_key_value_db,
+    char         *p_request,
+    size_t        request_len,
+
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==      p_request ) goto no_request;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    struct
+    {
+        char               *p_command,
+                           *p_key,
+                           *p_value;
+        size_t              length;
+        unsigned char       type;
+        unsigned long long  version;
+        long long           delta;
+        key_value_value     _value;
+
+        // the key, once this operation is applied
+        bool                exists,
+                            integral;
+        long long           integer;
+        unsigned long long  current;
+    } _operations[KEY_VALUE_DB_BATCH_MAX] = { 0 };
+    size_t              operation_count = 0,
+                        applied         = 0,
+                        length          = 0;
+    char               *p_line          = p_request,
+                       *p_end           = p_request + request_len;
+    char                _scratch[64]    = { 0 };
+    size_t              scratch_len     = 0;
+    unsigned long long  now             = key_value_db_time_ms();
+    bool                exec            = false;
+
+    // logs
+    log_info("[key value db] [batch]\n");
+
+    // parse one operation per line
+    while ( p_line < p_end && *p_line )
+    {
+
+        // initialized data
+        char   *p_newline = memchr(p_line, '\n', (size_t) ( p_end - p_line ));
+        size_t  line_len  = p_newline ? (size_t) ( p_newline - p_line ) : (size_t) ( p_end - p_line ),
+                cur       = 0;
+        char   *p_op      = NULL;
+
+        // terminate the line
+        p_line[line_len] = '\0';
+
+        // parse the operation
+        p_op = key_value_db_parse_token(p_line, line_len, &cur);
+
+        // blank line
+        if ( NULL == p_op ) goto next_line;
+
+        // nothing may follow the end of the batch
+        if ( exec ) goto bad_operation;
+
+        // the end of the batch
+        if ( 0 == strcmp(p_op, "exec") )
+        {
+            exec = true;
+
+            // the end of the line
+            if ( key_value_db_parse_token(p_line, line_len, &cur) ) goto bad_operation;
+
+            goto next_line;
+        }
+
+        // error check
+        if ( KEY_VALUE_DB_BATCH_MAX == operation_count ) goto too_many_operations;
+
+        // store the operation
+        _operations[operation_count].p_command = p_op;
+        _operations[operation_count].p_key     = key_value_db_parse_token(p_line, line_len, &cur);
+
+        // error check
+        if ( NULL == _operations[operation_count].p_key ) goto bad_operation;
+
+        // set <key> <value>
+        if ( 0 == strcmp(p_op, "set") )
+        {
+
+            // initialized data
+            char *p_value = key_value_db_parse_value(p_line, line_len, &cur);
+
+            // error check
+            if ( NULL == p_value ) goto bad_operation;
+
+            // validate and minify the value in place
+            if ( 0 == json_path_minify(p_value, strlen(p_value), &_operations[operation_count].length, &_operations[operation_count].type) ) goto bad_operation;
+            _operations[operation_count].p_value = p_value;
+        }
+
+        // incrby <key> <delta>
+        else if ( 0 == strcmp(p_op, "incrby") )
+        {
+
+            // initialized data
+            char *p_delta = key_value_db_parse_token(p_line, line_len, &cur);
+
+            // error check
+            if ( NULL == p_delta ) goto bad_operation;
+            if ( false == key_value_db_parse_integer(p_delta, &_operations[operation_count].delta) ) goto bad_operation;
+        }
+
+        // check <key> <version>
+        else if ( 0 == strcmp(p_op, "check") )
+        {
+
+            // initialized data
+            char *p_version = key_value_db_parse_token(p_line, line_len, &cur);
+
+            // error check
+            if ( NULL == p_version ) goto bad_operation;
+            if ( false == key_value_db_parse_unsigned(p_version, &_operations[operation_count].version) ) goto bad_operation;
+        }
+
+        // error
+        else goto bad_operation;
+
+        operation_count++;
+
+        next_line:
+
+        // advance to the next line
+        p_line += line_len + 1;
+    }
+
+    // error check
+    if ( false == exec ) goto no_exec;
+
+    // every guard must hold, and every increment must apply, before anything is
+    // written. each operation sees the key as the operations before it left it
+    for (size_t i = 0; i < operation_count; i++)
+    {
+
+        // initialized data
+        key_value_property *p_property = NULL;
+        size_t              previous   = i;
+
+        // the last operation of the batch on the key
+        while ( previous-- )
+            if ( 0 == strcmp(_operations[previous].p_key, _operations[i].p_key) ) break;
+
+        // the key, as the batch left it
+        if ( previous < i )
+            _operations[i].exists   = _operations[previous].exists,
+            _operations[i].integral = _operations[previous].integral,
+            _operations[i].integer  = _operations[previous].integer,
+            _operations[i].current  = _operations[previous].current;
+
+        // the key, as it is. a missing key is version 0
+        else if ( key_value_db_lookup(p_key_value_db, _operations[i].p_key, &p_property) && !key_value_property_expired(p_property, now) )
+            _operations[i].exists   = true,
+            _operations[i].integral = key_value_value_integer(&p_property->_value, &_operations[i].integer),
+            _operations[i].current  = p_property->version;
+
+        // sets replace the value. the value is built now, so writing it cannot fail to parse
+        if ( _operations[i].p_value )
+        {
+            if ( 0 == key_value_value_from_text(&_operations[i]._value, _operations[i].p_value, _operations[i].length, _operations[i].type) ) goto bad_operation;
+            _operations[i].exists   = true,
+            _operations[i].integral = key_value_value_integer(&_operations[i]._value, &_operations[i].integer),
+            _operations[i].current  = p_key_value_db->sequence + 1;
+        }
+
+        // increments need an integer that will not overflow. a missing key counts from zero
+        else if ( 0 == strcmp(_operations[i].p_command, "incrby") )
+        {
+            if ( false == _operations[i].exists ) _operations[i].integral = true, _operations[i].integer = 0;
+            if ( false == _operations[i].integral ) goto bad_operation;
+            if ( __builtin_add_overflow(_operations[i].integer, _operations[i].delta, &_operations[i].integer) ) goto bad_operation;
+            _operations[i].exists  = true,
+            _operations[i].current = p_key_value_db->sequence + 1;
+        }
+
+        // guard failed?
+        else if ( _operations[i].current != _operations[i].version )
+        {
+
+            // serialize the response
+            length  = (size_t) sprintf(p_response, "{\"okay\":false,\"value\":{\"key\":\"");
+            length += key_value_db_escape(p_response + length, _operations[i].p_key);
+            length += (size_t) sprintf(p_response + length, "\",\"version\":%llu}}", _operations[i].current);
+            *p_response_len = length;
+
+            // done
+            goto release;
+        }
+    }
+
+    // every write in the batch shares one commit sequence
+    p_key_value_db->sequence++;
+    p_key_value_db->batching = true;
+
+    // apply each write, in request order. the guards, the increments, and the
+    // values are checked, so only running out of memory stops a write
+    for (applied = 0; applied < operation_count; applied++)
+    {
+
+        // set. the value is taken over, even if it is not stored
+        if ( _operations[applied].p_value )
+        {
+            if ( 0 == key_value_db_store(p_key_value_db, _operations[applied].p_key, &_operations[applied]._value, 0, NULL) ) break;
+        }
+
+        // incrby
+        else if ( 0 == strcmp(_operations[applied].p_command, "incrby") )
+        {
+            if ( 0 == key_value_db_process_incr(p_key_value_db, _operations[applied].p_key, _operations[applied].delta, _scratch, &scratch_len) ) break;
+        }
+    }
+
+    // done batching
+    p_key_value_db->batching = false;
+
+    // stay under the memory limit, once the whole batch is written
+    key_value_db_evict(p_key_value_db, NULL);
+
+    // a write failed. the writes before it stay
+    if ( applied < operation_count ) goto failed_to_apply;
+
+    // serialize the response
+    *p_response_len = (size_t) sprintf(p_response, "{\"okay\":true,\"value\":{\"version\":%llu,\"operations\":%zu}}", p_key_value_db->sequence, operation_count);
+
+    release:
+
+    // release the values no write took over
+    for (size_t i = 0; i < operation_count; i++) key_value_value_free(&_operations[i]._value);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_request:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_request\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            too_many_operations:
+                #ifndef NDEBUG
+                    log_error("[key value db] Batch has more than %d operations in call to function \"%s\"\n", KEY_VALUE_DB_BATCH_MAX, __FUNCTION__);
+                #endif
+
+                // fall through
+                goto bad_batch;
+
+            bad_operation:
+                #ifndef NDEBUG
+                    log_error("[key value db] Bad batch operation \"%s\" in call to function \"%s\"\n", p_line, __FUNCTION__);
+                #endif
+
+                // fall through
+                goto bad_batch;
+
+            no_exec:
+                #ifndef NDEBUG
+                    log_error("[key value db] Batch does not end with \"exec\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // fall through
+                goto bad_batch;
+
+            bad_batch:
+
+                // release the values that were built
+                for (size_t i = 0; i < operation_count; i++) key_value_value_free(&_operations[i]._value);
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+
+            failed_to_apply:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to apply operation %zu of a batch in call to function \"%s\"\n", applied, __FUNCTION__);
+                #endif
+
+                // release the values no write took over
+                for (size_t i = applied; i < operation_count; i++) key_value_value_free(&_operations[i]._value);
+
+                // the writes before the one that failed were applied
+                *p_response_len = (size_t) sprintf(p_response, "{\"okay\":false,\"value\":{\"version\":%llu,\"applied\":%zu}}", p_key_value_db->sequence, applied);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_db_process_config
+(
+    key_value_db *p_key_value_db,
+    char         *p_name,
+    char         *p_value,
+
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==         p_name ) goto no_name;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // logs
+    log_info("[key value db] [config] \"%s\"\n", p_name);
+
+    // memory limit in bytes, or 0 for no limit
+    if ( 0 == strcmp(p_name, "maxmemory") )
+    {
+
+        // set
+        if ( p_value )
+        {
+            p_key_value_db->memory.max = strtoull(p_value, NULL, 10);
+            key_value_db_evict(p_key_value_db, NULL);
+        }
+
+        // serialize the response
+        *p_response_len = sprintf(p_response, "{\"okay\":true,\"value\":%zu}", p_key_value_db->memory.max);
+    }
+
+    // eviction policy
+    else if ( 0 == strcmp(p_name, "maxmemory-policy") )
+    {
+
+        // set
+        if ( p_value && 0 == eviction_policy_parse(p_value, &p_key_value_db->memory.policy) ) goto bad_value;
+
+        // serialize the response
+        *p_response_len = sprintf(p_response, "{\"okay\":true,\"value\":\"%s\"}", eviction_policy_name(p_key_value_db->memory.policy));
+    }
+
+    // connection limit
+    else if ( 0 == strcmp(p_name, "maxclients") )
+    {
+
+        // initialized data
+        unsigned long long limit = 0;
+
+        // set. at least the connection asking must fit
+        if ( p_value )
+        {
+            if ( false == key_value_db_parse_unsigned(p_value, &limit) || 0 == limit || limit > SIZE_MAX ) goto bad_value;
+            p_key_value_db->admission.max_connections = (size_t) limit;
+        }
+
+        // serialize the response
+        *p_response_len = sprintf(p_response, "{\"okay\":true,\"value\":%zu}", p_key_value_db->admission.max_connections);
+    }
+
+    // requests a connection may queue behind the one being served
+    else if ( 0 == strcmp(p_name, "maxinflight") )
+    {
+
+        // initialized data
+        unsigned long long limit = 0;
+
+        // set
+        if ( p_value )
+        {
+            if ( false == key_value_db_parse_unsigned(p_value, &limit) || limit >= SIZE_MAX ) goto bad_value;
+            p_key_value_db->admission.max_in_flight = (size_t) limit;
+        }
+
+        // serialize the response
+        *p_response_len = sprintf(p_response, "{\"okay\":true,\"value\":%zu}", p_key_value_db->admission.max_in_flight);
+    }
+
+    // slow log threshold, in microseconds
+    else if ( 0 == strcmp(p_name, "slowlog-threshold") )
+    {
+
+        // set
+        if ( p_value ) p_key_value_db->slowlog.threshold = strtoull(p_value, NULL, 10);
+
+        // serialize the response
+        *p_response_len = sprintf(p_response, "{\"okay\":true,\"value\":%llu}", p_key_value_db->slowlog.threshold);
+    }
+
+    // value compression. turning it on trains a dictionary from the values in
+    // memory, and packs them with it. turning it off leaves packed values packed
+    else if ( 0 == strcmp(p_name, "compression") )
+    {
+
+        // set
+        if ( p_value )
+        {
+            if      ( 0 == strcmp(p_value, "on")  ) { if ( 0 == key_value_db_compression_train(p_key_value_db) ) goto bad_value; }
+            else if ( 0 == strcmp(p_value, "off") ) dictionary_destroy(&p_key_value_db->compression.p_dictionary);
+            else                                    goto bad_value;
+        }
+
+        // serialize the response
+        *p_response_len = sprintf(p_response, "{\"okay\":true,\"value\":\"%s\"}", ( p_key_value_db->compression.p_dictionary ) ? "on" : "off");
+    }
+
+    // storage engine. tables can be added at run time, but not removed, since they may hold the only copy of a property
+    else if ( 0 == strcmp(p_name, "storage") )
+    {
+
+        // set
+        if ( p_value )
+        {
+
+            // back the keyspace with tables. every property in memory is dirty
+            if ( 0 == strcmp(p_value, "lsm") )
+            {
+                if ( NULL == p_key_value_db->storage.p_lsm )
+                {
+
+                    // initialized data
+                    lsm *p_lsm = NULL;
+
+                    // open the tables, then publish them to the prefetches
+                    if ( 0 == lsm_construct(&p_lsm, p_key_value_db->paths._lsm, KEY_VALUE_DB_BLOCK_CACHE) ) goto bad_value;
+                    __atomic_store_n(&p_key_value_db->storage.p_lsm, p_lsm, __ATOMIC_RELEASE);
+                    p_key_value_db->storage.dirty = p_key_value_db->memory.used;
+                }
+            }
+
+            // error check
+            else if ( 0 != strcmp(p_value, "memory") || p_key_value_db->storage.p_lsm ) goto bad_value;
+        }
+
+        // serialize the response
+        *p_response_len = sprintf(p_response, "{\"okay\":true,\"value\":\"%s\"}", ( p_key_value_db->storage.p_lsm ) ? "lsm" : "memory");
+    }
+
+    // unknown
+    else goto bad_value;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_name:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_name\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
+               #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // key value db errors
+        {
+            bad_value:
+                #ifndef NDEBUG
+                    log_error("[key value db] Bad config \"%s\" in call to function \"%s\"\n", p_name, __FUNCTION__);
+                #endif
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // error
+                return 0;
+        }
+    }
+}
+
+char *key_value_db_parse_token ( char *p_request, size_t request_len, size_t *p_cur )
+{
+
+    // initialized data
+    size_t cur   = *p_cur,
+           start = 0;
+
+    // skip leading blanks
+    while 
+    ( 
+        cur < request_len &&
+        isblank(p_request[cur])
+    ) cur++;
+
+    // bounds check
+    if ( cur >= request_len || p_request[cur] == '\0' ) return NULL;
+
+    // store the token start offset
+    start = cur;
+
+    // skip the token itself 
+    cur = tokenizer_token_end(p_request, request_len, cur);
+
+    // store a null terminator
+    p_request[cur] = '\0';
+
+    // update the cursor
+    *p_cur = cur + 1;
+
+    // done
+    return &p_request[start];
+}
+
+char *key_value_db_parse_value ( char *p_request, size_t request_len, size_t *p_cur )
+{
+
+    // initialized data
+    size_t cur   = *p_cur,
+           start = 0,
+           depth = 0;
+    bool   quote = false;
+
+    // skip leading blanks
+    while 
+    ( 
+        cur < request_len &&
+        isblank(p_request[cur])
+    ) cur++;
+
+    // bounds check
+    if ( cur >= request_len || p_request[cur] == '\0' ) return NULL;
+
+    // store the value start offset
+    start = cur;
+
+    // skip the value. strings, arrays and objects may contain blanks
+    for (; cur < request_len && p_request[cur] != '\0'; cur++)
+    {
+
+        // initialized data
+        char c = p_request[cur];
+
+        // inside a string
+        if ( quote )
+        {
+            if      ( c == '\\' ) cur++;
+            else if ( c == '"'  ) quote = false;
+        }
+
+        // outside a string
+        else if ( c == '"'             ) quote = true;
+        else if ( c == '[' || c == '{' ) depth++;
+        else if ( ( c == ']' || c == '}' ) && depth ) depth--;
+        else if ( 0 == depth && isblank(c) ) break;
+    }
+
+    // bounds check
+    if ( cur > request_len ) cur = request_len;
+
+    // store a null terminator
+    p_request[cur] = '\0';
+
+    // update the cursor
+    *p_cur = cur + 1;
+
+    // done
+    return &p_request[start];
+}
+
+bool key_value_db_parse_integer ( const char *p_text, long long *p_integer )
+{
+
+    // initialized data
+    char      *p_end   = NULL;
+    long long  integer = 0;
+
+    // parse the integer
+    errno   = 0,
+    integer = strtoll(p_text, &p_end, 10);
+
+    // empty, out of range, or followed by something that is not a digit
+    if ( p_end == p_text || '\0' != *p_end || ERANGE == errno ) return false;
+
+    // return the integer to the caller
+    *p_integer = integer;
+
+    // done
+    return true;
+}
+
+bool key_value_db_parse_unsigned ( const char *p_text, unsigned long long *p_integer )
+{
+
+    // initialized data
+    char               *p_end   = NULL;
+    unsigned long long  integer = 0;
+
+    // strtoull takes a sign, and negates the integer
+    if ( *p_text < '0' || *p_text > '9' ) return false;
+
+    // parse the integer
+    errno   = 0,
+    integer = strtoull(p_text, &p_end, 10);
+
+    // out of range, or followed by something that is not a digit
+    if ( '\0' != *p_end || ERANGE == errno ) return false;
+
+    // return the integer to the caller
+    *p_integer = integer;
+
+    // done
+    return true;
+}
+
+bool key_value_db_parse_expiry ( char *p_value, long long *p_seconds )
+{
+
+    // initialized data
+    size_t len    = strlen(p_value),
+           digits = 0;
+
+    // skip trailing blanks
+    while ( len && isblank(p_value[len - 1]) ) len--;
+
+    // skip the seconds
+    digits = len;
+    while ( digits && isdigit(p_value[digits - 1]) ) digits--;
+
+    // no seconds?
+    if ( digits == len || 0 == digits || !isblank(p_value[digits - 1]) ) return false;
+
+    // skip the blanks before the seconds
+    len = digits;
+    while ( len && isblank(p_value[len - 1]) ) len--;
+
+    // no "ex" token?
+    if ( len < 3 || 0 != strncmp(&p_value[len - 2], "ex", 2) || !isblank(p_value[len - 3]) ) return false;
+
+    // parse the seconds
+    *p_seconds = strtoll(&p_value[digits], NULL, 10);
+
+    // strip the expiry from the value
+    p_value[len - 2] = '\0';
+
+    // done
+    return true;
+}
+
+int key_value_db_process
+( 
+    key_value_db *p_key_value_db, 
+    char *p_request, size_t request_len,
+    char *p_response, size_t *p_response_len
+)
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==      p_request ) goto no_request;
+    if ( NULL ==     p_response ) goto no_response;
+    if ( NULL == p_response_len ) goto no_response_len;
+
+    // initialized data
+    size_t          cur      = 0;
+    tokenizer_verb  verb     = TOKENIZER_VERB_UNKNOWN;
+    char           *command  = NULL,
+           *op1      = NULL,
+           *op2      = NULL,
+           *op3      = NULL;
+
+    size_t command_start = 0, command_end   = 0,
+           op1_start     = 0, op1_end       = 0,
+           op2_start     = 0, op2_end       = 0,
+           op3_start     = 0, op3_end       = 0;
+
+    unsigned long long start = 0;
+
+    // the clock is only read for a tracer
+    if ( KEY_VALUE_DB_PROBE_ENABLED(request__end) ) start = key_value_db_ticks();
+
+    // refuse requests once shutdown has started
+    if ( p_key_value_db->stopping ) goto shutting_down;
+
+    // the server is not idle
+    p_key_value_db->last_request = key_value_db_time_ms();
+
+    // parse the command
+    {
+
+        // skip leading blanks
+        while 
+        ( 
+            isblank(p_request[cur]) && 
+            cur < request_len
+        ) cur++;
+        
+        // bounds check
+        if ( cur >= request_len ) goto bad_request;
+
+        // store the command start offset
+        command_start = cur;
+
+        // skip the command itself. a batch puts its first operation on the next line
+        cur = tokenizer_token_end(p_request, request_len, cur);
+
+        // store the command end offset
+        command_end = cur;
+
+        // store the command
+        command = &p_request[command_start],
+        verb    = tokenizer_verb_parse(command, command_end - command_start),
+        p_request[command_end] = '\0',
+        cur++;
+
+        // the slow log names the command, and its first operand
+        p_key_value_db->slowlog.p_command = command;
+        if ( cur < request_len ) p_key_value_db->slowlog.p_key = &p_request[cur];
+
+        // print the command
+        log_info("[key value db] Command: \"%s\"\n", command);
+
+        // trace the request, with its unparsed operands
+        KEY_VALUE_DB_PROBE3(request__start, command, ( cur < request_len ) ? &p_request[cur] : "", request_len);
+    }
+
+    // process get
+    if ( TOKENIZER_VERB_GET == verb )
+    {
+
+        // error check
+        if ( p_request[cur] == '\0' ) goto failed_to_parse_get_key;
+
+        // parse the key
+        {
+
+            // skip leading blanks
+            while 
+            ( 
+                isblank(p_request[cur]) && 
+                cur < request_len
+            ) cur++;
+
+            // bounds check
+            if ( cur >= request_len ) goto bad_request;
+
+            // store operand start offset
+            op1_start = cur;
+
+            // skip the operand itself 
+            cur = tokenizer_token_end(p_request, request_len, cur);
+
+            // bounds check
+            if ( cur > request_len ) goto bad_request;
+
+            // store the operand end offset
+            op1_end = cur;
+
+            // store the operand
+            op1 = &p_request[op1_start];
+            p_request[op1_end] = '\0';
+            cur++;
+            
+            // print the operand
+            // log_info("[key value db] Operand 1: \"%s\"\n", op1);
+        }
+
+        // error check
+        if ( NULL == op1 ) goto failed_to_parse_get_key;
+
+        // parse the optional snapshot
+        op2 = key_value_db_parse_token(p_request, request_len, &cur);
+
+        // process the get command
+        if ( op2 ) key_value_db_process_get_at(p_key_value_db, op1, op2, p_response, p_response_len);
+        else       key_value_db_process_get(p_key_value_db, op1, p_response, p_response_len);
+
+        // increment counters
+        p_key_value_db->counter.request.get++;
+    }
+    
+    // process set
+    else if ( TOKENIZER_VERB_SET == verb )
+    {
+
+        // initialized data
+        key_value_value     _value  = { 0 };
+        size_t              length  = 0;
+        unsigned char       type    = 0;
+        long long           seconds = 0;
+        unsigned long long  expires = 0;
+
+        // error check
+        if ( p_request[cur] == '\0' ) goto failed_to_parse_set_key;
+
+        // parse the key
+        {
+
+            // skip leading blanks
+            while 
+            ( 
+                isblank(p_request[cur]) && 
+                cur < request_len
+            ) cur++;
+
+            // bounds check
+            if ( cur >= request_len ) goto bad_request;
+
+            // store operand start offset
+            op1_start = cur;
+
+            // skip the operand itself 
+            cur = tokenizer_token_end(p_request, request_len, cur);
+
+            // bounds check
+            if ( cur > request_len ) goto bad_request;
+
+            // store the operand end offset
+            op1_end = cur;
+
+            // store the operand
+            op1 = &p_request[op1_start];
+            p_request[op1_end] = '\0';
+            cur++;
+            
+            // print the operand
+            // log_info("[key value db] Operand 1: \"%s\"\n", op1);
+        }
+
+        // parse the value
+        {
+
+            // skip leading blanks
+            while
+            (
+                isblank(p_request[cur]) &&
+                cur < request_len
+            ) cur++;
+
+            // bounds check
+            if (cur >= request_len) goto failed_to_parse_set_value;
+
+            // store operand start offset
+            op2_start = cur;
+
+            // the operand is the rest of the request
+            cur += strnlen(&p_request[cur], request_len - cur);
+
+            // bounds check
+            if (cur > request_len) goto failed_to_parse_set_value;
+
+            // store the operand end offset
+            op2_end = cur;
+
+            // store the operand
+            op2 = &p_request[op2_start];
+            p_request[op2_end] = '\0';
+            cur++;
+
+            // strip the optional expiry
+            if ( key_value_db_parse_expiry(op2, &seconds) )
+            {
+
+                // error check
+                if ( seconds <= 0 ) goto failed_to_parse_set_value;
+
+                // compute the expiry time
+                expires = key_value_db_time_ms() + (unsigned long long) seconds * 1000;
+            }
+
+            // validate, classify and minify the value in one pass
+            if ( 0 == json_path_minify(op2, strlen(op2), &length, &type) ) goto failed_to_parse_set_value;
+        }
+
+        // error check
+        if ( NULL == op1 ) goto failed_to_parse_set_key;
+
+        // store the value
+        if ( 0 == key_value_value_from_text(&_value, op2, length, type) ) goto failed_to_parse_set_value;
+
+        // process the set command. a failed write counts as an error
+        if ( key_value_db_process_set_value(p_key_value_db, op1, &_value, expires, p_response, p_response_len) )
+            p_key_value_db->counter.request.set++;
+    }
+
+    // process expire
+    else if ( TOKENIZER_VERB_EXPIRE == verb )
+    {
+
+        // initialized data
+        long long seconds = 0;
+
+        // parse the key and the seconds
+        op1 = key_value_db_parse_token(p_request, request_len, &cur);
+        op2 = key_value_db_parse_token(p_request, request_len, &cur);
+
+        // error check
+        if ( NULL == op1 || NULL == op2 ) goto bad_request;
+        if ( false == key_value_db_parse_integer(op2, &seconds) ) goto bad_request;
+
+        // process the expire command
+        key_value_db_process_expire(p_key_value_db, op1, seconds, p_response, p_response_len);
+    }
+
+    // process ttl
+    else if ( TOKENIZER_VERB_TTL == verb )
+    {
+
+        // parse the key
+        op1 = key_value_db_parse_token(p_request, request_len, &cur);
+
+        // error check
+        if ( NULL == op1 ) goto bad_request;
+
+        // process the ttl command
+        key_value_db_process_ttl(p_key_value_db, op1, p_response, p_response_len);
+    }
+    
+    // process incr, decr, incrby and decrby
+    else if
+    (
+        TOKENIZER_VERB_INCR   == verb ||
+        TOKENIZER_VERB_DECR   == verb ||
+        TOKENIZER_VERB_INCRBY == verb ||
+        TOKENIZER_VERB_DECRBY == verb
+    )
+    {
+
+        // initialized data
+        long long delta = 1;
+
+        // parse the key
+        op1 = key_value_db_parse_token(p_request, request_len, &cur);
+
+        // error check
+        if ( NULL == op1 ) goto bad_request;
+
+        // parse the delta
+        if ( TOKENIZER_VERB_INCRBY == verb || TOKENIZER_VERB_DECRBY == verb )
+        {
+            op2 = key_value_db_parse_token(p_request, request_len, &cur);
+            if ( NULL == op2 ) goto bad_request;
+            if ( false == key_value_db_parse_integer(op2, &delta) ) goto bad_request;
+        }
 
-        // key value db errors
+        // decrement. the smallest delta has no negation
+        if ( TOKENIZER_VERB_DECR == verb || TOKENIZER_VERB_DECRBY == verb )
         {
-            failed_to_construct_key_sets:
+            if ( LLONG_MIN == delta ) goto bad_request;
+            delta = -delta;
+        }
+
+        // process the incr command
+        key_value_db_process_incr(p_key_value_db, op1, delta, p_response, p_response_len);
+
+        // increment counters
+        p_key_value_db->counter.request.set++;
+    }
+
+    // process cas
+    else if ( TOKENIZER_VERB_CAS == verb )
+    {
+
+        // initialized data
+        key_value_value _value          = { 0 };
+        size_t          expected_len    = 0,
+                        length          = 0;
+        unsigned char   expected_type   = 0,
+                        type            = 0;
+
+        // parse the key, the expected value, and the new value
+        op1 = key_value_db_parse_token(p_request, request_len, &cur);
+        op2 = key_value_db_parse_value(p_request, request_len, &cur);
+        op3 = key_value_db_parse_value(p_request, request_len, &cur);
+
+        // error check
+        if ( NULL == op1 || NULL == op2 || NULL == op3 ) goto bad_request;
+
+        // validate and minify the values, so equal values compare equal
+        if ( 0 == json_path_minify(op2, strlen(op2), &expected_len, &expected_type) ) goto bad_request;
+        if ( 0 == json_path_minify(op3, strlen(op3), &length, &type)                ) goto bad_request;
+        if ( 0 == key_value_value_from_text(&_value, op3, length, type)              ) goto bad_request;
+
+        // process the cas command
+        key_value_db_process_cas(p_key_value_db, op1, op2, expected_len, expected_type, &_value, p_response, p_response_len);
+
+        // increment counters
+        p_key_value_db->counter.request.set++;
+    }
+
+    // process jget
+    else if ( TOKENIZER_VERB_JGET == verb )
+    {
+
+        // parse the key, and the path
+        op1 = key_value_db_parse_token(p_request, request_len, &cur);
+        op2 = key_value_db_parse_token(p_request, request_len, &cur);
+
+        // error check
+        if ( NULL == op1 || NULL == op2 ) goto bad_request;
+
+        // process the jget command
+        key_value_db_process_jget(p_key_value_db, op1, op2, p_response, p_response_len);
+
+        // increment counters
+        p_key_value_db->counter.request.get++;
+    }
+
+    // process jset, and jappend
+    else if ( TOKENIZER_VERB_JSET == verb || TOKENIZER_VERB_JAPPEND == verb )
+    {
+
+        // initialized data
+        size_t        length = 0;
+        unsigned char type   = 0;
+
+        // parse the key, the path, and the fragment
+        op1 = key_value_db_parse_token(p_request, request_len, &cur);
+        op2 = key_value_db_parse_token(p_request, request_len, &cur);
+        op3 = key_value_db_parse_value(p_request, request_len, &cur);
+
+        // error check
+        if ( NULL == op1 || NULL == op2 || NULL == op3 ) goto bad_request;
+
+        // validate and minify the fragment. the stored document is never parsed
+        if ( 0 == json_path_minify(op3, strlen(op3), &length, &type) ) goto bad_request;
+
+        // process the jset command
+        key_value_db_process_jset(p_key_value_db, op1, op2, op3, length, type, TOKENIZER_VERB_JAPPEND == verb, p_response, p_response_len);
+
+        // increment counters
+        p_key_value_db->counter.request.set++;
+    }
+
+    // process batch
+    else if ( TOKENIZER_VERB_BATCH == verb )
+    {
+
+        // process the batch command
+        key_value_db_process_batch(p_key_value_db, &p_request[cur], ( cur < request_len ) ? request_len - cur : 0, p_response, p_response_len);
+
+        // increment counters
+        p_key_value_db->counter.request.set++;
+    }
+
+    // process version
+    else if ( TOKENIZER_VERB_VERSION == verb )
+    {
+
+        // parse the key
+        op1 = key_value_db_parse_token(p_request, request_len, &cur);
+
+        // error check
+        if ( NULL == op1 ) goto bad_request;
+
+        // process the version command
+        key_value_db_process_version(p_key_value_db, op1, p_response, p_response_len);
+    }
+
+    // process config
+    else if ( TOKENIZER_VERB_CONFIG == verb )
+    {
+
+        // parse the name, and the optional value
+        op1 = key_value_db_parse_token(p_request, request_len, &cur);
+        op2 = key_value_db_parse_token(p_request, request_len, &cur);
+
+        // error check
+        if ( NULL == op1 ) goto bad_request;
+
+        // process the config command
+        key_value_db_process_config(p_key_value_db, op1, op2, p_response, p_response_len);
+    }
+
+    // process info
+    else if ( TOKENIZER_VERB_INFO == verb )
+    {
+
+        // parse the optional section
+        op1 = key_value_db_parse_token(p_request, request_len, &cur);
+
+        // process the info command
+        if      ( NULL == op1 )                  key_value_db_process_info(p_key_value_db, p_response, p_response_len);
+        else if ( 0 == strcmp(op1, "hotkeys") )  key_value_db_process_info_hot_keys(p_key_value_db, p_response, p_response_len);
+        else if ( 0 == strcmp(op1, "memory") )   key_value_db_process_info_memory(p_key_value_db, p_response, p_response_len);
+        else                                     goto bad_request;
+    }
+
+    // process write
+    else if ( TOKENIZER_VERB_WRITE == verb )
+    {
+
+        // process the write command
+        key_value_db_process_write(p_key_value_db, p_response, p_response_len);
+    }
+
+    // process slowlog
+    else if ( TOKENIZER_VERB_SLOWLOG == verb )
+    {
+
+        // parse the optional quantity, or reset
+        op1 = key_value_db_parse_token(p_request, request_len, &cur);
+
+        // process the slowlog command
+        key_value_db_process_slowlog(p_key_value_db, op1, p_response, p_response_len);
+    }
+
+    // process index
+    else if ( TOKENIZER_VERB_INDEX == verb )
+    {
+
+        // parse the optional name, pattern and path
+        op1 = key_value_db_parse_token(p_request, request_len, &cur);
+        op2 = ( op1 ) ? key_value_db_parse_token(p_request, request_len, &cur) : NULL;
+        op3 = ( op2 ) ? key_value_db_parse_token(p_request, request_len, &cur) : NULL;
+
+        // error check
+        if ( op3 && key_value_db_parse_token(p_request, request_len, &cur) ) goto bad_request;
+
+        // process the index command
+        key_value_db_process_index(p_key_value_db, op1, op2, op3, p_response, p_response_len);
+    }
+
+    // process find
+    else if ( TOKENIZER_VERB_FIND == verb )
+    {
+
+        // parse the name, the value, and the optional offset
+        op1 = key_value_db_parse_token(p_request, request_len, &cur);
+        op2 = key_value_db_parse_value(p_request, request_len, &cur);
+        op3 = key_value_db_parse_token(p_request, request_len, &cur);
+
+        // error check
+        if ( NULL == op1 || NULL == op2 ) goto bad_request;
+
+        // process the find command
+        key_value_db_process_find(p_key_value_db, op1, op2, ( op3 ) ? strtoull(op3, NULL, 10) : 0, p_response, p_response_len);
+    }
+
+    // process snapshot
+    else if ( TOKENIZER_VERB_SNAPSHOT == verb )
+    {
+
+        // parse the optional operation, and snapshot
+        op1 = key_value_db_parse_token(p_request, request_len, &cur);
+        op2 = ( op1 ) ? key_value_db_parse_token(p_request, request_len, &cur) : NULL;
+
+        // error check
+        if ( op2 && key_value_db_parse_token(p_request, request_len, &cur) ) goto bad_request;
+
+        // process the snapshot command
+        key_value_db_process_snapshot(p_key_value_db, op1, op2, p_response, p_response_len);
+    }
+
+    // process scan
+    else if ( TOKENIZER_VERB_SCAN == verb )
+    {
+
+        // parse the snapshot, and the optional pattern and cursor
+        op1 = key_value_db_parse_token(p_request, request_len, &cur);
+        op2 = ( op1 ) ? key_value_db_parse_token(p_request, request_len, &cur) : NULL;
+        op3 = ( op2 ) ? key_value_db_parse_token(p_request, request_len, &cur) : NULL;
+
+        // error check
+        if ( NULL == op1 ) goto bad_request;
+
+        // process the scan command
+        key_value_db_process_scan(p_key_value_db, op1, op2, op3, p_response, p_response_len);
+    }
+
+    // process watch
+    else if ( TOKENIZER_VERB_WATCH == verb )
+    {
+
+        // parse the prefix
+        op1 = key_value_db_parse_token(p_request, request_len, &cur);
+
+        // error check
+        if ( NULL == op1 ) goto bad_request;
+
+        // process the watch command
+        key_value_db_process_watch(p_key_value_db, op1, p_response, p_response_len);
+    }
+
+    // error
+    else 
+    {
+
+        // copy the error message to the response buffer
+        memcpy(p_response, "{\"okay\":false}", 14);
+        *p_response_len = 14;
+
+        // increment counters
+        p_key_value_db->counter.request.err++;
+    }
+
+    // trace the response
+    if ( KEY_VALUE_DB_PROBE_ENABLED(request__end) )
+        KEY_VALUE_DB_PROBE5(request__end, command, ( op1 ) ? op1 : "", key_value_db_elapsed_ns(p_key_value_db, start), *p_response_len, true);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
                 #ifndef NDEBUG
-                    log_error("[key value db] Failed to construct key sets in call to function \"%s\"", __FUNCTION__);
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
                 #endif
 
                 // error
                 return 0;
-        }
 
-        // binary tree errors
-        {
-            failed_to_construct_binary_tree:
+            no_request:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_request\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_response_len:
                 #ifndef NDEBUG
-                    log_error("[key value db] Failed to construct binary tree in call to function \"%s\"", __FUNCTION__);
+                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
                 #endif
 
                 // error
                 return 0;
         }
 
-        // standard library errors
+        // key value db errors
         {
-            no_mem:
+            failed_to_parse_get_key:
                 #ifndef NDEBUG
-                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"", __FUNCTION__);
+                    log_error("[key value db] Failed to parse get request key in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            failed_to_parse_set_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to parse set request key in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            failed_to_parse_set_value:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to parse set request value in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            bad_request:
+                #ifndef NDEBUG
+                    log_error("[key value db] Bad request in call to function \"%s\"\n", __FUNCTION__);
                 #endif
 
+                // done
+                goto failed;
+
+            shutting_down:
+                #ifndef NDEBUG
+                    log_error("[key value db] Refused a request during shutdown in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // done
+                goto failed;
+
+            failed:
+
+                // copy the error message to the response buffer
+                memcpy(p_response, "{\"okay\":false}", 14);
+                *p_response_len = 14;
+
+                // increment counters
+                p_key_value_db->counter.request.err++;
+
+                // trace the response
+                if ( KEY_VALUE_DB_PROBE_ENABLED(request__end) )
+                    KEY_VALUE_DB_PROBE5(request__end, ( command ) ? command : "", ( op1 ) ? op1 : "", key_value_db_elapsed_ns(p_key_value_db, start), *p_response_len, false);
+
                 // error
                 return 0;
         }
     }
 }
 
-int key_value_db_process_info
-( 
-    key_value_db *p_key_value_db, 
-    
-    char *p_response, size_t *p_response_len
-)
+int key_value_db_value_parse ( key_value_value *p_value, const char *p_text, size_t length )
 {
 
-    // argument check
-    if ( NULL == p_key_value_db ) goto no_key_value_db;
-    if ( NULL ==     p_response ) goto no_response;
-    if ( NULL == p_response_len ) goto no_response_len;
-
     // initialized data
-    key_value_property *p_value = NULL;
+    char          *p_buffer = NULL;
+    unsigned char  type     = 0;
 
-    // logs
-    log_info("[key value db] [info]\n");
+    // a small value is minified on the stack, and stored inline, or copied
+    if ( length < KEY_VALUE_DB_FRAME_SMALL )
+    {
 
-    // serialize the response
-    *p_response_len = 1 + sprintf(p_response,  
-        "{\"okay\":true,\"value\":{\"get\":%d,\"set\":%d,\"err\":%d}}",
+        // initialized data
+        char _text[KEY_VALUE_DB_FRAME_SMALL];
 
-        p_key_value_db->counter.request.get,
-        p_key_value_db->counter.request.set,
-        p_key_value_db->counter.request.err
-    );
+        // copy the value, so it can be minified in place
+        memcpy(_text, p_text, length);
+        _text[length] = '\0';
 
-    // success
-    return 1;
+        // validate, and minify the value
+        if ( 0 == json_path_minify(_text, length, &length, &type) ) return 0;
 
-    // error handling
+        // done
+        return key_value_value_from_text(p_value, _text, length, type);
+    }
+
+    // error check
+    if ( length > KEY_VALUE_VALUE_LIMIT ) return 0;
+
+    // a large value is copied once, to its final buffer
+    p_buffer = key_value_value_allocate(length + 1);
+    if ( NULL == p_buffer ) return 0;
+    memcpy(p_buffer, p_text, length);
+    p_buffer[length] = '\0';
+
+    // validate the value in one pass
+    if ( 0 == json_path_classify(p_buffer, length, &type) )
     {
 
-        // argument errors
-        {
-            no_key_value_db:
-                #ifndef NDEBUG
-                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
-                #endif
+        // release the buffer
+        key_value_value_release(p_buffer);
+
+        // error
+        return 0;
+    }
+
+    // done
+    return key_value_value_adopt(p_value, p_buffer, length, type);
+}
+
+int key_value_db_value_copy ( const key_value_value *p_value, char *p_buffer, size_t capacity, size_t *p_length )
+{
 
-                // error
-                return 0;
+    // initialized data
+    size_t length = key_value_value_length(p_value);
 
-            no_response:
-               #ifndef NDEBUG
-                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
-                #endif
+    // the caller learns the length it needs, even if the value does not fit
+    *p_length = length;
 
-                // error
-                return 0;
+    // error check
+    if ( NULL == p_buffer || length >= capacity ) return 0;
 
-            no_response_len:
-               #ifndef NDEBUG
-                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
-                #endif
+    // write the value, and a null terminator
+    key_value_value_serialize(p_value, p_buffer);
+    p_buffer[length] = '\0';
 
-                // error
-                return 0;
-        }
-    }
+    // success
+    return 1;
 }
 
-int key_value_db_process_write
-( 
-    key_value_db *p_key_value_db, 
-    
-    char *p_response, size_t *p_response_len
-)
+int key_value_db_get ( key_value_db *p_key_value_db, const char *p_key, char *p_value, size_t capacity, size_t *p_length )
 {
 
     // argument check
     if ( NULL == p_key_value_db ) goto no_key_value_db;
-    if ( NULL ==     p_response ) goto no_response;
-    if ( NULL == p_response_len ) goto no_response_len;
+    if ( NULL ==          p_key ) goto no_key;
+    if ( NULL ==       p_length ) goto no_length;
 
     // initialized data
-    key_value_property *p_value = NULL;
+    key_value_property *p_property = NULL;
+    int                 result     = 0;
 
-    // logs
-    log_info("[key value db] [write]\n");
+    // a miss has no length
+    *p_length = 0;
 
-    // serialize the response
-    // *p_response_len = 1 + sprintf(p_response,  
-    //     "{\"okay\":true,\"value\":{\"get\":%d,\"set\":%d,\"err\":%d}}",
+    // lock
+    mutex_lock(&p_key_value_db->_lock);
 
-    //     p_key_value_db->counter.request.get,
-    //     p_key_value_db->counter.request.set,
-    //     p_key_value_db->counter.request.err
-    // );
+    // refuse reads once shutdown has started
+    if ( p_key_value_db->stopping ) goto shutting_down;
 
-    // success
-    return 1;
+    // the database is not idle
+    p_key_value_db->last_request = key_value_db_time_ms();
+
+    // find the property, and copy its value
+    if ( key_value_db_fetch(p_key_value_db, p_key, &p_property) )
+        result = key_value_db_value_copy(&p_property->_value, p_value, capacity, p_length);
+
+    // increment counters
+    p_key_value_db->counter.request.get++;
+
+    // unlock
+    mutex_unlock(&p_key_value_db->_lock);
+
+    // done
+    return result;
 
     // error handling
     {
@@ -435,82 +8052,74 @@ int key_value_db_process_write
                 // error
                 return 0;
 
-            no_response:
-               #ifndef NDEBUG
-                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key\" in call to function \"%s\"", __FUNCTION__);
                 #endif
 
                 // error
                 return 0;
 
-            no_response_len:
-               #ifndef NDEBUG
-                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+            no_length:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_length\" in call to function \"%s\"", __FUNCTION__);
                 #endif
 
                 // error
                 return 0;
         }
+
+        // key value db errors
+        {
+            shutting_down:
+
+                // unlock
+                mutex_unlock(&p_key_value_db->_lock);
+
+                // error
+                return 0;
+        }
     }
 }
 
-int key_value_db_process_get
-( 
-    key_value_db *p_key_value_db, 
-    char         *p_key, 
-    
-    char *p_response, size_t *p_response_len
-)
+int key_value_db_set ( key_value_db *p_key_value_db, const char *p_key, const char *p_value, size_t length, long long seconds )
 {
 
     // argument check
     if ( NULL == p_key_value_db ) goto no_key_value_db;
     if ( NULL ==          p_key ) goto no_key;
-    if ( NULL ==     p_response ) goto no_response;
-    if ( NULL == p_response_len ) goto no_response_len;
+    if ( NULL ==        p_value ) goto no_value;
+    if ( strlen(p_key) > 63     ) goto key_too_long;
+    if ( seconds < 0            ) goto bad_expiry;
 
     // initialized data
-    key_value_property *p_value = NULL;
+    key_value_value    _value  = { 0 };
+    unsigned long long expires = ( seconds ) ? key_value_db_time_ms() + (unsigned long long) seconds * 1000 : 0;
+    int                result  = 0;
 
-    // logs
-    log_info("[key value db] [get] \"%s\"\n", p_key);
+    // validate the value, before taking the lock
+    if ( 0 == key_value_db_value_parse(&_value, p_value, length) ) goto bad_value;
 
-    // search the cache
-    if ( 0 == cache_find(p_key_value_db->p_cache, p_key, (void **)&p_value) ) goto not_in_cache;
-    
-    // logs
-    log_info("[key value db] Found key \"%s\" in cache \n", p_key);
+    // lock
+    mutex_lock(&p_key_value_db->_lock);
 
-    found:
+    // refuse writes once shutdown has started
+    if ( p_key_value_db->stopping ) goto shutting_down;
 
-    // serialize the response
-    memcpy(p_response, "{\"okay\":true,\"value\":", 21);
-    *p_response_len = 21 + json_value_serialize(p_value->p_value, p_response + 21);
-    memcpy(p_response + *p_response_len, "}", 1);
-    (*p_response_len)++;
+    // the database is not idle
+    p_key_value_db->last_request = key_value_db_time_ms();
 
-    // success
-    return 1;
+    // store the value
+    result = key_value_db_store(p_key_value_db, p_key, &_value, expires, NULL);
 
-    // this branch handles cache misses
-    not_in_cache:
-    {
+    // increment counters
+    p_key_value_db->counter.request.set++;
 
-        // search the binary tree
-        if ( 0 == binary_tree_search(p_key_value_db->p_binary_tree, p_key, (void **)&p_value) ) goto not_a_key;
-        
-        // logs
-        log_info("[key value db] Found key \"%s\" in tree\n", p_key);
-        
-        // logs
-        log_info("[key value db] Adding key \"%s\" to cache\n", p_key);
-    
-        // add the value to the cache
-        cache_insert(p_key_value_db->p_cache, p_value->_name, p_value);
+    // unlock
+    mutex_unlock(&p_key_value_db->_lock);
 
-        // done
-        goto found;
-    }
+    // done
+    return result;
 
     // error handling
     {
@@ -533,17 +8142,25 @@ int key_value_db_process_get
                 // error
                 return 0;
 
-            no_response:
-               #ifndef NDEBUG
-                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+            no_value:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_value\" in call to function \"%s\"", __FUNCTION__);
                 #endif
 
                 // error
                 return 0;
 
-            no_response_len:
-               #ifndef NDEBUG
-                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+            key_too_long:
+                #ifndef NDEBUG
+                    log_error("[key value db] Parameter \"p_key\" must be at most 63 characters in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            bad_expiry:
+                #ifndef NDEBUG
+                    log_error("[key value db] Parameter \"seconds\" must not be negative in call to function \"%s\"", __FUNCTION__);
                 #endif
 
                 // error
@@ -552,14 +8169,21 @@ int key_value_db_process_get
 
         // key value db errors
         {
-            not_a_key:
+            bad_value:
                 #ifndef NDEBUG
-                    log_error("[key value db] Key \"%s\" not found in call to function \"%s\"\n", p_key, __FUNCTION__);
+                    log_error("[key value db] Failed to parse value of key \"%s\" in call to function \"%s\"\n", p_key, __FUNCTION__);
                 #endif
 
-                // copy the error message to the response buffer
-                memcpy(p_response, "{\"okay\":false}", 14);
-                *p_response_len = 14;
+                // error
+                return 0;
+
+            shutting_down:
+
+                // unlock
+                mutex_unlock(&p_key_value_db->_lock);
+
+                // release the value
+                key_value_value_free(&_value);
 
                 // error
                 return 0;
@@ -567,59 +8191,55 @@ int key_value_db_process_get
     }
 }
 
-int key_value_db_process_set
-(
-    key_value_db *p_key_value_db,
-    char         *p_key,
-    json_value   *p_value,
+int key_value_db_del_key ( key_value_db *p_key_value_db, const char *p_key )
+{
 
-    char *p_response, size_t *p_response_len
-)
+    // initialized data
+    key_value_property *p_property = NULL;
+
+    // search the tree, and the tables
+    if ( 0 == key_value_db_lookup(p_key_value_db, p_key, &p_property) ) return 0;
+
+    // already expired. the expiry removes it
+    if ( key_value_property_expired(p_property, key_value_db_time_ms()) ) return 0;
+
+    // remove the property
+    key_value_db_delete(p_key_value_db, p_property);
+
+    // increment counters
+    p_key_value_db->counter.request.del++;
+
+    // success
+    return 1;
+}
+
+int key_value_db_del ( key_value_db *p_key_value_db, const char *p_key )
 {
 
     // argument check
     if ( NULL == p_key_value_db ) goto no_key_value_db;
     if ( NULL ==          p_key ) goto no_key;
-    if ( NULL ==        p_value ) goto no_value;
-    if ( NULL ==     p_response ) goto no_response;
-    if ( NULL == p_response_len ) goto no_response_len;
 
     // initialized data
-    key_value_property *p_property = NULL;
-
-    // logs
-    log_info("[key value db] [set] \"%s\"\n", p_key);
-
-    if ( binary_tree_search(p_key_value_db->p_binary_tree, p_key, (void **)&p_property) ) 
-        binary_tree_remove(p_key_value_db->p_binary_tree, p_property, (void **)&p_property);
-
-    p_property = default_allocator(0, sizeof(key_value_property));
-    if (NULL == p_property) goto no_mem;
-    
-    // copy the key
-    strncpy(p_property->_name, p_key, sizeof(p_property->_name) - 1);
-    p_property->_name[sizeof(p_property->_name) - 1] = '\0';
+    int result = 0;
 
-    // serialize the value
-    json_value_serialize(p_value, p_property->_value);
+    // lock
+    mutex_lock(&p_key_value_db->_lock);
 
-    // parse the value
-    json_value_parse(p_property->_value, NULL, &p_property->p_value);
+    // refuse writes once shutdown has started
+    if ( p_key_value_db->stopping ) goto shutting_down;
 
-    // insert the value 
-    binary_tree_insert(p_key_value_db->p_binary_tree, p_property);
+    // the database is not idle
+    p_key_value_db->last_request = key_value_db_time_ms();
 
-    // remove the property from the cache
-    cache_remove(p_key_value_db->p_cache, p_property->_name, NULL);
+    // delete the key
+    result = key_value_db_del_key(p_key_value_db, p_key);
 
-    // serialize the response
-    memcpy(p_response, "{\"okay\":true,\"value\":", 21);
-    *p_response_len = 21 + json_value_serialize(p_property->p_value, p_response + 21);
-    memcpy(p_response + *p_response_len, "}", 1);
-    (*p_response_len)++;
+    // unlock
+    mutex_unlock(&p_key_value_db->_lock);
 
-    // success
-    return 1;
+    // done
+    return result;
 
     // error handling
     {
@@ -639,55 +8259,16 @@ int key_value_db_process_set
                     log_error("[key value db] Null pointer provided for parameter \"p_key\" in call to function \"%s\"", __FUNCTION__);
                 #endif
 
-                // error
-                return 0;
-
-            no_value:
-               #ifndef NDEBUG
-                    log_error("[key value db] Null pointer provided for parameter \"p_value\" in call to function \"%s\"", __FUNCTION__);
-                #endif
-
-                // error
-                return 0;
-
-            no_response:
-               #ifndef NDEBUG
-                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
-                #endif
-
-                // error
-                return 0;
-
-            no_response_len:
-               #ifndef NDEBUG
-                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
-                #endif
-
                 // error
                 return 0;
         }
 
         // key value db errors
         {
-            not_a_key:
-                #ifndef NDEBUG
-                    log_error("[key value db] Key \"%s\" not found in call to function \"%s\"\n", p_key, __FUNCTION__);
-                #endif
+            shutting_down:
 
-                // copy the error message to the response buffer
-                memcpy(p_response, "{\"okay\":false}", 14);
-                *p_response_len = 14;
-
-                // error
-                return 0;
-        }
-
-        // standard library errors
-        {
-            no_mem:
-                #ifndef NDEBUG
-                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"", __FUNCTION__);
-                #endif
+                // unlock
+                mutex_unlock(&p_key_value_db->_lock);
 
                 // error
                 return 0;
@@ -695,252 +8276,291 @@ int key_value_db_process_set
     }
 }
 
-
-int key_value_db_process
-( 
-    key_value_db *p_key_value_db, 
-    char *p_request, size_t request_len,
-    char *p_response, size_t *p_response_len
+int key_value_db_scan
+(
+    key_value_db       *p_key_value_db,
+    const char         *p_pattern,
+    const char         *p_after,
+    key_value_db_entry *p_entries,
+    size_t              capacity,
+    size_t             *p_count,
+    bool               *p_more
 )
 {
 
     // argument check
     if ( NULL == p_key_value_db ) goto no_key_value_db;
-    if ( NULL ==      p_request ) goto no_request;
-    if ( NULL ==     p_response ) goto no_response;
-    if ( NULL == p_response_len ) goto no_response_len;
+    if ( NULL ==      p_entries ) goto no_entries;
+    if ( NULL ==        p_count ) goto no_count;
+    if ( NULL ==         p_more ) goto no_more;
 
     // initialized data
-    size_t  cur = 0;
-    char   *command  = NULL,
-           *op1      = NULL,
-           *op2      = NULL,
-           *op3      = NULL;
+    key_value_db_scan_page  _scan    = { .p_pattern = p_pattern, .p_after = p_after };
+    mvcc_snapshot           _now     = { 0 };
+    key_value_value         _scratch = { 0 };
+    const key_value_value  *p_value  = NULL;
+    unsigned long long      version  = 0;
+    size_t                  count    = 0,
+                            read     = 0;
 
-    size_t command_start = 0, command_end   = 0,
-           op1_start     = 0, op1_end       = 0,
-           op2_start     = 0, op2_end       = 0,
-           op3_start     = 0, op3_end       = 0;
+    // lock
+    mutex_lock(&p_key_value_db->_lock);
 
-    // parse the command
+    // refuse reads once shutdown has started
+    if ( p_key_value_db->stopping ) goto shutting_down;
+
+    // the database is not idle
+    p_key_value_db->last_request = key_value_db_time_ms();
+
+    // read as of now, like a snapshot opened by this call, without promoting keys from the tables
+    _now.sequence = p_key_value_db->sequence + 1,
+    _now.time     = p_key_value_db->last_request;
+
+    // the next keys, from memory, and the tables
+    key_value_db_scan_index(p_key_value_db, &_scan);
+    if ( p_key_value_db->storage.p_lsm && 0 == lsm_keys(p_key_value_db->storage.p_lsm, key_value_db_scan_table_key, &_scan) ) goto failed_to_read_tables;
+
+    // read each key, until the entries are full
+    for (read = 0; read < _scan.count && count < capacity; read++)
     {
 
-        // skip leading blanks
-        while 
-        ( 
-            isblank(p_request[cur]) && 
-            cur < request_len
-        ) cur++;
-        
-        // bounds check
-        if ( cur >= request_len ) goto bad_request;
+        // initialized data
+        key_value_db_entry *p_entry = &p_entries[count];
 
-        // store the command start offset
-        command_start = cur;
+        // deleted, or expired
+        if ( NULL == ( p_value = key_value_db_read_at(p_key_value_db, &_now, _scan._keys[read], &_scratch, &version) ) ) continue;
+
+        // the key, and the value, if the entry has room for it
+        strcpy(p_entry->_key, _scan._keys[read]);
+        p_entry->result = ( p_entry->p_value ) ? key_value_db_value_copy(p_value, p_entry->p_value, p_entry->capacity, &p_entry->length)
+                                               : ( p_entry->length = key_value_value_length(p_value), 1 );
+        count++;
+
+        // release the value read from the tables
+        key_value_value_free(&_scratch);
+    }
+
+    // increment counters
+    p_key_value_db->counter.request.get++;
+
+    // unlock
+    mutex_unlock(&p_key_value_db->_lock);
+
+    // return the page to the caller
+    *p_count = count,
+    *p_more  = _scan.more || read < _scan.count;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
 
-        // skip the command itself 
-        while 
-        ( 
-            !isblank(p_request[cur]) && 
-            p_request[cur] != '\0' &&
-            cur < request_len
-        ) cur++;
+                // error
+                return 0;
 
-        // bounds check
-        if ( cur > request_len ) goto bad_request;
+            no_entries:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_entries\" in call to function \"%s\"", __FUNCTION__);
+                #endif
 
-        // store the command end offset
-        command_end = cur;
+                // error
+                return 0;
 
-        // store the command
-        command = &p_request[command_start],
-        p_request[command_end] = '\0',
-        cur++;
+            no_count:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_count\" in call to function \"%s\"", __FUNCTION__);
+                #endif
 
-        // print the command
-        log_info("[key value db] Command: \"%s\"\n", command);
-    }
+                // error
+                return 0;
 
-    // process get
-    if ( 0 == strcmp(command, "get") )
-    {
+            no_more:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_more\" in call to function \"%s\"", __FUNCTION__);
+                #endif
 
-        // error check
-        if ( p_request[cur] == '\0' ) goto failed_to_parse_get_key;
+                // error
+                return 0;
+        }
 
-        // parse the key
+        // key value db errors
         {
+            failed_to_read_tables:
+                #ifndef NDEBUG
+                    log_error("[key value db] Failed to read the tables in call to function \"%s\"\n", __FUNCTION__);
+                #endif
 
-            // skip leading blanks
-            while 
-            ( 
-                isblank(p_request[cur]) && 
-                cur < request_len
-            ) cur++;
+                // fall through
+                goto shutting_down;
 
-            // bounds check
-            if ( cur >= request_len ) goto bad_request;
+            shutting_down:
 
-            // store operand start offset
-            op1_start = cur;
+                // unlock
+                mutex_unlock(&p_key_value_db->_lock);
 
-            // skip the operand itself 
-            while 
-            ( 
-                !isblank(p_request[cur]) && 
-                p_request[cur] != '\0' &&
-                cur < request_len
-            ) cur++;
+                // error
+                return 0;
+        }
+    }
+}
 
-            // bounds check
-            if ( cur > request_len ) goto bad_request;
+size_t key_value_db_get_batch ( key_value_db *p_key_value_db, key_value_db_entry *p_entries, size_t count )
+{
 
-            // store the operand end offset
-            op1_end = cur;
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==      p_entries ) goto no_entries;
 
-            // store the operand
-            op1 = &p_request[op1_start];
-            p_request[op1_end] = '\0';
-            cur++;
-            
-            // print the operand
-            // log_info("[key value db] Operand 1: \"%s\"\n", op1);
-        }
+    // initialized data
+    size_t found = 0;
 
-        // error check
-        if ( NULL == op1 ) goto failed_to_parse_get_key;
+    // lock
+    mutex_lock(&p_key_value_db->_lock);
 
-        // process the get command
-        key_value_db_process_get(p_key_value_db, op1, p_response, p_response_len);
+    // refuse reads once shutdown has started
+    if ( p_key_value_db->stopping ) goto shutting_down;
 
-        // increment counters
-        p_key_value_db->counter.request.get++;
-    }
-    
-    // process set
-    else if ( 0 == strcmp(command, "set") )
+    // the database is not idle
+    p_key_value_db->last_request = key_value_db_time_ms();
+
+    // get each value
+    for (size_t i = 0; i < count; i++)
     {
 
         // initialized data
-        json_value *p_value = NULL;
+        key_value_db_entry *p_entry    = &p_entries[i];
+        key_value_property *p_property = NULL;
 
-        // error check
-        if ( p_request[cur] == '\0' ) goto failed_to_parse_set_key;
+        // a miss has no length
+        p_entry->result = 0,
+        p_entry->length = 0;
 
-        // parse the key
-        {
+        // find the property, and copy its value
+        if ( key_value_db_fetch(p_key_value_db, p_entry->_key, &p_property) )
+            p_entry->result = key_value_db_value_copy(&p_property->_value, p_entry->p_value, p_entry->capacity, &p_entry->length);
 
-            // skip leading blanks
-            while 
-            ( 
-                isblank(p_request[cur]) && 
-                cur < request_len
-            ) cur++;
+        // increment counters
+        found += (size_t) p_entry->result,
+        p_key_value_db->counter.request.get++;
+    }
 
-            // bounds check
-            if ( cur >= request_len ) goto bad_request;
+    // unlock
+    mutex_unlock(&p_key_value_db->_lock);
 
-            // store operand start offset
-            op1_start = cur;
+    // done
+    return found;
 
-            // skip the operand itself 
-            while 
-            ( 
-                !isblank(p_request[cur]) && 
-                p_request[cur] != '\0' &&
-                cur < request_len
-            ) cur++;
+    // error handling
+    {
 
-            // bounds check
-            if ( cur > request_len ) goto bad_request;
+        // argument errors
+        {
+            no_key_value_db:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
+                #endif
 
-            // store the operand end offset
-            op1_end = cur;
+                // error
+                return 0;
 
-            // store the operand
-            op1 = &p_request[op1_start];
-            p_request[op1_end] = '\0';
-            cur++;
-            
-            // print the operand
-            // log_info("[key value db] Operand 1: \"%s\"\n", op1);
+            no_entries:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_entries\" in call to function \"%s\"", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
         }
 
-        // parse the value
+        // key value db errors
         {
+            shutting_down:
 
-            // skip leading blanks
-            while
-            (
-                isblank(p_request[cur]) &&
-                cur < request_len
-            ) cur++;
+                // unlock
+                mutex_unlock(&p_key_value_db->_lock);
 
-            // bounds check
-            if (cur >= request_len) goto failed_to_parse_set_value;
+                // error
+                return 0;
+        }
+    }
+}
 
-            // store operand start offset
-            op2_start = cur;
+int key_value_db_set_batch ( key_value_db *p_key_value_db, key_value_db_entry *p_entries, size_t count )
+{
 
-            // skip the operand itself
-            while
-            (
-                (p_request[cur] != '\0') &&
-                p_request[cur] != '\0' &&
-                cur < request_len
-            ) cur++;
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==      p_entries ) goto no_entries;
 
-            // bounds check
-            if (cur > request_len) goto failed_to_parse_set_value;
+    // initialized data
+    key_value_value *p_values = NULL;
+    size_t           parsed   = 0,
+                     stored   = 0;
 
-            // store the operand end offset
-            op2_end = cur;
+    // nothing to write
+    if ( 0 == count ) return 1;
 
-            // store the operand
-            op2 = &p_request[op2_start];
-            p_request[op2_end] = '\0';
-            cur++;
+    // allocate memory for the values
+    p_values = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, 0, count * sizeof(key_value_value));
+    if ( NULL == p_values ) goto no_mem;
+    memset(p_values, 0, count * sizeof(key_value_value));
 
-            json_value_parse(op2, NULL, &p_value);
-        }
+    // every value must be valid, before anything is written
+    for (parsed = 0; parsed < count; parsed++)
+    {
 
-        // error check
-        if ( NULL == op1 ) goto failed_to_parse_set_key;
+        // initialized data
+        key_value_db_entry *p_entry = &p_entries[parsed];
 
-        // process the set command
-        key_value_db_process_set(p_key_value_db, op1, p_value, p_response, p_response_len);
+        // not written, yet
+        p_entry->result = 0;
 
-        // increment counters
-        p_key_value_db->counter.request.set++;
+        // error check
+        if ( NULL == p_entry->p_value || strnlen(p_entry->_key, sizeof(p_entry->_key)) > 63 ) goto bad_entry;
+        if ( 0 == key_value_db_value_parse(&p_values[parsed], p_entry->p_value, p_entry->length) ) goto bad_entry;
     }
-    
-    // process info
-    else if ( 0 == strcmp(command, "info") )
-    {
 
-        // process the info command
-        key_value_db_process_info(p_key_value_db, p_response, p_response_len);
-    }
+    // lock
+    mutex_lock(&p_key_value_db->_lock);
 
-    // process write
-    else if ( 0 == strcmp(command, "write") )
-    {
+    // refuse writes once shutdown has started
+    if ( p_key_value_db->stopping ) goto shutting_down;
 
-        // process the write command
-        key_value_db_process_write(p_key_value_db, p_response, p_response_len);
-    }
+    // the database is not idle
+    p_key_value_db->last_request = key_value_db_time_ms();
 
-    // error
-    else 
-    {
+    // every write in the batch shares one commit sequence
+    p_key_value_db->sequence++;
+    p_key_value_db->batching = true;
 
-        // copy the error message to the response buffer
-        memcpy(p_response, "{\"okay\":false}", 14);
-        *p_response_len = 14;
+    // store each value, in order
+    for (size_t i = 0; i < count; i++)
+        p_entries[i].result = key_value_db_store(p_key_value_db, p_entries[i]._key, &p_values[i], 0, NULL),
+        stored             += (size_t) p_entries[i].result,
+        p_key_value_db->counter.request.set++;
 
-        // increment counters
-        p_key_value_db->counter.request.err++;
-    }
+    // done batching
+    p_key_value_db->batching = false;
+
+    // stay under the memory limit, once the whole batch is written
+    key_value_db_evict(p_key_value_db, NULL);
+
+    // unlock
+    mutex_unlock(&p_key_value_db->_lock);
+
+    // release the values. the properties took them over
+    p_values = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_values, 0);
+
+    // a write that failed leaves the rest written. the entries say which
+    if ( stored < count ) goto failed_to_store;
 
     // success
     return 1;
@@ -958,61 +8578,122 @@ int key_value_db_process
                 // error
                 return 0;
 
-            no_request:
+            no_entries:
                 #ifndef NDEBUG
-                    log_error("[key value db] Null pointer provided for parameter \"p_request\" in call to function \"%s\"", __FUNCTION__);
+                    log_error("[key value db] Null pointer provided for parameter \"p_entries\" in call to function \"%s\"", __FUNCTION__);
                 #endif
 
                 // error
                 return 0;
+        }
 
-            no_response:
+        // key value db errors
+        {
+            bad_entry:
                 #ifndef NDEBUG
-                    log_error("[key value db] Null pointer provided for parameter \"p_response\" in call to function \"%s\"", __FUNCTION__);
+                    log_error("[key value db] Failed to parse entry %zu in call to function \"%s\"\n", parsed, __FUNCTION__);
                 #endif
 
+                // fall through
+                goto release;
+
+            shutting_down:
+
+                // unlock
+                mutex_unlock(&p_key_value_db->_lock);
+
+                // fall through
+                goto release;
+
+            release:
+
+                // release the values
+                for (size_t i = 0; i < count; i++) key_value_value_free(&p_values[i]);
+                p_values = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_values, 0);
+
                 // error
                 return 0;
 
-            no_response_len:
+            failed_to_store:
                 #ifndef NDEBUG
-                    log_error("[key value db] Null pointer provided for parameter \"p_response_len\" in call to function \"%s\"", __FUNCTION__);
+                    log_error("[key value db] Failed to store %zu of %zu entries in call to function \"%s\"\n", count - stored, count, __FUNCTION__);
                 #endif
 
                 // error
                 return 0;
         }
 
-        // key value db errors
+        // standard library errors
         {
-            failed_to_parse_get_key:
+            no_mem:
                 #ifndef NDEBUG
-                    log_error("[key value db] Failed to parse get request key in call to function \"%s\"\n", __FUNCTION__);
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"", __FUNCTION__);
                 #endif
 
                 // error
                 return 0;
+        }
+    }
+}
 
-            failed_to_parse_set_key:
+size_t key_value_db_del_batch ( key_value_db *p_key_value_db, key_value_db_entry *p_entries, size_t count )
+{
+
+    // argument check
+    if ( NULL == p_key_value_db ) goto no_key_value_db;
+    if ( NULL ==      p_entries ) goto no_entries;
+
+    // initialized data
+    size_t deleted = 0;
+
+    // lock
+    mutex_lock(&p_key_value_db->_lock);
+
+    // refuse writes once shutdown has started
+    if ( p_key_value_db->stopping ) goto shutting_down;
+
+    // the database is not idle
+    p_key_value_db->last_request = key_value_db_time_ms();
+
+    // delete each key
+    for (size_t i = 0; i < count; i++)
+        p_entries[i].result = key_value_db_del_key(p_key_value_db, p_entries[i]._key),
+        deleted += (size_t) p_entries[i].result;
+
+    // unlock
+    mutex_unlock(&p_key_value_db->_lock);
+
+    // done
+    return deleted;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_key_value_db:
                 #ifndef NDEBUG
-                    log_error("[key value db] Failed to parse set request key in call to function \"%s\"\n", __FUNCTION__);
+                    log_error("[key value db] Null pointer provided for parameter \"p_key_value_db\" in call to function \"%s\"", __FUNCTION__);
                 #endif
 
                 // error
                 return 0;
 
-            failed_to_parse_set_value:
+            no_entries:
                 #ifndef NDEBUG
-                    log_error("[key value db] Failed to parse set request value in call to function \"%s\"\n", __FUNCTION__);
+                    log_error("[key value db] Null pointer provided for parameter \"p_entries\" in call to function \"%s\"", __FUNCTION__);
                 #endif
 
                 // error
                 return 0;
+        }
 
-            bad_request:
-                #ifndef NDEBUG
-                    log_error("[key value db] Bad request in call to function \"%s\"\n", __FUNCTION__);
-                #endif
+        // key value db errors
+        {
+            shutting_down:
+
+                // unlock
+                mutex_unlock(&p_key_value_db->_lock);
 
                 // error
                 return 0;
@@ -0,0 +1,2569 @@
+/** !
+ * Log structured merge tree storage engine
+ *
+ * @file src/lsm.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/lsm.h>
+
+// preprocessor definitions
+#define LSM_TOMBSTONE  0xFF
+#define LSM_ENTRY_HEAD 22
+#define LSM_FOOTER     48
+#define LSM_MAGIC      0x4B564C53
+#define LSM_MANIFEST   "MANIFEST"
+#define LSM_PREFETCH   16  // the most blocks one prefetch reads
+
+// structure declarations
+struct lsm_record_s;
+struct lsm_table_s;
+struct lsm_block_s;
+struct lsm_writer_s;
+struct lsm_cursor_s;
+
+// type definitions
+typedef struct lsm_record_s lsm_record;
+typedef struct lsm_table_s  lsm_table;
+typedef struct lsm_block_s  lsm_block;
+typedef struct lsm_writer_s lsm_writer;
+typedef struct lsm_cursor_s lsm_cursor;
+
+// structure definitions
+struct lsm_record_s
+{
+    const char         *p_key,
+                       *p_value;
+    size_t              key_length,
+                        length;
+    unsigned long long  expires,
+                        version;
+    unsigned char       type;
+};
+
+struct lsm_table_s
+{
+    unsigned long long  id;
+    FILE               *p_file;
+    size_t              size,
+                        entries;
+
+    // prefetches reading the file without the lock. a table compacted away
+    // while they do is closed by the last of them
+    size_t readers;
+    bool   retired;
+
+    // the last key of each block, and where the block is. keys point into the index section
+    struct
+    {
+        const char         *p_key;
+        size_t              key_length;
+        unsigned long long  offset;
+        size_t              length;
+    } *p_blocks;
+    size_t  blocks;
+    char   *p_index;
+
+    // bloom filter
+    unsigned char *p_bloom;
+    size_t         bloom_bits;
+
+    // key range
+    char _smallest[LSM_KEY_MAX],
+         _largest[LSM_KEY_MAX];
+};
+
+struct lsm_block_s
+{
+    unsigned long long  table,
+                        offset;
+    char               *p_data;
+    size_t              length;
+    lsm_block          *p_chain,
+                       *p_prev,
+                       *p_next;
+};
+
+struct lsm_writer_s
+{
+    FILE               *p_file;
+    unsigned long long  id,
+                        offset;
+    size_t              entries,
+                        blocks;
+
+    // the block being filled
+    char   *p_block;
+    size_t  block_length,
+            block_capacity;
+
+    // the index section being filled
+    char   *p_index;
+    size_t  index_length,
+            index_capacity;
+
+    // the hash of every key, for the bloom filter
+    char   *p_hashes;
+    size_t  hashes_capacity;
+
+    // the last key written
+    char   _last[LSM_KEY_MAX];
+    size_t last_length;
+};
+
+struct lsm_cursor_s
+{
+    FILE       *p_file;
+    lsm_table  *p_table;
+    char       *p_data;
+    size_t      capacity,
+                length,
+                position,
+                block;
+    lsm_record  _record;
+    bool        valid;
+};
+
+struct lsm_s
+{
+    char  _directory[FILENAME_MAX];
+    mutex _lock;
+    bool  running;
+
+    // level 0 tables overlap, and are newest first. deeper levels are sorted
+    // by key, and their tables do not overlap
+    struct
+    {
+        lsm_table **pp_tables;
+        size_t      count,
+                    capacity,
+                    bytes;
+        char        _pointer[LSM_KEY_MAX];  // where the next compaction of the level starts
+    } levels[LSM_LEVELS];
+
+    unsigned long long next_id,
+                       sequence;
+
+    // deletes that are not flushed yet, in an open addressing table
+    struct
+    {
+        char   (*p_keys)[LSM_KEY_MAX];
+        size_t   count,
+                 capacity;
+    } deletes;
+
+    // recently read blocks. each bucket is a chain, and the list is most recently used first
+    struct
+    {
+        lsm_block  **pp_buckets;
+        size_t       mask,
+                     size,
+                     capacity;
+        lsm_block    _sentinel;
+
+        // blocks too large to cache are read here
+        char        *p_scratch;
+        size_t       scratch_capacity;
+    } cache;
+
+    lsm_statistics   _statistics;
+    parallel_thread *p_compactor;
+
+    // failed compactions in a row. only the compaction thread touches it
+    unsigned long long failures;
+};
+
+static unsigned long long lsm_hash ( const char *p_key, size_t length )
+{
+
+    // initialized data
+    unsigned long long h = 0xcbf29ce484222325ULL;
+
+    // FNV-1a
+    for (size_t i = 0; i < length; i++) h ^= (unsigned char) p_key[i], h *= 0x100000001b3ULL;
+
+    // done
+    return h;
+}
+
+static int lsm_compare ( const char *p_a, size_t a_length, const char *p_b, size_t b_length )
+{
+
+    // initialized data
+    int result = memcmp(p_a, p_b, ( a_length < b_length ) ? a_length : b_length);
+
+    // a shorter key sorts first
+    if ( 0 == result ) result = ( a_length > b_length ) - ( a_length < b_length );
+
+    // done
+    return result;
+}
+
+static int lsm_entry_compare ( const void *p_a, const void *p_b )
+{
+
+    // done
+    return strcmp(((const lsm_entry *) p_a)->p_key, ((const lsm_entry *) p_b)->p_key);
+}
+
+static int lsm_key_compare ( const void *p_a, const void *p_b )
+{
+
+    // done
+    return strcmp((const char *) p_a, (const char *) p_b);
+}
+
+static unsigned long long lsm_time_ms ( void )
+{
+
+    // initialized data
+    struct timespec _now = { 0 };
+
+    // wall clock time, like the expiry times
+    clock_gettime(CLOCK_REALTIME, &_now);
+
+    // done
+    return (unsigned long long) _now.tv_sec * 1000 + (unsigned long long) _now.tv_nsec / 1000000;
+}
+
+static int lsm_reserve ( char **pp_data, size_t *p_capacity, size_t quantity )
+{
+
+    // initialized data
+    size_t  capacity = ( *p_capacity ) ? *p_capacity : 256;
+    char   *p_data   = NULL;
+
+    // big enough
+    if ( quantity <= *p_capacity ) return 1;
+
+    // double until it fits
+    while ( capacity < quantity ) capacity *= 2;
+
+    // grow the buffer
+    p_data = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, *pp_data, capacity);
+    if ( NULL == p_data ) return 0;
+
+    // store the buffer
+    *pp_data    = p_data,
+    *p_capacity = capacity;
+
+    // success
+    return 1;
+}
+
+static void lsm_path ( lsm *p_lsm, unsigned long long id, char *p_path )
+{
+
+    // tables are named by their id
+    snprintf(p_path, FILENAME_MAX, "%s/%06llu.sst", p_lsm->_directory, id);
+
+    // done
+    return;
+}
+
+static size_t lsm_record_encode ( char *p_data, const lsm_record *p_record )
+{
+
+    // initialized data
+    unsigned int length = (unsigned int) p_record->length;
+
+    // header
+    p_data[0] = (char) p_record->key_length,
+    p_data[1] = (char) p_record->type;
+    memcpy(&p_data[2],  &length,             sizeof(unsigned int));
+    memcpy(&p_data[6],  &p_record->expires, sizeof(unsigned long long));
+    memcpy(&p_data[14], &p_record->version, sizeof(unsigned long long));
+
+    // key, and value
+    memcpy(&p_data[LSM_ENTRY_HEAD], p_record->p_key, p_record->key_length);
+    memcpy(&p_data[LSM_ENTRY_HEAD + p_record->key_length], p_record->p_value, p_record->length);
+
+    // done
+    return LSM_ENTRY_HEAD + p_record->key_length + p_record->length;
+}
+
+static size_t lsm_record_decode ( const char *p_data, lsm_record *p_record )
+{
+
+    // initialized data
+    unsigned int length = 0;
+
+    // header
+    p_record->key_length = (unsigned char) p_data[0],
+    p_record->type       = (unsigned char) p_data[1];
+    memcpy(&length,             &p_data[2],  sizeof(unsigned int));
+    memcpy(&p_record->expires, &p_data[6],  sizeof(unsigned long long));
+    memcpy(&p_record->version, &p_data[14], sizeof(unsigned long long));
+    p_record->length = length;
+
+    // key, and value
+    p_record->p_key   = &p_data[LSM_ENTRY_HEAD],
+    p_record->p_value = &p_data[LSM_ENTRY_HEAD + p_record->key_length];
+
+    // done
+    return LSM_ENTRY_HEAD + p_record->key_length + p_record->length;
+}
+
+static void lsm_bloom_add ( unsigned char *p_bloom, size_t bits, unsigned long long hash )
+{
+
+    // initialized data
+    unsigned long long h1 = hash,
+                       h2 = ( hash >> 32 ) | 1;
+
+    // double hashing
+    for (size_t i = 0; i < LSM_BLOOM_HASHES; i++)
+    {
+
+        // initialized data
+        size_t bit = (size_t) ( ( h1 + i * h2 ) % bits );
+
+        // set the bit
+        p_bloom[bit / 8] |= (unsigned char) ( 1 << ( bit % 8 ) );
+    }
+
+    // done
+    return;
+}
+
+static bool lsm_bloom_test ( const unsigned char *p_bloom, size_t bits, unsigned long long hash )
+{
+
+    // initialized data
+    unsigned long long h1 = hash,
+                       h2 = ( hash >> 32 ) | 1;
+
+    // any clear bit rules the key out
+    for (size_t i = 0; i < LSM_BLOOM_HASHES; i++)
+    {
+
+        // initialized data
+        size_t bit = (size_t) ( ( h1 + i * h2 ) % bits );
+
+        // clear?
+        if ( 0 == ( p_bloom[bit / 8] & ( 1 << ( bit % 8 ) ) ) ) return false;
+    }
+
+    // done
+    return true;
+}
+
+static int lsm_sync ( FILE *p_f )
+{
+
+    // write out the buffer, then make the file durable
+    if ( fflush(p_f) ) return 0;
+
+    #ifdef _WIN64
+        return 0 == _commit(_fileno(p_f));
+    #else
+        return 0 == fsync(fileno(p_f));
+    #endif
+}
+
+static int lsm_sync_directory ( lsm *p_lsm )
+{
+
+    #ifdef _WIN64
+
+        // a rename is durable once it returns
+        (void) p_lsm;
+
+        // success
+        return 1;
+    #else
+
+        // initialized data
+        int descriptor = open(p_lsm->_directory, O_RDONLY | O_DIRECTORY),
+            result     = 0;
+
+        // error check
+        if ( descriptor < 0 ) return 0;
+
+        // make the new names durable
+        result = ( 0 == fsync(descriptor) );
+        close(descriptor);
+
+        // done
+        return result;
+    #endif
+}
+
+static int lsm_manifest_write ( lsm *p_lsm )
+{
+
+    // initialized data
+    char  _path[FILENAME_MAX]      = { 0 },
+          _temporary[FILENAME_MAX] = { 0 };
+    FILE *p_f                      = NULL;
+
+    // write beside the manifest, and rename over it when complete
+    snprintf(_path,      sizeof(_path),      "%s/" LSM_MANIFEST,        p_lsm->_directory);
+    snprintf(_temporary, sizeof(_temporary), "%s/" LSM_MANIFEST ".tmp", p_lsm->_directory);
+    p_f = fopen(_temporary, "w");
+    if ( NULL == p_f ) goto failed_to_open_file;
+
+    // the commit sequence, and the next table id
+    fprintf(p_f, "sequence %llu\nnext %llu\n", p_lsm->sequence, p_lsm->next_id);
+
+    // level 0 oldest first, so reading it back in order rebuilds it newest first
+    for (size_t i = p_lsm->levels[0].count; i > 0; i--)
+        fprintf(p_f, "table 0 %llu\n", p_lsm->levels[0].pp_tables[i - 1]->id);
+
+    // each deeper table
+    for (int level = 1; level < LSM_LEVELS; level++)
+        for (size_t i = 0; i < p_lsm->levels[level].count; i++)
+            fprintf(p_f, "table %d %llu\n", level, p_lsm->levels[level].pp_tables[i]->id);
+
+    // error check. the manifest is durable before it replaces the previous one
+    if ( 0 == lsm_sync(p_f) || ferror(p_f) ) goto failed_to_write_file;
+
+    // close the file
+    fclose(p_f);
+
+    // replace the previous manifest, then make the rename, and the names of the new tables, durable
+    if ( rename(_temporary, _path) ) goto failed_to_rename_file;
+    if ( 0 == lsm_sync_directory(p_lsm) ) goto failed_to_sync_directory;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // standard library errors
+        {
+            failed_to_open_file:
+                log_error("[standard library] Failed to open file \"%s\" in call to function \"%s\"\n", _temporary, __FUNCTION__);
+
+                // error
+                return 0;
+
+            failed_to_write_file:
+                log_error("[standard library] Failed to write file \"%s\" in call to function \"%s\"\n", _temporary, __FUNCTION__);
+
+                // release the file
+                fclose(p_f);
+                remove(_temporary);
+
+                // error
+                return 0;
+
+            failed_to_rename_file:
+                log_error("[standard library] Failed to rename file \"%s\" in call to function \"%s\"\n", _temporary, __FUNCTION__);
+
+                // release the file
+                remove(_temporary);
+
+                // error
+                return 0;
+
+            failed_to_sync_directory:
+                log_error("[standard library] Failed to sync directory \"%s\" in call to function \"%s\"\n", p_lsm->_directory, __FUNCTION__);
+
+                // the new manifest is in place, and can not be taken back, so the
+                // caller must not undo what it records
+                return 1;
+        }
+    }
+}
+
+static void lsm_table_close ( lsm *p_lsm, lsm_table *p_table, bool remove_file )
+{
+
+    // initialized data
+    char _path[FILENAME_MAX] = { 0 };
+
+    // close the file
+    if ( p_table->p_file ) fclose(p_table->p_file);
+
+    // remove the file
+    if ( remove_file ) lsm_path(p_lsm, p_table->id, _path), remove(_path);
+
+    // release the table
+    p_table->p_blocks = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_table->p_blocks, 0);
+    p_table->p_index  = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_table->p_index, 0);
+    p_table->p_bloom  = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_table->p_bloom, 0);
+    p_table           = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_table, 0);
+
+    // done
+    return;
+}
+
+static int lsm_table_open ( lsm *p_lsm, unsigned long long id, lsm_table **pp_table )
+{
+
+    // initialized data
+    char                _path[FILENAME_MAX]    = { 0 };
+    unsigned char       _footer[LSM_FOOTER]    = { 0 };
+    lsm_table          *p_table                = NULL;
+    unsigned long long  index_offset           = 0,
+                        index_length           = 0,
+                        bloom_offset           = 0,
+                        bloom_length           = 0,
+                        entries                = 0;
+    unsigned int        blocks                 = 0,
+                        magic                  = 0;
+    size_t              cur                    = 0;
+
+    // allocate the table
+    p_table = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, 0, sizeof(lsm_table));
+    if ( NULL == p_table ) goto no_mem;
+    memset(p_table, 0, sizeof(lsm_table));
+    p_table->id = id;
+
+    // open the file
+    lsm_path(p_lsm, id, _path);
+    p_table->p_file = fopen(_path, "rb");
+    if ( NULL == p_table->p_file ) goto failed_to_open_file;
+
+    // read the footer
+    if ( fseek(p_table->p_file, 0, SEEK_END) ) goto failed_to_read_file;
+    p_table->size = (size_t) ftell(p_table->p_file);
+    if ( p_table->size < LSM_FOOTER ) goto bad_table;
+    if ( fseek(p_table->p_file, (long) ( p_table->size - LSM_FOOTER ), SEEK_SET) ) goto failed_to_read_file;
+    if ( 1 != fread(_footer, LSM_FOOTER, 1, p_table->p_file) ) goto failed_to_read_file;
+    memcpy(&index_offset, &_footer[0],  sizeof(unsigned long long));
+    memcpy(&index_length, &_footer[8],  sizeof(unsigned long long));
+    memcpy(&bloom_offset, &_footer[16], sizeof(unsigned long long));
+    memcpy(&bloom_length, &_footer[24], sizeof(unsigned long long));
+    memcpy(&entries,      &_footer[32], sizeof(unsigned long long));
+    memcpy(&blocks,       &_footer[40], sizeof(unsigned int));
+    memcpy(&magic,        &_footer[44], sizeof(unsigned int));
+
+    // error check
+    if ( LSM_MAGIC != magic || 0 == blocks || 0 == bloom_length ) goto bad_table;
+    if ( index_offset + index_length > p_table->size || bloom_offset + bloom_length > p_table->size ) goto bad_table;
+
+    // read the index section, and the bloom filter
+    p_table->p_index = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, 0, (size_t) index_length),
+    p_table->p_bloom = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, 0, (size_t) bloom_length),
+    p_table->p_blocks = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, 0, blocks * sizeof(*p_table->p_blocks));
+    if ( NULL == p_table->p_index || NULL == p_table->p_bloom || NULL == p_table->p_blocks ) goto no_mem;
+    if ( fseek(p_table->p_file, (long) index_offset, SEEK_SET) ) goto failed_to_read_file;
+    if ( 1 != fread(p_table->p_index, (size_t) index_length, 1, p_table->p_file) ) goto failed_to_read_file;
+    if ( fseek(p_table->p_file, (long) bloom_offset, SEEK_SET) ) goto failed_to_read_file;
+    if ( 1 != fread(p_table->p_bloom, (size_t) bloom_length, 1, p_table->p_file) ) goto failed_to_read_file;
+    p_table->bloom_bits = (size_t) bloom_length * 8,
+    p_table->entries    = (size_t) entries,
+    p_table->blocks     = blocks;
+
+    // the smallest key
+    {
+
+        // initialized data
+        size_t length = (unsigned char) p_table->p_index[cur++];
+
+        // store the key
+        memcpy(p_table->_smallest, &p_table->p_index[cur], length);
+        p_table->_smallest[length] = '\0';
+        cur += length;
+    }
+
+    // the last key of each block, and where the block is
+    for (size_t i = 0; i < blocks; i++)
+    {
+
+        // initialized data
+        unsigned int length = 0;
+
+        // error check
+        if ( cur >= index_length ) goto bad_table;
+
+        // key
+        p_table->p_blocks[i].key_length = (unsigned char) p_table->p_index[cur++],
+        p_table->p_blocks[i].p_key      = &p_table->p_index[cur];
+        cur += p_table->p_blocks[i].key_length;
+
+        // error check
+        if ( cur + sizeof(unsigned long long) + sizeof(unsigned int) > index_length ) goto bad_table;
+
+        // location
+        memcpy(&p_table->p_blocks[i].offset, &p_table->p_index[cur], sizeof(unsigned long long));
+        memcpy(&length, &p_table->p_index[cur + sizeof(unsigned long long)], sizeof(unsigned int));
+        p_table->p_blocks[i].length = length;
+        cur += sizeof(unsigned long long) + sizeof(unsigned int);
+    }
+
+    // the largest key
+    memcpy(p_table->_largest, p_table->p_blocks[blocks - 1].p_key, p_table->p_blocks[blocks - 1].key_length);
+    p_table->_largest[p_table->p_blocks[blocks - 1].key_length] = '\0';
+
+    // return a pointer to the caller
+    *pp_table = p_table;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // lsm errors
+        {
+            bad_table:
+                log_error("[lsm] Table \"%s\" is corrupt in call to function \"%s\"\n", _path, __FUNCTION__);
+
+                // release the table
+                lsm_table_close(p_lsm, p_table, false);
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // release the table
+                if ( p_table ) lsm_table_close(p_lsm, p_table, false);
+
+                // error
+                return 0;
+
+            failed_to_open_file:
+                log_error("[standard library] Failed to open file \"%s\" in call to function \"%s\"\n", _path, __FUNCTION__);
+
+                // release the table
+                lsm_table_close(p_lsm, p_table, false);
+
+                // error
+                return 0;
+
+            failed_to_read_file:
+                log_error("[standard library] Failed to read file \"%s\" in call to function \"%s\"\n", _path, __FUNCTION__);
+
+                // release the table
+                lsm_table_close(p_lsm, p_table, false);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+static int lsm_level_insert ( lsm *p_lsm, int level, lsm_table *p_table )
+{
+
+    // initialized data
+    size_t i = 0;
+
+    // grow the level
+    if ( p_lsm->levels[level].count == p_lsm->levels[level].capacity )
+    {
+
+        // initialized data
+        size_t      capacity    = p_lsm->levels[level].capacity ? p_lsm->levels[level].capacity * 2 : 16;
+        lsm_table **pp_tables   = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_lsm->levels[level].pp_tables, capacity * sizeof(lsm_table *));
+
+        // error check
+        if ( NULL == pp_tables ) return 0;
+
+        // store the level
+        p_lsm->levels[level].pp_tables = pp_tables,
+        p_lsm->levels[level].capacity  = capacity;
+    }
+
+    // level 0 is newest first, and tables are numbered in the order they are written. deeper levels are sorted by key
+    if ( level )
+        while ( i < p_lsm->levels[level].count && strcmp(p_lsm->levels[level].pp_tables[i]->_smallest, p_table->_smallest) < 0 ) i++;
+    else
+        while ( i < p_lsm->levels[level].count && p_lsm->levels[level].pp_tables[i]->id > p_table->id ) i++;
+
+    // insert the table
+    memmove(&p_lsm->levels[level].pp_tables[i + 1], &p_lsm->levels[level].pp_tables[i], ( p_lsm->levels[level].count - i ) * sizeof(lsm_table *));
+    p_lsm->levels[level].pp_tables[i] = p_table;
+    p_lsm->levels[level].count++,
+    p_lsm->levels[level].bytes += p_table->size;
+
+    // success
+    return 1;
+}
+
+static void lsm_level_remove ( lsm *p_lsm, int level, lsm_table *p_table )
+{
+
+    // find the table
+    for (size_t i = 0; i < p_lsm->levels[level].count; i++)
+    {
+
+        // skip other tables
+        if ( p_lsm->levels[level].pp_tables[i] != p_table ) continue;
+
+        // remove the table
+        memmove(&p_lsm->levels[level].pp_tables[i], &p_lsm->levels[level].pp_tables[i + 1], ( p_lsm->levels[level].count - i - 1 ) * sizeof(lsm_table *));
+        p_lsm->levels[level].count--,
+        p_lsm->levels[level].bytes -= p_table->size;
+
+        // done
+        return;
+    }
+
+    // done
+    return;
+}
+
+static lsm_block **lsm_cache_bucket ( lsm *p_lsm, unsigned long long table, unsigned long long offset )
+{
+
+    // initialized data
+    lsm_block **pp_block = &p_lsm->cache.pp_buckets[( table * 0x9e3779b97f4a7c15ULL ^ offset ) & p_lsm->cache.mask];
+
+    // walk the chain
+    while ( *pp_block && ( (*pp_block)->table != table || (*pp_block)->offset != offset ) ) pp_block = &(*pp_block)->p_chain;
+
+    // done
+    return pp_block;
+}
+
+static void lsm_cache_unlink ( lsm_block *p_block )
+{
+
+    // unlink the block
+    p_block->p_prev->p_next = p_block->p_next,
+    p_block->p_next->p_prev = p_block->p_prev;
+
+    // done
+    return;
+}
+
+static void lsm_cache_push ( lsm *p_lsm, lsm_block *p_block )
+{
+
+    // most recently used first
+    p_block->p_prev = &p_lsm->cache._sentinel,
+    p_block->p_next = p_lsm->cache._sentinel.p_next;
+    p_lsm->cache._sentinel.p_next->p_prev = p_block,
+    p_lsm->cache._sentinel.p_next         = p_block;
+
+    // done
+    return;
+}
+
+static void lsm_cache_insert ( lsm *p_lsm, unsigned long long table, unsigned long long offset, lsm_block *p_block, size_t length )
+{
+
+    // cache the block. the data follows the block
+    p_block->table   = table,
+    p_block->offset  = offset,
+    p_block->p_data  = (char *) ( p_block + 1 ),
+    p_block->length  = length,
+    p_block->p_chain = NULL;
+    *lsm_cache_bucket(p_lsm, table, offset) = p_block;
+    lsm_cache_push(p_lsm, p_block);
+    p_lsm->cache.size += length;
+
+    // evict the least recently used blocks, but never the new one
+    while ( p_lsm->cache.size > p_lsm->cache.capacity && p_lsm->cache._sentinel.p_prev != p_block )
+    {
+
+        // initialized data
+        lsm_block *p_victim = p_lsm->cache._sentinel.p_prev;
+
+        // release the block
+        lsm_cache_unlink(p_victim);
+        *lsm_cache_bucket(p_lsm, p_victim->table, p_victim->offset) = p_victim->p_chain;
+        p_lsm->cache.size -= p_victim->length;
+        p_victim = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_victim, 0);
+    }
+
+    // done
+    return;
+}
+
+static const char *lsm_block_read ( lsm *p_lsm, lsm_table *p_table, size_t i )
+{
+
+    // initialized data
+    unsigned long long   offset   = p_table->p_blocks[i].offset;
+    size_t               length   = p_table->p_blocks[i].length;
+    lsm_block          **pp_block = lsm_cache_bucket(p_lsm, p_table->id, offset);
+    lsm_block           *p_block  = *pp_block;
+    char                *p_data   = NULL;
+
+    // hit
+    if ( p_block )
+    {
+
+        // most recently used first
+        lsm_cache_unlink(p_block);
+        lsm_cache_push(p_lsm, p_block);
+
+        // increment counters
+        p_lsm->_statistics.block_hits++;
+
+        // done
+        return p_block->p_data;
+    }
+
+    // increment counters
+    p_lsm->_statistics.block_misses++;
+
+    // a block larger than an eighth of the cache would flush it, so it is read into the scratch buffer
+    if ( length > p_lsm->cache.capacity / 8 )
+    {
+        if ( 0 == lsm_reserve(&p_lsm->cache.p_scratch, &p_lsm->cache.scratch_capacity, length) ) return NULL;
+        p_data = p_lsm->cache.p_scratch;
+    }
+
+    // allocate a cached block
+    else
+    {
+        p_block = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, 0, sizeof(lsm_block) + length);
+        if ( NULL == p_block ) return NULL;
+        p_data = (char *) ( p_block + 1 );
+    }
+
+    // read the block
+    if
+    (
+        fseek(p_table->p_file, (long) offset, SEEK_SET) ||
+        1 != fread(p_data, length, 1, p_table->p_file)
+    )
+    {
+
+        // logs
+        log_error("[lsm] Failed to read a block of table %llu\n", p_table->id);
+
+        // release the block
+        if ( p_block ) p_block = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_block, 0);
+
+        // error
+        return NULL;
+    }
+
+    // not cached
+    if ( NULL == p_block ) return p_data;
+
+    // cache the block
+    lsm_cache_insert(p_lsm, p_table->id, offset, p_block, length);
+
+    // done
+    return p_data;
+}
+
+static int lsm_table_find ( lsm *p_lsm, lsm_table *p_table, const char *p_key, size_t key_length, unsigned long long hash, lsm_record *p_record, lsm_table **pp_missing, size_t *p_missing )
+{
+
+    // initialized data
+    size_t      lo     = 0,
+                hi     = p_table->blocks;
+    const char *p_data = NULL;
+    size_t      cur    = 0;
+
+    // outside the key range
+    if ( strcmp(p_key, p_table->_smallest) < 0 || strcmp(p_key, p_table->_largest) > 0 ) return 0;
+
+    // ruled out by the bloom filter
+    if ( false == lsm_bloom_test(p_table->p_bloom, p_table->bloom_bits, hash) )
+    {
+        if ( NULL == pp_missing ) p_lsm->_statistics.bloom_skips++;
+        return 0;
+    }
+
+    // find the first block whose last key is not less than the key
+    while ( lo < hi )
+    {
+
+        // initialized data
+        size_t mid = ( lo + hi ) / 2;
+
+        // search
+        if ( lsm_compare(p_table->p_blocks[mid].p_key, p_table->p_blocks[mid].key_length, p_key, key_length) < 0 ) lo = mid + 1;
+        else hi = mid;
+    }
+
+    // error check
+    if ( lo == p_table->blocks ) return 0;
+
+    // a prefetch only looks in the cache, and ends the search at the first
+    // block that is not there. a block too large to cache is left to lsm_get
+    if ( pp_missing )
+    {
+
+        // initialized data
+        lsm_block *p_block = *lsm_cache_bucket(p_lsm, p_table->id, p_table->p_blocks[lo].offset);
+
+        // not cached
+        if ( NULL == p_block )
+        {
+            if ( p_table->p_blocks[lo].length <= p_lsm->cache.capacity / 8 ) *pp_missing = p_table, *p_missing = lo;
+            return 1;
+        }
+
+        p_data = p_block->p_data;
+    }
+
+    // read the block
+    else p_data = lsm_block_read(p_lsm, p_table, lo);
+    if ( NULL == p_data ) return 0;
+
+    // scan the block
+    while ( cur < p_table->p_blocks[lo].length )
+    {
+
+        // initialized data
+        int result = 0;
+
+        // decode the record
+        cur += lsm_record_decode(&p_data[cur], p_record);
+
+        // compare
+        result = lsm_compare(p_record->p_key, p_record->key_length, p_key, key_length);
+
+        // found
+        if ( 0 == result ) return 1;
+
+        // passed it
+        if ( result > 0 ) break;
+    }
+
+    // done
+    return 0;
+}
+
+static size_t lsm_deletes_slot ( lsm *p_lsm, const char *p_key )
+{
+
+    // initialized data
+    size_t mask = p_lsm->deletes.capacity - 1,
+           i    = (size_t) lsm_hash(p_key, strlen(p_key)) & mask;
+
+    // linear probing. an empty key ends the run
+    while ( p_lsm->deletes.p_keys[i][0] && strcmp(p_lsm->deletes.p_keys[i], p_key) ) i = ( i + 1 ) & mask;
+
+    // done
+    return i;
+}
+
+static bool lsm_deletes_find ( lsm *p_lsm, const char *p_key )
+{
+
+    // error check
+    if ( 0 == p_lsm->deletes.count ) return false;
+
+    // done
+    return '\0' != p_lsm->deletes.p_keys[lsm_deletes_slot(p_lsm, p_key)][0];
+}
+
+static int lsm_writer_open ( lsm *p_lsm, lsm_writer *p_writer )
+{
+
+    // initialized data
+    char _path[FILENAME_MAX] = { 0 };
+
+    // initialize the writer
+    memset(p_writer, 0, sizeof(lsm_writer));
+
+    // take the next id
+    mutex_lock(&p_lsm->_lock);
+    p_writer->id = p_lsm->next_id++;
+    mutex_unlock(&p_lsm->_lock);
+
+    // open the file
+    lsm_path(p_lsm, p_writer->id, _path);
+    p_writer->p_file = fopen(_path, "wb");
+    if ( NULL == p_writer->p_file ) goto failed_to_open_file;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // standard library errors
+        {
+            failed_to_open_file:
+                log_error("[standard library] Failed to open file \"%s\" in call to function \"%s\"\n", _path, __FUNCTION__);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+static int lsm_writer_block ( lsm_writer *p_writer )
+{
+
+    // initialized data
+    unsigned int length = (unsigned int) p_writer->block_length;
+
+    // nothing to write
+    if ( 0 == p_writer->block_length ) return 1;
+
+    // write the block
+    if ( 1 != fwrite(p_writer->p_block, p_writer->block_length, 1, p_writer->p_file) ) return 0;
+
+    // index the block by its last key
+    if ( 0 == lsm_reserve(&p_writer->p_index, &p_writer->index_capacity, p_writer->index_length + 1 + p_writer->last_length + sizeof(unsigned long long) + sizeof(unsigned int)) ) return 0;
+    p_writer->p_index[p_writer->index_length++] = (char) p_writer->last_length;
+    memcpy(&p_writer->p_index[p_writer->index_length], p_writer->_last, p_writer->last_length);
+    p_writer->index_length += p_writer->last_length;
+    memcpy(&p_writer->p_index[p_writer->index_length], &p_writer->offset, sizeof(unsigned long long));
+    p_writer->index_length += sizeof(unsigned long long);
+    memcpy(&p_writer->p_index[p_writer->index_length], &length, sizeof(unsigned int));
+    p_writer->index_length += sizeof(unsigned int);
+
+    // start the next block
+    p_writer->offset      += p_writer->block_length,
+    p_writer->block_length = 0;
+    p_writer->blocks++;
+
+    // success
+    return 1;
+}
+
+static int lsm_writer_add ( lsm_writer *p_writer, const lsm_record *p_record )
+{
+
+    // initialized data
+    size_t             size = LSM_ENTRY_HEAD + p_record->key_length + p_record->length;
+    unsigned long long hash = lsm_hash(p_record->p_key, p_record->key_length);
+
+    // a full block is written out. a block holds at least one record
+    if ( p_writer->block_length && p_writer->block_length + size > LSM_BLOCK_SIZE )
+        if ( 0 == lsm_writer_block(p_writer) ) return 0;
+
+    // the index section starts with the smallest key
+    if ( 0 == p_writer->entries )
+    {
+        if ( 0 == lsm_reserve(&p_writer->p_index, &p_writer->index_capacity, 1 + p_record->key_length) ) return 0;
+        p_writer->p_index[0] = (char) p_record->key_length;
+        memcpy(&p_writer->p_index[1], p_record->p_key, p_record->key_length);
+        p_writer->index_length = 1 + p_record->key_length;
+    }
+
+    // append the record
+    if ( 0 == lsm_reserve(&p_writer->p_block, &p_writer->block_capacity, p_writer->block_length + size) ) return 0;
+    p_writer->block_length += lsm_record_encode(&p_writer->p_block[p_writer->block_length], p_record);
+
+    // remember the hash, for the bloom filter
+    if ( 0 == lsm_reserve(&p_writer->p_hashes, &p_writer->hashes_capacity, ( p_writer->entries + 1 ) * sizeof(unsigned long long)) ) return 0;
+    memcpy(&p_writer->p_hashes[p_writer->entries * sizeof(unsigned long long)], &hash, sizeof(unsigned long long));
+    p_writer->entries++;
+
+    // remember the last key
+    memcpy(p_writer->_last, p_record->p_key, p_record->key_length);
+    p_writer->last_length = p_record->key_length;
+
+    // success
+    return 1;
+}
+
+static void lsm_writer_release ( lsm *p_lsm, lsm_writer *p_writer, bool remove_file )
+{
+
+    // initialized data
+    char _path[FILENAME_MAX] = { 0 };
+
+    // close the file
+    if ( p_writer->p_file ) fclose(p_writer->p_file), p_writer->p_file = NULL;
+
+    // remove the file
+    if ( remove_file ) lsm_path(p_lsm, p_writer->id, _path), remove(_path);
+
+    // release the buffers
+    p_writer->p_block  = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_writer->p_block, 0),
+    p_writer->p_index  = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_writer->p_index, 0),
+    p_writer->p_hashes = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_writer->p_hashes, 0);
+
+    // done
+    return;
+}
+
+static int lsm_writer_close ( lsm *p_lsm, lsm_writer *p_writer, lsm_table **pp_table )
+{
+
+    // initialized data
+    size_t              bloom_length = ( p_writer->entries * LSM_BLOOM_BITS + 63 ) / 64 * 8;
+    unsigned char      *p_bloom      = NULL;
+    unsigned char       _footer[LSM_FOOTER] = { 0 };
+    unsigned long long  index_offset = 0,
+                        index_length = 0,
+                        bloom_offset = 0,
+                        bloom_size   = bloom_length,
+                        entries      = p_writer->entries;
+    unsigned int        blocks       = 0,
+                        magic        = LSM_MAGIC;
+
+    // no records
+    *pp_table = NULL;
+    if ( 0 == p_writer->entries ) goto empty;
+
+    // write the last block
+    if ( 0 == lsm_writer_block(p_writer) ) goto failed_to_write_file;
+    blocks = (unsigned int) p_writer->blocks;
+
+    // build the bloom filter
+    p_bloom = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, 0, bloom_length);
+    if ( NULL == p_bloom ) goto no_mem;
+    memset(p_bloom, 0, bloom_length);
+    for (size_t i = 0; i < p_writer->entries; i++)
+    {
+
+        // initialized data
+        unsigned long long hash = 0;
+
+        // add the key
+        memcpy(&hash, &p_writer->p_hashes[i * sizeof(unsigned long long)], sizeof(unsigned long long));
+        lsm_bloom_add(p_bloom, bloom_length * 8, hash);
+    }
+
+    // write the index section, the bloom filter, and the footer
+    index_offset = p_writer->offset,
+    index_length = p_writer->index_length,
+    bloom_offset = index_offset + index_length;
+    memcpy(&_footer[0],  &index_offset, sizeof(unsigned long long));
+    memcpy(&_footer[8],  &index_length, sizeof(unsigned long long));
+    memcpy(&_footer[16], &bloom_offset, sizeof(unsigned long long));
+    memcpy(&_footer[24], &bloom_size,   sizeof(unsigned long long));
+    memcpy(&_footer[32], &entries,      sizeof(unsigned long long));
+    memcpy(&_footer[40], &blocks,       sizeof(unsigned int));
+    memcpy(&_footer[44], &magic,        sizeof(unsigned int));
+    if
+    (
+        1 != fwrite(p_writer->p_index, p_writer->index_length, 1, p_writer->p_file) ||
+        1 != fwrite(p_bloom, bloom_length, 1, p_writer->p_file)                       ||
+        1 != fwrite(_footer, LSM_FOOTER, 1, p_writer->p_file)                         ||
+        0 == lsm_sync(p_writer->p_file)                                               ||
+        ferror(p_writer->p_file)
+    ) goto failed_to_write_file;
+
+    // release the bloom filter
+    p_bloom = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_bloom, 0);
+
+    // release the writer, and keep the file
+    lsm_writer_release(p_lsm, p_writer, false);
+
+    // done
+    return lsm_table_open(p_lsm, p_writer->id, pp_table);
+
+    // nothing was written
+    empty:
+
+        // release the writer, and the file
+        lsm_writer_release(p_lsm, p_writer, true);
+
+        // success
+        return 1;
+
+    // error handling
+    {
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // release the writer, and the file
+                lsm_writer_release(p_lsm, p_writer, true);
+
+                // error
+                return 0;
+
+            failed_to_write_file:
+                log_error("[standard library] Failed to write table %llu in call to function \"%s\"\n", p_writer->id, __FUNCTION__);
+
+                // release the writer, and the file
+                if ( p_bloom ) p_bloom = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_bloom, 0);
+                lsm_writer_release(p_lsm, p_writer, true);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+static int lsm_list_append ( lsm_table ***ppp_tables, size_t *p_count, lsm_table *p_table )
+{
+
+    // initialized data
+    lsm_table **pp_tables = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, *ppp_tables, ( *p_count + 1 ) * sizeof(lsm_table *));
+
+    // error check
+    if ( NULL == pp_tables ) return 0;
+
+    // append the table
+    pp_tables[(*p_count)++] = p_table;
+    *ppp_tables = pp_tables;
+
+    // success
+    return 1;
+}
+
+static int lsm_cursor_next ( lsm *p_lsm, lsm_cursor *p_cursor )
+{
+
+    // read the next block
+    while ( p_cursor->position >= p_cursor->length )
+    {
+
+        // initialized data
+        lsm_table *p_table = p_cursor->p_table;
+
+        // end of the table
+        if ( p_cursor->block == p_table->blocks )
+        {
+            p_cursor->valid = false;
+            return 1;
+        }
+
+        // open the table. the compactor reads through its own file, so readers keep theirs
+        if ( NULL == p_cursor->p_file )
+        {
+
+            // initialized data
+            char _path[FILENAME_MAX] = { 0 };
+
+            // open the file
+            lsm_path(p_lsm, p_table->id, _path);
+            p_cursor->p_file = fopen(_path, "rb");
+            if ( NULL == p_cursor->p_file ) return 0;
+        }
+
+        // read the block
+        if ( 0 == lsm_reserve(&p_cursor->p_data, &p_cursor->capacity, p_table->p_blocks[p_cursor->block].length) ) return 0;
+        if ( fseek(p_cursor->p_file, (long) p_table->p_blocks[p_cursor->block].offset, SEEK_SET) ) return 0;
+        if ( 1 != fread(p_cursor->p_data, p_table->p_blocks[p_cursor->block].length, 1, p_cursor->p_file) ) return 0;
+        p_cursor->length   = p_table->p_blocks[p_cursor->block].length,
+        p_cursor->position = 0;
+        p_cursor->block++;
+    }
+
+    // decode the next record
+    p_cursor->position += lsm_record_decode(&p_cursor->p_data[p_cursor->position], &p_cursor->_record);
+    p_cursor->valid     = true;
+
+    // success
+    return 1;
+}
+
+static void lsm_cursor_release ( lsm_cursor *p_cursor )
+{
+
+    // close the file
+    if ( p_cursor->p_file ) fclose(p_cursor->p_file), p_cursor->p_file = NULL;
+
+    // release the buffer
+    p_cursor->p_data = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_cursor->p_data, 0);
+
+    // done
+    return;
+}
+
+static int lsm_compact ( lsm *p_lsm )
+{
+
+    // initialized data
+    lsm_table          **pp_inputs  = NULL,
+                       **pp_outputs = NULL;
+    lsm_cursor          *p_cursors  = NULL;
+    size_t               inputs     = 0,
+                         upper      = 0,
+                         outputs    = 0,
+                         capacity   = 0;
+    int                  level      = -1;
+    double               best       = 1.0;
+    bool                 bottom     = true,
+                         writing    = false;
+    char                 _smallest[LSM_KEY_MAX] = { 0 },
+                         _largest[LSM_KEY_MAX]  = { 0 };
+    unsigned long long   now        = lsm_time_ms();
+    lsm_writer           _writer    = { 0 };
+    lsm_table           *p_output   = NULL;
+
+    // lock
+    mutex_lock(&p_lsm->_lock);
+
+    // level 0 is compacted when it has too many tables, since every one of them is searched
+    if ( p_lsm->levels[0].count >= LSM_L0_TRIGGER ) level = 0;
+
+    // otherwise, the level furthest over its target size
+    else
+    {
+
+        // initialized data
+        double target = LSM_LEVEL_BASE;
+
+        // score each level
+        for (int i = 1; i < LSM_LEVELS - 1; i++, target *= LSM_LEVEL_RATIO)
+            if ( (double) p_lsm->levels[i].bytes / target > best )
+                best  = (double) p_lsm->levels[i].bytes / target,
+                level = i;
+    }
+
+    // nothing to do
+    if ( -1 == level ) goto done;
+
+    // room for every input
+    capacity  = p_lsm->levels[level].count + p_lsm->levels[level + 1].count;
+    pp_inputs = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, 0, capacity * sizeof(lsm_table *));
+    if ( NULL == pp_inputs ) goto no_mem;
+
+    // level 0 compacts every table, newest first
+    if ( 0 == level )
+    {
+        for (size_t i = 0; i < p_lsm->levels[0].count; i++)
+        {
+
+            // initialized data
+            lsm_table *p_table = p_lsm->levels[0].pp_tables[i];
+
+            // widen the key range
+            if ( 0 == i || strcmp(p_table->_smallest, _smallest) < 0 ) strcpy(_smallest, p_table->_smallest);
+            if ( 0 == i || strcmp(p_table->_largest,  _largest)  > 0 ) strcpy(_largest,  p_table->_largest);
+
+            pp_inputs[inputs++] = p_table;
+        }
+    }
+
+    // deeper levels compact one table at a time, round robin through the key space
+    else
+    {
+
+        // initialized data
+        lsm_table *p_table = p_lsm->levels[level].pp_tables[0];
+
+        // the first table after the previous compaction
+        for (size_t i = 0; i < p_lsm->levels[level].count; i++)
+            if ( strcmp(p_lsm->levels[level].pp_tables[i]->_smallest, p_lsm->levels[level]._pointer) > 0 )
+            {
+                p_table = p_lsm->levels[level].pp_tables[i];
+                break;
+            }
+
+        // the key range
+        strcpy(_smallest, p_table->_smallest),
+        strcpy(_largest,  p_table->_largest);
+
+        // continue from here next time
+        strcpy(p_lsm->levels[level]._pointer, p_table->_largest);
+
+        pp_inputs[inputs++] = p_table;
+    }
+
+    // every overlapping table of the next level
+    upper = inputs;
+    for (size_t i = 0; i < p_lsm->levels[level + 1].count; i++)
+    {
+
+        // initialized data
+        lsm_table *p_table = p_lsm->levels[level + 1].pp_tables[i];
+
+        // overlap?
+        if ( strcmp(p_table->_largest, _smallest) < 0 || strcmp(p_table->_smallest, _largest) > 0 ) continue;
+
+        pp_inputs[inputs++] = p_table;
+    }
+
+    // deletes, and expired records, can only be dropped when no deeper level holds an older record
+    for (int i = level + 2; i < LSM_LEVELS; i++)
+        if ( p_lsm->levels[i].count ) bottom = false;
+
+    // a lone table that overlaps nothing moves down without being rewritten
+    if ( level && 1 == inputs )
+    {
+
+        // move the table
+        if ( 0 == lsm_level_insert(p_lsm, level + 1, pp_inputs[0]) ) goto no_mem;
+        lsm_level_remove(p_lsm, level, pp_inputs[0]);
+
+        // persist the move, or take it back
+        if ( 0 == lsm_manifest_write(p_lsm) )
+        {
+            lsm_level_remove(p_lsm, level + 1, pp_inputs[0]);
+            lsm_level_insert(p_lsm, level, pp_inputs[0]);
+            mutex_unlock(&p_lsm->_lock);
+            goto failed_to_compact;
+        }
+        p_lsm->_statistics.compactions++;
+        p_lsm->failures = 0;
+
+        // unlock
+        mutex_unlock(&p_lsm->_lock);
+
+        // release the inputs
+        pp_inputs = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, pp_inputs, 0);
+
+        // success
+        return 1;
+    }
+
+    // unlock. the inputs stay put, since only this thread removes tables
+    mutex_unlock(&p_lsm->_lock);
+
+    // logs
+    log_info("[lsm] Compacting %zu tables from level %d, and %zu tables from level %d\n", upper, level, inputs - upper, level + 1);
+
+    // open a cursor on each input. earlier inputs hold newer records
+    p_cursors = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, 0, inputs * sizeof(lsm_cursor));
+    if ( NULL == p_cursors ) goto no_mem_unlocked;
+    memset(p_cursors, 0, inputs * sizeof(lsm_cursor));
+    for (size_t i = 0; i < inputs; i++)
+    {
+        p_cursors[i].p_table = pp_inputs[i];
+        if ( 0 == lsm_cursor_next(p_lsm, &p_cursors[i]) ) goto failed_to_compact;
+    }
+
+    // merge
+    for (;;)
+    {
+
+        // initialized data
+        lsm_cursor *p_min                 = NULL;
+        char        _key[LSM_KEY_MAX]     = { 0 };
+        size_t      key_length            = 0;
+
+        // the smallest key. ties go to the newest record
+        for (size_t i = 0; i < inputs; i++)
+            if ( p_cursors[i].valid && ( NULL == p_min || lsm_compare(p_cursors[i]._record.p_key, p_cursors[i]._record.key_length, p_min->_record.p_key, p_min->_record.key_length) < 0 ) )
+                p_min = &p_cursors[i];
+
+        // done
+        if ( NULL == p_min ) break;
+
+        // keep the record, unless nothing older can be hiding under it
+        if
+        (
+            false == bottom ||
+            (
+                LSM_TOMBSTONE != p_min->_record.type &&
+                ( 0 == p_min->_record.expires || p_min->_record.expires > now )
+            )
+        )
+        {
+
+            // start an output table
+            if ( false == writing )
+            {
+                if ( 0 == lsm_writer_open(p_lsm, &_writer) ) goto failed_to_compact;
+                writing = true;
+            }
+
+            // write the record
+            if ( 0 == lsm_writer_add(&_writer, &p_min->_record) ) goto failed_to_compact;
+
+            // finish a full output table
+            if ( _writer.offset + _writer.block_length >= LSM_TABLE_SIZE )
+            {
+
+                // close the table
+                writing = false;
+                if ( 0 == lsm_writer_close(p_lsm, &_writer, &p_output) ) goto failed_to_compact;
+
+                // store the table
+                if ( 0 == lsm_list_append(&pp_outputs, &outputs, p_output) ) goto failed_to_store_table;
+            }
+        }
+
+        // skip every older record of the key
+        memcpy(_key, p_min->_record.p_key, p_min->_record.key_length);
+        key_length = p_min->_record.key_length;
+        for (size_t i = 0; i < inputs; i++)
+            if ( p_cursors[i].valid && 0 == lsm_compare(p_cursors[i]._record.p_key, p_cursors[i]._record.key_length, _key, key_length) )
+                if ( 0 == lsm_cursor_next(p_lsm, &p_cursors[i]) ) goto failed_to_compact;
+    }
+
+    // finish the last output table
+    if ( writing )
+    {
+
+        // close the table
+        writing = false;
+        if ( 0 == lsm_writer_close(p_lsm, &_writer, &p_output) ) goto failed_to_compact;
+
+        // store the table
+        if ( p_output && 0 == lsm_list_append(&pp_outputs, &outputs, p_output) ) goto failed_to_store_table;
+    }
+
+    // release the cursors
+    for (size_t i = 0; i < inputs; i++) lsm_cursor_release(&p_cursors[i]);
+    p_cursors = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_cursors, 0);
+
+    // lock
+    mutex_lock(&p_lsm->_lock);
+
+    // swap the outputs in for the inputs
+    for (size_t i = 0; i < inputs; i++) lsm_level_remove(p_lsm, ( i < upper ) ? level : level + 1, pp_inputs[i]);
+    for (size_t i = 0; i < outputs; i++) if ( 0 == lsm_level_insert(p_lsm, level + 1, pp_outputs[i]) ) goto failed_to_persist;
+
+    // persist the swap. the inputs are only removed once the manifest no longer lists them
+    if ( 0 == lsm_manifest_write(p_lsm) ) goto failed_to_persist;
+    p_lsm->_statistics.compactions++;
+    p_lsm->failures = 0;
+
+    // a prefetch still reading an input closes it when it is done
+    for (size_t i = 0; i < inputs; i++)
+        if ( pp_inputs[i]->readers ) pp_inputs[i]->retired = true, pp_inputs[i] = NULL;
+
+    // unlock. no reader can find an input any more
+    mutex_unlock(&p_lsm->_lock);
+
+    // remove the inputs
+    for (size_t i = 0; i < inputs; i++) if ( pp_inputs[i] ) lsm_table_close(p_lsm, pp_inputs[i], true);
+
+    // release the lists
+    pp_inputs  = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, pp_inputs, 0),
+    pp_outputs = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, pp_outputs, 0);
+
+    // success
+    return 1;
+
+    // nothing to do
+    done:
+
+        // nothing is failing
+        p_lsm->failures = 0;
+
+        // unlock
+        mutex_unlock(&p_lsm->_lock);
+
+        // done
+        return 0;
+
+    // error handling
+    {
+
+        // lsm errors
+        {
+            failed_to_store_table:
+
+                // release the table
+                lsm_table_close(p_lsm, p_output, true);
+
+                // fall through
+                goto failed_to_compact;
+
+            failed_to_persist:
+
+                // take the swap back. no reader saw the outputs, since the lock was held throughout
+                for (size_t i = 0; i < outputs; i++) lsm_level_remove(p_lsm, level + 1, pp_outputs[i]);
+                for (size_t i = 0; i < inputs; i++) lsm_level_insert(p_lsm, ( i < upper ) ? level : level + 1, pp_inputs[i]);
+
+                // unlock
+                mutex_unlock(&p_lsm->_lock);
+
+                // fall through
+                goto failed_to_compact;
+
+            failed_to_compact:
+
+                // the compaction thread waits twice as long after each failure in a row, so this is logged less and less often
+                p_lsm->failures++;
+                log_error("[lsm] Failed to compact level %d, %llu times in a row, in call to function \"%s\"\n", level, p_lsm->failures, __FUNCTION__);
+
+                // release the partial output
+                if ( writing ) lsm_writer_release(p_lsm, &_writer, true);
+                for (size_t i = 0; i < outputs; i++) lsm_table_close(p_lsm, pp_outputs[i], true);
+                if ( p_cursors ) for (size_t i = 0; i < inputs; i++) lsm_cursor_release(&p_cursors[i]);
+                p_cursors  = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_cursors, 0),
+                pp_outputs = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, pp_outputs, 0),
+                pp_inputs  = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, pp_inputs, 0);
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+
+                // unlock
+                mutex_unlock(&p_lsm->_lock);
+
+                // fall through
+                goto no_mem_unlocked;
+
+            no_mem_unlocked:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // back off, as for any other failure
+                p_lsm->failures++;
+
+                // release the inputs
+                pp_inputs = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, pp_inputs, 0);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+static void *lsm_compactor ( void *p_parameter )
+{
+
+    // initialized data
+    lsm             *p_lsm = p_parameter;
+    struct timespec  _wait = { .tv_sec = 0, .tv_nsec = LSM_COMPACT_MS * 1000000 };
+
+    while ( p_lsm->running )
+    {
+
+        // initialized data
+        unsigned long long waits = 0;
+
+        // compact until nothing is due
+        if ( lsm_compact(p_lsm) ) continue;
+
+        // then wait. each failure in a row doubles the wait, so an error that
+        // persists does not spin. the wait is sliced, so destroy is not held up
+        waits = 1ULL << ( ( p_lsm->failures < LSM_COMPACT_BACKOFF ) ? p_lsm->failures : LSM_COMPACT_BACKOFF );
+        for (unsigned long long i = 0; i < waits && p_lsm->running; i++) nanosleep(&_wait, NULL);
+    }
+
+    // success
+    return (void *) 1;
+}
+
+int lsm_construct ( lsm **pp_lsm, const char *p_directory, size_t block_cache )
+{
+
+    // argument check
+    if ( NULL ==      pp_lsm ) goto no_lsm;
+    if ( NULL == p_directory ) goto no_directory;
+
+    // initialized data
+    lsm    *p_lsm               = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, 0, sizeof(lsm));
+    char    _path[FILENAME_MAX] = { 0 };
+    char    _word[16]           = { 0 };
+    FILE   *p_f                 = NULL;
+    size_t  buckets             = 1;
+
+    // error check
+    if ( NULL == p_lsm ) goto no_mem;
+
+    // initialize the lsm tree
+    memset(p_lsm, 0, sizeof(lsm));
+    strncpy(p_lsm->_directory, p_directory, sizeof(p_lsm->_directory) - 1);
+    mutex_create(&p_lsm->_lock);
+    p_lsm->next_id = 1;
+
+    // create the directory
+    #ifdef _WIN64
+        _mkdir(p_directory);
+    #else
+        mkdir(p_directory, 0755);
+    #endif
+
+    // size the block cache hash table for blocks of the usual size
+    while ( buckets < block_cache / LSM_BLOCK_SIZE ) buckets <<= 1;
+    p_lsm->cache.pp_buckets = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, 0, buckets * sizeof(lsm_block *));
+    if ( NULL == p_lsm->cache.pp_buckets ) goto no_mem;
+    memset(p_lsm->cache.pp_buckets, 0, buckets * sizeof(lsm_block *));
+    p_lsm->cache.mask              = buckets - 1,
+    p_lsm->cache.capacity          = block_cache,
+    p_lsm->cache._sentinel.p_next  = &p_lsm->cache._sentinel,
+    p_lsm->cache._sentinel.p_prev  = &p_lsm->cache._sentinel;
+
+    // size the pending deletes
+    p_lsm->deletes.capacity = 1024;
+    p_lsm->deletes.p_keys   = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, 0, p_lsm->deletes.capacity * LSM_KEY_MAX);
+    if ( NULL == p_lsm->deletes.p_keys ) goto no_mem;
+    memset(p_lsm->deletes.p_keys, 0, p_lsm->deletes.capacity * LSM_KEY_MAX);
+
+    // read the manifest
+    snprintf(_path, sizeof(_path), "%s/" LSM_MANIFEST, p_directory);
+    p_f = fopen(_path, "r");
+    if ( NULL == p_f && ENOENT != errno ) goto failed_to_open_manifest;
+    if ( p_f )
+    {
+
+        // each line is a word, and its values
+        while ( 1 == fscanf(p_f, "%15s", _word) )
+        {
+
+            // the commit sequence
+            if ( 0 == strcmp(_word, "sequence") )
+            {
+                if ( 1 != fscanf(p_f, "%llu", &p_lsm->sequence) ) goto bad_manifest;
+            }
+
+            // the next table id
+            else if ( 0 == strcmp(_word, "next") )
+            {
+                if ( 1 != fscanf(p_f, "%llu", &p_lsm->next_id) ) goto bad_manifest;
+            }
+
+            // a table
+            else if ( 0 == strcmp(_word, "table") )
+            {
+
+                // initialized data
+                int                 level   = 0;
+                unsigned long long  id      = 0;
+                lsm_table          *p_table = NULL;
+
+                // parse the line
+                if ( 2 != fscanf(p_f, "%d %llu", &level, &id) || level < 0 || level >= LSM_LEVELS ) goto bad_manifest;
+
+                // open the table. serving without it would bring back older records of its keys
+                if ( 0 == lsm_table_open(p_lsm, id, &p_table) ) goto failed_to_open_table;
+
+                // add the table to its level
+                if ( 0 == lsm_level_insert(p_lsm, level, p_table) ) goto no_mem;
+            }
+
+            // anything else
+            else goto bad_manifest;
+        }
+
+        // error check
+        if ( ferror(p_f) ) goto bad_manifest;
+
+        // close the file
+        fclose(p_f);
+        p_f = NULL;
+    }
+
+    // logs
+    {
+
+        // initialized data
+        size_t tables = 0;
+
+        // count the tables
+        for (int level = 0; level < LSM_LEVELS; level++) tables += p_lsm->levels[level].count;
+
+        log_info("[lsm] Opened %zu tables in \"%s\"\n", tables, p_directory);
+    }
+
+    // start the compaction thread
+    p_lsm->running = true;
+    if ( 0 == parallel_thread_start(&p_lsm->p_compactor, (fn_parallel_task *) lsm_compactor, p_lsm) ) goto failed_to_start_thread;
+
+    // return a pointer to the caller
+    *pp_lsm = p_lsm;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_lsm:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"pp_lsm\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_directory:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"p_directory\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // lsm errors
+        {
+            bad_manifest:
+                log_error("[lsm] Manifest \"%s\" is corrupt in call to function \"%s\"\n", _path, __FUNCTION__);
+
+                // done
+                goto failed_to_open;
+
+            failed_to_open_table:
+                log_error("[lsm] Failed to open a table listed in \"%s\" in call to function \"%s\"\n", _path, __FUNCTION__);
+
+                // done
+                goto failed_to_open;
+
+            failed_to_open:
+
+                // release the lsm tree. nothing in the directory is changed
+                fclose(p_f);
+                lsm_destroy(&p_lsm);
+
+                // error
+                return 0;
+
+            failed_to_start_thread:
+                log_error("[lsm] Failed to start the compaction thread in call to function \"%s\"\n", __FUNCTION__);
+
+                // release the lsm tree
+                p_lsm->running = false;
+                lsm_destroy(&p_lsm);
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // release the lsm tree
+                if ( p_f ) fclose(p_f);
+                if ( p_lsm ) lsm_destroy(&p_lsm);
+
+                // error
+                return 0;
+
+            failed_to_open_manifest:
+                log_error("[standard library] Failed to open file \"%s\" in call to function \"%s\"\n", _path, __FUNCTION__);
+
+                // release the lsm tree
+                lsm_destroy(&p_lsm);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+bool lsm_exists ( const char *p_directory )
+{
+
+    // initialized data
+    char  _path[FILENAME_MAX] = { 0 };
+    FILE *p_f                 = NULL;
+
+    // error check
+    if ( NULL == p_directory ) return false;
+
+    // look for the manifest
+    snprintf(_path, sizeof(_path), "%s/" LSM_MANIFEST, p_directory);
+    p_f = fopen(_path, "r");
+    if ( NULL == p_f ) return false;
+
+    // close the file
+    fclose(p_f);
+
+    // done
+    return true;
+}
+
+static int lsm_search ( lsm *p_lsm, const char *p_key, lsm_record *p_record, lsm_table **pp_missing, size_t *p_missing )
+{
+
+    // initialized data
+    size_t             key_length = strlen(p_key);
+    unsigned long long hash       = lsm_hash(p_key, key_length);
+
+    // deleted, and not flushed yet
+    if ( lsm_deletes_find(p_lsm, p_key) ) return 0;
+
+    // level 0 tables overlap, so each one is searched, newest first
+    for (size_t i = 0; i < p_lsm->levels[0].count; i++)
+        if ( lsm_table_find(p_lsm, p_lsm->levels[0].pp_tables[i], p_key, key_length, hash, p_record, pp_missing, p_missing) ) return 1;
+
+    // deeper levels have at most one table that covers the key
+    for (int level = 1; level < LSM_LEVELS; level++)
+    {
+
+        // initialized data
+        size_t lo = 0,
+               hi = p_lsm->levels[level].count;
+
+        // find the first table whose largest key is not less than the key
+        while ( lo < hi )
+        {
+
+            // initialized data
+            size_t mid = ( lo + hi ) / 2;
+
+            // search
+            if ( strcmp(p_lsm->levels[level].pp_tables[mid]->_largest, p_key) < 0 ) lo = mid + 1;
+            else hi = mid;
+        }
+
+        // search the table
+        if ( lo < p_lsm->levels[level].count && lsm_table_find(p_lsm, p_lsm->levels[level].pp_tables[lo], p_key, key_length, hash, p_record, pp_missing, p_missing) ) return 1;
+    }
+
+    // not found
+    return 0;
+}
+
+int lsm_get ( lsm *p_lsm, const char *p_key, key_value_value *p_value, unsigned long long *p_expires, unsigned long long *p_version )
+{
+
+    // argument check
+    if ( NULL ==     p_lsm ) goto no_lsm;
+    if ( NULL ==     p_key ) goto no_key;
+    if ( NULL ==   p_value ) goto no_value;
+
+    // initialized data
+    lsm_record _record = { 0 };
+    int        result  = 0;
+
+    // lock
+    mutex_lock(&p_lsm->_lock);
+
+    // not found
+    if ( 0 == lsm_search(p_lsm, p_key, &_record, NULL, NULL) ) goto done;
+
+    // a delete hides every older record
+    if ( LSM_TOMBSTONE == _record.type ) goto done;
+
+    // copy the value out of the block, before the block cache can release it
+    result = key_value_value_from_text(p_value, _record.p_value, _record.length, _record.type);
+
+    // return the metadata to the caller
+    if ( p_expires ) *p_expires = _record.expires;
+    if ( p_version ) *p_version = _record.version;
+
+    done:
+
+    // unlock
+    mutex_unlock(&p_lsm->_lock);
+
+    // done
+    return result;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_lsm:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"p_lsm\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_value:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"p_value\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int lsm_prefetch ( lsm *p_lsm, const char *p_key )
+{
+
+    // argument check
+    if ( NULL == p_lsm ) goto no_lsm;
+    if ( NULL == p_key ) goto no_key;
+
+    #ifndef _WIN64
+
+        // each block read moves the search on, to the next table that may hold the key
+        for (size_t reads = 0; reads < LSM_PREFETCH; reads++)
+        {
+
+            // initialized data
+            lsm_record          _record  = { 0 };
+            lsm_table          *p_table  = NULL;
+            lsm_block          *p_block  = NULL;
+            size_t              block    = 0,
+                                length   = 0;
+            unsigned long long  offset   = 0;
+            bool                read     = false,
+                                retired  = false;
+
+            // lock
+            mutex_lock(&p_lsm->_lock);
+
+            // the first block lsm_get would read from the disk
+            lsm_search(p_lsm, p_key, &_record, &p_table, &block);
+
+            // lsm_get needs no disk read
+            if ( NULL == p_table )
+            {
+                mutex_unlock(&p_lsm->_lock);
+                break;
+            }
+
+            // keep the table open while it is read
+            p_table->readers++;
+            offset = p_table->p_blocks[block].offset,
+            length = p_table->p_blocks[block].length;
+
+            // unlock
+            mutex_unlock(&p_lsm->_lock);
+
+            // read the block, without the lock. pread leaves the file position to lsm_get
+            p_block = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, 0, sizeof(lsm_block) + length);
+            if ( p_block ) read = ( (ssize_t) length == pread(fileno(p_table->p_file), p_block + 1, length, (off_t) offset) );
+
+            // lock
+            mutex_lock(&p_lsm->_lock);
+
+            // cache the block, unless another reader already did
+            if ( read && NULL == *lsm_cache_bucket(p_lsm, p_table->id, offset) )
+                lsm_cache_insert(p_lsm, p_table->id, offset, p_block, length),
+                p_block = NULL;
+
+            // the last reader of a table that was compacted away closes it
+            retired = ( 0 == --p_table->readers && p_table->retired );
+
+            // unlock
+            mutex_unlock(&p_lsm->_lock);
+
+            // release the block, and the table
+            if ( p_block ) p_block = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_block, 0);
+            if ( retired ) lsm_table_close(p_lsm, p_table, true);
+
+            // error check
+            if ( false == read ) goto failed_to_read_block;
+        }
+    #endif
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_lsm:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"p_lsm\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // lsm errors
+        {
+            #ifndef _WIN64
+            failed_to_read_block:
+                log_error("[lsm] Failed to read a block in call to function \"%s\"\n", __FUNCTION__);
+
+                // error
+                return 0;
+            #endif
+        }
+    }
+}
+
+unsigned long long lsm_sequence ( lsm *p_lsm )
+{
+
+    // done
+    return ( p_lsm ) ? p_lsm->sequence : 0;
+}
+
+int lsm_statistics_get ( lsm *p_lsm, lsm_statistics *p_statistics )
+{
+
+    // argument check
+    if ( NULL ==        p_lsm ) goto no_lsm;
+    if ( NULL == p_statistics ) goto no_statistics;
+
+    // lock
+    mutex_lock(&p_lsm->_lock);
+
+    // copy the counters
+    *p_statistics = p_lsm->_statistics;
+
+    // add up the levels
+    p_statistics->tables = 0,
+    p_statistics->bytes  = 0;
+    for (int level = 0; level < LSM_LEVELS; level++)
+        p_statistics->tables += p_lsm->levels[level].count,
+        p_statistics->bytes  += p_lsm->levels[level].bytes;
+
+    // unlock
+    mutex_unlock(&p_lsm->_lock);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_lsm:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"p_lsm\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_statistics:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"p_statistics\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int lsm_keys ( lsm *p_lsm, fn_lsm_key *pfn_key, void *p_parameter )
+{
+
+    // argument check
+    if ( NULL ==   p_lsm ) goto no_lsm;
+    if ( NULL == pfn_key ) goto no_key_function;
+
+    // initialized data
+    lsm_cursor *p_cursors = NULL;
+    size_t      tables    = 0;
+    int         result    = 1;
+
+    // lock. the compactor can not retire a table while it is read
+    mutex_lock(&p_lsm->_lock);
+
+    // count the tables
+    for (int level = 0; level < LSM_LEVELS; level++) tables += p_lsm->levels[level].count;
+
+    // open a cursor on each table. earlier cursors hold newer records
+    p_cursors = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, 0, ( tables ? tables : 1 ) * sizeof(lsm_cursor));
+    if ( NULL == p_cursors ) goto no_mem;
+    memset(p_cursors, 0, ( tables ? tables : 1 ) * sizeof(lsm_cursor));
+    tables = 0;
+    for (int level = 0; level < LSM_LEVELS && result; level++)
+        for (size_t i = 0; i < p_lsm->levels[level].count && result; i++)
+            p_cursors[tables].p_table = p_lsm->levels[level].pp_tables[i],
+            result                    = lsm_cursor_next(p_lsm, &p_cursors[tables++]);
+
+    // merge, so each key is passed once
+    while ( result )
+    {
+
+        // initialized data
+        lsm_cursor *p_min             = NULL;
+        char        _key[LSM_KEY_MAX] = { 0 };
+        size_t      key_length        = 0;
+
+        // the smallest key. ties go to the newest record
+        for (size_t i = 0; i < tables; i++)
+            if ( p_cursors[i].valid && ( NULL == p_min || lsm_compare(p_cursors[i]._record.p_key, p_cursors[i]._record.key_length, p_min->_record.p_key, p_min->_record.key_length) < 0 ) )
+                p_min = &p_cursors[i];
+
+        // done
+        if ( NULL == p_min ) break;
+
+        // the key, terminated for the deletes table
+        key_length = p_min->_record.key_length;
+        memcpy(_key, p_min->_record.p_key, key_length);
+
+        // pass the key, unless its newest record, or a delete that is not written yet, removed it
+        if ( LSM_TOMBSTONE != p_min->_record.type && false == lsm_deletes_find(p_lsm, _key) && 0 == pfn_key(_key, key_length, p_parameter) ) result = 0;
+
+        // skip every older record of the key
+        for (size_t i = 0; i < tables && result; i++)
+            if ( p_cursors[i].valid && 0 == lsm_compare(p_cursors[i]._record.p_key, p_cursors[i]._record.key_length, _key, key_length) )
+                result = lsm_cursor_next(p_lsm, &p_cursors[i]);
+    }
+
+    // release the cursors
+    for (size_t i = 0; i < tables; i++) lsm_cursor_release(&p_cursors[i]);
+    p_cursors = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_cursors, 0);
+
+    // unlock
+    mutex_unlock(&p_lsm->_lock);
+
+    // done
+    return result;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_lsm:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"p_lsm\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key_function:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"pfn_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+
+                // unlock
+                mutex_unlock(&p_lsm->_lock);
+
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int lsm_delete ( lsm *p_lsm, const char *p_key )
+{
+
+    // argument check
+    if ( NULL == p_lsm ) goto no_lsm;
+    if ( NULL == p_key ) goto no_key;
+
+    // lock
+    mutex_lock(&p_lsm->_lock);
+
+    // keep the table at most half full
+    if ( 2 * ( p_lsm->deletes.count + 1 ) > p_lsm->deletes.capacity )
+    {
+
+        // initialized data
+        char   (*p_keys)[LSM_KEY_MAX] = p_lsm->deletes.p_keys;
+        size_t   capacity             = p_lsm->deletes.capacity;
+
+        // allocate a larger table
+        p_lsm->deletes.p_keys = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, 0, 2 * capacity * LSM_KEY_MAX);
+        if ( NULL == p_lsm->deletes.p_keys )
+        {
+            p_lsm->deletes.p_keys = p_keys;
+            goto no_mem;
+        }
+        memset(p_lsm->deletes.p_keys, 0, 2 * capacity * LSM_KEY_MAX);
+        p_lsm->deletes.capacity = 2 * capacity;
+
+        // rehash
+        for (size_t i = 0; i < capacity; i++)
+            if ( p_keys[i][0] ) strcpy(p_lsm->deletes.p_keys[lsm_deletes_slot(p_lsm, p_keys[i])], p_keys[i]);
+
+        // release the old table
+        p_keys = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_keys, 0);
+    }
+
+    // record the delete
+    {
+
+        // initialized data
+        size_t i = lsm_deletes_slot(p_lsm, p_key);
+
+        // new delete?
+        if ( '\0' == p_lsm->deletes.p_keys[i][0] )
+            strncpy(p_lsm->deletes.p_keys[i], p_key, LSM_KEY_MAX - 1),
+            p_lsm->deletes.count++;
+    }
+
+    // unlock
+    mutex_unlock(&p_lsm->_lock);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_lsm:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"p_lsm\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // unlock
+                mutex_unlock(&p_lsm->_lock);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int lsm_flush ( lsm *p_lsm, lsm_entry *p_entries, size_t count, unsigned long long sequence )
+{
+
+    // argument check
+    if ( NULL ==                  p_lsm ) goto no_lsm;
+    if ( NULL == p_entries && count > 0 ) goto no_entries;
+
+    // initialized data
+    char               (*p_deletes)[LSM_KEY_MAX] = NULL;
+    size_t               deletes                 = 0,
+                         i                       = 0,
+                         j                       = 0;
+    lsm_writer           _writer                 = { 0 };
+    lsm_table           *p_table                 = NULL;
+    unsigned long long   previous                = 0;
+
+    // sort the records
+    qsort(p_entries, count, sizeof(lsm_entry), lsm_entry_compare);
+
+    // gather the pending deletes, sorted. only the caller adds deletes, so they hold still
+    if ( p_lsm->deletes.count )
+    {
+
+        // allocate a list
+        p_deletes = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, 0, p_lsm->deletes.count * LSM_KEY_MAX);
+        if ( NULL == p_deletes ) goto no_mem;
+
+        // copy each delete
+        for (size_t k = 0; k < p_lsm->deletes.capacity; k++)
+            if ( p_lsm->deletes.p_keys[k][0] ) memcpy(p_deletes[deletes++], p_lsm->deletes.p_keys[k], LSM_KEY_MAX);
+
+        // sort
+        qsort(p_deletes, deletes, LSM_KEY_MAX, lsm_key_compare);
+    }
+
+    // write a level 0 table
+    if ( count + deletes )
+    {
+
+        // open a table
+        if ( 0 == lsm_writer_open(p_lsm, &_writer) ) goto failed_to_flush;
+
+        // merge the records with the deletes
+        while ( i < count || j < deletes )
+        {
+
+            // initialized data
+            int        result  = ( i == count ) ? 1 : ( j == deletes ) ? -1 : strcmp(p_entries[i].p_key, p_deletes[j]);
+            lsm_record _record = { 0 };
+
+            // a record
+            if ( result <= 0 )
+            {
+                _record.p_key      = p_entries[i].p_key,
+                _record.key_length = strlen(p_entries[i].p_key),
+                _record.p_value    = p_entries[i].p_value,
+                _record.length     = p_entries[i].length,
+                _record.expires    = p_entries[i].expires,
+                _record.version    = p_entries[i].version,
+                _record.type       = p_entries[i].type;
+
+                // a record written after a delete shadows it
+                if ( 0 == result ) j++;
+                i++;
+            }
+
+            // a delete
+            else
+            {
+                _record.p_key      = p_deletes[j],
+                _record.key_length = strlen(p_deletes[j]),
+                _record.p_value    = "",
+                _record.type       = LSM_TOMBSTONE,
+                _record.version    = sequence;
+                j++;
+            }
+
+            // write the record
+            if ( 0 == lsm_writer_add(&_writer, &_record) ) goto failed_to_flush;
+        }
+
+        // close the table
+        if ( 0 == lsm_writer_close(p_lsm, &_writer, &p_table) ) goto failed_to_flush_closed;
+    }
+
+    // release the deletes list
+    p_deletes = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_deletes, 0);
+
+    // lock
+    mutex_lock(&p_lsm->_lock);
+
+    // the newest level 0 table
+    if ( p_table && 0 == lsm_level_insert(p_lsm, 0, p_table) )
+    {
+        mutex_unlock(&p_lsm->_lock);
+        lsm_table_close(p_lsm, p_table, true);
+        goto no_mem;
+    }
+
+    // persist the table, and the commit sequence, or take the table back. the deletes stay pending
+    previous        = p_lsm->sequence,
+    p_lsm->sequence = sequence;
+    if ( 0 == lsm_manifest_write(p_lsm) )
+    {
+        p_lsm->sequence = previous;
+        if ( p_table ) lsm_level_remove(p_lsm, 0, p_table);
+        mutex_unlock(&p_lsm->_lock);
+        if ( p_table ) lsm_table_close(p_lsm, p_table, true);
+        goto failed_to_flush_closed;
+    }
+    p_lsm->_statistics.flushes++;
+
+    // the deletes are written
+    memset(p_lsm->deletes.p_keys, 0, p_lsm->deletes.capacity * LSM_KEY_MAX);
+    p_lsm->deletes.count = 0;
+
+    // unlock
+    mutex_unlock(&p_lsm->_lock);
+
+    // logs
+    log_info("[lsm] Flushed %zu records, and %zu deletes\n", count, deletes);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_lsm:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"p_lsm\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_entries:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"p_entries\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // lsm errors
+        {
+            failed_to_flush:
+
+                // release the table
+                lsm_writer_release(p_lsm, &_writer, true);
+
+                // fall through
+                goto failed_to_flush_closed;
+
+            failed_to_flush_closed:
+                log_error("[lsm] Failed to flush in call to function \"%s\"\n", __FUNCTION__);
+
+                // release the deletes list
+                p_deletes = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_deletes, 0);
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // release the deletes list
+                p_deletes = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_deletes, 0);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int lsm_destroy ( lsm **pp_lsm )
+{
+
+    // argument check
+    if ( NULL == pp_lsm ) goto no_lsm;
+
+    // initialized data
+    lsm *p_lsm = *pp_lsm;
+
+    // no more pointer for caller
+    *pp_lsm = NULL;
+
+    // stop the compaction thread
+    if ( p_lsm->p_compactor ) p_lsm->running = false, parallel_thread_join(&p_lsm->p_compactor);
+
+    // close each table
+    for (int level = 0; level < LSM_LEVELS; level++)
+    {
+        for (size_t i = 0; i < p_lsm->levels[level].count; i++) lsm_table_close(p_lsm, p_lsm->levels[level].pp_tables[i], false);
+        p_lsm->levels[level].pp_tables = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_lsm->levels[level].pp_tables, 0);
+    }
+
+    // release each cached block
+    if ( p_lsm->cache._sentinel.p_next )
+        while ( p_lsm->cache._sentinel.p_next != &p_lsm->cache._sentinel )
+        {
+
+            // initialized data
+            lsm_block *p_block = p_lsm->cache._sentinel.p_next;
+
+            // release the block
+            lsm_cache_unlink(p_block);
+            p_block = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_block, 0);
+        }
+
+    // release the lsm tree
+    mutex_destroy(&p_lsm->_lock);
+    p_lsm->cache.pp_buckets = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_lsm->cache.pp_buckets, 0),
+    p_lsm->cache.p_scratch  = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_lsm->cache.p_scratch, 0),
+    p_lsm->deletes.p_keys   = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_lsm->deletes.p_keys, 0);
+    p_lsm                   = key_value_memory_allocator(KEY_VALUE_MEMORY_STORAGE, p_lsm, 0);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_lsm:
+                #ifndef NDEBUG
+                    log_error("[lsm] Null pointer provided for parameter \"pp_lsm\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
@@ -0,0 +1,197 @@
+/** !
+ * Memory accounting, per subsystem
+ *
+ * @file src/memory.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/memory.h>
+
+// posix
+#ifdef __linux__
+    #include <unistd.h>
+#endif
+
+// preprocessor macros
+#define KEY_VALUE_MEMORY_SIZE(p_header) ( ( (size_t *) (p_header) )[0] )
+#define KEY_VALUE_MEMORY_TAG(p_header)  ( ( (size_t *) (p_header) )[1] )
+
+// data
+static const char *_key_value_memory_tag_names[KEY_VALUE_MEMORY_QUANTITY] =
+{
+    [KEY_VALUE_MEMORY_PROPERTIES]  = "properties",
+    [KEY_VALUE_MEMORY_VALUES]      = "values",
+    [KEY_VALUE_MEMORY_KEYSPACE]    = "keyspace",
+    [KEY_VALUE_MEMORY_CACHE]       = "cache",
+    [KEY_VALUE_MEMORY_FILTER]      = "filter",
+    [KEY_VALUE_MEMORY_STORAGE]     = "storage",
+    [KEY_VALUE_MEMORY_CONNECTIONS] = "connections",
+    [KEY_VALUE_MEMORY_OTHER]       = "other",
+    [KEY_VALUE_MEMORY_INDEXES]     = "indexes",
+    [KEY_VALUE_MEMORY_VERSIONS]    = "versions",
+    [KEY_VALUE_MEMORY_INDEX]       = "index"
+};
+
+// connection threads, and the compaction thread, allocate concurrently
+static key_value_memory_usage _key_value_memory_usage[KEY_VALUE_MEMORY_QUANTITY] = { 0 };
+
+size_t key_value_memory_slack ( size_t size )
+{
+
+    // initialized data
+    size_t chunk = ( size + KEY_VALUE_MEMORY_CHUNK_HEADER + KEY_VALUE_MEMORY_CHUNK_ALIGN - 1 ) & ~(size_t) ( KEY_VALUE_MEMORY_CHUNK_ALIGN - 1 );
+
+    // the smallest chunk
+    if ( chunk < KEY_VALUE_MEMORY_CHUNK_MIN ) chunk = KEY_VALUE_MEMORY_CHUNK_MIN;
+
+    // done
+    return chunk - size;
+}
+
+static void key_value_memory_account ( size_t tag, size_t size, bool add )
+{
+
+    // initialized data
+    key_value_memory_usage *p_usage  = &_key_value_memory_usage[tag];
+    size_t                  overhead = KEY_VALUE_MEMORY_HEADER + key_value_memory_slack(KEY_VALUE_MEMORY_HEADER + size);
+
+    // an allocation
+    if ( add )
+        __atomic_add_fetch(&p_usage->bytes, size, __ATOMIC_RELAXED),
+        __atomic_add_fetch(&p_usage->objects, 1, __ATOMIC_RELAXED),
+        __atomic_add_fetch(&p_usage->overhead, overhead, __ATOMIC_RELAXED),
+        __atomic_add_fetch(&p_usage->allocations, 1, __ATOMIC_RELAXED);
+
+    // a release
+    else
+        __atomic_sub_fetch(&p_usage->bytes, size, __ATOMIC_RELAXED),
+        __atomic_sub_fetch(&p_usage->objects, 1, __ATOMIC_RELAXED),
+        __atomic_sub_fetch(&p_usage->overhead, overhead, __ATOMIC_RELAXED);
+
+    // done
+    return;
+}
+
+void *key_value_memory_allocator ( key_value_memory_tag tag, void *p_data, size_t size )
+{
+
+    // argument check
+    if ( tag >= KEY_VALUE_MEMORY_QUANTITY ) tag = KEY_VALUE_MEMORY_OTHER;
+    if ( size > (size_t) -1 - KEY_VALUE_MEMORY_HEADER ) goto too_large;
+
+    // initialized data
+    char *p_header = ( p_data ) ? (char *) p_data - KEY_VALUE_MEMORY_HEADER : NULL,
+         *p_result = NULL;
+
+    // release
+    if ( 0 == size )
+    {
+
+        // nothing to release
+        if ( NULL == p_header ) return NULL;
+
+        // account for the memory, under the tag it was allocated with
+        key_value_memory_account(KEY_VALUE_MEMORY_TAG(p_header), KEY_VALUE_MEMORY_SIZE(p_header), false);
+
+        // release the memory
+        default_allocator(p_header, 0);
+
+        // done
+        return NULL;
+    }
+
+    // allocate, or reallocate
+    p_result = default_allocator(p_header, KEY_VALUE_MEMORY_HEADER + size);
+
+    // error check. memory that failed to reallocate is unchanged
+    if ( NULL == p_result ) goto no_mem;
+
+    // the old memory is gone
+    if ( p_header ) key_value_memory_account(KEY_VALUE_MEMORY_TAG(p_result), KEY_VALUE_MEMORY_SIZE(p_result), false);
+
+    // the new memory
+    KEY_VALUE_MEMORY_SIZE(p_result) = size,
+    KEY_VALUE_MEMORY_TAG(p_result)  = tag;
+    key_value_memory_account(tag, size, true);
+
+    // success
+    return p_result + KEY_VALUE_MEMORY_HEADER;
+
+    // error handling
+    {
+
+        // standard library errors
+        {
+            too_large:
+                #ifndef NDEBUG
+                    log_error("[standard library] Allocation of %zu bytes is too large in call to function \"%s\"\n", size, __FUNCTION__);
+                #endif
+
+                // error
+                return NULL;
+
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return NULL;
+        }
+    }
+}
+
+void key_value_memory_usage_get ( key_value_memory_tag tag, key_value_memory_usage *p_usage )
+{
+
+    // argument check
+    if ( NULL == p_usage ) return;
+    if ( tag >= KEY_VALUE_MEMORY_QUANTITY ) { memset(p_usage, 0, sizeof(key_value_memory_usage)); return; }
+
+    // copy the counters
+    p_usage->bytes       = __atomic_load_n(&_key_value_memory_usage[tag].bytes, __ATOMIC_RELAXED),
+    p_usage->objects     = __atomic_load_n(&_key_value_memory_usage[tag].objects, __ATOMIC_RELAXED),
+    p_usage->overhead    = __atomic_load_n(&_key_value_memory_usage[tag].overhead, __ATOMIC_RELAXED),
+    p_usage->allocations = __atomic_load_n(&_key_value_memory_usage[tag].allocations, __ATOMIC_RELAXED);
+
+    // done
+    return;
+}
+
+const char *key_value_memory_tag_name ( key_value_memory_tag tag )
+{
+
+    // done
+    return ( tag < KEY_VALUE_MEMORY_QUANTITY ) ? _key_value_memory_tag_names[tag] : "unknown";
+}
+
+size_t key_value_memory_resident ( void )
+{
+
+    // the second field of statm is the resident page count
+    #ifdef __linux__
+    {
+
+        // initialized data
+        FILE   *p_file   = fopen("/proc/self/statm", "r");
+        size_t  pages    = 0,
+                resident = 0;
+
+        // error check
+        if ( NULL == p_file ) return 0;
+
+        // read the resident page count
+        if ( 2 != fscanf(p_file, "%zu %zu", &pages, &resident) ) resident = 0;
+        fclose(p_file);
+
+        // done
+        return resident * (size_t) sysconf(_SC_PAGESIZE);
+    }
+
+    // unknown
+    #else
+        return 0;
+    #endif
+}
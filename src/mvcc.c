@@ -0,0 +1,592 @@
+/** !
+ * Multi version reads
+ *
+ * @file src/mvcc.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/mvcc.h>
+
+// structure declarations
+struct mvcc_entry_s;
+
+// type definitions
+typedef struct mvcc_entry_s mvcc_entry;
+
+// structure definitions
+struct mvcc_entry_s
+{
+
+    // the next key in the bucket
+    mvcc_entry         *p_next;
+    unsigned long long  hash;
+
+    // the saved versions, oldest first, so each replaced the one before it
+    mvcc_version *p_versions;
+    size_t        count,
+                  capacity;
+
+    char _key[MVCC_KEY_MAX];
+};
+
+struct mvcc_s
+{
+
+    // open snapshots, in no particular order
+    mvcc_snapshot _snapshots[MVCC_SNAPSHOT_MAX];
+    size_t        snapshots,
+                  next_id;
+
+    // keys with saved versions
+    mvcc_entry **pp_buckets;
+    size_t       buckets,
+                 keys,
+                 versions;
+};
+
+static unsigned long long mvcc_hash ( const char *p_key )
+{
+
+    // initialized data
+    unsigned long long h = 0xcbf29ce484222325ULL;
+
+    // FNV-1a
+    for (; *p_key; p_key++) h ^= (unsigned char) *p_key, h *= 0x100000001b3ULL;
+
+    // done
+    return h;
+}
+
+static mvcc_entry **mvcc_slot ( mvcc *p_mvcc, const char *p_key, unsigned long long hash )
+{
+
+    // initialized data
+    mvcc_entry **pp_entry = &p_mvcc->pp_buckets[hash & ( p_mvcc->buckets - 1 )];
+
+    // walk the chain
+    while ( *pp_entry && ( (*pp_entry)->hash != hash || strcmp((*pp_entry)->_key, p_key) ) ) pp_entry = &(*pp_entry)->p_next;
+
+    // done
+    return pp_entry;
+}
+
+static int mvcc_grow ( mvcc *p_mvcc )
+{
+
+    // initialized data
+    size_t       buckets    = p_mvcc->buckets * 2;
+    mvcc_entry **pp_buckets = key_value_memory_allocator(KEY_VALUE_MEMORY_VERSIONS, 0, buckets * sizeof(mvcc_entry *));
+
+    // error check
+    if ( NULL == pp_buckets ) return 0;
+    memset(pp_buckets, 0, buckets * sizeof(mvcc_entry *));
+
+    // move each entry
+    for (size_t i = 0; i < p_mvcc->buckets; i++)
+    {
+        for (mvcc_entry *p_entry = p_mvcc->pp_buckets[i], *p_next = NULL; p_entry; p_entry = p_next)
+        {
+            p_next = p_entry->p_next;
+            p_entry->p_next = pp_buckets[p_entry->hash & ( buckets - 1 )];
+            pp_buckets[p_entry->hash & ( buckets - 1 )] = p_entry;
+        }
+    }
+
+    // replace the buckets
+    key_value_memory_allocator(KEY_VALUE_MEMORY_VERSIONS, p_mvcc->pp_buckets, 0);
+    p_mvcc->pp_buckets = pp_buckets,
+    p_mvcc->buckets    = buckets;
+
+    // success
+    return 1;
+}
+
+static void mvcc_collect ( mvcc *p_mvcc )
+{
+
+    // initialized data
+    unsigned long long oldest = (unsigned long long) -1;
+
+    // the oldest open snapshot. without one, no version is needed
+    for (size_t i = 0; i < p_mvcc->snapshots; i++)
+        if ( p_mvcc->_snapshots[i].sequence < oldest ) oldest = p_mvcc->_snapshots[i].sequence;
+
+    // each key
+    for (size_t i = 0; i < p_mvcc->buckets; i++)
+    {
+        for (mvcc_entry **pp_entry = &p_mvcc->pp_buckets[i]; *pp_entry; )
+        {
+
+            // initialized data
+            mvcc_entry *p_entry = *pp_entry;
+            size_t      drop    = 0;
+
+            // versions replaced at, or before, the oldest snapshot are no one's
+            while ( drop < p_entry->count && p_entry->p_versions[drop].superseded <= oldest )
+                key_value_value_free(&p_entry->p_versions[drop++]._value);
+
+            // keep the rest
+            memmove(p_entry->p_versions, &p_entry->p_versions[drop], ( p_entry->count - drop ) * sizeof(mvcc_version));
+            p_entry->count   -= drop,
+            p_mvcc->versions -= drop;
+
+            // the key still has versions
+            if ( p_entry->count ) { pp_entry = &p_entry->p_next; continue; }
+
+            // release the key
+            *pp_entry = p_entry->p_next;
+            key_value_memory_allocator(KEY_VALUE_MEMORY_VERSIONS, p_entry->p_versions, 0);
+            key_value_memory_allocator(KEY_VALUE_MEMORY_VERSIONS, p_entry, 0);
+            p_mvcc->keys--;
+        }
+    }
+
+    // done
+    return;
+}
+
+int mvcc_construct ( mvcc **pp_mvcc )
+{
+
+    // argument check
+    if ( NULL == pp_mvcc ) goto no_mvcc;
+
+    // initialized data
+    mvcc *p_mvcc = key_value_memory_allocator(KEY_VALUE_MEMORY_VERSIONS, 0, sizeof(mvcc));
+
+    // error check
+    if ( NULL == p_mvcc ) goto no_mem;
+
+    // initialize the version store
+    memset(p_mvcc, 0, sizeof(mvcc));
+
+    // allocate the buckets
+    p_mvcc->pp_buckets = key_value_memory_allocator(KEY_VALUE_MEMORY_VERSIONS, 0, MVCC_BUCKETS * sizeof(mvcc_entry *));
+    if ( NULL == p_mvcc->pp_buckets ) goto no_buckets;
+    memset(p_mvcc->pp_buckets, 0, MVCC_BUCKETS * sizeof(mvcc_entry *));
+    p_mvcc->buckets = MVCC_BUCKETS;
+
+    // return a pointer to the caller
+    *pp_mvcc = p_mvcc;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_mvcc:
+                #ifndef NDEBUG
+                    log_error("[mvcc] Null pointer provided for parameter \"pp_mvcc\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_buckets:
+
+                // release the version store
+                p_mvcc = key_value_memory_allocator(KEY_VALUE_MEMORY_VERSIONS, p_mvcc, 0);
+
+                // fall through
+                goto no_mem;
+
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int mvcc_snapshot_open ( mvcc *p_mvcc, unsigned long long sequence, unsigned long long now, size_t *p_id )
+{
+
+    // argument check
+    if ( NULL == p_mvcc ) goto no_mvcc;
+    if ( NULL ==   p_id ) goto no_id;
+
+    // error check
+    if ( MVCC_SNAPSHOT_MAX == p_mvcc->snapshots ) goto too_many_snapshots;
+
+    // open the snapshot
+    p_mvcc->_snapshots[p_mvcc->snapshots++] = (mvcc_snapshot)
+    {
+        .id       = ++p_mvcc->next_id,
+        .sequence = sequence,
+        .time     = now,
+        .used     = now
+    };
+
+    // return the id to the caller
+    *p_id = p_mvcc->next_id;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_mvcc:
+                #ifndef NDEBUG
+                    log_error("[mvcc] Null pointer provided for parameter \"p_mvcc\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_id:
+                #ifndef NDEBUG
+                    log_error("[mvcc] Null pointer provided for parameter \"p_id\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // mvcc errors
+        {
+            too_many_snapshots:
+                #ifndef NDEBUG
+                    log_error("[mvcc] %d snapshots are already open in call to function \"%s\"\n", MVCC_SNAPSHOT_MAX, __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int mvcc_snapshot_get ( mvcc *p_mvcc, size_t id, unsigned long long now, mvcc_snapshot *p_snapshot )
+{
+
+    // argument check
+    if ( NULL ==     p_mvcc ) return 0;
+    if ( NULL == p_snapshot ) return 0;
+
+    // find the snapshot
+    for (size_t i = 0; i < p_mvcc->snapshots; i++)
+    {
+        if ( id != p_mvcc->_snapshots[i].id ) continue;
+
+        // mark it used, and return it to the caller
+        p_mvcc->_snapshots[i].used = now;
+        *p_snapshot = p_mvcc->_snapshots[i];
+
+        // success
+        return 1;
+    }
+
+    // not open
+    return 0;
+}
+
+int mvcc_snapshot_close ( mvcc *p_mvcc, size_t id )
+{
+
+    // argument check
+    if ( NULL == p_mvcc ) return 0;
+
+    // find the snapshot
+    for (size_t i = 0; i < p_mvcc->snapshots; i++)
+    {
+        if ( id != p_mvcc->_snapshots[i].id ) continue;
+
+        // close it
+        p_mvcc->_snapshots[i] = p_mvcc->_snapshots[--p_mvcc->snapshots];
+
+        // drop the versions only it needed
+        mvcc_collect(p_mvcc);
+
+        // success
+        return 1;
+    }
+
+    // not open
+    return 0;
+}
+
+size_t mvcc_snapshot_expire ( mvcc *p_mvcc, unsigned long long now, unsigned long long idle )
+{
+
+    // initialized data
+    size_t closed = 0;
+
+    // argument check
+    if ( NULL == p_mvcc ) return 0;
+
+    // close each idle snapshot
+    for (size_t i = 0; i < p_mvcc->snapshots; )
+    {
+        if ( p_mvcc->_snapshots[i].used + idle > now ) { i++; continue; }
+        p_mvcc->_snapshots[i] = p_mvcc->_snapshots[--p_mvcc->snapshots];
+        closed++;
+    }
+
+    // drop the versions only they needed
+    if ( closed ) mvcc_collect(p_mvcc);
+
+    // done
+    return closed;
+}
+
+size_t mvcc_snapshots ( mvcc *p_mvcc, mvcc_snapshot *p_snapshots )
+{
+
+    // argument check
+    if ( NULL ==      p_mvcc ) return 0;
+    if ( NULL == p_snapshots ) return 0;
+
+    // copy the snapshots
+    memcpy(p_snapshots, p_mvcc->_snapshots, p_mvcc->snapshots * sizeof(mvcc_snapshot));
+
+    // done
+    return p_mvcc->snapshots;
+}
+
+bool mvcc_pinned ( mvcc *p_mvcc )
+{
+
+    // done
+    return p_mvcc && p_mvcc->snapshots;
+}
+
+int mvcc_save ( mvcc *p_mvcc, const char *p_key, unsigned long long superseded, const key_value_value *p_value, unsigned long long version, unsigned long long expires )
+{
+
+    // argument check
+    if ( NULL == p_mvcc ) goto no_mvcc;
+    if ( NULL ==  p_key ) goto no_key;
+
+    // initialized data
+    unsigned long long  hash     = mvcc_hash(p_key),
+                        newest   = 0;
+    mvcc_entry        **pp_entry = NULL,
+                       *p_entry  = NULL;
+    mvcc_version       *p_saved  = NULL;
+
+    // no snapshot reads the old version
+    if ( 0 == p_mvcc->snapshots ) return 1;
+
+    // the newest open snapshot
+    for (size_t i = 0; i < p_mvcc->snapshots; i++)
+        if ( p_mvcc->_snapshots[i].sequence > newest ) newest = p_mvcc->_snapshots[i].sequence;
+
+    // find the key
+    pp_entry = mvcc_slot(p_mvcc, p_key, hash);
+    p_entry  = *pp_entry;
+
+    // a write since the newest snapshot saved what every snapshot reads
+    if ( p_entry && p_entry->count && p_entry->p_versions[p_entry->count - 1].superseded > newest ) return 1;
+
+    // add the key
+    if ( NULL == p_entry )
+    {
+
+        // make room
+        if ( p_mvcc->keys + 1 > p_mvcc->buckets )
+        {
+            if ( 0 == mvcc_grow(p_mvcc) ) goto no_mem;
+            pp_entry = mvcc_slot(p_mvcc, p_key, hash);
+        }
+
+        // allocate the key
+        p_entry = key_value_memory_allocator(KEY_VALUE_MEMORY_VERSIONS, 0, sizeof(mvcc_entry));
+        if ( NULL == p_entry ) goto no_mem;
+        memset(p_entry, 0, sizeof(mvcc_entry));
+        strncpy(p_entry->_key, p_key, MVCC_KEY_MAX - 1);
+        p_entry->hash = hash;
+
+        // link the key
+        *pp_entry = p_entry;
+        p_mvcc->keys++;
+    }
+
+    // grow the versions
+    if ( p_entry->count == p_entry->capacity )
+    {
+
+        // initialized data
+        size_t        capacity   = ( p_entry->capacity ) ? p_entry->capacity * 2 : 2;
+        mvcc_version *p_versions = key_value_memory_allocator(KEY_VALUE_MEMORY_VERSIONS, p_entry->p_versions, capacity * sizeof(mvcc_version));
+
+        // error check
+        if ( NULL == p_versions ) goto no_mem;
+
+        // store the versions
+        p_entry->p_versions = p_versions,
+        p_entry->capacity   = capacity;
+    }
+
+    // initialized data
+    p_saved  = &p_entry->p_versions[p_entry->count];
+    *p_saved = (mvcc_version)
+    {
+        .version    = version,
+        .expires    = expires,
+        .superseded = superseded,
+        .found      = ( NULL != p_value )
+    };
+
+    // share an out of line buffer, or copy the value
+    if ( p_value )
+    {
+
+        // initialized data
+        const char *p_buffer = key_value_value_retain(p_value);
+        size_t      length   = 0;
+        const char *p_text   = NULL;
+
+        // share the buffer
+        if ( p_buffer ) key_value_value_adopt(&p_saved->_value, (char *) p_buffer, p_value->heap.length, p_value->type);
+
+        // copy the value
+        else
+        {
+            p_text = key_value_value_text(p_value, &length);
+            if ( 0 == key_value_value_from_text(&p_saved->_value, p_text, length, p_value->type) ) goto no_mem;
+        }
+    }
+
+    // count the version
+    p_entry->count++;
+    p_mvcc->versions++;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_mvcc:
+                #ifndef NDEBUG
+                    log_error("[mvcc] Null pointer provided for parameter \"p_mvcc\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[mvcc] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+const mvcc_version *mvcc_read ( mvcc *p_mvcc, const char *p_key, unsigned long long sequence )
+{
+
+    // initialized data
+    mvcc_entry *p_entry = NULL;
+
+    // argument check
+    if ( NULL == p_mvcc || NULL == p_key ) return NULL;
+
+    // nothing is saved
+    if ( 0 == p_mvcc->keys ) return NULL;
+
+    // find the key
+    p_entry = *mvcc_slot(p_mvcc, p_key, mvcc_hash(p_key));
+    if ( NULL == p_entry ) return NULL;
+
+    // the first version replaced after the snapshot is the one it reads
+    for (size_t i = 0; i < p_entry->count; i++)
+        if ( p_entry->p_versions[i].superseded > sequence ) return &p_entry->p_versions[i];
+
+    // not written since the snapshot
+    return NULL;
+}
+
+int mvcc_keys ( mvcc *p_mvcc, fn_mvcc_key *pfn_key, void *p_parameter )
+{
+
+    // argument check
+    if ( NULL ==  p_mvcc ) return 0;
+    if ( NULL == pfn_key ) return 0;
+
+    // each key
+    for (size_t i = 0; i < p_mvcc->buckets; i++)
+        for (mvcc_entry *p_entry = p_mvcc->pp_buckets[i]; p_entry; p_entry = p_entry->p_next)
+            if ( 0 == pfn_key(p_entry->_key, p_parameter) ) return 0;
+
+    // success
+    return 1;
+}
+
+size_t mvcc_count ( mvcc *p_mvcc )
+{
+
+    // done
+    return ( p_mvcc ) ? p_mvcc->versions : 0;
+}
+
+int mvcc_destroy ( mvcc **pp_mvcc )
+{
+
+    // argument check
+    if ( NULL == pp_mvcc ) goto no_mvcc;
+
+    // initialized data
+    mvcc *p_mvcc = *pp_mvcc;
+
+    // no more pointer for caller
+    *pp_mvcc = NULL;
+
+    // nothing to release
+    if ( NULL == p_mvcc ) return 1;
+
+    // close every snapshot, which drops every version
+    p_mvcc->snapshots = 0;
+    mvcc_collect(p_mvcc);
+
+    // release the version store
+    key_value_memory_allocator(KEY_VALUE_MEMORY_VERSIONS, p_mvcc->pp_buckets, 0);
+    key_value_memory_allocator(KEY_VALUE_MEMORY_VERSIONS, p_mvcc, 0);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_mvcc:
+                #ifndef NDEBUG
+                    log_error("[mvcc] Null pointer provided for parameter \"pp_mvcc\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
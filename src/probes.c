@@ -0,0 +1,26 @@
+/** !
+ * USDT probe semaphores
+ *
+ * @file src/probes.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/probes.h>
+
+#ifdef KEY_VALUE_DB_USDT
+
+// data
+// a tracer raises the semaphore of each probe it attaches to
+unsigned short key_value_db_connection__accept_semaphore __attribute__((section(".probes"))) = 0,
+               key_value_db_connection__close_semaphore  __attribute__((section(".probes"))) = 0,
+               key_value_db_request__start_semaphore     __attribute__((section(".probes"))) = 0,
+               key_value_db_request__end_semaphore       __attribute__((section(".probes"))) = 0,
+               key_value_db_cache__hit_semaphore         __attribute__((section(".probes"))) = 0,
+               key_value_db_cache__miss_semaphore        __attribute__((section(".probes"))) = 0,
+               key_value_db_index__insert_semaphore      __attribute__((section(".probes"))) = 0,
+               key_value_db_index__remove_semaphore      __attribute__((section(".probes"))) = 0,
+               key_value_db_evict_semaphore              __attribute__((section(".probes"))) = 0;
+
+#endif
@@ -0,0 +1,444 @@
+/** !
+ * Shared memory rings
+ *
+ * @file src/ring.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/ring.h>
+
+// platform dependent includes
+#ifdef __linux__
+    #include <unistd.h>
+    #include <sys/syscall.h>
+    #include <linux/futex.h>
+#endif
+
+// preprocessor definitions
+#if defined(__x86_64__) || defined(__i386__)
+    #define RING_PAUSE() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+    #define RING_PAUSE() __asm__ volatile ( "yield" )
+#else
+    #define RING_PAUSE() ( (void) 0 )
+#endif
+
+// the layout is shared with other languages
+_Static_assert(offsetof(ring_header, head)           ==   0, "ring layout");
+_Static_assert(offsetof(ring_header, tail)           ==  64, "ring layout");
+_Static_assert(offsetof(ring_header, readable)       == 128, "ring layout");
+_Static_assert(offsetof(ring_header, reader_waiting) == 132, "ring layout");
+_Static_assert(offsetof(ring_header, writable)       == 192, "ring layout");
+_Static_assert(offsetof(ring_header, writer_waiting) == 196, "ring layout");
+_Static_assert(offsetof(ring_header, closed)         == 256, "ring layout");
+_Static_assert(offsetof(ring_header, capacity)       == 264, "ring layout");
+_Static_assert(offsetof(ring_header, _data)          == RING_HEADER, "ring layout");
+
+// structure definitions
+struct ring_s
+{
+    ring_header *p_header;
+    size_t       capacity;
+};
+
+static void ring_sleep ( unsigned int *p_word, unsigned int value, int timeout_ms )
+{
+
+    #ifdef __linux__
+    {
+
+        // initialized data
+        struct timespec _timeout = { .tv_sec = timeout_ms / 1000, .tv_nsec = ( timeout_ms % 1000 ) * 1000000L };
+
+        // sleep until woken, or the timeout. the word is shared with another process
+        syscall(SYS_futex, p_word, FUTEX_WAIT, value, &_timeout, NULL, 0);
+    }
+    #else
+    {
+
+        // initialized data
+        struct timespec _tick = { .tv_sec = 0, .tv_nsec = 1000000 };
+
+        // without a futex, poll every millisecond
+        for (int i = 0; i < timeout_ms && value == __atomic_load_n(p_word, __ATOMIC_ACQUIRE); i++) nanosleep(&_tick, NULL);
+    }
+    #endif
+
+    // done
+    return;
+}
+
+static void ring_wake ( unsigned int *p_word )
+{
+
+    // change the word, so a side about to sleep does not
+    __atomic_add_fetch(p_word, 1, __ATOMIC_SEQ_CST);
+
+    // wake the sleeper
+    #ifdef __linux__
+        syscall(SYS_futex, p_word, FUTEX_WAKE, 1, NULL, NULL, 0);
+    #endif
+
+    // done
+    return;
+}
+
+static bool ring_ready ( ring *p_ring, bool reader )
+{
+
+    // initialized data
+    ring_header *p_header = p_ring->p_header;
+
+    // the reader waits for bytes, and the writer for room
+    if ( reader ) return __atomic_load_n(&p_header->head, __ATOMIC_SEQ_CST) != p_header->tail;
+    else          return p_header->head - __atomic_load_n(&p_header->tail, __ATOMIC_SEQ_CST) < p_ring->capacity;
+}
+
+static bool ring_wait ( ring *p_ring, bool reader, int timeout_ms )
+{
+
+    // initialized data
+    ring_header  *p_header  = p_ring->p_header;
+    unsigned int *p_signal  = ( reader ) ? &p_header->readable       : &p_header->writable,
+                 *p_waiting = ( reader ) ? &p_header->reader_waiting : &p_header->writer_waiting,
+                  signal    = 0;
+
+    // poll, then sleep once
+    for (size_t spin = 0; ; spin++)
+    {
+
+        // ready
+        if ( ring_ready(p_ring, reader) ) return true;
+
+        // closed. the other side may have written its last bytes just before
+        if ( __atomic_load_n(&p_header->closed, __ATOMIC_SEQ_CST) ) return reader && ring_ready(p_ring, reader);
+
+        // poll
+        if ( spin < RING_SPIN ) { RING_PAUSE(); continue; }
+
+        // already slept
+        if ( spin > RING_SPIN ) return false;
+
+        // say this side is sleeping, then look again, so a wake is never missed
+        signal = __atomic_load_n(p_signal, __ATOMIC_SEQ_CST);
+        __atomic_store_n(p_waiting, 1, __ATOMIC_SEQ_CST);
+        if ( false == ring_ready(p_ring, reader) && 0 == __atomic_load_n(&p_header->closed, __ATOMIC_SEQ_CST) ) ring_sleep(p_signal, signal, timeout_ms);
+        __atomic_store_n(p_waiting, 0, __ATOMIC_SEQ_CST);
+    }
+}
+
+size_t ring_size ( size_t capacity )
+{
+
+    // done
+    return RING_HEADER + capacity;
+}
+
+int ring_construct ( ring **pp_ring, void *p_memory, size_t capacity )
+{
+
+    // argument check
+    if ( NULL ==  pp_ring                                                 ) goto no_ring;
+    if ( NULL == p_memory                                                 ) goto no_memory;
+    if ( capacity < RING_CAPACITY_MIN || ( capacity & ( capacity - 1 ) ) ) goto bad_capacity;
+
+    // initialized data
+    ring *p_ring = key_value_memory_allocator(KEY_VALUE_MEMORY_CONNECTIONS, 0, sizeof(ring));
+
+    // error check
+    if ( NULL == p_ring ) goto no_mem;
+
+    // initialize the shared memory
+    memset(p_memory, 0, RING_HEADER);
+    ((ring_header *) p_memory)->capacity = capacity;
+
+    // populate the ring
+    *p_ring = (ring) { .p_header = p_memory, .capacity = capacity };
+
+    // return a pointer to the caller
+    *pp_ring = p_ring;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_ring:
+                #ifndef NDEBUG
+                    log_error("[ring] Null pointer provided for parameter \"pp_ring\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_memory:
+                #ifndef NDEBUG
+                    log_error("[ring] Null pointer provided for parameter \"p_memory\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            bad_capacity:
+                #ifndef NDEBUG
+                    log_error("[ring] Parameter \"capacity\" must be a power of two, of at least %d, in call to function \"%s\"\n", RING_CAPACITY_MIN, __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int ring_attach ( ring **pp_ring, void *p_memory, size_t size )
+{
+
+    // argument check
+    if ( NULL ==  pp_ring ) goto no_ring;
+    if ( NULL == p_memory ) goto no_memory;
+
+    // initialized data
+    ring   *p_ring   = NULL;
+    size_t  capacity = 0;
+
+    // error check
+    if ( size < RING_HEADER ) goto not_a_ring;
+
+    // the capacity must fit in the mapping
+    capacity = (size_t) ((ring_header *) p_memory)->capacity;
+    if ( capacity < RING_CAPACITY_MIN || ( capacity & ( capacity - 1 ) ) || capacity > size - RING_HEADER ) goto not_a_ring;
+
+    // allocate the ring
+    p_ring = key_value_memory_allocator(KEY_VALUE_MEMORY_CONNECTIONS, 0, sizeof(ring));
+    if ( NULL == p_ring ) goto no_mem;
+
+    // populate the ring
+    *p_ring = (ring) { .p_header = p_memory, .capacity = capacity };
+
+    // return a pointer to the caller
+    *pp_ring = p_ring;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_ring:
+                #ifndef NDEBUG
+                    log_error("[ring] Null pointer provided for parameter \"pp_ring\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_memory:
+                #ifndef NDEBUG
+                    log_error("[ring] Null pointer provided for parameter \"p_memory\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // ring errors
+        {
+            not_a_ring:
+                #ifndef NDEBUG
+                    log_error("[ring] The memory does not hold a ring in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+size_t ring_read ( ring *p_ring, void *p_data, size_t capacity, int timeout_ms )
+{
+
+    // argument check
+    if ( NULL == p_ring || NULL == p_data || 0 == capacity ) return 0;
+
+    // initialized data
+    ring_header        *p_header  = p_ring->p_header;
+    unsigned long long  tail      = p_header->tail,
+                        available = 0;
+    size_t              offset    = 0,
+                        first     = 0;
+
+    // wait for bytes
+    if ( false == ring_wait(p_ring, true, timeout_ms) ) return 0;
+
+    // the bytes the writer published. more than the capacity is a broken ring
+    available = __atomic_load_n(&p_header->head, __ATOMIC_ACQUIRE) - tail;
+    if ( available > p_ring->capacity ) goto broken;
+    if ( available > capacity ) available = capacity;
+
+    // copy the bytes, which may wrap around the end
+    offset = (size_t) ( tail & ( p_ring->capacity - 1 ) ),
+    first  = ( available < p_ring->capacity - offset ) ? (size_t) available : p_ring->capacity - offset;
+    memcpy(p_data, &p_header->_data[offset], first);
+    memcpy((char *) p_data + first, p_header->_data, (size_t) available - first);
+
+    // give the room back, and wake a waiting writer
+    __atomic_store_n(&p_header->tail, tail + available, __ATOMIC_SEQ_CST);
+    if ( __atomic_load_n(&p_header->writer_waiting, __ATOMIC_SEQ_CST) ) ring_wake(&p_header->writable);
+
+    // done
+    return (size_t) available;
+
+    // this branch closes a ring the other side broke
+    broken:
+
+        // close the ring
+        ring_close(p_ring);
+
+        // error
+        return 0;
+}
+
+size_t ring_write ( ring *p_ring, const void *p_data, size_t length, int timeout_ms )
+{
+
+    // argument check
+    if ( NULL == p_ring || NULL == p_data || 0 == length ) return 0;
+
+    // initialized data
+    ring_header        *p_header = p_ring->p_header;
+    unsigned long long  head     = p_header->head,
+                        used     = 0;
+    size_t              room     = 0,
+                        offset   = 0,
+                        first    = 0;
+
+    // wait for room
+    if ( false == ring_wait(p_ring, false, timeout_ms) ) return 0;
+
+    // the room the reader gave back. less than none is a broken ring
+    used = head - __atomic_load_n(&p_header->tail, __ATOMIC_ACQUIRE);
+    if ( used > p_ring->capacity ) goto broken;
+    room = p_ring->capacity - (size_t) used;
+    if ( length > room ) length = room;
+
+    // copy the bytes, which may wrap around the end
+    offset = (size_t) ( head & ( p_ring->capacity - 1 ) ),
+    first  = ( length < p_ring->capacity - offset ) ? length : p_ring->capacity - offset;
+    memcpy(&p_header->_data[offset], p_data, first);
+    memcpy(p_header->_data, (const char *) p_data + first, length - first);
+
+    // publish the bytes, and wake a waiting reader
+    __atomic_store_n(&p_header->head, head + length, __ATOMIC_SEQ_CST);
+    if ( __atomic_load_n(&p_header->reader_waiting, __ATOMIC_SEQ_CST) ) ring_wake(&p_header->readable);
+
+    // done
+    return length;
+
+    // this branch closes a ring the other side broke
+    broken:
+
+        // close the ring
+        ring_close(p_ring);
+
+        // error
+        return 0;
+}
+
+int ring_try_write ( ring *p_ring, const void *p_data, size_t length )
+{
+
+    // argument check
+    if ( NULL == p_ring || NULL == p_data ) return 0;
+
+    // initialized data
+    ring_header        *p_header = p_ring->p_header;
+    unsigned long long  used     = p_header->head - __atomic_load_n(&p_header->tail, __ATOMIC_ACQUIRE);
+
+    // closed, broken, or not enough room
+    if ( __atomic_load_n(&p_header->closed, __ATOMIC_ACQUIRE) ) return 0;
+    if ( used > p_ring->capacity || p_ring->capacity - (size_t) used < length ) return 0;
+
+    // write every byte. there is room, so nothing waits
+    return ( length == ring_write(p_ring, p_data, length, 0) );
+}
+
+void ring_close ( ring *p_ring )
+{
+
+    // argument check
+    if ( NULL == p_ring ) return;
+
+    // close the ring
+    __atomic_store_n(&p_ring->p_header->closed, 1, __ATOMIC_SEQ_CST);
+
+    // wake both sides
+    ring_wake(&p_ring->p_header->readable),
+    ring_wake(&p_ring->p_header->writable);
+
+    // done
+    return;
+}
+
+bool ring_closed ( ring *p_ring )
+{
+
+    // done
+    return ( NULL == p_ring ) || __atomic_load_n(&p_ring->p_header->closed, __ATOMIC_ACQUIRE);
+}
+
+int ring_destroy ( ring **pp_ring )
+{
+
+    // argument check
+    if ( NULL == pp_ring ) goto no_ring;
+
+    // release the ring
+    *pp_ring = key_value_memory_allocator(KEY_VALUE_MEMORY_CONNECTIONS, *pp_ring, 0);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_ring:
+                #ifndef NDEBUG
+                    log_error("[ring] Null pointer provided for parameter \"pp_ring\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
@@ -0,0 +1,545 @@
+/** !
+ * Secondary indexes, from a JSON path in the values of matching keys, to the keys
+ *
+ * @file src/secondary_index.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/secondary_index.h>
+
+// structure declarations
+struct secondary_index_entry_s;
+
+// type definitions
+typedef struct secondary_index_entry_s secondary_index_entry;
+
+// structure definitions
+struct secondary_index_entry_s
+{
+
+    // chained by key, to find the entry of a key, and by value, to find the
+    // keys of a value. many keys may share a value, so that chain is doubly
+    // linked, and an entry leaves it without a walk
+    secondary_index_entry  *p_next_key,
+                           *p_next_value,
+                          **pp_prev_value;
+    unsigned long long      key_hash,
+                            value_hash;
+
+    char                    _key[SECONDARY_INDEX_KEY_MAX];
+    size_t                  value_length;
+    char                    _value[];
+};
+
+struct secondary_index_s
+{
+    char                    _name[SECONDARY_INDEX_NAME_MAX],
+                            _pattern[SECONDARY_INDEX_PATTERN_MAX],
+                            _path[SECONDARY_INDEX_PATH_MAX];
+    size_t                  path_length;
+
+    // two tables of the same size, one per chain
+    secondary_index_entry **pp_keys,
+                          **pp_values;
+    size_t                  buckets,
+                            count;
+};
+
+static unsigned long long secondary_index_hash ( const char *p_data, size_t length )
+{
+
+    // initialized data
+    unsigned long long h = 0xcbf29ce484222325ULL;
+
+    // FNV-1a
+    for (size_t i = 0; i < length; i++) h ^= (unsigned char) p_data[i], h *= 0x100000001b3ULL;
+
+    // done
+    return h;
+}
+
+bool secondary_index_glob ( const char *p_pattern, const char *p_key )
+{
+
+    // initialized data
+    const char *p_star  = NULL,
+               *p_retry = NULL;
+
+    // match, backtracking to the last star on a mismatch
+    while ( *p_key )
+    {
+        if      ( '*' == *p_pattern )                       p_star = p_pattern++, p_retry = p_key;
+        else if ( '?' == *p_pattern || *p_pattern == *p_key ) p_pattern++, p_key++;
+        else if ( p_star )                                  p_pattern = p_star + 1, p_key = ++p_retry;
+        else                                                return false;
+    }
+
+    // trailing stars match nothing
+    while ( '*' == *p_pattern ) p_pattern++;
+
+    // done
+    return '\0' == *p_pattern;
+}
+
+static secondary_index_entry **secondary_index_key_slot ( secondary_index *p_secondary_index, const char *p_key, unsigned long long hash )
+{
+
+    // initialized data
+    secondary_index_entry **pp_entry = &p_secondary_index->pp_keys[hash & ( p_secondary_index->buckets - 1 )];
+
+    // walk the chain
+    while ( *pp_entry && ( (*pp_entry)->key_hash != hash || strcmp((*pp_entry)->_key, p_key) ) ) pp_entry = &(*pp_entry)->p_next_key;
+
+    // done
+    return pp_entry;
+}
+
+static void secondary_index_link_value ( secondary_index *p_secondary_index, secondary_index_entry *p_entry )
+{
+
+    // initialized data
+    secondary_index_entry **pp_head = &p_secondary_index->pp_values[p_entry->value_hash & ( p_secondary_index->buckets - 1 )];
+
+    // push the entry
+    p_entry->p_next_value  = *pp_head,
+    p_entry->pp_prev_value = pp_head;
+    if ( *pp_head ) (*pp_head)->pp_prev_value = &p_entry->p_next_value;
+    *pp_head = p_entry;
+
+    // done
+    return;
+}
+
+static int secondary_index_grow ( secondary_index *p_secondary_index )
+{
+
+    // initialized data
+    size_t                  buckets   = p_secondary_index->buckets * 2;
+    secondary_index_entry **pp_keys   = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEXES, 0, buckets * sizeof(secondary_index_entry *)),
+                          **pp_values = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEXES, 0, buckets * sizeof(secondary_index_entry *)),
+                          **pp_old    = p_secondary_index->pp_keys;
+
+    // error check
+    if ( NULL == pp_keys || NULL == pp_values ) goto no_mem;
+
+    // swap in the new tables
+    memset(pp_keys, 0, buckets * sizeof(secondary_index_entry *));
+    memset(pp_values, 0, buckets * sizeof(secondary_index_entry *));
+    p_secondary_index->pp_values = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEXES, p_secondary_index->pp_values, 0),
+    p_secondary_index->pp_values = pp_values,
+    p_secondary_index->pp_keys   = pp_keys,
+    p_secondary_index->buckets   = buckets;
+
+    // rehash each entry into both chains
+    for (size_t i = 0; i < buckets / 2; i++)
+    {
+
+        // initialized data
+        secondary_index_entry *p_entry = pp_old[i];
+
+        // each entry in the old chain
+        while ( p_entry )
+        {
+
+            // initialized data
+            secondary_index_entry *p_next = p_entry->p_next_key;
+
+            // relink the entry
+            p_entry->p_next_key = pp_keys[p_entry->key_hash & ( buckets - 1 )],
+            pp_keys[p_entry->key_hash & ( buckets - 1 )] = p_entry;
+            secondary_index_link_value(p_secondary_index, p_entry);
+
+            // next
+            p_entry = p_next;
+        }
+    }
+
+    // release the old table
+    pp_old = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEXES, pp_old, 0);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // release the new tables
+                pp_keys   = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEXES, pp_keys, 0),
+                pp_values = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEXES, pp_values, 0);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int secondary_index_construct ( secondary_index **pp_secondary_index, const char *p_name, const char *p_pattern, const char *p_path )
+{
+
+    // argument check
+    if ( NULL == pp_secondary_index ) goto no_secondary_index;
+    if ( NULL ==             p_name ) goto no_name;
+    if ( NULL ==          p_pattern ) goto no_pattern;
+    if ( NULL ==             p_path ) goto no_path;
+
+    // initialized data
+    secondary_index *p_secondary_index = NULL;
+
+    // error check
+    if ( 0 == strlen(p_name)    || strlen(p_name)    >= SECONDARY_INDEX_NAME_MAX    ) goto bad_name;
+    if ( 0 == strlen(p_pattern) || strlen(p_pattern) >= SECONDARY_INDEX_PATTERN_MAX ) goto bad_pattern;
+    if ( 0 == strlen(p_path)    || strlen(p_path)    >= SECONDARY_INDEX_PATH_MAX    ) goto bad_path;
+
+    // allocate the index
+    p_secondary_index = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEXES, 0, sizeof(secondary_index));
+    if ( NULL == p_secondary_index ) goto no_mem;
+    memset(p_secondary_index, 0, sizeof(secondary_index));
+
+    // store the definition
+    strcpy(p_secondary_index->_name, p_name);
+    strcpy(p_secondary_index->_pattern, p_pattern);
+    strcpy(p_secondary_index->_path, p_path);
+    p_secondary_index->path_length = strlen(p_path);
+
+    // allocate the tables
+    p_secondary_index->buckets   = SECONDARY_INDEX_BUCKETS,
+    p_secondary_index->pp_keys   = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEXES, 0, SECONDARY_INDEX_BUCKETS * sizeof(secondary_index_entry *)),
+    p_secondary_index->pp_values = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEXES, 0, SECONDARY_INDEX_BUCKETS * sizeof(secondary_index_entry *));
+    if ( NULL == p_secondary_index->pp_keys || NULL == p_secondary_index->pp_values ) goto no_mem;
+    memset(p_secondary_index->pp_keys, 0, SECONDARY_INDEX_BUCKETS * sizeof(secondary_index_entry *));
+    memset(p_secondary_index->pp_values, 0, SECONDARY_INDEX_BUCKETS * sizeof(secondary_index_entry *));
+
+    // return a pointer to the caller
+    *pp_secondary_index = p_secondary_index;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_secondary_index:
+                #ifndef NDEBUG
+                    log_error("[secondary index] Null pointer provided for parameter \"pp_secondary_index\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_name:
+                #ifndef NDEBUG
+                    log_error("[secondary index] Null pointer provided for parameter \"p_name\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_pattern:
+                #ifndef NDEBUG
+                    log_error("[secondary index] Null pointer provided for parameter \"p_pattern\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_path:
+                #ifndef NDEBUG
+                    log_error("[secondary index] Null pointer provided for parameter \"p_path\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // secondary index errors
+        {
+            bad_name:
+                #ifndef NDEBUG
+                    log_error("[secondary index] Parameter \"p_name\" must be 1 to %d characters in call to function \"%s\"\n", SECONDARY_INDEX_NAME_MAX - 1, __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            bad_pattern:
+                #ifndef NDEBUG
+                    log_error("[secondary index] Parameter \"p_pattern\" must be 1 to %d characters in call to function \"%s\"\n", SECONDARY_INDEX_PATTERN_MAX - 1, __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            bad_path:
+                #ifndef NDEBUG
+                    log_error("[secondary index] Parameter \"p_path\" must be 1 to %d characters in call to function \"%s\"\n", SECONDARY_INDEX_PATH_MAX - 1, __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // release the index
+                secondary_index_destroy(&p_secondary_index);
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int secondary_index_update ( secondary_index *p_secondary_index, const char *p_key, const char *p_text, size_t length )
+{
+
+    // argument check
+    if ( NULL == p_secondary_index ) return 0;
+    if ( NULL ==             p_key ) return 0;
+    if ( NULL ==            p_text ) return 0;
+
+    // initialized data
+    size_t                  offset   = 0,
+                            span     = 0;
+    unsigned long long      key_hash = 0;
+    secondary_index_entry **pp_slot  = NULL,
+                           *p_entry  = NULL;
+
+    // not indexed by this index
+    if ( false == secondary_index_match(p_secondary_index, p_key) ) return 0;
+
+    // nothing at the path, or too much to index
+    if ( 0 == json_path_locate(p_text, length, p_secondary_index->_path, p_secondary_index->path_length, &offset, &span) ) goto drop;
+    if ( SECONDARY_INDEX_VALUE_MAX < span ) goto drop;
+
+    // find the entry of the key
+    key_hash = secondary_index_hash(p_key, strlen(p_key)),
+    pp_slot  = secondary_index_key_slot(p_secondary_index, p_key, key_hash);
+
+    // the indexed value did not change
+    if ( *pp_slot && (*pp_slot)->value_length == span && 0 == memcmp((*pp_slot)->_value, &p_text[offset], span) ) return 1;
+
+    // the indexed value changed
+    if ( *pp_slot ) secondary_index_remove(p_secondary_index, p_key);
+
+    // make room
+    if ( p_secondary_index->count + 1 > p_secondary_index->buckets ) secondary_index_grow(p_secondary_index);
+
+    // allocate an entry
+    p_entry = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEXES, 0, sizeof(secondary_index_entry) + span);
+    if ( NULL == p_entry ) goto no_mem;
+
+    // populate the entry
+    memset(p_entry, 0, sizeof(secondary_index_entry));
+    strncpy(p_entry->_key, p_key, SECONDARY_INDEX_KEY_MAX - 1);
+    memcpy(p_entry->_value, &p_text[offset], span);
+    p_entry->key_hash     = key_hash,
+    p_entry->value_hash   = secondary_index_hash(&p_text[offset], span),
+    p_entry->value_length = span;
+
+    // link the entry into both chains
+    p_entry->p_next_key = p_secondary_index->pp_keys[key_hash & ( p_secondary_index->buckets - 1 )],
+    p_secondary_index->pp_keys[key_hash & ( p_secondary_index->buckets - 1 )] = p_entry;
+    secondary_index_link_value(p_secondary_index, p_entry);
+    p_secondary_index->count++;
+
+    // success
+    return 1;
+
+    // this branch handles values with nothing to index
+    drop:
+    {
+
+        // forget the key
+        secondary_index_remove(p_secondary_index, p_key);
+
+        // done
+        return 0;
+    }
+
+    // error handling
+    {
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int secondary_index_remove ( secondary_index *p_secondary_index, const char *p_key )
+{
+
+    // argument check
+    if ( NULL == p_secondary_index ) return 0;
+    if ( NULL ==             p_key ) return 0;
+
+    // initialized data
+    secondary_index_entry **pp_slot = secondary_index_key_slot(p_secondary_index, p_key, secondary_index_hash(p_key, strlen(p_key))),
+                           *p_entry = *pp_slot;
+
+    // not indexed
+    if ( NULL == p_entry ) return 0;
+
+    // unlink the entry from both chains
+    *pp_slot = p_entry->p_next_key;
+    *p_entry->pp_prev_value = p_entry->p_next_value;
+    if ( p_entry->p_next_value ) p_entry->p_next_value->pp_prev_value = p_entry->pp_prev_value;
+    p_secondary_index->count--;
+
+    // release the entry
+    p_entry = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEXES, p_entry, 0);
+
+    // success
+    return 1;
+}
+
+bool secondary_index_match ( secondary_index *p_secondary_index, const char *p_key )
+{
+
+    // argument check
+    if ( NULL == p_secondary_index ) return false;
+    if ( NULL ==             p_key ) return false;
+
+    // done
+    return secondary_index_glob(p_secondary_index->_pattern, p_key);
+}
+
+size_t secondary_index_find ( secondary_index *p_secondary_index, const char *p_value, size_t length, fn_secondary_index_key *pfn_key, void *p_parameter )
+{
+
+    // argument check
+    if ( NULL == p_secondary_index ) return 0;
+    if ( NULL ==           p_value ) return 0;
+    if ( NULL ==           pfn_key ) return 0;
+
+    // initialized data
+    unsigned long long     hash    = secondary_index_hash(p_value, length);
+    secondary_index_entry *p_entry = p_secondary_index->pp_values[hash & ( p_secondary_index->buckets - 1 )];
+    size_t                 calls   = 0;
+
+    // each entry with the value
+    for (; p_entry; p_entry = p_entry->p_next_value)
+    {
+
+        // another value in the same bucket
+        if ( p_entry->value_hash != hash || p_entry->value_length != length || memcmp(p_entry->_value, p_value, length) ) continue;
+
+        // call the function
+        calls++;
+        if ( 0 == pfn_key(p_entry->_key, p_parameter) ) break;
+    }
+
+    // done
+    return calls;
+}
+
+const char *secondary_index_name ( secondary_index *p_secondary_index )
+{
+
+    // done
+    return ( p_secondary_index ) ? p_secondary_index->_name : NULL;
+}
+
+const char *secondary_index_pattern ( secondary_index *p_secondary_index )
+{
+
+    // done
+    return ( p_secondary_index ) ? p_secondary_index->_pattern : NULL;
+}
+
+const char *secondary_index_path ( secondary_index *p_secondary_index )
+{
+
+    // done
+    return ( p_secondary_index ) ? p_secondary_index->_path : NULL;
+}
+
+size_t secondary_index_count ( secondary_index *p_secondary_index )
+{
+
+    // done
+    return ( p_secondary_index ) ? p_secondary_index->count : 0;
+}
+
+int secondary_index_destroy ( secondary_index **pp_secondary_index )
+{
+
+    // argument check
+    if ( NULL == pp_secondary_index ) goto no_secondary_index;
+
+    // initialized data
+    secondary_index *p_secondary_index = *pp_secondary_index;
+
+    // nothing to destroy
+    if ( NULL == p_secondary_index ) return 1;
+
+    // no more pointer for caller
+    *pp_secondary_index = NULL;
+
+    // release each entry
+    for (size_t i = 0; p_secondary_index->pp_keys && i < p_secondary_index->buckets; i++)
+    {
+
+        // initialized data
+        secondary_index_entry *p_entry = p_secondary_index->pp_keys[i];
+
+        // each entry in the chain
+        while ( p_entry )
+        {
+
+            // initialized data
+            secondary_index_entry *p_next = p_entry->p_next_key;
+
+            // release the entry
+            p_entry = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEXES, p_entry, 0);
+
+            // next
+            p_entry = p_next;
+        }
+    }
+
+    // release the tables, and the index
+    p_secondary_index->pp_keys   = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEXES, p_secondary_index->pp_keys, 0),
+    p_secondary_index->pp_values = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEXES, p_secondary_index->pp_values, 0);
+    p_secondary_index            = key_value_memory_allocator(KEY_VALUE_MEMORY_INDEXES, p_secondary_index, 0);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_secondary_index:
+                #ifndef NDEBUG
+                    log_error("[secondary index] Null pointer provided for parameter \"pp_secondary_index\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
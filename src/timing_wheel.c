@@ -0,0 +1,431 @@
+/** !
+ * Hierarchical timing wheel
+ *
+ * @file src/timing_wheel.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/timing_wheel.h>
+
+// structure definitions
+struct timing_wheel_s
+{
+    unsigned long long now;
+    size_t             count;
+
+    // each slot is the sentinel of a circular list
+    timing_wheel_timer _slots[TIMING_WHEEL_LEVELS][TIMING_WHEEL_SLOTS];
+
+    // timers beyond the range of the top level
+    timing_wheel_timer _overflow;
+
+    // timers that are due, waiting to be reclaimed
+    timing_wheel_timer _expired;
+};
+
+static void timing_wheel_list_init ( timing_wheel_timer *p_sentinel )
+{
+
+    // empty circular list
+    p_sentinel->p_next = p_sentinel,
+    p_sentinel->p_prev = p_sentinel;
+
+    // done
+    return;
+}
+
+static void timing_wheel_list_push ( timing_wheel_timer *p_sentinel, timing_wheel_timer *p_timer )
+{
+
+    // link the timer at the tail
+    p_timer->p_next          = p_sentinel,
+    p_timer->p_prev          = p_sentinel->p_prev,
+    p_sentinel->p_prev->p_next = p_timer,
+    p_sentinel->p_prev       = p_timer;
+
+    // done
+    return;
+}
+
+static void timing_wheel_list_unlink ( timing_wheel_timer *p_timer )
+{
+
+    // unlink the timer
+    p_timer->p_prev->p_next = p_timer->p_next,
+    p_timer->p_next->p_prev = p_timer->p_prev,
+    p_timer->p_next         = NULL,
+    p_timer->p_prev         = NULL;
+
+    // done
+    return;
+}
+
+static void timing_wheel_place ( timing_wheel *p_timing_wheel, timing_wheel_timer *p_timer )
+{
+
+    // initialized data
+    unsigned long long deadline = p_timer->deadline,
+                       delta    = 0;
+
+    // already due
+    if ( deadline <= p_timing_wheel->now )
+    {
+        timing_wheel_list_push(&p_timing_wheel->_expired, p_timer);
+
+        // done
+        return;
+    }
+
+    // compute the distance to the deadline
+    delta = deadline - p_timing_wheel->now;
+
+    // find the lowest level that spans the distance
+    for (size_t level = 0; level < TIMING_WHEEL_LEVELS; level++)
+    {
+
+        // initialized data
+        size_t shift = level * TIMING_WHEEL_SLOT_BITS;
+
+        // too far for this level?
+        if ( delta >> ( shift + TIMING_WHEEL_SLOT_BITS ) ) continue;
+
+        // link the timer into its slot
+        timing_wheel_list_push(&p_timing_wheel->_slots[level][( deadline >> shift ) & TIMING_WHEEL_SLOT_MASK], p_timer);
+
+        // done
+        return;
+    }
+
+    // too far for every level
+    timing_wheel_list_push(&p_timing_wheel->_overflow, p_timer);
+
+    // done
+    return;
+}
+
+static void timing_wheel_cascade ( timing_wheel *p_timing_wheel, timing_wheel_timer *p_sentinel )
+{
+
+    // initialized data
+    timing_wheel_timer _list = { 0 };
+
+    // empty?
+    if ( p_sentinel->p_next == p_sentinel ) return;
+
+    // detach the whole slot, so that re placed timers can land back in it
+    _list.p_next         = p_sentinel->p_next,
+    _list.p_prev         = p_sentinel->p_prev,
+    _list.p_next->p_prev = &_list,
+    _list.p_prev->p_next = &_list;
+    timing_wheel_list_init(p_sentinel);
+
+    // re place each timer relative to the current tick
+    while ( _list.p_next != &_list )
+    {
+
+        // initialized data
+        timing_wheel_timer *p_timer = _list.p_next;
+
+        // move the timer
+        timing_wheel_list_unlink(p_timer);
+        timing_wheel_place(p_timing_wheel, p_timer);
+    }
+
+    // done
+    return;
+}
+
+int timing_wheel_construct ( timing_wheel **pp_timing_wheel, unsigned long long now )
+{
+
+    // argument check
+    if ( NULL == pp_timing_wheel ) goto no_timing_wheel;
+
+    // initialized data
+    timing_wheel *p_timing_wheel = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, 0, sizeof(timing_wheel));
+
+    // error check
+    if ( NULL == p_timing_wheel ) goto no_mem;
+
+    // initialize the wheel
+    memset(p_timing_wheel, 0, sizeof(timing_wheel));
+    p_timing_wheel->now = now;
+
+    // initialize each list
+    for (size_t level = 0; level < TIMING_WHEEL_LEVELS; level++)
+        for (size_t slot = 0; slot < TIMING_WHEEL_SLOTS; slot++)
+            timing_wheel_list_init(&p_timing_wheel->_slots[level][slot]);
+
+    timing_wheel_list_init(&p_timing_wheel->_overflow);
+    timing_wheel_list_init(&p_timing_wheel->_expired);
+
+    // return a pointer to the caller
+    *pp_timing_wheel = p_timing_wheel;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_timing_wheel:
+                #ifndef NDEBUG
+                    log_error("[timing wheel] Null pointer provided for parameter \"pp_timing_wheel\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int timing_wheel_add ( timing_wheel *p_timing_wheel, timing_wheel_timer *p_timer, unsigned long long deadline )
+{
+
+    // argument check
+    if ( NULL == p_timing_wheel ) goto no_timing_wheel;
+    if ( NULL ==        p_timer ) goto no_timer;
+
+    // re arm?
+    if ( p_timer->p_next ) timing_wheel_remove(p_timing_wheel, p_timer);
+
+    // store the deadline
+    p_timer->deadline = deadline;
+
+    // link the timer
+    timing_wheel_place(p_timing_wheel, p_timer);
+
+    // increment the counter
+    p_timing_wheel->count++;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_timing_wheel:
+                #ifndef NDEBUG
+                    log_error("[timing wheel] Null pointer provided for parameter \"p_timing_wheel\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_timer:
+                #ifndef NDEBUG
+                    log_error("[timing wheel] Null pointer provided for parameter \"p_timer\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int timing_wheel_remove ( timing_wheel *p_timing_wheel, timing_wheel_timer *p_timer )
+{
+
+    // argument check
+    if ( NULL == p_timing_wheel ) goto no_timing_wheel;
+    if ( NULL ==        p_timer ) goto no_timer;
+
+    // not armed?
+    if ( NULL == p_timer->p_next ) return 1;
+
+    // unlink the timer
+    timing_wheel_list_unlink(p_timer);
+
+    // decrement the counter
+    p_timing_wheel->count--;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_timing_wheel:
+                #ifndef NDEBUG
+                    log_error("[timing wheel] Null pointer provided for parameter \"p_timing_wheel\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_timer:
+                #ifndef NDEBUG
+                    log_error("[timing wheel] Null pointer provided for parameter \"p_timer\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int timing_wheel_advance ( timing_wheel *p_timing_wheel, unsigned long long now )
+{
+
+    // argument check
+    if ( NULL == p_timing_wheel ) goto no_timing_wheel;
+
+    // step one tick at a time
+    while ( p_timing_wheel->now < now )
+    {
+
+        // initialized data
+        unsigned long long tick = ++p_timing_wheel->now;
+
+        // cascade the upper levels when the level below wraps
+        for (size_t level = 1; level < TIMING_WHEEL_LEVELS; level++)
+        {
+
+            // initialized data
+            size_t shift = level * TIMING_WHEEL_SLOT_BITS;
+
+            // the level below has not wrapped
+            if ( tick & ( ( 1ULL << shift ) - 1 ) ) break;
+
+            // cascade the slot
+            timing_wheel_cascade(p_timing_wheel, &p_timing_wheel->_slots[level][( tick >> shift ) & TIMING_WHEEL_SLOT_MASK]);
+
+            // the top level wrapped, so the overflow list may now fit
+            if ( level == TIMING_WHEEL_LEVELS - 1 )
+                timing_wheel_cascade(p_timing_wheel, &p_timing_wheel->_overflow);
+        }
+
+        // everything in the current slot is due
+        timing_wheel_cascade(p_timing_wheel, &p_timing_wheel->_slots[0][tick & TIMING_WHEEL_SLOT_MASK]);
+    }
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_timing_wheel:
+                #ifndef NDEBUG
+                    log_error("[timing wheel] Null pointer provided for parameter \"p_timing_wheel\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int timing_wheel_expired ( timing_wheel *p_timing_wheel, timing_wheel_timer **pp_timer )
+{
+
+    // argument check
+    if ( NULL == p_timing_wheel ) goto no_timing_wheel;
+    if ( NULL ==       pp_timer ) goto no_timer;
+
+    // initialized data
+    timing_wheel_timer *p_timer = p_timing_wheel->_expired.p_next;
+
+    // empty?
+    if ( p_timer == &p_timing_wheel->_expired ) return 0;
+
+    // unlink the timer
+    timing_wheel_list_unlink(p_timer);
+
+    // decrement the counter
+    p_timing_wheel->count--;
+
+    // return a pointer to the caller
+    *pp_timer = p_timer;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_timing_wheel:
+                #ifndef NDEBUG
+                    log_error("[timing wheel] Null pointer provided for parameter \"p_timing_wheel\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_timer:
+                #ifndef NDEBUG
+                    log_error("[timing wheel] Null pointer provided for parameter \"pp_timer\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+size_t timing_wheel_count ( timing_wheel *p_timing_wheel )
+{
+
+    // argument check
+    if ( NULL == p_timing_wheel ) return 0;
+
+    // done
+    return p_timing_wheel->count;
+}
+
+int timing_wheel_destroy ( timing_wheel **pp_timing_wheel )
+{
+
+    // argument check
+    if ( NULL == pp_timing_wheel ) goto no_timing_wheel;
+
+    // initialized data
+    timing_wheel *p_timing_wheel = *pp_timing_wheel;
+
+    // no more pointer for caller
+    *pp_timing_wheel = NULL;
+
+    // release the wheel
+    p_timing_wheel = key_value_memory_allocator(KEY_VALUE_MEMORY_OTHER, p_timing_wheel, 0);
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_timing_wheel:
+                #ifndef NDEBUG
+                    log_error("[timing wheel] Null pointer provided for parameter \"pp_timing_wheel\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
@@ -0,0 +1,265 @@
+/** !
+ * Vectorized request tokenizer
+ *
+ * @file src/tokenizer.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/tokenizer.h>
+
+// platform dependent includes
+#if ( defined(__x86_64__) || defined(__i386__) ) && defined(__GNUC__)
+    #define TOKENIZER_X86
+    #include <immintrin.h>
+#endif
+
+// preprocessor definitions
+#define TOKENIZER_HASH(p, length) ( ( 3 * (unsigned char) (p)[0] + (unsigned char) (p)[1] + 4 * (unsigned char) (p)[(length) - 1] + (length) ) & 63 )
+
+// type definitions
+typedef size_t (fn_tokenizer_scan)( const char *p_text, size_t length, size_t i );
+
+// data
+/// perfect hash of every verb
+static const struct
+{
+    const char     *p_name;
+    size_t          length;
+    tokenizer_verb  verb;
+} _verbs[64] =
+{
+    [ 1] = { "expire",   6, TOKENIZER_VERB_EXPIRE   },
+    [ 3] = { "ttl",      3, TOKENIZER_VERB_TTL      },
+    [ 5] = { "jset",     4, TOKENIZER_VERB_JSET     },
+    [ 6] = { "version",  7, TOKENIZER_VERB_VERSION  },
+    [14] = { "index",    5, TOKENIZER_VERB_INDEX    },
+    [17] = { "set",      3, TOKENIZER_VERB_SET      },
+    [19] = { "incrby",   6, TOKENIZER_VERB_INCRBY   },
+    [25] = { "cas",      3, TOKENIZER_VERB_CAS      },
+    [29] = { "decr",     4, TOKENIZER_VERB_DECR     },
+    [31] = { "snapshot", 8, TOKENIZER_VERB_SNAPSHOT },
+    [40] = { "slowlog",  7, TOKENIZER_VERB_SLOWLOG  },
+    [41] = { "info",     4, TOKENIZER_VERB_INFO     },
+    [43] = { "watch",    5, TOKENIZER_VERB_WATCH    },
+    [44] = { "batch",    5, TOKENIZER_VERB_BATCH    },
+    [45] = { "get",      3, TOKENIZER_VERB_GET      },
+    [47] = { "find",     4, TOKENIZER_VERB_FIND     },
+    [48] = { "write",    5, TOKENIZER_VERB_WRITE    },
+    [53] = { "incr",     4, TOKENIZER_VERB_INCR     },
+    [54] = { "jappend",  7, TOKENIZER_VERB_JAPPEND  },
+    [56] = { "scan",     4, TOKENIZER_VERB_SCAN     },
+    [57] = { "jget",     4, TOKENIZER_VERB_JGET     },
+    [58] = { "config",   6, TOKENIZER_VERB_CONFIG   },
+    [59] = { "decrby",   6, TOKENIZER_VERB_DECRBY   }
+};
+
+/// scalar implementation
+static size_t tokenizer_token_end_scalar ( const char *p_text, size_t length, size_t i )
+{
+
+    // find the first blank, newline or null terminator
+    for (; i < length; i++)
+        if ( ' ' == p_text[i] || '\t' == p_text[i] || '\n' == p_text[i] || '\r' == p_text[i] || '\0' == p_text[i] ) break;
+
+    // done
+    return i;
+}
+
+static size_t tokenizer_string_end_scalar ( const char *p_text, size_t length, size_t i )
+{
+
+    // find the first quote, backslash or control character
+    for (; i < length; i++)
+        if ( '"' == p_text[i] || '\\' == p_text[i] || (unsigned char) p_text[i] < 0x20 ) break;
+
+    // done
+    return i;
+}
+
+#ifdef TOKENIZER_X86
+
+/// sse4.2 implementation
+__attribute__((target("sse4.2")))
+static size_t tokenizer_token_end_sse42 ( const char *p_text, size_t length, size_t i )
+{
+
+    // initialized data
+    const __m128i delimiters = _mm_setr_epi8(' ', '\t', '\n', '\r', '\0', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+    // sixteen bytes at a time
+    for (; i + 16 <= length; i += 16)
+    {
+
+        // initialized data
+        int index = _mm_cmpestri(delimiters, 5, _mm_loadu_si128((const __m128i *) &p_text[i]), 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+
+        // found?
+        if ( index < 16 ) return i + (size_t) index;
+    }
+
+    // done
+    return tokenizer_token_end_scalar(p_text, length, i);
+}
+
+__attribute__((target("sse4.2")))
+static size_t tokenizer_string_end_sse42 ( const char *p_text, size_t length, size_t i )
+{
+
+    // initialized data
+    const __m128i ranges = _mm_setr_epi8(0x00, 0x1F, '"', '"', '\\', '\\', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+    // sixteen bytes at a time
+    for (; i + 16 <= length; i += 16)
+    {
+
+        // initialized data
+        int index = _mm_cmpestri(ranges, 6, _mm_loadu_si128((const __m128i *) &p_text[i]), 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+
+        // found?
+        if ( index < 16 ) return i + (size_t) index;
+    }
+
+    // done
+    return tokenizer_string_end_scalar(p_text, length, i);
+}
+
+/// avx2 implementation
+__attribute__((target("avx2")))
+static size_t tokenizer_token_end_avx2 ( const char *p_text, size_t length, size_t i )
+{
+
+    // initialized data
+    const __m256i space   = _mm256_set1_epi8(' '),
+                  tab     = _mm256_set1_epi8('\t'),
+                  newline = _mm256_set1_epi8('\n'),
+                  ret     = _mm256_set1_epi8('\r'),
+                  zero    = _mm256_setzero_si256();
+
+    // thirty two bytes at a time
+    for (; i + 32 <= length; i += 32)
+    {
+
+        // initialized data
+        __m256i  block = _mm256_loadu_si256((const __m256i *) &p_text[i]),
+                 match = _mm256_or_si256(
+                             _mm256_or_si256(_mm256_cmpeq_epi8(block, space), _mm256_cmpeq_epi8(block, tab)),
+                             _mm256_or_si256(
+                                 _mm256_or_si256(_mm256_cmpeq_epi8(block, newline), _mm256_cmpeq_epi8(block, ret)),
+                                 _mm256_cmpeq_epi8(block, zero)
+                             )
+                         );
+        unsigned mask  = (unsigned) _mm256_movemask_epi8(match);
+
+        // found?
+        if ( mask ) return i + (size_t) __builtin_ctz(mask);
+    }
+
+    // done
+    return tokenizer_token_end_scalar(p_text, length, i);
+}
+
+__attribute__((target("avx2")))
+static size_t tokenizer_string_end_avx2 ( const char *p_text, size_t length, size_t i )
+{
+
+    // initialized data
+    const __m256i quote     = _mm256_set1_epi8('"'),
+                  backslash = _mm256_set1_epi8('\\'),
+                  control   = _mm256_set1_epi8(0x1F);
+
+    // thirty two bytes at a time
+    for (; i + 32 <= length; i += 32)
+    {
+
+        // initialized data
+        __m256i  block = _mm256_loadu_si256((const __m256i *) &p_text[i]),
+                 match = _mm256_or_si256(
+                             _mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, backslash)),
+                             _mm256_cmpeq_epi8(_mm256_max_epu8(block, control), control)
+                         );
+        unsigned mask  = (unsigned) _mm256_movemask_epi8(match);
+
+        // found?
+        if ( mask ) return i + (size_t) __builtin_ctz(mask);
+    }
+
+    // done
+    return tokenizer_string_end_scalar(p_text, length, i);
+}
+
+#endif
+
+/// the implementation in use
+static fn_tokenizer_scan *pfn_token_end  = tokenizer_token_end_scalar,
+                         *pfn_string_end = tokenizer_string_end_scalar;
+static const char        *p_implementation = "scalar";
+
+void tokenizer_init ( void )
+{
+
+    #ifdef TOKENIZER_X86
+
+        // initialize the cpu feature flags
+        __builtin_cpu_init();
+
+        // avx2
+        if ( __builtin_cpu_supports("avx2") )
+            pfn_token_end    = tokenizer_token_end_avx2,
+            pfn_string_end   = tokenizer_string_end_avx2,
+            p_implementation = "avx2";
+
+        // sse4.2
+        else if ( __builtin_cpu_supports("sse4.2") )
+            pfn_token_end    = tokenizer_token_end_sse42,
+            pfn_string_end   = tokenizer_string_end_sse42,
+            p_implementation = "sse4.2";
+    #endif
+
+    // logs
+    log_info("[key value db] Tokenizer is using the %s implementation\n", p_implementation);
+
+    // done
+    return;
+}
+
+size_t tokenizer_token_end ( const char *p_text, size_t length, size_t i )
+{
+
+    // done
+    return pfn_token_end(p_text, length, i);
+}
+
+size_t tokenizer_string_end ( const char *p_text, size_t length, size_t i )
+{
+
+    // done
+    return pfn_string_end(p_text, length, i);
+}
+
+tokenizer_verb tokenizer_verb_parse ( const char *p_verb, size_t length )
+{
+
+    // initialized data
+    size_t h = 0;
+
+    // every verb has at least three characters
+    if ( length < 3 ) return TOKENIZER_VERB_UNKNOWN;
+
+    // hash the verb
+    h = TOKENIZER_HASH(p_verb, length);
+
+    // one comparison confirms the verb
+    if ( _verbs[h].length == length && 0 == memcmp(_verbs[h].p_name, p_verb, length) ) return _verbs[h].verb;
+
+    // done
+    return TOKENIZER_VERB_UNKNOWN;
+}
+
+const char *tokenizer_implementation ( void )
+{
+
+    // done
+    return p_implementation;
+}
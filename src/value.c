@@ -0,0 +1,490 @@
+/** !
+ * Tagged property values
+ *
+ * @file src/value.c
+ *
+ * @author Jacob Smith
+ */
+
+// header
+#include <key_value/value.h>
+
+// out of line buffers are prefixed with a reference count
+#define KEY_VALUE_VALUE_REFERENCES(p_text) ( (size_t *) ( (char *) (p_text) - sizeof(size_t) ) )
+
+// structure declarations
+struct key_value_value_packed_s;
+
+// type definitions
+typedef struct key_value_value_packed_s key_value_value_packed_data;
+
+// structure definitions
+struct key_value_value_packed_s
+{
+    dictionary *p_dictionary;
+    size_t      length;
+    char        _data[];
+};
+
+// packed values are decompressed here, so reading one allocates nothing
+static _Thread_local char _key_value_value_scratch[KEY_VALUE_VALUE_PACK_MAX];
+
+char *key_value_value_allocate ( size_t length )
+{
+
+    // initialized data
+    size_t *p_references = key_value_memory_allocator(KEY_VALUE_MEMORY_VALUES, 0, sizeof(size_t) + length);
+
+    // error check
+    if ( NULL == p_references ) return NULL;
+
+    // one reference, held by the caller
+    *p_references = 1;
+
+    // done
+    return (char *) ( p_references + 1 );
+}
+
+int key_value_value_adopt ( key_value_value *p_value, char *p_text, size_t length, unsigned char type )
+{
+
+    // argument check
+    if ( NULL == p_value ) return 0;
+    if ( NULL ==  p_text ) return 0;
+
+    // release the previous value
+    key_value_value_free(p_value);
+
+    // store the buffer
+    p_value->heap.p_text = p_text,
+    p_value->heap.length = length,
+    p_value->length      = KEY_VALUE_VALUE_HEAP,
+    p_value->type        = type;
+
+    // success
+    return 1;
+}
+
+const char *key_value_value_retain ( const key_value_value *p_value )
+{
+
+    // inline values can not outlive the record
+    if ( KEY_VALUE_VALUE_HEAP != p_value->length ) return NULL;
+
+    // take a reference
+    __atomic_add_fetch(KEY_VALUE_VALUE_REFERENCES(p_value->heap.p_text), 1, __ATOMIC_RELAXED);
+
+    // done
+    return p_value->heap.p_text;
+}
+
+void key_value_value_release ( const char *p_text )
+{
+
+    // drop a reference, and release the buffer with the last one
+    if ( p_text && 0 == __atomic_sub_fetch(KEY_VALUE_VALUE_REFERENCES(p_text), 1, __ATOMIC_ACQ_REL) )
+        key_value_memory_allocator(KEY_VALUE_MEMORY_VALUES, KEY_VALUE_VALUE_REFERENCES(p_text), 0);
+
+    // done
+    return;
+}
+
+int key_value_value_from_text ( key_value_value *p_value, const char *p_text, size_t length, unsigned char type )
+{
+
+    // argument check
+    if ( NULL == p_value ) goto no_value;
+    if ( NULL ==  p_text ) goto no_text;
+
+    // release the previous value
+    key_value_value_free(p_value);
+
+    // store the value inline
+    if ( length <= KEY_VALUE_VALUE_INLINE )
+    {
+        memcpy(p_value->_inline, p_text, length);
+        p_value->length = (unsigned char) length;
+    }
+
+    // store the value out of line
+    else
+    {
+
+        // initialized data
+        char *p_heap = key_value_value_allocate(length);
+
+        // error check
+        if ( NULL == p_heap ) goto no_mem;
+
+        // copy the value
+        memcpy(p_heap, p_text, length);
+
+        // store the value
+        p_value->heap.p_text = p_heap,
+        p_value->heap.length = length,
+        p_value->length      = KEY_VALUE_VALUE_HEAP;
+    }
+
+    // store the type
+    p_value->type = type;
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_value:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_value\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_text:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_text\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_value_splice ( key_value_value *p_value, size_t offset, size_t span, const char *p_text, size_t length )
+{
+
+    // argument check
+    if ( NULL == p_value ) goto no_value;
+    if ( NULL ==  p_text ) goto no_text;
+
+    // initialized data
+    size_t      old_length = 0;
+    const char *p_old      = key_value_value_text(p_value, &old_length);
+    size_t      tail       = old_length - offset - span,
+                new_length = old_length - span + length;
+
+    // error check
+    if ( offset + span > old_length         ) goto out_of_bounds;
+    if ( new_length > KEY_VALUE_VALUE_LIMIT ) goto too_long;
+
+    // the result is short enough to be inline
+    if ( new_length <= KEY_VALUE_VALUE_INLINE )
+    {
+
+        // initialized data
+        char _text[KEY_VALUE_VALUE_INLINE] = { 0 };
+
+        // compose the result
+        memcpy(_text, p_old, offset);
+        memcpy(&_text[offset], p_text, length);
+        memcpy(&_text[offset + length], &p_old[offset + span], tail);
+
+        // done
+        return key_value_value_from_text(p_value, _text, new_length, p_value->type);
+    }
+
+    // the value is inline, or a response is still sending the buffer
+    if ( KEY_VALUE_VALUE_HEAP != p_value->length || 1 != __atomic_load_n(KEY_VALUE_VALUE_REFERENCES(p_old), __ATOMIC_ACQUIRE) )
+    {
+
+        // initialized data
+        char *p_heap = key_value_value_allocate(new_length);
+
+        // error check
+        if ( NULL == p_heap ) goto no_mem;
+
+        // compose the result
+        memcpy(p_heap, p_old, offset);
+        memcpy(&p_heap[offset], p_text, length);
+        memcpy(&p_heap[offset + length], &p_old[offset + span], tail);
+
+        // store the result, and drop the shared buffer, or the packed value
+        key_value_value_free(p_value);
+        p_value->heap.p_text = p_heap,
+        p_value->heap.length = new_length,
+        p_value->length      = KEY_VALUE_VALUE_HEAP;
+
+        // success
+        return 1;
+    }
+
+    // edit the out of line buffer in place
+    {
+
+        // initialized data
+        size_t *p_references = KEY_VALUE_VALUE_REFERENCES(p_value->heap.p_text);
+        char   *p_heap       = NULL;
+
+        // shrink after moving the tail. the tail has moved, so if the buffer
+        // can not shrink, the value keeps the larger buffer
+        if ( new_length < old_length )
+        {
+            memmove(&p_value->heap.p_text[offset + length], &p_value->heap.p_text[offset + span], tail);
+            p_heap       = (char *) ( p_references + 1 );
+            p_references = key_value_memory_allocator(KEY_VALUE_MEMORY_VALUES, p_references, sizeof(size_t) + new_length);
+            if ( p_references ) p_heap = (char *) ( p_references + 1 );
+        }
+
+        // grow before moving the tail
+        else
+        {
+            p_references = key_value_memory_allocator(KEY_VALUE_MEMORY_VALUES, p_references, sizeof(size_t) + new_length);
+            if ( NULL == p_references ) goto no_mem;
+            p_heap = (char *) ( p_references + 1 );
+            memmove(&p_heap[offset + length], &p_heap[offset + span], tail);
+        }
+
+        // copy the fragment
+        memcpy(&p_heap[offset], p_text, length);
+
+        // store the result
+        p_value->heap.p_text = p_heap,
+        p_value->heap.length = new_length;
+    }
+
+    // success
+    return 1;
+
+    // error handling
+    {
+
+        // argument errors
+        {
+            no_value:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_value\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            no_text:
+                #ifndef NDEBUG
+                    log_error("[key value db] Null pointer provided for parameter \"p_text\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            out_of_bounds:
+                #ifndef NDEBUG
+                    log_error("[key value db] Splice is out of bounds in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+
+            too_long:
+                #ifndef NDEBUG
+                    log_error("[key value db] Value would exceed %d bytes in call to function \"%s\"\n", KEY_VALUE_VALUE_LIMIT, __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // error
+                return 0;
+        }
+    }
+}
+
+int key_value_value_pack ( key_value_value *p_value, dictionary *p_dictionary )
+{
+
+    // argument check
+    if ( NULL ==      p_value ) return 0;
+    if ( NULL == p_dictionary ) return 0;
+
+    // initialized data
+    key_value_value_packed_data *p_packed = NULL;
+    char                         _data[KEY_VALUE_VALUE_PACK_MAX];
+    size_t                       length   = 0,
+                                 packed   = 0;
+    const char                  *p_text   = NULL;
+
+    // already packed with this dictionary
+    if ( KEY_VALUE_VALUE_PACKED == p_value->length && p_dictionary == ( (key_value_value_packed_data *) p_value->packed.p_packed )->p_dictionary ) return 1;
+
+    // inline, and long, values are left alone
+    if ( KEY_VALUE_VALUE_HEAP != p_value->length && KEY_VALUE_VALUE_PACKED != p_value->length ) return 0;
+    if ( p_value->heap.length > KEY_VALUE_VALUE_PACK_MAX ) return 0;
+
+    // compress the value. it must save more than the header costs
+    p_text = key_value_value_text(p_value, &length);
+    if ( length <= sizeof(key_value_value_packed_data) ) return 0;
+    if ( 0 == dictionary_compress(p_dictionary, p_text, length, _data, length - sizeof(key_value_value_packed_data), &packed) ) return 0;
+
+    // allocate the packed value
+    p_packed = key_value_memory_allocator(KEY_VALUE_MEMORY_VALUES, 0, sizeof(key_value_value_packed_data) + packed);
+    if ( NULL == p_packed ) return 0;
+
+    // copy the compressed value
+    p_packed->p_dictionary = p_dictionary,
+    p_packed->length       = packed;
+    memcpy(p_packed->_data, _data, packed);
+    dictionary_retain(p_dictionary, length, packed);
+
+    // replace the value
+    key_value_value_free(p_value);
+    p_value->packed.p_packed = p_packed,
+    p_value->packed.length   = length,
+    p_value->length          = KEY_VALUE_VALUE_PACKED;
+
+    // success
+    return 1;
+}
+
+const char *key_value_value_text ( const key_value_value *p_value, size_t *p_length )
+{
+
+    // packed
+    if ( KEY_VALUE_VALUE_PACKED == p_value->length )
+    {
+        *p_length = key_value_value_serialize(p_value, _key_value_value_scratch);
+
+        // done
+        return _key_value_value_scratch;
+    }
+
+    // out of line
+    if ( KEY_VALUE_VALUE_HEAP == p_value->length )
+    {
+        *p_length = p_value->heap.length;
+
+        // done
+        return p_value->heap.p_text;
+    }
+
+    // inline
+    *p_length = p_value->length;
+
+    // done
+    return p_value->_inline;
+}
+
+int key_value_value_integer ( const key_value_value *p_value, long long *p_integer )
+{
+
+    // initialized data
+    char        _digits[KEY_VALUE_VALUE_INLINE + 1] = { 0 };
+    size_t      length                              = 0;
+    const char *p_text                              = NULL;
+
+    // error check
+    if ( JSON_VALUE_INTEGER != p_value->type ) return 0;
+
+    // integers are always short enough to be inline
+    p_text = key_value_value_text(p_value, &length);
+    if ( length > KEY_VALUE_VALUE_INLINE ) return 0;
+
+    // parse the integer
+    memcpy(_digits, p_text, length);
+    *p_integer = strtoll(_digits, NULL, 10);
+
+    // success
+    return 1;
+}
+
+size_t key_value_value_length ( const key_value_value *p_value )
+{
+
+    // done
+    return ( KEY_VALUE_VALUE_HEAP == p_value->length || KEY_VALUE_VALUE_PACKED == p_value->length ) ? p_value->heap.length : p_value->length;
+}
+
+bool key_value_value_packed ( const key_value_value *p_value )
+{
+
+    // done
+    return KEY_VALUE_VALUE_PACKED == p_value->length;
+}
+
+size_t key_value_value_heap_size ( const key_value_value *p_value )
+{
+
+    // packed
+    if ( KEY_VALUE_VALUE_PACKED == p_value->length )
+        return sizeof(key_value_value_packed_data) + ( (key_value_value_packed_data *) p_value->packed.p_packed )->length;
+
+    // done
+    return ( KEY_VALUE_VALUE_HEAP == p_value->length ) ? p_value->heap.length : 0;
+}
+
+size_t key_value_value_serialize ( const key_value_value *p_value, char *p_buffer )
+{
+
+    // decompress a packed value straight into the buffer
+    if ( KEY_VALUE_VALUE_PACKED == p_value->length )
+    {
+
+        // initialized data
+        key_value_value_packed_data *p_packed = p_value->packed.p_packed;
+
+        // error check
+        if ( 0 == dictionary_decompress(p_packed->p_dictionary, p_packed->_data, p_packed->length, p_buffer, p_value->packed.length) ) return 0;
+
+        // done
+        return p_value->packed.length;
+    }
+
+    // initialized data
+    size_t      length = 0;
+    const char *p_text = key_value_value_text(p_value, &length);
+
+    // copy the value
+    memcpy(p_buffer, p_text, length);
+
+    // done
+    return length;
+}
+
+void key_value_value_free ( key_value_value *p_value )
+{
+
+    // drop the reference to the out of line buffer
+    if ( KEY_VALUE_VALUE_HEAP == p_value->length )
+        key_value_value_release(p_value->heap.p_text),
+        p_value->heap.p_text = NULL;
+
+    // release the packed value, and its reference to the dictionary
+    else if ( KEY_VALUE_VALUE_PACKED == p_value->length )
+    {
+
+        // initialized data
+        key_value_value_packed_data *p_packed = p_value->packed.p_packed;
+
+        // release the packed value
+        dictionary_release(p_packed->p_dictionary, p_value->packed.length, p_packed->length);
+        p_value->packed.p_packed = key_value_memory_allocator(KEY_VALUE_MEMORY_VALUES, p_packed, 0);
+    }
+
+    // empty inline value
+    p_value->length = 0;
+
+    // done
+    return;
+}
@@ -0,0 +1,368 @@
+/** !
+ * B+tree tests. Random inserts and removes are checked against a sorted
+ * reference, then keys in order, and in reverse order, load the tree, and
+ * are removed
+ *
+ * @file tests/b_plus_tree_test.c
+ *
+ * @author Jacob Smith
+ */
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// key value
+#include <key_value/b_plus_tree.h>
+#include <key_value/memory.h>
+
+// preprocessor definitions
+#define B_PLUS_TREE_TEST_KEYS   20000
+#define B_PLUS_TREE_TEST_STEPS  ( 6 * B_PLUS_TREE_TEST_KEYS )
+#define B_PLUS_TREE_TEST_CHECKS 8
+#define B_PLUS_TREE_TEST_SORTED ( 10 * B_PLUS_TREE_TEST_KEYS )
+
+// structure declarations
+struct b_plus_tree_test_item_s;
+struct b_plus_tree_test_walk_s;
+
+// type definitions
+typedef struct b_plus_tree_test_item_s b_plus_tree_test_item;
+typedef struct b_plus_tree_test_walk_s b_plus_tree_test_walk;
+
+// structure definitions
+struct b_plus_tree_test_item_s
+{
+    char _key[B_PLUS_TREE_KEY_MAX];
+    bool in;
+};
+
+// the keys a range walk is expected to visit, in order
+struct b_plus_tree_test_walk_s
+{
+    b_plus_tree_test_item **pp_expected;
+    size_t                  count,
+                            visited;
+    bool                    match;
+};
+
+// data
+static size_t failures = 0;
+
+// forward declarations
+/** !
+ * Count a failed check, and report it
+ *
+ * @param passed  the result of the check
+ * @param p_check what was checked
+ *
+ * @return void
+ */
+void b_plus_tree_test_check ( bool passed, const char *p_check );
+
+/** !
+ * Get the key of an item
+ *
+ * @param p_value the item
+ *
+ * @return the key
+ */
+const char *b_plus_tree_test_key ( const void *p_value );
+
+/** !
+ * Compare the keys of two items, for qsort
+ *
+ * @param p_a pointer to an item pointer
+ * @param p_b pointer to an item pointer
+ *
+ * @return the order of the keys
+ */
+int b_plus_tree_test_compare ( const void *p_a, const void *p_b );
+
+/** !
+ * Check each item a range walk visits against the next expected item
+ *
+ * @param p_value     the item
+ * @param p_parameter the walk
+ *
+ * @return 1 to continue, 0 to stop
+ */
+int b_plus_tree_test_visit ( void *p_value, void *p_parameter );
+
+/** !
+ * Check the tree against the items that are in it. Each item is searched
+ * for, and the tree is walked from a key, and from the first key
+ *
+ * @param p_b_plus_tree the B+tree
+ * @param p_items       the items
+ * @param count         the quantity of items
+ * @param pp_sorted     scratch space for count item pointers
+ * @param p_first       the key to walk from
+ * @param p_phase       what the tree went through
+ *
+ * @return void
+ */
+void b_plus_tree_test_validate ( b_plus_tree *p_b_plus_tree, b_plus_tree_test_item *p_items, size_t count, b_plus_tree_test_item **pp_sorted, const char *p_first, const char *p_phase );
+
+// function definitions
+void b_plus_tree_test_check ( bool passed, const char *p_check )
+{
+
+    // report the failure
+    if ( false == passed ) failures++, printf("[b plus tree test] Failed: %s\n", p_check);
+
+    // done
+    return;
+}
+
+const char *b_plus_tree_test_key ( const void *p_value )
+{
+
+    // done
+    return ((const b_plus_tree_test_item *) p_value)->_key;
+}
+
+int b_plus_tree_test_compare ( const void *p_a, const void *p_b )
+{
+
+    // done
+    return strcmp((*(b_plus_tree_test_item * const *) p_a)->_key, (*(b_plus_tree_test_item * const *) p_b)->_key);
+}
+
+int b_plus_tree_test_visit ( void *p_value, void *p_parameter )
+{
+
+    // initialized data
+    b_plus_tree_test_walk *p_walk = p_parameter;
+
+    // a walk past the last expected item, or out of order, is wrong
+    if ( p_walk->visited == p_walk->count || p_walk->pp_expected[p_walk->visited] != p_value ) return p_walk->match = false, 0;
+
+    // next item
+    p_walk->visited++;
+
+    // done
+    return 1;
+}
+
+void b_plus_tree_test_validate ( b_plus_tree *p_b_plus_tree, b_plus_tree_test_item *p_items, size_t count, b_plus_tree_test_item **pp_sorted, const char *p_first, const char *p_phase )
+{
+
+    // initialized data
+    b_plus_tree_statistics  _statistics = { 0 };
+    b_plus_tree_test_walk   _walk       = { .pp_expected = pp_sorted, .match = true };
+    size_t                  live        = 0,
+                            first       = 0;
+    bool                    found       = true;
+    char                    _check[128] = { 0 };
+
+    // every item is found if, and only if, it is in the tree
+    for (size_t i = 0; i < count; i++)
+    {
+
+        // initialized data
+        void *p_value = NULL;
+
+        // search the tree
+        if ( b_plus_tree_search(p_b_plus_tree, p_items[i]._key, &p_value) != p_items[i].in ) found = false;
+        if ( p_items[i].in && p_value != &p_items[i] ) found = false;
+
+        // the expected order
+        if ( p_items[i].in ) pp_sorted[live++] = &p_items[i];
+    }
+
+    // sort the items that are in the tree
+    qsort(pp_sorted, live, sizeof(b_plus_tree_test_item *), b_plus_tree_test_compare);
+
+    // the size of the tree
+    b_plus_tree_statistics_get(p_b_plus_tree, &_statistics);
+    snprintf(_check, sizeof(_check), "%s, the count", p_phase);
+    b_plus_tree_test_check(_statistics.count == live, _check);
+    snprintf(_check, sizeof(_check), "%s, search", p_phase);
+    b_plus_tree_test_check(found, _check);
+
+    // walk from the first key
+    _walk.count = live;
+    b_plus_tree_range(p_b_plus_tree, NULL, b_plus_tree_test_visit, &_walk);
+    snprintf(_check, sizeof(_check), "%s, a walk from the first key", p_phase);
+    b_plus_tree_test_check(_walk.match && _walk.visited == live, _check);
+
+    // walk from a key, which need not be in the tree
+    while ( first < live && strcmp(pp_sorted[first]->_key, p_first) < 0 ) first++;
+    _walk.pp_expected = &pp_sorted[first],
+    _walk.count       = live - first,
+    _walk.visited     = 0,
+    _walk.match       = true;
+    b_plus_tree_range(p_b_plus_tree, p_first, b_plus_tree_test_visit, &_walk);
+    snprintf(_check, sizeof(_check), "%s, a walk from \"%s\"", p_phase, p_first);
+    b_plus_tree_test_check(_walk.match && _walk.visited == live - first, _check);
+
+    // done
+    return;
+}
+
+// entry point
+int main ( int argc, const char *argv[] )
+{
+
+    // unused
+    (void) argc;
+    (void) argv;
+
+    // initialized data
+    b_plus_tree             *p_b_plus_tree = NULL;
+    b_plus_tree_test_item   *p_items       = calloc(B_PLUS_TREE_TEST_SORTED, sizeof(b_plus_tree_test_item));
+    b_plus_tree_test_item  **pp_sorted     = calloc(B_PLUS_TREE_TEST_SORTED, sizeof(b_plus_tree_test_item *));
+    b_plus_tree_statistics   _statistics   = { 0 };
+    key_value_memory_usage   _usage        = { 0 };
+    const char              *_prefixes[]   = { "id:user:", "id:user:0000000000", "a", "id:org:", "", "zzzzzzzzzzzzzzzzzzzzzz:" };
+    bool                     removed       = true;
+
+    // error check
+    if ( NULL == p_items || NULL == pp_sorted ) goto no_mem;
+
+    // a fixed seed, so a failure repeats
+    srand(1);
+
+    // random keys. shared prefixes, and keys that are prefixes of others, reach
+    // the prefix, and head, comparisons
+    {
+
+        // construct a B+tree
+        if ( 0 == b_plus_tree_construct(&p_b_plus_tree, b_plus_tree_test_key) ) goto failed_to_construct;
+
+        // unique keys, of varying length
+        for (size_t i = 0; i < B_PLUS_TREE_TEST_KEYS; i++)
+        {
+
+            // initialized data
+            int r = rand();
+
+            // the key
+            snprintf(p_items[i]._key, sizeof(p_items[i]._key), "%s%0*zu%s", _prefixes[r % 6], r / 6 % 20 + 1, i, ( r % 7 ) ? "" : "xyz");
+        }
+
+        // insert, and remove, at random
+        for (size_t step = 1; step <= B_PLUS_TREE_TEST_STEPS; step++)
+        {
+
+            // initialized data
+            b_plus_tree_test_item *p_item  = &p_items[(size_t) rand() % B_PLUS_TREE_TEST_KEYS];
+            void                  *p_value = NULL;
+
+            // insert the item, or remove it
+            if ( false == p_item->in )
+                p_item->in = ( 1 == b_plus_tree_insert(p_b_plus_tree, p_item) );
+            else
+                removed     = removed && b_plus_tree_remove(p_b_plus_tree, p_item->_key, &p_value) && p_value == p_item,
+                p_item->in  = false;
+
+            // check the tree now and then
+            if ( 0 == step % ( B_PLUS_TREE_TEST_STEPS / B_PLUS_TREE_TEST_CHECKS ) )
+                b_plus_tree_test_validate(p_b_plus_tree, p_items, B_PLUS_TREE_TEST_KEYS, pp_sorted, p_items[(size_t) rand() % B_PLUS_TREE_TEST_KEYS]._key, "random");
+        }
+        b_plus_tree_test_check(removed, "random, each remove returns the value");
+
+        // a key in the tree is not inserted again
+        for (size_t i = 0; i < B_PLUS_TREE_TEST_KEYS; i++)
+            if ( p_items[i].in ) { b_plus_tree_test_check(0 == b_plus_tree_insert(p_b_plus_tree, &p_items[i]), "random, a duplicate insert"); break; }
+
+        // remove every key
+        for (size_t i = 0; i < B_PLUS_TREE_TEST_KEYS; i++)
+            if ( p_items[i].in ) removed = removed && b_plus_tree_remove(p_b_plus_tree, p_items[i]._key, NULL), p_items[i].in = false;
+        b_plus_tree_test_check(removed, "random, removing every key");
+        b_plus_tree_test_validate(p_b_plus_tree, p_items, B_PLUS_TREE_TEST_KEYS, pp_sorted, "", "random, emptied");
+        b_plus_tree_statistics_get(p_b_plus_tree, &_statistics);
+        b_plus_tree_test_check(1 == _statistics.height && 0 == _statistics.inners, "random, an empty tree is one leaf");
+    }
+
+    // sorted keys fill their leaves, as they are appended
+    {
+
+        // the keys, in order
+        for (size_t i = 0; i < B_PLUS_TREE_TEST_SORTED; i++)
+            snprintf(p_items[i]._key, sizeof(p_items[i]._key), "id:user:%09zu", i),
+            p_items[i].in = ( 1 == b_plus_tree_insert(p_b_plus_tree, &p_items[i]) );
+        b_plus_tree_test_validate(p_b_plus_tree, p_items, B_PLUS_TREE_TEST_SORTED, pp_sorted, "id:user:000100000", "sorted");
+
+        // every leaf, but the last, is full
+        b_plus_tree_statistics_get(p_b_plus_tree, &_statistics);
+        b_plus_tree_test_check(_statistics.leaves == ( B_PLUS_TREE_TEST_SORTED + B_PLUS_TREE_FANOUT - 1 ) / B_PLUS_TREE_FANOUT, "sorted, full leaves");
+
+        // remove seven of every eight keys, which leaves the leaves under
+        // B_PLUS_TREE_MIN, so they merge, and rotate
+        for (size_t i = 0; i < B_PLUS_TREE_TEST_SORTED; i++)
+            if ( i % 8 )
+                removed = removed && b_plus_tree_remove(p_b_plus_tree, p_items[i]._key, NULL),
+                p_items[i].in = false;
+        b_plus_tree_test_check(removed, "sorted, removing seven of every eight keys");
+        b_plus_tree_test_validate(p_b_plus_tree, p_items, B_PLUS_TREE_TEST_SORTED, pp_sorted, "id:user:000100003", "sorted, seven of every eight keys removed");
+
+        // fewer leaves hold the rest
+        b_plus_tree_statistics_get(p_b_plus_tree, &_statistics);
+        b_plus_tree_test_check(_statistics.leaves < ( B_PLUS_TREE_TEST_SORTED / 8 ) / B_PLUS_TREE_MIN * 2, "sorted, the leaves merge");
+
+        // release the tree
+        b_plus_tree_destroy(&p_b_plus_tree);
+    }
+
+    // keys in reverse order split at the front of the leaves
+    {
+
+        // construct a B+tree
+        if ( 0 == b_plus_tree_construct(&p_b_plus_tree, b_plus_tree_test_key) ) goto failed_to_construct;
+
+        // the keys, in reverse order
+        for (size_t i = B_PLUS_TREE_TEST_SORTED; i-- > 0; )
+            p_items[i].in = ( 1 == b_plus_tree_insert(p_b_plus_tree, &p_items[i]) );
+        b_plus_tree_test_validate(p_b_plus_tree, p_items, B_PLUS_TREE_TEST_SORTED, pp_sorted, "id:user:000150000x", "reverse");
+
+        // remove the keys, from the first
+        for (size_t i = 0; i < B_PLUS_TREE_TEST_SORTED; i++)
+            removed = removed && b_plus_tree_remove(p_b_plus_tree, p_items[i]._key, NULL),
+            p_items[i].in = false;
+        b_plus_tree_test_check(removed, "reverse, removing every key in order");
+        b_plus_tree_test_validate(p_b_plus_tree, p_items, B_PLUS_TREE_TEST_SORTED, pp_sorted, "", "reverse, emptied");
+
+        // release the tree
+        b_plus_tree_destroy(&p_b_plus_tree);
+    }
+
+    // every node was released
+    key_value_memory_usage_get(KEY_VALUE_MEMORY_INDEX, &_usage);
+    b_plus_tree_test_check(0 == _usage.bytes && 0 == _usage.objects, "destroy releases every node");
+
+    // release the items
+    free(p_items);
+    free(pp_sorted);
+
+    // report
+    printf("[b plus tree test] %s\n", ( failures ) ? "FAILED" : "passed");
+
+    // done
+    return ( failures ) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+    // error handling
+    {
+
+        // b plus tree errors
+        {
+            failed_to_construct:
+                printf("[b plus tree test] Failed to construct a B+tree\n");
+
+                // error
+                return EXIT_FAILURE;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                printf("[b plus tree test] Failed to allocate memory\n");
+
+                // error
+                return EXIT_FAILURE;
+        }
+    }
+}
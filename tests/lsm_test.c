@@ -0,0 +1,293 @@
+/** !
+ * LSM tree tests. Batches of overwrites, and deletes, are flushed until the
+ * compaction thread merges level 0, then every key is read back, before, and
+ * after, the tables are reopened
+ *
+ * @file tests/lsm_test.c
+ *
+ * @author Jacob Smith
+ */
+
+// standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+// posix
+#include <unistd.h>
+#include <dirent.h>
+
+// key value
+#include <key_value/lsm.h>
+#include <key_value/value.h>
+
+// preprocessor definitions
+#define LSM_TEST_KEYS        20000
+#define LSM_TEST_BATCH       1000
+#define LSM_TEST_ROUNDS      3
+#define LSM_TEST_DELETE      7     // every seventh key is deleted in the last round
+#define LSM_TEST_BLOCK_CACHE ( 1024 * 1024 )
+#define LSM_TEST_WAIT_MS     10000
+
+// data
+static size_t failures = 0;
+
+// forward declarations
+/** !
+ * Count a failed check, and report it
+ *
+ * @param passed  the result of the check
+ * @param p_check what was checked
+ *
+ * @return void
+ */
+void lsm_test_check ( bool passed, const char *p_check );
+
+/** !
+ * Remove a directory of tables, from a previous run, or this one
+ *
+ * @param p_directory the directory
+ *
+ * @return void
+ */
+void lsm_test_remove ( const char *p_directory );
+
+/** !
+ * Write the value a key has after a round
+ *
+ * @param p_value the buffer
+ * @param key     the key
+ * @param round   the round
+ *
+ * @return the length of the value
+ */
+size_t lsm_test_value ( char *p_value, size_t key, size_t round );
+
+/** !
+ * Read every key back, and compare it with the value of the last round
+ *
+ * @param p_lsm the lsm tree
+ *
+ * @return the quantity of keys that were wrong
+ */
+size_t lsm_test_verify ( lsm *p_lsm );
+
+// function definitions
+void lsm_test_check ( bool passed, const char *p_check )
+{
+
+    // report the failure
+    if ( false == passed ) failures++, printf("[lsm test] Failed: %s\n", p_check);
+
+    // done
+    return;
+}
+
+void lsm_test_remove ( const char *p_directory )
+{
+
+    // initialized data
+    DIR           *p_dir   = opendir(p_directory);
+    struct dirent *p_entry = NULL;
+    char           _path[FILENAME_MAX];
+
+    // nothing to remove
+    if ( NULL == p_dir ) return;
+
+    // remove each file
+    while ( ( p_entry = readdir(p_dir) ) )
+    {
+        if ( '.' == p_entry->d_name[0] ) continue;
+        snprintf(_path, sizeof(_path), "%s/%s", p_directory, p_entry->d_name);
+        remove(_path);
+    }
+
+    // remove the directory
+    closedir(p_dir);
+    rmdir(p_directory);
+
+    // done
+    return;
+}
+
+size_t lsm_test_value ( char *p_value, size_t key, size_t round )
+{
+
+    // a string, long enough that a batch spans many blocks
+    return (size_t) sprintf(p_value, "\"value %zu of key %zu, padded to span blocks ........................\"", round, key);
+}
+
+size_t lsm_test_verify ( lsm *p_lsm )
+{
+
+    // initialized data
+    size_t wrong = 0;
+
+    // read each key
+    for (size_t i = 0; i < LSM_TEST_KEYS; i++)
+    {
+
+        // initialized data
+        key_value_value     _value   = { 0 };
+        unsigned long long  expires  = 0,
+                            version  = 0;
+        char                _key[LSM_KEY_MAX],
+                            _expected[128];
+        size_t              expected = lsm_test_value(_expected, i, LSM_TEST_ROUNDS - 1),
+                            length   = 0;
+        const char         *p_text   = NULL;
+        int                 found    = 0;
+
+        // the key
+        snprintf(_key, sizeof(_key), "key:%06zu", i);
+        found = lsm_get(p_lsm, _key, &_value, &expires, &version);
+
+        // a deleted key is missing
+        if ( 0 == i % LSM_TEST_DELETE )
+        {
+            if ( found ) wrong++, key_value_value_free(&_value);
+
+            // next key
+            continue;
+        }
+
+        // the newest value
+        if ( 0 == found ) { wrong++; continue; }
+        p_text = key_value_value_text(&_value, &length);
+        if ( length != expected || memcmp(p_text, _expected, length) ) wrong++;
+        key_value_value_free(&_value);
+    }
+
+    // done
+    return wrong;
+}
+
+// entry point
+int main ( int argc, const char *argv[] )
+{
+
+    // initialized data
+    const char         *p_directory = ( argc > 1 ) ? argv[1] : "lsm_test.lsm";
+    lsm                *p_lsm       = NULL;
+    lsm_entry          *p_entries   = calloc(LSM_TEST_BATCH, sizeof(lsm_entry));
+    char              (*p_keys)[LSM_KEY_MAX] = calloc(LSM_TEST_BATCH, LSM_KEY_MAX);
+    char              (*p_values)[128]       = calloc(LSM_TEST_BATCH, 128);
+    lsm_statistics      _statistics = { 0 };
+    struct timespec     _wait       = { .tv_sec = 0, .tv_nsec = 10 * 1000000 };
+    unsigned long long  sequence    = 0;
+    bool                flushed     = true;
+
+    // error check
+    if ( NULL == p_entries || NULL == p_keys || NULL == p_values ) goto no_mem;
+
+    // start without tables
+    lsm_test_remove(p_directory);
+    lsm_test_check(false == lsm_exists(p_directory), "no tables before the first open");
+
+    // open the tables
+    if ( 0 == lsm_construct(&p_lsm, p_directory, LSM_TEST_BLOCK_CACHE) ) goto failed_to_open;
+
+    // write each key once a round, in batches, in a scattered order. the last
+    // round deletes every seventh key instead
+    for (size_t round = 0; round < LSM_TEST_ROUNDS; round++)
+    {
+        for (size_t first = 0; first < LSM_TEST_KEYS; first += LSM_TEST_BATCH)
+        {
+
+            // initialized data
+            size_t count = 0;
+
+            // the batch
+            for (size_t j = first; j < first + LSM_TEST_BATCH && j < LSM_TEST_KEYS; j++)
+            {
+
+                // initialized data
+                size_t key = j * 7919 % LSM_TEST_KEYS;
+
+                // the key
+                snprintf(p_keys[count], LSM_KEY_MAX, "key:%06zu", key);
+
+                // a delete is written with the next flush
+                if ( LSM_TEST_ROUNDS - 1 == round && 0 == key % LSM_TEST_DELETE )
+                {
+                    lsm_delete(p_lsm, p_keys[count]);
+
+                    // next key
+                    continue;
+                }
+
+                // the record
+                p_entries[count] = (lsm_entry)
+                {
+                    .p_key   = p_keys[count],
+                    .p_value = p_values[count],
+                    .length  = lsm_test_value(p_values[count], key, round),
+                    .version = ++sequence,
+                    .type    = JSON_VALUE_STRING
+                };
+                count++;
+            }
+
+            // write a level 0 table
+            flushed = flushed && lsm_flush(p_lsm, p_entries, count, sequence);
+        }
+    }
+    lsm_test_check(flushed, "every flush");
+
+    // wait for the compaction thread to merge level 0
+    for (size_t waited = 0; waited < LSM_TEST_WAIT_MS; waited += 10)
+    {
+        lsm_statistics_get(p_lsm, &_statistics);
+        if ( _statistics.compactions ) break;
+        nanosleep(&_wait, NULL);
+    }
+    lsm_test_check(_statistics.flushes == LSM_TEST_ROUNDS * LSM_TEST_KEYS / LSM_TEST_BATCH, "the flush count");
+    lsm_test_check(0 < _statistics.compactions, "compaction");
+    lsm_test_check(0 == lsm_test_verify(p_lsm), "the newest values, after compaction");
+
+    // reopen the tables
+    lsm_destroy(&p_lsm);
+    lsm_test_check(lsm_exists(p_directory), "tables after a close");
+    if ( 0 == lsm_construct(&p_lsm, p_directory, LSM_TEST_BLOCK_CACHE) ) goto failed_to_open;
+    lsm_test_check(sequence == lsm_sequence(p_lsm), "the commit sequence, after a reopen");
+    lsm_test_check(0 == lsm_test_verify(p_lsm), "the newest values, after a reopen");
+
+    // close the tables, and remove them
+    lsm_destroy(&p_lsm);
+    lsm_test_remove(p_directory);
+
+    // release the batch
+    free(p_entries);
+    free(p_keys);
+    free(p_values);
+
+    // report
+    printf("[lsm test] %s\n", ( failures ) ? "FAILED" : "passed");
+
+    // done
+    return ( failures ) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+    // error handling
+    {
+
+        // lsm errors
+        {
+            failed_to_open:
+                printf("[lsm test] Failed to open the tables in \"%s\"\n", p_directory);
+
+                // error
+                return EXIT_FAILURE;
+        }
+
+        // standard library errors
+        {
+            no_mem:
+                printf("[lsm test] Failed to allocate memory\n");
+
+                // error
+                return EXIT_FAILURE;
+        }
+    }
+}